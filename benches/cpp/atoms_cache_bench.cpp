@@ -0,0 +1,101 @@
+// Measures the cost of ConFrame::atoms(): the first call, which fills the
+// per-atom cache through strided copies, against cached calls and against a
+// plain rkr_frame_copy_positions into a caller buffer.
+//
+// Usage: atoms_cache_bench [n_atoms ...]   (default: 100 10000 1000000)
+#include "readcon-core.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+readcon::ConFrame make_frame(size_t n_atoms) {
+    readcon::ConFrameBuilder builder({100.0, 100.0, 100.0}, {90.0, 90.0, 90.0},
+                                     {"Random Number Seed", "0.0000 TIME"},
+                                     {"0 0", "0 0 0"});
+    for (size_t i = 0; i < n_atoms; ++i) {
+        double f = static_cast<double>(i);
+        const char *symbol = i < n_atoms / 2 ? "Cu" : "H";
+        double mass = i < n_atoms / 2 ? 63.546 : 1.008;
+        builder.add_atom_with_velocity(symbol, f * 0.731, f * 1.377, f * 2.113,
+                                       i % 7 == 0, i, mass, 0.1, 0.2, 0.3);
+    }
+    return builder.build();
+}
+
+// A zero `bytes_per_atom` marks calls that move no data; only their latency
+// is printed.
+void report(const char *name, size_t n_atoms, size_t bytes_per_atom,
+            double seconds_per_call) {
+    if (bytes_per_atom == 0) {
+        std::printf("%-28s %9zu atoms  %12.3f us/call\n", name, n_atoms,
+                    seconds_per_call * 1e6);
+        return;
+    }
+    double atoms_per_s = static_cast<double>(n_atoms) / seconds_per_call;
+    std::printf("%-28s %9zu atoms  %12.3f us/call  %10.3e atoms/s  %9.1f MB/s\n",
+                name, n_atoms, seconds_per_call * 1e6, atoms_per_s,
+                atoms_per_s * static_cast<double>(bytes_per_atom) / 1e6);
+}
+
+void bench(size_t n_atoms) {
+    // Each cold measurement needs a frame whose cache has never been filled.
+    size_t reps = n_atoms >= 1000000 ? 3 : n_atoms >= 10000 ? 20 : 200;
+    std::vector<readcon::ConFrame> frames;
+    frames.reserve(reps);
+    for (size_t i = 0; i < reps; ++i) {
+        frames.push_back(make_frame(n_atoms));
+    }
+
+    auto start = Clock::now();
+    for (const auto &frame : frames) {
+        if (frame.atoms().size() != n_atoms) {
+            std::abort();
+        }
+    }
+    std::chrono::duration<double> cold = Clock::now() - start;
+    report("atoms() first call", n_atoms, sizeof(readcon::Atom),
+           cold.count() / static_cast<double>(reps));
+
+    const size_t warm_calls = 100000;
+    size_t checksum = 0;
+    start = Clock::now();
+    for (size_t i = 0; i < warm_calls; ++i) {
+        checksum += frames[i % reps].atoms().size();
+    }
+    std::chrono::duration<double> warm = Clock::now() - start;
+    if (checksum != warm_calls * n_atoms) {
+        std::abort();
+    }
+    report("atoms() cached", n_atoms, 0,
+           warm.count() / static_cast<double>(warm_calls));
+
+    std::vector<double> xyz(3 * n_atoms);
+    start = Clock::now();
+    for (const auto &frame : frames) {
+        readcon::rkr_frame_copy_positions(frame.get_handle(), xyz.data(), 3);
+    }
+    std::chrono::duration<double> copy = Clock::now() - start;
+    report("rkr_frame_copy_positions", n_atoms, 3 * sizeof(double),
+           copy.count() / static_cast<double>(reps));
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+    }
+    if (sizes.empty()) {
+        sizes = {100, 10000, 1000000};
+    }
+    for (size_t n_atoms : sizes) {
+        bench(n_atoms);
+    }
+    return 0;
+}
@@ -1,5 +1,6 @@
 #[path = "../tests/common/mod.rs"]
 mod common;
+mod synthetic;
 
 use std::path::Path;
 use criterion::{criterion_group, criterion_main, Criterion};
@@ -93,6 +94,17 @@ fn large_file_bench(c: &mut Criterion) {
         })
     });
 
+    group.bench_function("100_frames_next_into", |b| {
+        b.iter(|| {
+            let mut iter = ConFrameIterator::new(&large);
+            let mut frame = iter.next().unwrap().unwrap();
+            while let Some(result) = iter.next_into(&mut frame) {
+                let _ = black_box(result);
+            }
+            let _ = black_box(frame);
+        })
+    });
+
     group.bench_function("100_frames_forward_skip", |b| {
         b.iter(|| {
             let mut iter = ConFrameIterator::new(&large);
@@ -149,6 +161,48 @@ fn fast_float_microbench(c: &mut Criterion) {
     group.finish();
 }
 
+/// Compares the allocation-free scalar atom-line parser against the generic
+/// five-float tokenizer on every atom line of a frame.
+fn atom_line_bench(c: &mut Criterion) {
+    let cuh2 = fs::read_to_string(test_case!("cuh2.con")).expect("Can't find test.");
+    let large = synthetic::large_frame_text(100_000);
+    let mut group = c.benchmark_group("AtomLineParsing");
+
+    for (name, text) in [("cuh2", &cuh2), ("100k_atoms", &large)] {
+        let atom_lines: Vec<&str> = text
+            .lines()
+            .filter(|l| l.split_ascii_whitespace().count() == 5)
+            .collect();
+
+        group.bench_function(format!("{name}_parse_line_of_n_f64"), |b| {
+            b.iter(|| {
+                for line in &atom_lines {
+                    let vals = readcon_core::parser::parse_line_of_n_f64(black_box(line), 5).unwrap();
+                    let _ = black_box((vals[3] != 0.0, vals[4] as u64));
+                }
+            })
+        });
+
+        group.bench_function(format!("{name}_parse_atom_line"), |b| {
+            b.iter(|| {
+                for line in &atom_lines {
+                    let atom = readcon_core::parser::parse_atom_line(black_box(line)).unwrap();
+                    let _ = black_box(atom);
+                }
+            })
+        });
+
+        group.bench_function(format!("{name}_full_frame"), |b| {
+            b.iter(|| {
+                let frames: Vec<_> = ConFrameIterator::new(text).collect();
+                let _ = black_box(frames);
+            })
+        });
+    }
+
+    group.finish();
+}
+
 criterion_group!(
     benches,
     iterator_bench,
@@ -157,5 +211,6 @@ criterion_group!(
     large_file_bench,
     mmap_vs_read_bench,
     fast_float_microbench,
+    atom_line_bench,
 );
 criterion_main!(benches);
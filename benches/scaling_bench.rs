@@ -0,0 +1,167 @@
+//! Scaling benchmarks over synthetic systems of 1e2 to 1e6 atoms. Writer
+//! precision is covered by the `FrameWriting` group in `writer_bench`.
+//!
+//! Every group reports both atoms/s and MB/s, so a regression shows up in
+//! `critcmp` whichever unit it is read in.
+
+mod synthetic;
+
+use criterion::{criterion_group, criterion_main, BenchmarkId, Criterion, Throughput};
+use readcon_core::ffi;
+use readcon_core::iterators::{read_all_frames, ConFrameIterator};
+use std::ffi::CString;
+use std::fs;
+use std::hint::black_box;
+use synthetic::SystemSpec;
+
+fn throughput(spec: &SystemSpec, bytes: u64) -> Throughput {
+    Throughput::ElementsAndBytes {
+        elements: spec.total_atoms(),
+        bytes,
+    }
+}
+
+/// In-memory parsing across system size, composition and velocities, with
+/// about a million atoms per measurement.
+fn parse_scaling_bench(c: &mut Criterion) {
+    let mut group = c.benchmark_group("SyntheticParse");
+    group.sample_size(10);
+
+    for atoms in [100, 10_000, 1_000_000] {
+        for components in [1, 4] {
+            for velocities in [false, true] {
+                let spec = SystemSpec::new(atoms, components, 1_000_000 / atoms, velocities);
+                let text = spec.text();
+                group.throughput(throughput(&spec, text.len() as u64));
+                group.bench_with_input(
+                    BenchmarkId::new("collect", spec.label()),
+                    &text,
+                    |b, text| {
+                        b.iter(|| {
+                            let frames: Vec<_> = ConFrameIterator::new(text).collect();
+                            black_box(frames)
+                        })
+                    },
+                );
+            }
+        }
+    }
+
+    group.finish();
+}
+
+/// Per-frame overhead: the same 1e3-atom frame repeated 1 to 1000 times.
+fn frame_count_bench(c: &mut Criterion) {
+    let mut group = c.benchmark_group("SyntheticFrameCount");
+
+    for frames in [1, 10, 100, 1000] {
+        let spec = SystemSpec::new(1000, 2, frames, false);
+        let text = spec.text();
+        group.throughput(throughput(&spec, text.len() as u64));
+        group.bench_with_input(BenchmarkId::new("next_into", spec.label()), &text, |b, text| {
+            b.iter(|| {
+                let mut iter = ConFrameIterator::new(text);
+                let mut frame = iter.next().unwrap().unwrap();
+                while let Some(result) = iter.next_into(&mut frame) {
+                    result.unwrap();
+                }
+                black_box(frame)
+            })
+        });
+    }
+
+    group.finish();
+}
+
+/// `read_all_frames_parallel` on 100 frames of 1e4 atoms, by pool size.
+#[cfg(feature = "parallel")]
+fn parallel_scaling_bench(c: &mut Criterion) {
+    use readcon_core::iterators::read_all_frames_parallel;
+
+    let spec = SystemSpec::new(10_000, 2, 100, false);
+    let file = spec.write_temp();
+    let mut group = c.benchmark_group("ParallelScaling");
+    group.sample_size(10);
+    group.throughput(throughput(&spec, file.bytes));
+
+    for threads in [1, 2, 4, 8] {
+        group.bench_with_input(BenchmarkId::new("threads", threads), &threads, |b, &n| {
+            b.iter(|| black_box(read_all_frames_parallel(&file.path, n).unwrap()))
+        });
+    }
+
+    group.finish();
+}
+
+#[cfg(not(feature = "parallel"))]
+fn parallel_scaling_bench(_: &mut Criterion) {}
+
+/// `read_all_frames` below the mmap threshold (whole-file read) and far
+/// above it (mapped), against reading the file into a `String` first.
+fn read_path_bench(c: &mut Criterion) {
+    let mut group = c.benchmark_group("ReadAllFrames");
+
+    for spec in [
+        SystemSpec::new(100, 2, 1, false),
+        SystemSpec::new(100_000, 2, 10, false),
+    ] {
+        let file = spec.write_temp();
+        group.throughput(throughput(&spec, file.bytes));
+        group.bench_function(BenchmarkId::new("read_all_frames", spec.label()), |b| {
+            b.iter(|| black_box(read_all_frames(&file.path).unwrap()))
+        });
+        group.bench_function(BenchmarkId::new("read_to_string", spec.label()), |b| {
+            b.iter(|| {
+                let text = fs::read_to_string(&file.path).unwrap();
+                let frames: Vec<_> = ConFrameIterator::new(&text).collect();
+                black_box(frames)
+            })
+        });
+    }
+
+    group.finish();
+}
+
+/// Cost of getting one parsed frame's atoms across the C API: the
+/// allocating `rkr_frame_to_c_frame` against a strided copy into a reused
+/// caller buffer.
+fn ffi_extraction_bench(c: &mut Criterion) {
+    let mut group = c.benchmark_group("FfiExtraction");
+
+    for atoms in [1_000, 100_000] {
+        let spec = SystemSpec::new(atoms, 4, 1, true);
+        let file = spec.write_temp();
+        let path = CString::new(file.path.to_str().unwrap()).unwrap();
+        let handle = unsafe { ffi::rkr_read_first_frame(path.as_ptr()) };
+        assert!(!handle.is_null());
+        group.throughput(throughput(&spec, file.bytes));
+
+        group.bench_function(BenchmarkId::new("rkr_frame_to_c_frame", spec.label()), |b| {
+            b.iter(|| unsafe {
+                let frame = ffi::rkr_frame_to_c_frame(handle);
+                ffi::free_c_frame(black_box(frame));
+            })
+        });
+        group.bench_function(BenchmarkId::new("rkr_frame_copy_positions", spec.label()), |b| {
+            let mut xyz = vec![0.0; 3 * atoms];
+            b.iter(|| unsafe {
+                ffi::rkr_frame_copy_positions(handle, xyz.as_mut_ptr(), 3);
+                black_box(&xyz);
+            })
+        });
+
+        unsafe { ffi::free_rkr_frame(handle) };
+    }
+
+    group.finish();
+}
+
+criterion_group!(
+    benches,
+    parse_scaling_bench,
+    frame_count_bench,
+    parallel_scaling_bench,
+    read_path_bench,
+    ffi_extraction_bench,
+);
+criterion_main!(benches);
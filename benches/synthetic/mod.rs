@@ -0,0 +1,177 @@
+//! Synthetic trajectories for the benchmarks.
+//!
+//! Systems are described by a `SystemSpec` and generated deterministically,
+//! so runs on different commits parse byte-identical inputs. Each bench
+//! target uses only part of the module.
+
+#![allow(dead_code)]
+
+use readcon_core::types::{ConFrame, ConFrameBuilder};
+use readcon_core::writer::ConFrameWriter;
+use std::path::PathBuf;
+
+const ELEMENTS: [(&str, f64); 8] = [
+    ("Cu", 63.546),
+    ("H", 1.008),
+    ("O", 15.999),
+    ("C", 12.011),
+    ("N", 14.007),
+    ("Pt", 195.08),
+    ("Fe", 55.845),
+    ("Si", 28.085),
+];
+
+/// Shape of a generated trajectory.
+#[derive(Debug, Clone, Copy)]
+pub struct SystemSpec {
+    pub atoms: usize,
+    /// Number of atom types, at most 8. Atoms are split evenly between them.
+    pub components: usize,
+    pub frames: usize,
+    pub velocities: bool,
+}
+
+impl SystemSpec {
+    pub fn new(atoms: usize, components: usize, frames: usize, velocities: bool) -> Self {
+        assert!((1..=ELEMENTS.len()).contains(&components));
+        SystemSpec {
+            atoms,
+            components,
+            frames,
+            velocities,
+        }
+    }
+
+    /// Total atoms over all frames, for per-atom throughput.
+    pub fn total_atoms(&self) -> u64 {
+        (self.atoms * self.frames) as u64
+    }
+
+    /// A short benchmark id such as `1e4_atoms_4_types_100_frames_vel`.
+    pub fn label(&self) -> String {
+        format!(
+            "{}_atoms_{}_types_{}_frames{}",
+            scientific(self.atoms),
+            self.components,
+            self.frames,
+            if self.velocities { "_vel" } else { "" }
+        )
+    }
+
+    /// Builds the frames in memory.
+    pub fn frames(&self) -> Vec<ConFrame> {
+        let cell = [100.0, 100.0, 100.0];
+        (0..self.frames)
+            .map(|f| {
+                // Blank header lines would read as a velocity separator.
+                let mut builder = ConFrameBuilder::new(cell, [90.0, 90.0, 90.0])
+                    .prebox_header(["Random Number Seed".into(), format!("{f}.0000 TIME")])
+                    .postbox_header(["0 0".into(), "0 0 0".into()]);
+                let mut state = 0x9e37_79b9_7f4a_7c15u64 ^ f as u64;
+                for i in 0..self.atoms {
+                    let (symbol, mass) = ELEMENTS[i * self.components / self.atoms.max(1)];
+                    let x = uniform(&mut state) * cell[0];
+                    let y = uniform(&mut state) * cell[1];
+                    let z = uniform(&mut state) * cell[2];
+                    let fixed = i % 7 == 0;
+                    if self.velocities {
+                        let vx = uniform(&mut state) - 0.5;
+                        let vy = uniform(&mut state) - 0.5;
+                        let vz = uniform(&mut state) - 0.5;
+                        builder.add_atom_with_velocity(
+                            symbol, x, y, z, fixed, i as u64, mass, vx, vy, vz,
+                        );
+                    } else {
+                        builder.add_atom(symbol, x, y, z, fixed, i as u64, mass);
+                    }
+                }
+                builder.build()
+            })
+            .collect()
+    }
+
+    /// Serializes the frames as `.con`/`.convel` text at 8 digits.
+    pub fn text(&self) -> String {
+        let mut out = Vec::new();
+        {
+            let mut writer = ConFrameWriter::with_precision(&mut out, 8);
+            writer.extend(self.frames().iter()).unwrap();
+        }
+        String::from_utf8(out).unwrap()
+    }
+
+    /// Writes the text to a fresh file in the temporary directory.
+    pub fn write_temp(&self) -> TempTrajectory {
+        let ext = if self.velocities { "convel" } else { "con" };
+        let path = std::env::temp_dir().join(format!(
+            "readcon-bench-{}-{}.{ext}",
+            std::process::id(),
+            self.label()
+        ));
+        let text = self.text();
+        std::fs::write(&path, &text).unwrap();
+        TempTrajectory {
+            path,
+            bytes: text.len() as u64,
+        }
+    }
+}
+
+/// Builds a single-component frame with `num_atoms` atoms, formatted like
+/// the coordinate lines in `cuh2.con`. Shared by the atom-line and writer
+/// benchmarks, so both measure the same coordinates.
+pub fn large_frame_text(num_atoms: usize) -> String {
+    let mut buf = String::with_capacity(num_atoms * 80 + 256);
+    buf.push_str("Random Number Seed\n0.0000 TIME\n");
+    buf.push_str("100.000000 100.000000 100.000000\n90.000000 90.000000 90.000000\n");
+    buf.push_str("0 0\n0 0 0\n1\n");
+    buf.push_str(&format!("{num_atoms}\n63.546\nCu\nCoordinates of Component 1\n"));
+    for i in 0..num_atoms {
+        let f = i as f64;
+        buf.push_str(&format!(
+            "{:>22.17} {:>22.17} {:>22.17} {} {:>4}\n",
+            (f * 0.731).rem_euclid(100.0),
+            (f * 1.377).rem_euclid(100.0),
+            (f * 2.113).rem_euclid(100.0),
+            i % 2,
+            i
+        ));
+    }
+    buf
+}
+
+/// A generated trajectory on disk, removed when dropped.
+pub struct TempTrajectory {
+    pub path: PathBuf,
+    pub bytes: u64,
+}
+
+impl Drop for TempTrajectory {
+    fn drop(&mut self) {
+        let _ = std::fs::remove_file(&self.path);
+    }
+}
+
+/// splitmix64 mapped to [0, 1).
+fn uniform(state: &mut u64) -> f64 {
+    *state = state.wrapping_add(0x9e37_79b9_7f4a_7c15);
+    let mut z = *state;
+    z = (z ^ (z >> 30)).wrapping_mul(0xbf58_476d_1ce4_e5b9);
+    z = (z ^ (z >> 27)).wrapping_mul(0x94d0_49bb_1331_11eb);
+    (z ^ (z >> 31)) as f64 / (u64::MAX as f64 + 1.0)
+}
+
+/// Formats powers of ten as `1e4`, anything else in full.
+fn scientific(n: usize) -> String {
+    let mut exp = 0;
+    let mut rest = n;
+    while rest >= 10 && rest % 10 == 0 {
+        rest /= 10;
+        exp += 1;
+    }
+    if rest == 1 && exp > 0 {
+        format!("1e{exp}")
+    } else {
+        n.to_string()
+    }
+}
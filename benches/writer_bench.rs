@@ -0,0 +1,53 @@
+#[path = "../tests/common/mod.rs"]
+mod common;
+mod synthetic;
+
+use criterion::{criterion_group, criterion_main, Criterion, Throughput};
+use readcon_core::iterators::ConFrameIterator;
+use readcon_core::types::ConFrame;
+use readcon_core::writer::ConFrameWriter;
+use std::fs;
+use std::hint::black_box;
+use std::io;
+use std::path::Path;
+use synthetic::SystemSpec;
+
+fn written_len(frames: &[ConFrame], precision: usize) -> u64 {
+    let mut out = Vec::new();
+    {
+        let mut writer = ConFrameWriter::with_precision(&mut out, precision);
+        writer.extend(frames.iter()).unwrap();
+    }
+    out.len() as u64
+}
+
+/// Serialization throughput into `io::sink()`, so only formatting is
+/// measured, by precision. Reported as MB/s of `.con` text produced.
+fn writer_bench(c: &mut Criterion) {
+    let fdat = fs::read_to_string(test_case!("tiny_multi_cuh2.convel")).expect("Can't find test.");
+    let convel: Vec<ConFrame> = ConFrameIterator::new(&fdat).map(|r| r.unwrap()).collect();
+    let large_text = synthetic::large_frame_text(100_000);
+    let large: Vec<ConFrame> = ConFrameIterator::new(&large_text).map(|r| r.unwrap()).collect();
+    let spec = SystemSpec::new(10_000, 4, 10, true);
+    let (mixed_name, mixed) = (spec.label(), spec.frames());
+    let mut group = c.benchmark_group("FrameWriting");
+
+    for (name, frames) in [
+        ("multi_cuh2_convel", &convel),
+        ("100k_atoms", &large),
+        (mixed_name.as_str(), &mixed),
+    ] {
+        for precision in [3, 6, 10, 17] {
+            group.throughput(Throughput::Bytes(written_len(frames, precision)));
+            group.bench_function(format!("{name}_precision_{precision}"), |b| {
+                let mut writer = ConFrameWriter::with_precision(io::sink(), precision);
+                b.iter(|| writer.extend(black_box(frames.iter())).unwrap())
+            });
+        }
+    }
+
+    group.finish();
+}
+
+criterion_group!(benches, writer_bench);
+criterion_main!(benches);
@@ -17,26 +17,76 @@ namespace readcon {
 #endif  // __cplusplus
 
 /**
- * An iterator that lazily parses simulation frames from a `.con` or `.convel`
- * file's contents.
+ * `RKRAsyncWriterOptions::fsync_policy`: never call fsync.
+ */
+#define RKR_FSYNC_NONE 0
+
+/**
+ * `RKRAsyncWriterOptions::fsync_policy`: fsync every `fsync_every` frames
+ * and on close.
+ */
+#define RKR_FSYNC_EVERY_N_FRAMES 1
+
+/**
+ * `RKRAsyncWriterOptions::fsync_policy`: fsync once, on close.
+ */
+#define RKR_FSYNC_ON_CLOSE 2
+
+/**
+ * A frame iterator that owns the contents of a file.
+ *
+ * Unlike [`ConFrameIterator`], it does not need the whole file as a `&str`:
+ * files above [`MMAP_THRESHOLD`] are memory-mapped and UTF-8 is validated one
+ * frame at a time, just before the frame is parsed. The time to the first
+ * frame therefore does not depend on the file size, and only pages that have
+ * been consumed need to be resident. The mapping is advised as sequential,
+ * and the expected extent of the next frame is prefetched as each frame is
+ * yielded.
+ *
+ * Frame boundaries are found with the same header-only scan that builds a
+ * [`FrameIndex`]; `seek()` and `len()` work as on [`ConFrameIterator`].
  *
- * This struct wraps an iterator over the lines of a string and, upon each iteration,
- * attempts to parse a complete `ConFrame`. Velocity sections are detected
- * automatically: if a blank line follows the coordinate blocks, the velocity
- * data is parsed into the atoms.
+ * `.conb` files are detected by their magic bytes; their offset table
+ * serves as the index and frames are decoded instead of parsed.
  *
- * The iterator yields items of type `Result<ConFrame, ParseError>`, allowing for
- * robust error handling for each frame.
+ * Compressed files are recognised by extension (`compression` feature).
+ * zstd files written by [`crate::writer::ConFrameWriter`] carry a seek
+ * table, so they are decompressed one frame group at a time and `len()`
+ * and `seek()` use the table without decompressing ahead; other
+ * compressed files are decompressed whole on open.
  */
-typedef struct ConFrameIterator ConFrameIterator;
-
-typedef struct String String;
+typedef struct ConFrameFileIterator ConFrameFileIterator;
 
 typedef struct CConFrameIterator {
-    struct ConFrameIterator *iterator;
-    struct String *file_contents;
+    struct ConFrameFileIterator *iterator;
 } CConFrameIterator;
 
+/**
+ * Selects which parts of each frame `con_frame_iterator_set_options`
+ * parses. Zero-initialised options parse everything.
+ */
+typedef struct RKRParseOptions {
+    /**
+     * Parse only the frame headers; frames have no atoms.
+     */
+    bool header_only;
+    /**
+     * Skip velocity sections; frames report no velocities.
+     */
+    bool skip_velocities;
+    /**
+     * Symbols of the components to keep (NULL or none: keep all).
+     */
+    const char *const *components;
+    uintptr_t num_components;
+    /**
+     * If true, keep only atoms with `atom_id_min <= id < atom_id_max`.
+     */
+    bool filter_atom_ids;
+    uint64_t atom_id_min;
+    uint64_t atom_id_max;
+} RKRParseOptions;
+
 /**
  * An opaque handle to a full, lossless Rust `ConFrame` object.
  * The C/C++ side needs to treat this as a void pointer
@@ -59,6 +109,18 @@ typedef struct CAtom {
     bool has_velocity;
 } CAtom;
 
+/**
+ * One component's run of atoms, as returned by `rkr_frame_get_components`.
+ * Atoms `offset .. offset + count` of the frame (and of its columns) all
+ * have this atomic number (0 if the symbol is unknown) and mass.
+ */
+typedef struct CComponent {
+    uint64_t atomic_number;
+    double mass;
+    uintptr_t offset;
+    uintptr_t count;
+} CComponent;
+
 /**
  * A transparent, "lossy" C-struct containing only the core atomic data.
  * This can be extracted from an `RKRConFrame` handle for direct data access.
@@ -80,6 +142,22 @@ typedef struct RKRConFrameWriter {
     uint8_t _private[0];
 } RKRConFrameWriter;
 
+/**
+ * Frame-level metadata for `rkr_writer_write_arrays`.
+ */
+typedef struct RKRFrameHeader {
+    double cell[3];
+    double angles[3];
+    /**
+     * The two lines before the cell line; NULL entries are written empty.
+     */
+    const char *prebox[2];
+    /**
+     * The two lines after the angles line; NULL entries are written empty.
+     */
+    const char *postbox[2];
+} RKRFrameHeader;
+
 /**
  * An opaque handle to a Rust `ConFrameBuilder` object.
  */
@@ -87,23 +165,188 @@ typedef struct RKRConFrameBuilder {
     uint8_t _private[0];
 } RKRConFrameBuilder;
 
+/**
+ * A caller-supplied per-frame function for `rkr_for_each_frame`.
+ *
+ * It receives `user_data`, the frame's index in the file and a frame handle
+ * that it OWNS and must free with `free_rkr_frame`. It returns 0 to
+ * continue, or any other value to stop delivering frames.
+ */
+typedef int32_t (*RKRFrameCallback)(void *user_data,
+                                    uintptr_t frame_no,
+                                    struct RKRConFrame *frame);
+
+/**
+ * An opaque handle to a Rust `Trajectory`: frames that share one copy of
+ * their counts, masses, symbols, ids and fixed flags.
+ */
+typedef struct RKRTrajectory {
+    uint8_t _private[0];
+} RKRTrajectory;
+
+/**
+ * An opaque handle to a Rust `ConFrameStreamReader` object.
+ */
+typedef struct RKRConFrameStreamReader {
+    uint8_t _private[0];
+} RKRConFrameStreamReader;
+
+/**
+ * A caller-supplied read function for `rkr_stream_reader_new`.
+ *
+ * It must copy up to `len` bytes into `buf` and return the number of bytes
+ * copied, 0 at end of input, or a negative value on error.
+ */
+typedef intptr_t (*RKRReadCallback)(void *user_data, uint8_t *buf, uintptr_t len);
+
+/**
+ * Configuration for `rkr_async_writer_new`.
+ */
+typedef struct RKRAsyncWriterOptions {
+    /**
+     * Number of decimal places for floating-point output.
+     */
+    uint8_t precision;
+    /**
+     * Maximum number of queued frames (at least 1).
+     */
+    uintptr_t queue_capacity;
+    /**
+     * If true, `rkr_async_writer_push` returns 1 instead of blocking when
+     * the queue is full.
+     */
+    bool reject_when_full;
+    /**
+     * One of the `RKR_FSYNC_*` constants.
+     */
+    uint32_t fsync_policy;
+    /**
+     * Frame interval for `RKR_FSYNC_EVERY_N_FRAMES`.
+     */
+    uintptr_t fsync_every;
+} RKRAsyncWriterOptions;
+
+/**
+ * An opaque handle to a Rust `AsyncConFrameWriter` object.
+ */
+typedef struct RKRAsyncConFrameWriter {
+    uint8_t _private[0];
+} RKRAsyncConFrameWriter;
+
+/**
+ * Calls and total wall-clock nanoseconds of one instrumented stage.
+ */
+typedef struct RKRStageStats {
+    uint64_t calls;
+    uint64_t nanos;
+} RKRStageStats;
+
+/**
+ * Process-wide parse, write and conversion counters, filled by
+ * `rkr_stats_snapshot`. All zero unless the library was built with the
+ * `instrumentation` feature.
+ */
+typedef struct RKRStats {
+    /**
+     * Bytes of frame text consumed by the parser.
+     */
+    uint64_t bytes_scanned;
+    uint64_t frames_parsed;
+    uint64_t atoms_parsed;
+    /**
+     * Bytes of frame text produced by the writer.
+     */
+    uint64_t bytes_written;
+    uint64_t frames_written;
+    uint64_t atoms_written;
+    /**
+     * Atom and output buffers allocated or grown.
+     */
+    uint64_t allocations;
+    /**
+     * The header stage; its time is included in `parse_single_frame`.
+     */
+    struct RKRStageStats parse_frame_header;
+    struct RKRStageStats parse_single_frame;
+    struct RKRStageStats parse_velocity_section;
+    struct RKRStageStats frame_to_c_frame;
+    /**
+     * Frame formatting, excluding the underlying file I/O.
+     */
+    struct RKRStageStats write_frame;
+} RKRStats;
+
 #ifdef __cplusplus
 extern "C" {
 #endif // __cplusplus
 
 /**
  * Creates a new iterator for a .con file.
+ * Files of 64 KiB and above are memory-mapped rather than read into memory,
+ * and each frame is UTF-8 validated only when it is reached.
  * The caller OWNS the returned pointer and MUST call `free_con_frame_iterator`.
  * Returns NULL if there are no more frames or on error.
  */
 struct CConFrameIterator *read_con_file_iterator(const char *filename_c);
 
+/**
+ * Creates a new iterator for a .con file with a ready-built frame index,
+ * so that `con_frame_iterator_seek` and `con_frame_iterator_len` are O(1).
+ *
+ * If `persist_index` is true, the index is loaded from the `<file>.idx`
+ * sidecar when it matches the file's size and modification time, and is
+ * otherwise rebuilt and written back to the sidecar. Seekable `.con.zst`
+ * files need no index: their seek table already serves `seek` and `len`.
+ * The caller OWNS the returned pointer and MUST call `free_con_frame_iterator`.
+ * Returns NULL on error, including a malformed frame found while indexing.
+ */
+struct CConFrameIterator *read_con_file_iterator_indexed(const char *filename_c,
+                                                         bool persist_index);
+
+/**
+ * Repositions the iterator so the next `con_frame_iterator_next` call returns
+ * frame `frame_no` (zero-based). Seeking to the frame count positions the
+ * iterator at the end. Builds the frame index on first use.
+ * Returns 0 on success, -1 on error or if `frame_no` is out of range.
+ */
+int32_t con_frame_iterator_seek(struct CConFrameIterator *iterator,
+                                uintptr_t frame_no);
+
+/**
+ * Writes the total number of frames in the file to `num_frames`.
+ * Builds the frame index on first use.
+ * Returns 0 on success, -1 on error.
+ */
+int32_t con_frame_iterator_len(struct CConFrameIterator *iterator,
+                               uintptr_t *num_frames);
+
+/**
+ * Sets the options used to parse subsequent frames. NULL `options`
+ * restores full parsing. Filtered frames describe only the kept atoms, so
+ * their per-type counts and masses may differ from the file's.
+ * Returns 0 on success, -1 on a NULL iterator or an invalid symbol string.
+ */
+int32_t con_frame_iterator_set_options(struct CConFrameIterator *iterator,
+                                       const struct RKRParseOptions *options);
+
 /**
  * Reads the next frame from the iterator, returning an opaque handle.
  * The caller OWNS the returned handle and must free it with `free_rkr_frame`.
  */
 struct RKRConFrame *con_frame_iterator_next(struct CConFrameIterator *iterator);
 
+/**
+ * Parses the next frame into an existing handle, reusing its memory.
+ * `frame_handle` may be any live handle, typically the one returned by the
+ * previous `con_frame_iterator_next`. Pointers obtained from the handle's
+ * column accessors are invalidated.
+ * Returns 0 on success, 1 at the end of the file (the handle is untouched),
+ * and -1 on error, in which case the handle's contents are unspecified but
+ * it must still be freed with `free_rkr_frame`.
+ */
+int32_t con_frame_iterator_next_into(struct CConFrameIterator *iterator,
+                                     struct RKRConFrame *frame_handle);
+
 /**
  * Frees the memory for an opaque `RKRConFrame` handle.
  */
@@ -151,6 +394,134 @@ char *rkr_frame_get_header_line_cpp(const struct RKRConFrame *frame_handle,
  */
 void rkr_free_string(char *s);
 
+/**
+ * Returns a pointer to one contiguous coordinate column of the frame.
+ *
+ * `axis` selects x (0), y (1) or z (2). The number of elements is written
+ * to `len`. The column is built on the first column access and is OWNED by
+ * the frame handle: the pointer stays valid until `free_rkr_frame` and must
+ * not be freed by the caller.
+ * Returns NULL on error or if `axis` is out of range.
+ */
+const double *rkr_frame_get_positions(const struct RKRConFrame *frame_handle,
+                                      uintptr_t axis,
+                                      uintptr_t *len);
+
+/**
+ * Returns a pointer to one contiguous velocity column of the frame.
+ *
+ * `axis` selects vx (0), vy (1) or vz (2). Ownership and lifetime follow
+ * `rkr_frame_get_positions`. If the frame has no velocities, `len` is set to
+ * 0 and NULL is returned.
+ * Returns NULL on error or if `axis` is out of range.
+ */
+const double *rkr_frame_get_velocities(const struct RKRConFrame *frame_handle,
+                                       uintptr_t axis,
+                                       uintptr_t *len);
+
+/**
+ * Returns a pointer to the contiguous atom ID column of the frame.
+ * Ownership and lifetime follow `rkr_frame_get_positions`.
+ * Returns NULL on error.
+ */
+const uint64_t *rkr_frame_get_atom_ids(const struct RKRConFrame *frame_handle,
+                                       uintptr_t *len);
+
+/**
+ * Returns a pointer to the contiguous fixed-atom flag column of the frame.
+ * Ownership and lifetime follow `rkr_frame_get_positions`.
+ * Returns NULL on error.
+ */
+const bool *rkr_frame_get_fixed_mask(const struct RKRConFrame *frame_handle,
+                                     uintptr_t *len);
+
+/**
+ * Returns the frame's per-component atom runs, in header order.
+ *
+ * Each run gives the atomic number, mass, first atom index and atom count
+ * of one component, so per-species work can slice the column accessors
+ * directly. The number of runs is written to `len`. Ownership and lifetime
+ * follow `rkr_frame_get_positions`.
+ * Returns NULL on error; a frame without components also yields NULL with
+ * `len` set to 0.
+ */
+const struct CComponent *rkr_frame_get_components(const struct RKRConFrame *frame_handle,
+                                                  uintptr_t *len);
+
+/**
+ * Returns the number of atoms in the frame, or 0 if the handle is NULL.
+ */
+uintptr_t rkr_frame_num_atoms(const struct RKRConFrame *frame_handle);
+
+/**
+ * Returns `true` if the frame carries velocities, `false` otherwise or if
+ * the handle is NULL.
+ */
+bool rkr_frame_has_velocities(const struct RKRConFrame *frame_handle);
+
+/**
+ * Copies the box lengths and angles into caller-provided 3-element arrays.
+ * Either pointer may be NULL to skip that quantity.
+ * Returns 0 on success, -1 if the handle is NULL.
+ */
+int32_t rkr_frame_get_cell(const struct RKRConFrame *frame_handle, double *cell, double *angles);
+
+/**
+ * Copies the atom positions into caller memory without allocating.
+ *
+ * `stride` is the distance, in doubles, between consecutive atoms:
+ * - `stride >= 3` writes interleaved records, atom `i` at
+ *   `xyz[i * stride + 0..3]` (a C `double[n][3]` or Fortran `xyz(3, n)`
+ *   for `stride == 3`; larger strides leave padding untouched);
+ * - `stride == 1` writes structure-of-arrays blocks, x in `xyz[0..n]`,
+ *   y in `xyz[n..2n]` and z in `xyz[2n..3n]` (Fortran `xyz(n, 3)`).
+ *
+ * `n` is `rkr_frame_num_atoms`, and the buffer must hold at least
+ * `(n - 1) * stride + 3` (interleaved) or `3 * n` (blocks) doubles.
+ * Returns 0 on success, -1 on a NULL argument or a stride of 0 or 2.
+ */
+int32_t rkr_frame_copy_positions(const struct RKRConFrame *frame_handle,
+                                 double *xyz,
+                                 uintptr_t stride);
+
+/**
+ * Copies the atom velocities into caller memory without allocating, using
+ * the layout described for `rkr_frame_copy_positions`. An atom without a
+ * velocity reads 0.0, as in `CAtom`; `rkr_frame_copy_velocity_mask` tells
+ * which atoms have one.
+ * Returns 0 on success, 1 if no atom has a velocity (nothing is written),
+ * and -1 on a NULL argument or an invalid stride.
+ */
+int32_t rkr_frame_copy_velocities(const struct RKRConFrame *frame_handle,
+                                  double *vxyz,
+                                  uintptr_t stride);
+
+/**
+ * Copies the atom IDs into caller memory without allocating, writing atom
+ * `i`'s ID to `ids[i * stride]` (`stride == 1` for a contiguous array).
+ * Returns 0 on success, -1 on a NULL argument or a zero stride.
+ */
+int32_t rkr_frame_copy_ids(const struct RKRConFrame *frame_handle, uint64_t *ids, uintptr_t stride);
+
+/**
+ * Copies the fixed-atom flags into caller memory without allocating,
+ * writing atom `i`'s flag to `fixed[i * stride]`.
+ * Returns 0 on success, -1 on a NULL argument or a zero stride.
+ */
+int32_t rkr_frame_copy_fixed_mask(const struct RKRConFrame *frame_handle,
+                                  bool *fixed,
+                                  uintptr_t stride);
+
+/**
+ * Copies the per-atom velocity flags (`CAtom::has_velocity`) into caller
+ * memory without allocating, writing atom `i`'s flag to
+ * `has_velocity[i * stride]`.
+ * Returns 0 on success, -1 on a NULL argument or a zero stride.
+ */
+int32_t rkr_frame_copy_velocity_mask(const struct RKRConFrame *frame_handle,
+                                     bool *has_velocity,
+                                     uintptr_t stride);
+
 /**
  * Creates a new frame writer for the specified file.
  * The caller OWNS the returned pointer and MUST call `free_rkr_writer`.
@@ -162,6 +533,15 @@ struct RKRConFrameWriter *create_writer_from_path_c(const char *filename_c);
  */
 void free_rkr_writer(struct RKRConFrameWriter *writer_handle);
 
+/**
+ * Flushes the writer and completes compressed output with its last group
+ * and seek table; nothing can be written afterwards. `free_rkr_writer`
+ * does this too but cannot report a failure, so call this first when the
+ * output is compressed. Returns 0 on success, -1 on a NULL handle or an
+ * I/O error.
+ */
+int32_t rkr_writer_finish(struct RKRConFrameWriter *writer_handle);
+
 /**
  * Writes multiple frames from an array of handles to the file managed by the writer.
  */
@@ -169,6 +549,31 @@ int32_t rkr_writer_extend(struct RKRConFrameWriter *writer_handle,
                           const struct RKRConFrame *const *frame_handles,
                           uintptr_t num_frames);
 
+/**
+ * Writes one frame straight from caller-owned arrays, without building a
+ * frame handle.
+ *
+ * Atoms are grouped by component: `component_counts`, `symbols` and
+ * `masses` hold `num_components` entries, and the first
+ * `component_counts[0]` atoms belong to `symbols[0]`. With `n` the sum of
+ * the counts, `xyz` holds `3 * n` interleaved coordinates and `ids` `n`
+ * atom ids. `vel` (`3 * n` interleaved velocities) may be NULL for a
+ * `.con` frame and `fixed` (`n` flags) may be NULL for all free atoms.
+ * The output matches `rkr_writer_extend` on the equivalent frame.
+ * Returns 0 on success, or -1 on a NULL argument, a NULL or non-UTF-8
+ * symbol or header line, or a write error.
+ */
+int32_t rkr_writer_write_arrays(struct RKRConFrameWriter *writer_handle,
+                                const struct RKRFrameHeader *header,
+                                uintptr_t num_components,
+                                const uintptr_t *component_counts,
+                                const char *const *symbols,
+                                const double *masses,
+                                const double *xyz,
+                                const double *vel,
+                                const uint64_t *ids,
+                                const bool *fixed);
+
 /**
  * Creates a new frame writer with custom floating-point precision.
  * The caller OWNS the returned pointer and MUST call `free_rkr_writer`.
@@ -176,6 +581,53 @@ int32_t rkr_writer_extend(struct RKRConFrameWriter *writer_handle,
 struct RKRConFrameWriter *create_writer_from_path_with_precision_c(const char *filename_c,
                                                                    uint8_t precision);
 
+/**
+ * Creates a new frame writer whose `rkr_writer_extend` serializes frames in
+ * parallel. `n_threads` bounds the writer's worker pool (0 means one thread
+ * per logical CPU) and `max_in_flight_bytes` caps the formatted text held
+ * before it is written (0 selects a 64 MiB default). Output order and bytes
+ * match the serial writer. When the library is built without the `parallel`
+ * feature, both options are ignored and frames are written serially.
+ * The caller OWNS the returned pointer and MUST call `free_rkr_writer`.
+ */
+struct RKRConFrameWriter *create_writer_from_path_parallel_c(const char *filename_c,
+                                                             uint8_t precision,
+                                                             uintptr_t n_threads,
+                                                             uintptr_t max_in_flight_bytes);
+
+/**
+ * Opens an existing trajectory for appending (creating it if missing).
+ * The last frame already in the file is parsed in full first, so nothing
+ * is appended after a truncated frame.
+ * The caller OWNS the returned pointer and MUST call `free_rkr_writer`.
+ * Returns NULL on error, including a file that does not end in a complete
+ * frame.
+ */
+struct RKRConFrameWriter *create_writer_append_c(const char *filename_c, uint8_t precision);
+
+/**
+ * Pads every coordinate written from now on to at least `width` bytes, so
+ * frames can later be patched in place with `rkr_patch_positions`.
+ * 0 disables padding. Returns 0 on success, -1 if the handle is NULL.
+ */
+int32_t rkr_writer_set_coordinate_width(struct RKRConFrameWriter *writer_handle,
+                                        uintptr_t width);
+
+/**
+ * Overwrites the coordinates of frame `frame_no` in place, without moving
+ * any other byte of the file. `positions` holds `num_atoms` interleaved
+ * x, y, z triples in file order; `precision` and `width` must match those
+ * the file was written with.
+ * Returns 0 on success, or -1 on error (nothing is written if a value
+ * does not fit the field width).
+ */
+int32_t rkr_patch_positions(const char *filename_c,
+                            uintptr_t frame_no,
+                            const double *positions,
+                            uintptr_t num_atoms,
+                            uint8_t precision,
+                            uintptr_t width);
+
 /**
  * Creates a new frame builder with the given cell dimensions, angles, and header lines.
  * The caller OWNS the returned pointer and MUST call `free_rkr_frame_builder` or
@@ -218,6 +670,34 @@ int32_t rkr_frame_add_atom_with_velocity(struct RKRConFrameBuilder *builder_hand
                                          double vy,
                                          double vz);
 
+/**
+ * Adds `count` atoms of one component from caller arrays in one call.
+ *
+ * `xyz` holds `3 * count` interleaved coordinates and `ids` `count` atom
+ * ids. `fixed` (`count` flags) may be NULL for all free atoms, and `vel`
+ * (`3 * count` interleaved velocities) may be NULL for none. The symbol is
+ * converted once for the whole run. Adding the components in order, one
+ * call each, lets `rkr_frame_builder_build` keep the atoms as added.
+ * Returns 0 on success, -1 on a NULL builder, symbol, `xyz` or `ids`, or
+ * an invalid symbol string.
+ */
+int32_t rkr_frame_add_atoms_bulk(struct RKRConFrameBuilder *builder_handle,
+                                 const char *symbol,
+                                 uintptr_t count,
+                                 const double *xyz,
+                                 const uint64_t *ids,
+                                 const bool *fixed,
+                                 double mass,
+                                 const double *vel);
+
+/**
+ * Reserves room for at least `additional` more atoms in the builder, so
+ * adding them does not reallocate.
+ * Returns 0 on success, -1 on a NULL builder.
+ */
+int32_t rkr_frame_builder_reserve(struct RKRConFrameBuilder *builder_handle,
+                                  uintptr_t additional);
+
 /**
  * Consumes the builder and returns a finalized RKRConFrame handle.
  * The builder handle is invalidated after this call.
@@ -249,11 +729,216 @@ struct RKRConFrame **rkr_read_all_frames(const char *filename_c,
                                          uintptr_t *num_frames);
 
 /**
- * Frees an array of frame handles returned by `rkr_read_all_frames`.
+ * Reads all frames from a .con file, parsing frames in parallel.
+ * `n_threads` bounds the worker pool used for this call; 0 means one
+ * thread per logical CPU. When the library is built without the `parallel`
+ * feature, `n_threads` is ignored and frames are parsed serially.
+ * The caller OWNS both the array and each frame handle.
+ * Free frames with `free_rkr_frame` and the array with `free_rkr_frame_array`.
+ * Returns NULL on error.
+ */
+struct RKRConFrame **rkr_read_all_frames_parallel(const char *filename_c,
+                                                  uintptr_t n_threads,
+                                                  uintptr_t *num_frames);
+
+/**
+ * Frees an array of frame handles returned by `rkr_read_all_frames` or
+ * `rkr_read_all_frames_parallel`.
  * Each frame is freed individually, then the array itself.
  */
 void free_rkr_frame_array(struct RKRConFrame **frames, uintptr_t num_frames);
 
+/**
+ * Parses every frame of a file and passes each one to `callback` as soon as
+ * it is ready, without collecting them.
+ * `n_threads` bounds the worker pool used for this call; 0 means one
+ * thread per logical CPU. `callback` runs on the worker threads,
+ * concurrently and in no particular frame order, so it and `user_data`
+ * must be thread-safe. Without the `parallel` feature, frames are
+ * delivered in order on the calling thread and `n_threads` is ignored.
+ * Returns 0 once every frame was delivered, 1 if `callback` asked to stop,
+ * or -1 on a NULL argument or a read or parse error (frames before the
+ * error may or may not have been delivered).
+ */
+int32_t rkr_for_each_frame(const char *filename_c,
+                           uintptr_t n_threads,
+                           RKRFrameCallback callback,
+                           void *user_data);
+
+/**
+ * Reads a whole file into a shared-topology trajectory.
+ * Per-atom data that does not change between frames is stored once, so
+ * long trajectories take about a third of the memory of
+ * `rkr_read_all_frames`.
+ * The caller OWNS the returned handle and MUST call `free_rkr_trajectory`.
+ * Returns NULL on error.
+ */
+struct RKRTrajectory *rkr_read_trajectory(const char *filename_c);
+
+/**
+ * Frees a trajectory returned by `rkr_read_trajectory`.
+ */
+void free_rkr_trajectory(struct RKRTrajectory *trajectory);
+
+/**
+ * Returns the number of frames, or 0 if the handle is NULL.
+ */
+uintptr_t rkr_trajectory_len(const struct RKRTrajectory *trajectory);
+
+/**
+ * Returns the number of distinct topologies (1 if the composition never
+ * changes), or 0 if the handle is NULL or the trajectory is empty.
+ */
+uintptr_t rkr_trajectory_num_topologies(const struct RKRTrajectory *trajectory);
+
+/**
+ * Returns the number of atoms in frame `frame_no`, or 0 if the handle is
+ * NULL or the frame is out of range.
+ */
+uintptr_t rkr_trajectory_num_atoms(const struct RKRTrajectory *trajectory, uintptr_t frame_no);
+
+/**
+ * Builds a full frame handle for frame `frame_no`, for use with every
+ * `rkr_frame_*` function and the writers.
+ * The caller OWNS the returned handle and MUST call `free_rkr_frame`.
+ * Returns NULL if the handle is NULL or the frame is out of range.
+ */
+struct RKRConFrame *rkr_trajectory_frame(const struct RKRTrajectory *trajectory,
+                                         uintptr_t frame_no);
+
+/**
+ * Copies the box lengths and angles of frame `frame_no` into
+ * caller-provided 3-element arrays. Either pointer may be NULL.
+ * Returns 0 on success, -1 if the handle is NULL or the frame is out of
+ * range.
+ */
+int32_t rkr_trajectory_get_cell(const struct RKRTrajectory *trajectory,
+                                uintptr_t frame_no,
+                                double *cell,
+                                double *angles);
+
+/**
+ * Returns the positions of frame `frame_no` as `3 * len` interleaved
+ * doubles (x, y, z per atom), writing the atom count to `len`.
+ * The array is OWNED by the trajectory: it stays valid until
+ * `free_rkr_trajectory` and must not be freed by the caller.
+ * Returns NULL if the handle is NULL or the frame is out of range.
+ */
+const double *rkr_trajectory_get_positions(const struct RKRTrajectory *trajectory,
+                                           uintptr_t frame_no,
+                                           uintptr_t *len);
+
+/**
+ * Returns the velocities of frame `frame_no` laid out as in
+ * `rkr_trajectory_get_positions`. If the frame has no velocities, `len` is
+ * set to 0 and NULL is returned.
+ * Returns NULL if the handle is NULL or the frame is out of range.
+ */
+const double *rkr_trajectory_get_velocities(const struct RKRTrajectory *trajectory,
+                                            uintptr_t frame_no,
+                                            uintptr_t *len);
+
+/**
+ * Returns the atom ids of frame `frame_no`. Frames that share a topology
+ * return the same pointer. Ownership and lifetime follow
+ * `rkr_trajectory_get_positions`.
+ * Returns NULL if the handle is NULL or the frame is out of range.
+ */
+const uint64_t *rkr_trajectory_get_atom_ids(const struct RKRTrajectory *trajectory,
+                                            uintptr_t frame_no,
+                                            uintptr_t *len);
+
+/**
+ * Returns the fixed-atom flags of frame `frame_no`. Ownership, lifetime and
+ * sharing follow `rkr_trajectory_get_atom_ids`.
+ * Returns NULL if the handle is NULL or the frame is out of range.
+ */
+const bool *rkr_trajectory_get_fixed_mask(const struct RKRTrajectory *trajectory,
+                                          uintptr_t frame_no,
+                                          uintptr_t *len);
+
+/**
+ * Creates a frame reader that pulls its input through `read_callback`,
+ * e.g. from a pipe, socket or decompression stream.
+ * Memory use is bounded by the largest frame, not the length of the input.
+ * `user_data` is passed unchanged to every callback invocation and must stay
+ * valid until the reader is freed.
+ * The caller OWNS the returned pointer and MUST call `free_rkr_stream_reader`.
+ * Returns NULL if `read_callback` is NULL.
+ */
+struct RKRConFrameStreamReader *rkr_stream_reader_new(RKRReadCallback read_callback,
+                                                      void *user_data);
+
+/**
+ * Reads the next frame from the stream, returning an opaque handle.
+ * The caller OWNS the returned handle and must free it with `free_rkr_frame`.
+ * Returns NULL at end of input or on a read or parse error.
+ */
+struct RKRConFrame *rkr_stream_reader_next(struct RKRConFrameStreamReader *reader);
+
+/**
+ * Frees a reader created by `rkr_stream_reader_new`.
+ */
+void free_rkr_stream_reader(struct RKRConFrameStreamReader *reader);
+
+/**
+ * Creates the output file and starts a background writer thread.
+ * `options` may be NULL for the defaults (precision 6, 64 queued frames,
+ * blocking push, no fsync).
+ * The caller OWNS the returned pointer and MUST call
+ * `rkr_async_writer_close` or `free_rkr_async_writer`.
+ * Returns NULL on error, including an unknown `fsync_policy`.
+ */
+struct RKRAsyncConFrameWriter *rkr_async_writer_new(const char *filename_c,
+                                                    const struct RKRAsyncWriterOptions *options);
+
+/**
+ * Queues a frame for writing.
+ * Returns 0 if the frame was queued, in which case the writer takes
+ * ownership of `frame_handle` and the caller must NOT free it.
+ * Returns 1 if the queue is full and the writer rejects instead of blocking,
+ * or -1 on error; in both cases the caller keeps ownership of the frame.
+ */
+int32_t rkr_async_writer_push(struct RKRAsyncConFrameWriter *writer_handle,
+                              struct RKRConFrame *frame_handle);
+
+/**
+ * Blocks until every frame queued so far has been written to the file.
+ * Returns 0 on success, or -1 if the writer has hit an I/O error.
+ */
+int32_t rkr_async_writer_flush(struct RKRAsyncConFrameWriter *writer_handle);
+
+/**
+ * Writes the remaining queued frames, applies the fsync policy, stops the
+ * writer thread and frees the handle.
+ * Returns 0 once everything is on the file, or -1 on error. The handle is
+ * freed in both cases and must not be used again.
+ */
+int32_t rkr_async_writer_close(struct RKRAsyncConFrameWriter *writer_handle);
+
+/**
+ * Frees an asynchronous writer, waiting for queued frames to be written.
+ * Errors are discarded; use `rkr_async_writer_close` to observe them.
+ */
+void free_rkr_async_writer(struct RKRAsyncConFrameWriter *writer_handle);
+
+/**
+ * Copies the current counters into `out`.
+ * Returns 0 on success, or -1 on a NULL `out`.
+ */
+int32_t rkr_stats_snapshot(struct RKRStats *out);
+
+/**
+ * Sets every counter back to zero.
+ */
+void rkr_stats_reset(void);
+
+/**
+ * Returns true if the library was built with the `instrumentation`
+ * feature, i.e. if `rkr_stats_snapshot` reports anything.
+ */
+bool rkr_stats_enabled(void);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -3,20 +3,51 @@
 
 #pragma once
 
+/*
+ * Thread safety
+ *
+ * - ConFrame and Trajectory are immutable once created: their const
+ *   accessors may be called from any number of threads at once (the
+ *   ConFrame caches fill under std::once_flag), so one frame can be shared
+ *   read-only across an OpenMP team or thread pool. The one exception is a
+ *   frame being refilled by a ConFrameIterator with set_recycle_frames().
+ * - Every class may be moved to, and used from, another thread.
+ * - ConFrameIterator, ConFrameStream, ConFrameWriter, AsyncConFrameWriter
+ *   and ConFrameBuilder are not synchronised; use each one from a single
+ *   thread at a time.
+ * - The readers (read_*, for_each_frame) and the stats functions may be
+ *   called concurrently.
+ */
+
+#include <algorithm>
 #include <array>
+#include <exception>
 #include <filesystem>
+#include <istream>
 #include <iterator>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#define READCON_HAS_SPAN 1
+#endif
+
 #include "readcon-core.h"
 
 namespace readcon {
 
 /**
  * @brief C++ representation of a single atom's core data.
+ *
+ * `has_velocity` is set per atom, as in the C `CAtom`; an atom without a
+ * velocity reads 0.0 for `vx`, `vy` and `vz`.
  */
 struct Atom {
     uint64_t atomic_number;
@@ -32,10 +63,124 @@ struct Atom {
     bool has_velocity;
 };
 
+#ifdef READCON_HAS_SPAN
+/**
+ * @brief Read-only structure-of-arrays view over a per-atom 3-vector.
+ *
+ * The spans point into a structure-of-arrays copy of the atoms that the
+ * Rust frame handle builds on first column access and keeps, one per handle.
+ * They remain valid for the lifetime of the ConFrame they were obtained from.
+ * All three spans are empty if the quantity is absent (e.g. velocities in a
+ * .con file).
+ */
+struct CoordinateColumns {
+    std::span<const double> x;
+    std::span<const double> y;
+    std::span<const double> z;
+};
+#endif
+
+/**
+ * @brief Options for the parallel overload of read_all_frames.
+ */
+struct ParallelOptions {
+    /// Number of worker threads; 0 uses one thread per logical CPU.
+    size_t threads = 0;
+};
+
+/**
+ * @brief Selects which parts of each frame a ConFrameIterator parses.
+ *
+ * Skipped lines are stepped over without parsing their numbers. Filtered
+ * frames describe only the kept atoms (per-type counts and masses are
+ * adjusted, empty components dropped); header-only frames have no atoms.
+ */
+struct ParseOptions {
+    /// Parse only the frame headers.
+    bool header_only = false;
+    /// Skip velocity sections.
+    bool skip_velocities = false;
+    /// Symbols of the components to keep; empty keeps all.
+    std::vector<std::string> components;
+    /// Keep only atoms with `first <= id < second`, if set.
+    std::optional<std::pair<uint64_t, uint64_t>> atom_ids;
+};
+
+#ifdef READCON_HAS_SPAN
+/**
+ * @brief A frame described by caller-owned arrays, for
+ * ConFrameWriter::write().
+ *
+ * Atoms are grouped by component: the first `component_counts[0]` atoms
+ * belong to `symbols[0]`, and so on. `xyz` and `velocities` hold three
+ * interleaved values per atom; empty `velocities` writes a .con frame and
+ * empty `fixed` writes every atom as free. Nothing is copied; the arrays
+ * only need to outlive the write() call.
+ */
+struct FrameView {
+    std::array<double, 3> cell{};
+    std::array<double, 3> angles{90.0, 90.0, 90.0};
+    std::array<const char *, 2> prebox{"", ""};
+    std::array<const char *, 2> postbox{"", ""};
+    std::span<const size_t> component_counts;
+    std::span<const char *const> symbols;
+    std::span<const double> masses;
+    std::span<const double> xyz;
+    std::span<const double> velocities;
+    std::span<const uint64_t> atom_ids;
+    std::span<const bool> fixed;
+};
+#endif
+
+/**
+ * @brief Options for a ConFrameWriter that serializes frames in parallel.
+ *
+ * Without the library's `parallel` feature the options are ignored and
+ * frames are written serially; the output is the same either way.
+ */
+struct ParallelWriteOptions {
+    /// Number of worker threads; 0 uses one thread per logical CPU.
+    size_t threads = 0;
+    /// Cap on formatted text held before writing; 0 selects 64 MiB.
+    size_t max_in_flight_bytes = 0;
+};
+
+/**
+ * @brief When an AsyncConFrameWriter calls fsync on its output file.
+ */
+enum class FsyncPolicy {
+    None,         ///< Never.
+    EveryNFrames, ///< Every AsyncWriterOptions::fsync_every frames, and on close.
+    OnClose,      ///< Once, when the writer is closed.
+};
+
+/**
+ * @brief Options for AsyncConFrameWriter.
+ */
+struct AsyncWriterOptions {
+    /// Number of decimal places for floating-point output.
+    uint8_t precision = 6;
+    /// Maximum number of frames waiting to be written.
+    size_t queue_capacity = 64;
+    /// If false, push() returns false instead of blocking on a full queue.
+    bool block_when_full = true;
+    FsyncPolicy fsync = FsyncPolicy::None;
+    /// Frame interval for FsyncPolicy::EveryNFrames.
+    size_t fsync_every = 0;
+};
+
 // Forward declarations
 class ConFrame;
 class ConFrameWriter;
+class AsyncConFrameWriter;
 class ConFrameBuilder;
+class Trajectory;
+
+namespace detail {
+std::vector<ConFrame> adopt_frame_array(RKRConFrame **handles,
+                                        size_t num_frames);
+ConFrame adopt_frame(RKRConFrame *handle);
+} // namespace detail
 
 /**
  * @brief An iterator for lazily reading frames from a .con file.
@@ -74,18 +219,53 @@ class ConFrameIterator {
 
       private:
         friend class ConFrameIterator;
-        explicit Iterator(CConFrameIterator *iterator_ptr);
+        Iterator(CConFrameIterator *iterator_ptr, bool recycle_frames);
         void fetch_next_frame();
         CConFrameIterator *iterator_ptr_ = nullptr;
+        bool recycle_frames_ = false;
         std::unique_ptr<ConFrame> current_frame_;
     };
 
     /**
      * @brief Constructs a frame iterator from a file path.
      * @param path The path to the .con file.
-     * @throws std::runtime_error if the file cannot be opened.
+     * @param persist_index If true, build the frame index up front and keep
+     *        it in a `<file>.idx` sidecar that is reused while the file's
+     *        size and modification time are unchanged.
+     * @throws std::runtime_error if the file cannot be opened (or indexed).
      */
-    explicit ConFrameIterator(const std::filesystem::path &path);
+    explicit ConFrameIterator(const std::filesystem::path &path,
+                              bool persist_index = false);
+    /**
+     * @brief Returns the total number of frames in the file.
+     *
+     * Builds the frame index with a header-only scan on first use.
+     * @throws std::runtime_error if the file contains a malformed frame.
+     */
+    size_t size();
+    /**
+     * @brief Random access to frame `index` (zero-based).
+     *
+     * This seeks the underlying reader, so a subsequent begin() continues
+     * from the frame after `index`.
+     * @throws std::out_of_range if `index` is not less than size().
+     */
+    ConFrame operator[](size_t index);
+    /**
+     * @brief Enables or disables frame recycling for subsequent begin() calls.
+     *
+     * When enabled, range-for iteration refills one ConFrame in place
+     * instead of allocating a new one per step, so references obtained from
+     * a frame (atoms(), positions(), ...) are only valid until the iterator
+     * advances. Moving the frame out of the loop is allowed; the next step
+     * then allocates a fresh frame.
+     */
+    void set_recycle_frames(bool enable);
+    /**
+     * @brief Restricts what is parsed for subsequent frames.
+     * @throws std::runtime_error if the options are rejected.
+     */
+    void set_parse_options(const ParseOptions &options);
     /**
      * @brief Returns an iterator to the beginning of the sequence of frames.
      */
@@ -106,6 +286,73 @@ class ConFrameIterator {
     };
 
     std::unique_ptr<CConFrameIterator, IteratorDeleter> iterator_ptr_;
+    bool recycle_frames_ = false;
+};
+
+/**
+ * @brief Reads frames incrementally from a std::istream.
+ *
+ * Use this for input that is not a regular file, such as std::cin fed by
+ * `zstd -dc traj.con.zst |`. Only one frame is buffered at a time. The
+ * stream must outlive this object. Iteration stops at end of input or at
+ * the first read or parse error.
+ *
+ * Example:
+ *
+ * readcon::ConFrameStream frames(std::cin);
+ * for (auto&& frame : frames) {
+ * // use frame
+ * }
+ */
+class ConFrameStream {
+  public:
+    /**
+     * @brief Single-pass input iterator over the frames of the stream.
+     */
+    class Iterator {
+      public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = ConFrame;
+        using difference_type = std::ptrdiff_t;
+        using pointer = ConFrame *;
+        using reference = ConFrame &;
+
+        reference operator*();
+        pointer operator->();
+        Iterator &operator++();
+        bool operator!=(const Iterator &other) const;
+
+      private:
+        friend class ConFrameStream;
+        explicit Iterator(RKRConFrameStreamReader *reader_ptr);
+        void fetch_next_frame();
+        RKRConFrameStreamReader *reader_ptr_ = nullptr;
+        std::unique_ptr<ConFrame> current_frame_;
+    };
+
+    /**
+     * @brief Wraps `input` for frame-by-frame reading.
+     * @throws std::runtime_error if the reader cannot be created.
+     */
+    explicit ConFrameStream(std::istream &input);
+
+    /** @brief Reads the first remaining frame and returns an iterator to it. */
+    Iterator begin();
+    /** @brief Returns the end-of-stream iterator. */
+    Iterator end();
+
+  private:
+    static intptr_t read_callback(void *user_data, uint8_t *buf, uintptr_t len);
+
+    struct ReaderDeleter {
+        void operator()(RKRConFrameStreamReader *ptr) const {
+            if (ptr) {
+                free_rkr_stream_reader(ptr);
+            }
+        }
+    };
+
+    std::unique_ptr<RKRConFrameStreamReader, ReaderDeleter> reader_ptr_;
 };
 
 /**
@@ -114,14 +361,25 @@ class ConFrameIterator {
  * This class follows RAII to manage the memory of an opaque `RKRConFrame`
  * handle. It provides accessor methods to safely retrieve data from the
  * underlying Rust object.
+ *
+ * The accessors cache in three independent tiers, each filled on first use:
+ * metadata (cell, angles, atom count, velocity flag), header lines and the
+ * atom array. Scanning cells over a trajectory therefore never copies atoms.
+ * Filling is thread-safe, so one frame may be read from several threads.
  */
 class ConFrame {
   public:
+    friend class ConFrameIterator;
     friend class ConFrameIterator::Iterator;
+    friend class ConFrameStream::Iterator;
     friend class ConFrameWriter;
+    friend class AsyncConFrameWriter;
     friend class ConFrameBuilder;
+    friend class Trajectory;
     friend ConFrame read_first_frame(const std::filesystem::path &);
-    friend std::vector<ConFrame> read_all_frames(const std::filesystem::path &);
+    friend std::vector<ConFrame> detail::adopt_frame_array(RKRConFrame **,
+                                                           size_t);
+    friend ConFrame detail::adopt_frame(RKRConFrame *);
 
     ConFrame(const ConFrame &) = delete;
     ConFrame &operator=(const ConFrame &) = delete;
@@ -134,6 +392,38 @@ class ConFrame {
     const std::array<std::string, 2> &prebox_header() const;
     const std::array<std::string, 2> &postbox_header() const;
     bool has_velocities() const;
+    /** @brief Number of atoms, without filling the atom cache. */
+    size_t num_atoms() const;
+
+#ifdef READCON_HAS_SPAN
+    /**
+     * @brief Views of the x, y and z coordinate columns.
+     *
+     * Unlike atoms(), this does not populate the per-atom cache. The first
+     * column access copies the atoms once into columns cached on the Rust
+     * frame handle; later calls return views of that same copy.
+     */
+    CoordinateColumns positions() const;
+    /**
+     * @brief Views of the velocity columns (empty if absent).
+     */
+    CoordinateColumns velocities() const;
+    /**
+     * @brief View of the atom ID column.
+     */
+    std::span<const uint64_t> atom_ids() const;
+    /**
+     * @brief View of the fixed-atom flag column.
+     */
+    std::span<const bool> fixed_mask() const;
+    /**
+     * @brief View of the per-component atom runs.
+     *
+     * Each run's atoms share one atomic number and mass, and occupy
+     * `[offset, offset + count)` of the column views.
+     */
+    std::span<const CComponent> components() const;
+#endif
 
     const RKRConFrame *get_handle() const { return frame_handle_.get(); }
 
@@ -148,14 +438,27 @@ class ConFrame {
     std::unique_ptr<RKRConFrame, FrameDeleter> frame_handle_;
 
     // --- Caching Implementation ---
-    void cache_data() const;
-    mutable bool is_cached_ = false;
-    mutable std::vector<Atom> atoms_cache_;
-    mutable std::array<double, 3> cell_cache_;
-    mutable std::array<double, 3> angles_cache_;
-    mutable std::array<std::string, 2> prebox_header_cache_;
-    mutable std::array<std::string, 2> postbox_header_cache_;
-    mutable bool has_velocities_cache_ = false;
+    // One once_flag per tier. The flags cannot be reset or moved, so the
+    // tiers live behind a pointer and a recycled frame gets a fresh Cache.
+    struct Cache {
+        std::once_flag metadata_once;
+        std::array<double, 3> cell{};
+        std::array<double, 3> angles{};
+        size_t num_atoms = 0;
+        bool has_velocities = false;
+
+        std::once_flag header_once;
+        std::array<std::string, 2> prebox_header;
+        std::array<std::string, 2> postbox_header;
+
+        std::once_flag atoms_once;
+        std::vector<Atom> atoms;
+    };
+    const Cache &cache_metadata() const;
+    const Cache &cache_header() const;
+    const Cache &cache_atoms() const;
+    void invalidate_cache();
+    std::unique_ptr<Cache> cache_ = std::make_unique<Cache>();
 };
 
 /**
@@ -167,6 +470,12 @@ class ConFrame {
  */
 class ConFrameWriter {
   public:
+    /** @brief How an existing output file is treated. */
+    enum class Mode {
+        Truncate, ///< Start a new file, discarding any previous contents.
+        Append,   ///< Keep the file and write after its last complete frame.
+    };
+
     /**
      * @brief Constructs a writer and opens the specified file for writing.
      * @param path The path to the output .con file.
@@ -176,6 +485,34 @@ class ConFrameWriter {
     explicit ConFrameWriter(const std::filesystem::path &path,
                             uint8_t precision = 6);
 
+    /**
+     * @brief Constructs a writer whose extend() formats frames in parallel.
+     * @param path The path to the output .con file.
+     * @param precision Number of decimal places for floating-point output.
+     * @param options Thread count and in-flight memory cap.
+     * @throws std::runtime_error if the file cannot be created.
+     */
+    ConFrameWriter(const std::filesystem::path &path, uint8_t precision,
+                   const ParallelWriteOptions &options);
+
+    /**
+     * @brief Constructs a writer in the given mode.
+     *
+     * In Mode::Append the last frame already in the file is parsed in full
+     * before anything is written.
+     * @throws std::runtime_error if the file cannot be opened, or in
+     * append mode does not end in a complete frame.
+     */
+    ConFrameWriter(const std::filesystem::path &path, Mode mode,
+                   uint8_t precision = 6);
+
+    /**
+     * @brief Pads coordinates written from now on to at least `width` bytes
+     * (0 disables padding), making frames patchable with patch_positions().
+     * @throws std::runtime_error if the writer has been moved from.
+     */
+    void set_coordinate_width(size_t width);
+
     /**
      * @brief Writes all frames from a vector to the file.
      * @param frames A vector of ConFrame objects.
@@ -183,6 +520,28 @@ class ConFrameWriter {
      */
     void extend(const std::vector<ConFrame> &frames);
 
+#ifdef READCON_HAS_SPAN
+    /**
+     * @brief Writes one frame straight from the arrays in `view`.
+     *
+     * The output matches extend() on the equivalent ConFrame, without
+     * building one.
+     * @throws std::invalid_argument if the array sizes disagree.
+     * @throws std::runtime_error if the write fails.
+     */
+    void write(const FrameView &view);
+#endif
+
+    /**
+     * @brief Flushes and completes compressed output (the last group and
+     * the zstd seek table). Nothing can be written afterwards.
+     *
+     * The destructor does this too but cannot report a failure, so call
+     * finish() explicitly when writing .zst or .gz files.
+     * @throws std::runtime_error if the final write fails.
+     */
+    void finish();
+
   private:
     struct WriterDeleter {
         void operator()(RKRConFrameWriter *ptr) const {
@@ -193,11 +552,65 @@ class ConFrameWriter {
     std::unique_ptr<RKRConFrameWriter, WriterDeleter> writer_handle_;
 };
 
+/**
+ * @brief Writes frames to a .con file from a background thread.
+ *
+ * push() moves a frame into a bounded queue that a Rust writer thread
+ * drains in order, so the caller never waits on formatting or write(2)
+ * unless the queue is full and block_when_full is set.
+ *
+ * Example:
+ *
+ * readcon::AsyncConFrameWriter writer("traj.con", {.queue_capacity = 16});
+ * writer.push(std::move(frame));
+ * writer.close(); // or let the destructor wait for the queue to drain
+ */
+class AsyncConFrameWriter {
+  public:
+    /**
+     * @brief Creates the output file and starts the writer thread.
+     * @throws std::runtime_error if the file cannot be created.
+     */
+    explicit AsyncConFrameWriter(const std::filesystem::path &path,
+                                 const AsyncWriterOptions &options = {});
+
+    /**
+     * @brief Queues a frame; on success `frame` is left empty.
+     * @return false if the queue is full and block_when_full is false, in
+     * which case `frame` is untouched.
+     * @throws std::runtime_error if the writer thread has stopped.
+     */
+    bool push(ConFrame &&frame);
+
+    /**
+     * @brief Blocks until every frame pushed so far is in the file.
+     * @throws std::runtime_error if a write failed.
+     */
+    void flush();
+
+    /**
+     * @brief Drains the queue, applies the fsync policy and stops the thread.
+     * @throws std::runtime_error if a write or fsync failed.
+     */
+    void close();
+
+  private:
+    struct AsyncWriterDeleter {
+        void operator()(RKRAsyncConFrameWriter *ptr) const {
+            if (ptr)
+                free_rkr_async_writer(ptr);
+        }
+    };
+    std::unique_ptr<RKRAsyncConFrameWriter, AsyncWriterDeleter> writer_handle_;
+};
+
 /**
  * @brief A builder for constructing ConFrame objects from in-memory data.
  *
  * Atoms are accumulated and grouped by symbol on build() to compute
- * the header fields.
+ * the header fields. Components added in order, each in one contiguous
+ * run, are kept as added without a regrouping pass; add_component() adds a
+ * whole run in one call.
  *
  * Example:
  *
@@ -215,6 +628,14 @@ class ConFrameBuilder {
                     const std::array<std::string, 2> &prebox = {"", ""},
                     const std::array<std::string, 2> &postbox = {"", ""});
 
+    /**
+     * @brief Constructs a builder with room for `num_atoms` atoms.
+     */
+    ConFrameBuilder(const std::array<double, 3> &cell,
+                    const std::array<double, 3> &angles, size_t num_atoms,
+                    const std::array<std::string, 2> &prebox = {"", ""},
+                    const std::array<std::string, 2> &postbox = {"", ""});
+
     ~ConFrameBuilder();
     ConFrameBuilder(const ConFrameBuilder &) = delete;
     ConFrameBuilder &operator=(const ConFrameBuilder &) = delete;
@@ -234,6 +655,22 @@ class ConFrameBuilder {
                                 double z, bool is_fixed, uint64_t atom_id,
                                 double mass, double vx, double vy, double vz);
 
+#ifdef READCON_HAS_SPAN
+    /**
+     * @brief Adds a run of atoms of one component in a single call.
+     *
+     * `xyz` (and `velocities`, if not empty) hold three interleaved values
+     * per atom, one per entry of `atom_ids`. An empty `fixed` leaves every
+     * atom free and an empty `velocities` adds none.
+     * @throws std::invalid_argument if the sizes disagree.
+     */
+    void add_component(const std::string &symbol, double mass,
+                       std::span<const double> xyz,
+                       std::span<const uint64_t> atom_ids,
+                       std::span<const bool> fixed = {},
+                       std::span<const double> velocities = {});
+#endif
+
     /**
      * @brief Consumes the builder and returns a finalized ConFrame.
      * @throws std::runtime_error if the build fails.
@@ -244,6 +681,89 @@ class ConFrameBuilder {
     RKRConFrameBuilder *builder_handle_ = nullptr;
 };
 
+/**
+ * @brief A whole trajectory whose frames share their topology.
+ *
+ * Counts, masses, symbols, atom ids and fixed flags are stored once for
+ * every run of frames in which they do not change; each frame keeps only
+ * its cell, header lines, positions and velocities. Obtain one with
+ * read_trajectory().
+ *
+ * Example:
+ *
+ * auto traj = readcon::read_trajectory("md.convel");
+ * for (size_t i = 0; i < traj.size(); ++i) {
+ *     auto xyz = traj.positions(i); // 3 * traj.num_atoms(i) doubles
+ * }
+ */
+class Trajectory {
+  public:
+    Trajectory(const Trajectory &) = delete;
+    Trajectory &operator=(const Trajectory &) = delete;
+    Trajectory(Trajectory &&) = default;
+    Trajectory &operator=(Trajectory &&) = default;
+
+    /** @brief Number of frames. */
+    size_t size() const { return rkr_trajectory_len(handle_.get()); }
+    bool empty() const { return size() == 0; }
+    /** @brief Number of distinct topologies (1 if it never changes). */
+    size_t num_topologies() const {
+        return rkr_trajectory_num_topologies(handle_.get());
+    }
+    /** @throws std::out_of_range if `frame_no >= size()`. */
+    size_t num_atoms(size_t frame_no) const;
+    /** @throws std::out_of_range if `frame_no >= size()`. */
+    std::array<double, 3> cell(size_t frame_no) const;
+    /** @throws std::out_of_range if `frame_no >= size()`. */
+    std::array<double, 3> angles(size_t frame_no) const;
+    /**
+     * @brief Builds frame `frame_no` as a full ConFrame, e.g. for writing.
+     * @throws std::out_of_range if `frame_no >= size()`.
+     */
+    ConFrame frame(size_t frame_no) const;
+
+#ifdef READCON_HAS_SPAN
+    /**
+     * @brief Zero-copy view of frame `frame_no`'s positions, three
+     * interleaved values (x, y, z) per atom.
+     *
+     * The span stays valid for the lifetime of the Trajectory.
+     * @throws std::out_of_range if `frame_no >= size()`.
+     */
+    std::span<const double> positions(size_t frame_no) const;
+    /**
+     * @brief Velocities laid out as positions(); empty if absent.
+     * @throws std::out_of_range if `frame_no >= size()`.
+     */
+    std::span<const double> velocities(size_t frame_no) const;
+    /**
+     * @brief Atom ids, shared by all frames with the same topology.
+     * @throws std::out_of_range if `frame_no >= size()`.
+     */
+    std::span<const uint64_t> atom_ids(size_t frame_no) const;
+    /**
+     * @brief Fixed-atom flags, shared like atom_ids().
+     * @throws std::out_of_range if `frame_no >= size()`.
+     */
+    std::span<const bool> fixed_mask(size_t frame_no) const;
+#endif
+
+    const RKRTrajectory *get_handle() const { return handle_.get(); }
+
+  private:
+    friend Trajectory read_trajectory(const std::filesystem::path &);
+    explicit Trajectory(RKRTrajectory *handle) : handle_(handle) {}
+    void check_index(size_t frame_no) const;
+
+    struct TrajectoryDeleter {
+        void operator()(RKRTrajectory *ptr) const {
+            if (ptr)
+                free_rkr_trajectory(ptr);
+        }
+    };
+    std::unique_ptr<RKRTrajectory, TrajectoryDeleter> handle_;
+};
+
 // --- Convenience free functions ---
 
 /**
@@ -259,17 +779,12 @@ inline ConFrame read_first_frame(const std::filesystem::path &path) {
     return ConFrame(handle);
 }
 
+namespace detail {
 /**
- * @brief Reads all frames from a .con file using mmap.
- * @throws std::runtime_error on failure.
+ * @brief Takes ownership of a frame array returned by the C API.
  */
-inline std::vector<ConFrame> read_all_frames(const std::filesystem::path &path) {
-    size_t num_frames = 0;
-    RKRConFrame **handles = rkr_read_all_frames(path.c_str(), &num_frames);
-    if (!handles) {
-        throw std::runtime_error("Failed to read frames from: " +
-                                 path.string());
-    }
+inline std::vector<ConFrame> adopt_frame_array(RKRConFrame **handles,
+                                               size_t num_frames) {
     std::vector<ConFrame> frames;
     frames.reserve(num_frames);
     for (size_t i = 0; i < num_frames; ++i) {
@@ -284,10 +799,153 @@ inline std::vector<ConFrame> read_all_frames(const std::filesystem::path &path)
     return frames;
 }
 
+/**
+ * @brief Takes ownership of one frame handle returned by the C API.
+ */
+inline ConFrame adopt_frame(RKRConFrame *handle) { return ConFrame(handle); }
+} // namespace detail
+
+/**
+ * @brief Reads all frames from a .con file using mmap.
+ * @throws std::runtime_error on failure.
+ */
+inline std::vector<ConFrame> read_all_frames(const std::filesystem::path &path) {
+    size_t num_frames = 0;
+    RKRConFrame **handles = rkr_read_all_frames(path.c_str(), &num_frames);
+    if (!handles) {
+        throw std::runtime_error("Failed to read frames from: " +
+                                 path.string());
+    }
+    return detail::adopt_frame_array(handles, num_frames);
+}
+
+/**
+ * @brief Reads all frames from a .con file, parsing frames in parallel.
+ *
+ * The worker pool is created for this call and bounded by
+ * `options.threads`, so it does not compete with other ranks or pools on
+ * the same node. Parses serially if the library was built without the
+ * `parallel` feature.
+ * @throws std::runtime_error on failure.
+ */
+inline std::vector<ConFrame> read_all_frames(const std::filesystem::path &path,
+                                             const ParallelOptions &options) {
+    size_t num_frames = 0;
+    RKRConFrame **handles = rkr_read_all_frames_parallel(
+        path.c_str(), options.threads, &num_frames);
+    if (!handles) {
+        throw std::runtime_error("Failed to read frames from: " +
+                                 path.string());
+    }
+    return detail::adopt_frame_array(handles, num_frames);
+}
+
+/**
+ * @brief Reads a whole file into a shared-topology Trajectory.
+ *
+ * Uses about a third of the memory of read_all_frames() when the
+ * composition is constant.
+ * @throws std::runtime_error on failure.
+ */
+inline Trajectory read_trajectory(const std::filesystem::path &path) {
+    RKRTrajectory *handle = rkr_read_trajectory(path.c_str());
+    if (!handle) {
+        throw std::runtime_error("Failed to read trajectory from: " +
+                                 path.string());
+    }
+    return Trajectory(handle);
+}
+
+/**
+ * @brief Parses a file in parallel and hands each frame to `callback` on
+ * the worker thread that parsed it, without collecting the frames.
+ *
+ * `callback(size_t frame_no, ConFrame frame)` runs concurrently on up to
+ * `options.threads` workers and sees frames in no particular order, so it
+ * must be thread-safe. It may return void, or bool where false stops the
+ * remaining frames. An exception thrown by the callback also stops them
+ * and is rethrown here. Without the `parallel` feature, frames arrive in
+ * order on the calling thread.
+ * @return true if every frame was delivered, false if `callback` stopped.
+ * @throws std::runtime_error on a read or parse failure.
+ */
+template <typename Callback>
+bool for_each_frame(const std::filesystem::path &path, Callback &&callback,
+                    const ParallelOptions &options = {}) {
+    using Fn = std::remove_reference_t<Callback>;
+    struct State {
+        Fn *callback;
+        std::mutex mutex;
+        std::exception_ptr error;
+    } state{&callback, {}, {}};
+    auto trampoline = [](void *user_data, size_t frame_no,
+                         RKRConFrame *handle) -> int32_t {
+        State &shared = *static_cast<State *>(user_data);
+        ConFrame frame = detail::adopt_frame(handle);
+        try {
+            if constexpr (std::is_same_v<
+                              std::invoke_result_t<Fn &, size_t, ConFrame &&>,
+                              bool>) {
+                return (*shared.callback)(frame_no, std::move(frame)) ? 0 : 1;
+            } else {
+                (*shared.callback)(frame_no, std::move(frame));
+                return 0;
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(shared.mutex);
+            if (!shared.error) {
+                shared.error = std::current_exception();
+            }
+            return 1;
+        }
+    };
+    int32_t status = rkr_for_each_frame(path.c_str(), options.threads,
+                                        trampoline, &state);
+    if (state.error) {
+        std::rethrow_exception(state.error);
+    }
+    if (status < 0) {
+        throw std::runtime_error("Failed to read frames from: " +
+                                 path.string());
+    }
+    return status == 0;
+}
+
+/**
+ * @brief Process-wide parse, write and conversion counters (RKRStats).
+ */
+using Stats = RKRStats;
+
+/**
+ * @brief Returns true if the library was built with the `instrumentation`
+ * feature, i.e. if stats() reports anything.
+ */
+inline bool stats_enabled() { return rkr_stats_enabled(); }
+
+/**
+ * @brief Returns a snapshot of the instrumentation counters.
+ *
+ * Counters cover every thread since start-up or the last reset_stats(), so
+ * take the difference of two snapshots to attribute one load or dump.
+ */
+inline Stats stats() {
+    Stats s{};
+    rkr_stats_snapshot(&s);
+    return s;
+}
+
+/**
+ * @brief Sets every instrumentation counter back to zero.
+ */
+inline void reset_stats() { rkr_stats_reset(); }
+
 // --- Implementation of ConFrameIterator and its nested Iterator ---
 
-inline ConFrameIterator::ConFrameIterator(const std::filesystem::path &path) {
-    CConFrameIterator *iter_ptr = read_con_file_iterator(path.c_str());
+inline ConFrameIterator::ConFrameIterator(const std::filesystem::path &path,
+                                          bool persist_index) {
+    CConFrameIterator *iter_ptr =
+        persist_index ? read_con_file_iterator_indexed(path.c_str(), true)
+                      : read_con_file_iterator(path.c_str());
     if (!iter_ptr) {
         throw std::runtime_error("Failed to open .con file for iteration: " +
                                  path.string());
@@ -295,23 +953,84 @@ inline ConFrameIterator::ConFrameIterator(const std::filesystem::path &path) {
     iterator_ptr_.reset(iter_ptr);
 }
 
+inline size_t ConFrameIterator::size() {
+    size_t num_frames = 0;
+    if (con_frame_iterator_len(iterator_ptr_.get(), &num_frames) != 0) {
+        throw std::runtime_error("Failed to index frames.");
+    }
+    return num_frames;
+}
+
+inline ConFrame ConFrameIterator::operator[](size_t index) {
+    if (index >= size()) {
+        throw std::out_of_range("Frame index out of range: " +
+                                std::to_string(index));
+    }
+    if (con_frame_iterator_seek(iterator_ptr_.get(), index) != 0) {
+        throw std::runtime_error("Failed to seek to frame " +
+                                 std::to_string(index));
+    }
+    RKRConFrame *frame_handle = con_frame_iterator_next(iterator_ptr_.get());
+    if (!frame_handle) {
+        throw std::runtime_error("Failed to parse frame " +
+                                 std::to_string(index));
+    }
+    return ConFrame(frame_handle);
+}
+
+inline void ConFrameIterator::set_recycle_frames(bool enable) {
+    recycle_frames_ = enable;
+}
+
+inline void ConFrameIterator::set_parse_options(const ParseOptions &options) {
+    std::vector<const char *> symbols;
+    symbols.reserve(options.components.size());
+    for (const auto &symbol : options.components) {
+        symbols.push_back(symbol.c_str());
+    }
+    RKRParseOptions c_options{};
+    c_options.header_only = options.header_only;
+    c_options.skip_velocities = options.skip_velocities;
+    c_options.components = symbols.data();
+    c_options.num_components = symbols.size();
+    if (options.atom_ids) {
+        c_options.filter_atom_ids = true;
+        c_options.atom_id_min = options.atom_ids->first;
+        c_options.atom_id_max = options.atom_ids->second;
+    }
+    if (con_frame_iterator_set_options(iterator_ptr_.get(), &c_options) != 0) {
+        throw std::runtime_error("Invalid parse options.");
+    }
+}
+
 inline ConFrameIterator::Iterator ConFrameIterator::begin() {
-    return Iterator(iterator_ptr_.get());
+    return Iterator(iterator_ptr_.get(), recycle_frames_);
 }
 inline ConFrameIterator::Iterator ConFrameIterator::end() {
-    return Iterator(nullptr);
+    return Iterator(nullptr, false);
 }
 inline bool
 ConFrameIterator::Iterator::operator!=(const Iterator &other) const {
     return current_frame_ != other.current_frame_;
 }
-inline ConFrameIterator::Iterator::Iterator(CConFrameIterator *iterator_ptr)
-    : iterator_ptr_(iterator_ptr) {
+inline ConFrameIterator::Iterator::Iterator(CConFrameIterator *iterator_ptr,
+                                            bool recycle_frames)
+    : iterator_ptr_(iterator_ptr), recycle_frames_(recycle_frames) {
     if (iterator_ptr_)
         fetch_next_frame();
 }
 
 inline void ConFrameIterator::Iterator::fetch_next_frame() {
+    if (recycle_frames_ && current_frame_ && current_frame_->frame_handle_) {
+        if (con_frame_iterator_next_into(iterator_ptr_,
+                                         current_frame_->frame_handle_.get()) ==
+            0) {
+            current_frame_->invalidate_cache();
+        } else {
+            current_frame_ = nullptr;
+        }
+        return;
+    }
     RKRConFrame *frame_handle = con_frame_iterator_next(iterator_ptr_);
     if (frame_handle) {
         current_frame_ = std::unique_ptr<ConFrame>(new ConFrame(frame_handle));
@@ -331,93 +1050,261 @@ inline ConFrameIterator::Iterator &ConFrameIterator::Iterator::operator++() {
     return *this;
 }
 
-// --- Implementation of ConFrame methods ---
+// --- Implementation of ConFrameStream and its nested Iterator ---
 
-inline ConFrame::ConFrame(RKRConFrame *frame_handle)
-    : frame_handle_(frame_handle) {}
+inline ConFrameStream::ConFrameStream(std::istream &input)
+    : reader_ptr_(rkr_stream_reader_new(&ConFrameStream::read_callback,
+                                        static_cast<void *>(&input))) {
+    if (!reader_ptr_) {
+        throw std::runtime_error("Failed to create stream reader.");
+    }
+}
 
-inline void ConFrame::cache_data() const {
-    if (is_cached_) {
-        return;
+inline intptr_t ConFrameStream::read_callback(void *user_data, uint8_t *buf,
+                                              uintptr_t len) {
+    auto *input = static_cast<std::istream *>(user_data);
+    input->read(reinterpret_cast<char *>(buf),
+                static_cast<std::streamsize>(len));
+    if (input->bad()) {
+        return -1;
     }
+    return static_cast<intptr_t>(input->gcount());
+}
 
-    // Extract the C-struct once for numeric data.
-    CFrame *c_frame = rkr_frame_to_c_frame(frame_handle_.get());
-    if (!c_frame) {
-        throw std::runtime_error(
-            "Failed to extract CFrame from handle for caching.");
+inline ConFrameStream::Iterator ConFrameStream::begin() {
+    return Iterator(reader_ptr_.get());
+}
+inline ConFrameStream::Iterator ConFrameStream::end() {
+    return Iterator(nullptr);
+}
+inline bool ConFrameStream::Iterator::operator!=(const Iterator &other) const {
+    return current_frame_ != other.current_frame_;
+}
+inline ConFrameStream::Iterator::Iterator(RKRConFrameStreamReader *reader_ptr)
+    : reader_ptr_(reader_ptr) {
+    if (reader_ptr_)
+        fetch_next_frame();
+}
+
+inline void ConFrameStream::Iterator::fetch_next_frame() {
+    RKRConFrame *frame_handle = rkr_stream_reader_next(reader_ptr_);
+    if (frame_handle) {
+        current_frame_ = std::unique_ptr<ConFrame>(new ConFrame(frame_handle));
+    } else {
+        current_frame_ = nullptr;
     }
+}
+
+inline ConFrame &ConFrameStream::Iterator::operator*() {
+    return *current_frame_;
+}
+inline ConFrame *ConFrameStream::Iterator::operator->() {
+    return current_frame_.get();
+}
+inline ConFrameStream::Iterator &ConFrameStream::Iterator::operator++() {
+    fetch_next_frame();
+    return *this;
+}
 
-    cell_cache_ = {c_frame->cell[0], c_frame->cell[1], c_frame->cell[2]};
-    angles_cache_ = {c_frame->angles[0], c_frame->angles[1],
-                     c_frame->angles[2]};
+// --- Implementation of ConFrame methods ---
 
-    has_velocities_cache_ = c_frame->has_velocities;
+inline ConFrame::ConFrame(RKRConFrame *frame_handle)
+    : frame_handle_(frame_handle) {}
 
-    atoms_cache_.reserve(c_frame->num_atoms);
-    for (size_t i = 0; i < c_frame->num_atoms; ++i) {
-        const CAtom &c_atom = c_frame->atoms[i];
-        atoms_cache_.emplace_back(
-            Atom{c_atom.atomic_number, c_atom.x, c_atom.y, c_atom.z,
-                 c_atom.atom_id, c_atom.mass, c_atom.is_fixed,
-                 c_atom.vx, c_atom.vy, c_atom.vz, c_atom.has_velocity});
-    }
+inline const ConFrame::Cache &ConFrame::cache_metadata() const {
+    std::call_once(cache_->metadata_once, [this] {
+        const RKRConFrame *handle = frame_handle_.get();
+        if (rkr_frame_get_cell(handle, cache_->cell.data(),
+                               cache_->angles.data()) != 0) {
+            throw std::runtime_error("Failed to read frame cell for caching.");
+        }
+        cache_->num_atoms = rkr_frame_num_atoms(handle);
+        cache_->has_velocities = rkr_frame_has_velocities(handle);
+    });
+    return *cache_;
+}
 
-    free_c_frame(c_frame);
+inline const ConFrame::Cache &ConFrame::cache_header() const {
+    std::call_once(cache_->header_once, [this] {
+        // The helper lambda ensures each allocated line is always freed.
+        auto get_and_free_string =
+            [frame_handle = frame_handle_.get()](bool is_prebox, size_t index) {
+                char *c_str = rkr_frame_get_header_line_cpp(frame_handle,
+                                                            is_prebox, index);
+                if (!c_str) {
+                    return std::string();
+                }
+                std::string result(c_str);
+                rkr_free_string(c_str);
+                return result;
+            };
+        cache_->prebox_header = {get_and_free_string(true, 0),
+                                 get_and_free_string(true, 1)};
+        cache_->postbox_header = {get_and_free_string(false, 0),
+                                  get_and_free_string(false, 1)};
+    });
+    return *cache_;
+}
 
-    // Cache headers using the flexible FFI that allocates and frees
-    // strings. This helper lambda makes the code cleaner and ensures memory is
-    // always freed.
-    auto get_and_free_string =
-        [frame_handle = frame_handle_.get()](bool is_prebox, size_t index) {
-            char *c_str =
-                rkr_frame_get_header_line_cpp(frame_handle, is_prebox, index);
-            if (!c_str) {
-                return std::string();
+inline const ConFrame::Cache &ConFrame::cache_atoms() const {
+    const Cache &metadata = cache_metadata();
+    std::call_once(cache_->atoms_once, [this, &metadata] {
+        const RKRConFrame *handle = frame_handle_.get();
+        std::vector<Atom> &atoms_cache = cache_->atoms;
+        atoms_cache.assign(metadata.num_atoms, Atom{});
+        if (atoms_cache.empty()) {
+            return;
+        }
+        // The columns are copied into flat scratch buffers and scattered.
+        // Writing them strided through &atoms->x would walk a double* across
+        // separate Atom objects, which C++ does not allow even though the
+        // layout would work.
+        const size_t n = atoms_cache.size();
+        std::vector<double> xyz(3 * n);
+        std::vector<double> vxyz(3 * n);
+        std::vector<uint64_t> ids(n);
+        std::unique_ptr<bool[]> fixed(new bool[n]);
+        std::unique_ptr<bool[]> has_velocity(new bool[n]);
+        if (rkr_frame_copy_positions(handle, xyz.data(), 1) != 0 ||
+            rkr_frame_copy_ids(handle, ids.data(), 1) != 0 ||
+            rkr_frame_copy_fixed_mask(handle, fixed.get(), 1) != 0 ||
+            rkr_frame_copy_velocity_mask(handle, has_velocity.get(), 1) != 0) {
+            atoms_cache.clear();
+            throw std::runtime_error("Failed to copy atom data for caching.");
+        }
+        // 1 means no atom has a velocity; the Atom{} zeros then stand.
+        int vel_status = rkr_frame_copy_velocities(handle, vxyz.data(), 1);
+        if (vel_status < 0) {
+            atoms_cache.clear();
+            throw std::runtime_error("Failed to copy atom data for caching.");
+        }
+        Atom *atoms = atoms_cache.data();
+        for (size_t i = 0; i < n; ++i) {
+            atoms[i].x = xyz[i];
+            atoms[i].y = xyz[n + i];
+            atoms[i].z = xyz[2 * n + i];
+            atoms[i].atom_id = ids[i];
+            atoms[i].is_fixed = fixed[i];
+            atoms[i].has_velocity = has_velocity[i];
+        }
+        if (vel_status == 0) {
+            for (size_t i = 0; i < n; ++i) {
+                atoms[i].vx = vxyz[i];
+                atoms[i].vy = vxyz[n + i];
+                atoms[i].vz = vxyz[2 * n + i];
             }
-            std::string result(c_str);
-            rkr_free_string(c_str);
-            return result;
-        };
+        }
 
-    prebox_header_cache_[0] = get_and_free_string(true, 0);
-    prebox_header_cache_[1] = get_and_free_string(true, 1);
-    postbox_header_cache_[0] = get_and_free_string(false, 0);
-    postbox_header_cache_[1] = get_and_free_string(false, 1);
+        // Element and mass are per component.
+        size_t num_components = 0;
+        const CComponent *components =
+            rkr_frame_get_components(handle, &num_components);
+        for (size_t c = 0; c < num_components; ++c) {
+            const CComponent &run = components[c];
+            size_t end = std::min(run.offset + run.count, atoms_cache.size());
+            for (size_t i = run.offset; i < end; ++i) {
+                atoms[i].atomic_number = run.atomic_number;
+                atoms[i].mass = run.mass;
+            }
+        }
+    });
+    return *cache_;
+}
 
-    is_cached_ = true;
+inline void ConFrame::invalidate_cache() {
+    // Keep the atom cache's capacity for the next cache_atoms() call.
+    auto fresh = std::make_unique<Cache>();
+    if (cache_) {
+        fresh->atoms = std::move(cache_->atoms);
+        fresh->atoms.clear();
+    }
+    cache_ = std::move(fresh);
 }
 
 inline const std::array<double, 3> &ConFrame::cell() const {
-    cache_data();
-    return cell_cache_;
+    return cache_metadata().cell;
 }
 
 inline const std::array<double, 3> &ConFrame::angles() const {
-    cache_data();
-    return angles_cache_;
+    return cache_metadata().angles;
 }
 
 inline const std::vector<Atom> &ConFrame::atoms() const {
-    cache_data();
-    return atoms_cache_;
+    return cache_atoms().atoms;
 }
 
 inline const std::array<std::string, 2> &ConFrame::prebox_header() const {
-    cache_data();
-    return prebox_header_cache_;
+    return cache_header().prebox_header;
 }
 
 inline const std::array<std::string, 2> &ConFrame::postbox_header() const {
-    cache_data();
-    return postbox_header_cache_;
+    return cache_header().postbox_header;
 }
 
 inline bool ConFrame::has_velocities() const {
-    cache_data();
-    return has_velocities_cache_;
+    return cache_metadata().has_velocities;
+}
+
+inline size_t ConFrame::num_atoms() const {
+    return cache_metadata().num_atoms;
+}
+
+#ifdef READCON_HAS_SPAN
+inline CoordinateColumns ConFrame::positions() const {
+    CoordinateColumns view;
+    std::span<const double> *axes[3] = {&view.x, &view.y, &view.z};
+    for (size_t axis = 0; axis < 3; ++axis) {
+        size_t len = 0;
+        const double *data =
+            rkr_frame_get_positions(frame_handle_.get(), axis, &len);
+        if (!data) {
+            throw std::runtime_error("Failed to access position columns.");
+        }
+        *axes[axis] = std::span<const double>(data, len);
+    }
+    return view;
 }
 
+inline CoordinateColumns ConFrame::velocities() const {
+    CoordinateColumns view;
+    std::span<const double> *axes[3] = {&view.x, &view.y, &view.z};
+    for (size_t axis = 0; axis < 3; ++axis) {
+        size_t len = 0;
+        const double *data =
+            rkr_frame_get_velocities(frame_handle_.get(), axis, &len);
+        // NULL with len == 0 simply means the frame has no velocities.
+        *axes[axis] = std::span<const double>(data, data ? len : 0);
+    }
+    return view;
+}
+
+inline std::span<const uint64_t> ConFrame::atom_ids() const {
+    size_t len = 0;
+    const uint64_t *data = rkr_frame_get_atom_ids(frame_handle_.get(), &len);
+    if (!data) {
+        throw std::runtime_error("Failed to access atom ID column.");
+    }
+    return std::span<const uint64_t>(data, len);
+}
+
+inline std::span<const bool> ConFrame::fixed_mask() const {
+    size_t len = 0;
+    const bool *data = rkr_frame_get_fixed_mask(frame_handle_.get(), &len);
+    if (!data) {
+        throw std::runtime_error("Failed to access fixed-atom column.");
+    }
+    return std::span<const bool>(data, len);
+}
+
+inline std::span<const CComponent> ConFrame::components() const {
+    size_t len = 0;
+    const CComponent *data =
+        rkr_frame_get_components(frame_handle_.get(), &len);
+    // NULL with len == 0 means the frame has no components.
+    return std::span<const CComponent>(data, data ? len : 0);
+}
+#endif
+
 // --- Implementation of ConFrameWriter methods ---
 
 inline ConFrameWriter::ConFrameWriter(const std::filesystem::path &path,
@@ -434,6 +1321,18 @@ inline ConFrameWriter::ConFrameWriter(const std::filesystem::path &path,
     }
 }
 
+inline ConFrameWriter::ConFrameWriter(const std::filesystem::path &path,
+                                      uint8_t precision,
+                                      const ParallelWriteOptions &options) {
+    writer_handle_.reset(create_writer_from_path_parallel_c(
+        path.c_str(), precision, options.threads,
+        options.max_in_flight_bytes));
+    if (!writer_handle_) {
+        throw std::runtime_error("Failed to create writer for file: " +
+                                 path.string());
+    }
+}
+
 inline void ConFrameWriter::extend(const std::vector<ConFrame> &frames) {
     if (frames.empty())
         return;
@@ -450,6 +1349,145 @@ inline void ConFrameWriter::extend(const std::vector<ConFrame> &frames) {
     }
 }
 
+#ifdef READCON_HAS_SPAN
+inline void ConFrameWriter::write(const FrameView &view) {
+    const size_t k = view.component_counts.size();
+    size_t n = 0;
+    for (size_t count : view.component_counts) {
+        n += count;
+    }
+    if (view.symbols.size() != k || view.masses.size() != k ||
+        view.xyz.size() != 3 * n || view.atom_ids.size() != n ||
+        (!view.fixed.empty() && view.fixed.size() != n) ||
+        (!view.velocities.empty() && view.velocities.size() != 3 * n)) {
+        throw std::invalid_argument(
+            "FrameView: array sizes do not match the component counts.");
+    }
+    RKRFrameHeader header{};
+    std::copy(view.cell.begin(), view.cell.end(), header.cell);
+    std::copy(view.angles.begin(), view.angles.end(), header.angles);
+    header.prebox[0] = view.prebox[0];
+    header.prebox[1] = view.prebox[1];
+    header.postbox[0] = view.postbox[0];
+    header.postbox[1] = view.postbox[1];
+    if (rkr_writer_write_arrays(
+            writer_handle_.get(), &header, k, view.component_counts.data(),
+            view.symbols.data(), view.masses.data(), view.xyz.data(),
+            view.velocities.empty() ? nullptr : view.velocities.data(),
+            view.atom_ids.data(),
+            view.fixed.empty() ? nullptr : view.fixed.data()) != 0) {
+        throw std::runtime_error("Failed to write frame from arrays.");
+    }
+}
+#endif
+
+inline ConFrameWriter::ConFrameWriter(const std::filesystem::path &path,
+                                      Mode mode, uint8_t precision) {
+    if (mode == Mode::Append) {
+        writer_handle_.reset(create_writer_append_c(path.c_str(), precision));
+    } else {
+        writer_handle_.reset(
+            create_writer_from_path_with_precision_c(path.c_str(), precision));
+    }
+    if (!writer_handle_) {
+        throw std::runtime_error("Failed to create writer for file: " +
+                                 path.string());
+    }
+}
+
+inline void ConFrameWriter::set_coordinate_width(size_t width) {
+    if (rkr_writer_set_coordinate_width(writer_handle_.get(), width) != 0) {
+        throw std::runtime_error("Failed to set the coordinate width.");
+    }
+}
+
+inline void ConFrameWriter::finish() {
+    if (rkr_writer_finish(writer_handle_.get()) != 0) {
+        throw std::runtime_error("Failed to finish writing the file.");
+    }
+}
+
+/**
+ * @brief Overwrites the coordinates of one frame in place.
+ *
+ * The file must have been written with the same precision and with
+ * ConFrameWriter::set_coordinate_width(width); no other byte moves.
+ * @throws std::runtime_error if the frame does not exist, the atom count
+ * differs, or a value does not fit the field width (nothing is written).
+ */
+inline void patch_positions(const std::filesystem::path &path,
+                            size_t frame_no,
+                            const std::vector<std::array<double, 3>> &positions,
+                            uint8_t precision, size_t width) {
+    const double *xyz = positions.empty() ? nullptr : positions.front().data();
+    if (rkr_patch_positions(path.c_str(), frame_no, xyz, positions.size(),
+                            precision, width) != 0) {
+        throw std::runtime_error("Failed to patch frame " +
+                                 std::to_string(frame_no) + " of " +
+                                 path.string());
+    }
+}
+
+// --- Implementation of AsyncConFrameWriter methods ---
+
+inline AsyncConFrameWriter::AsyncConFrameWriter(
+    const std::filesystem::path &path, const AsyncWriterOptions &options) {
+    RKRAsyncWriterOptions c_options{};
+    c_options.precision = options.precision;
+    c_options.queue_capacity = options.queue_capacity;
+    c_options.reject_when_full = !options.block_when_full;
+    switch (options.fsync) {
+    case FsyncPolicy::None:
+        c_options.fsync_policy = RKR_FSYNC_NONE;
+        break;
+    case FsyncPolicy::EveryNFrames:
+        c_options.fsync_policy = RKR_FSYNC_EVERY_N_FRAMES;
+        break;
+    case FsyncPolicy::OnClose:
+        c_options.fsync_policy = RKR_FSYNC_ON_CLOSE;
+        break;
+    }
+    c_options.fsync_every = options.fsync_every;
+    writer_handle_.reset(rkr_async_writer_new(path.c_str(), &c_options));
+    if (!writer_handle_) {
+        throw std::runtime_error("Failed to create writer for file: " +
+                                 path.string());
+    }
+}
+
+inline bool AsyncConFrameWriter::push(ConFrame &&frame) {
+    if (!writer_handle_ || !frame.frame_handle_) {
+        throw std::runtime_error("Cannot push to a closed writer or from an "
+                                 "empty frame.");
+    }
+    switch (rkr_async_writer_push(writer_handle_.get(),
+                                  frame.frame_handle_.get())) {
+    case 0:
+        // The writer thread owns and frees the Rust frame now.
+        frame.frame_handle_.release();
+        frame.invalidate_cache();
+        return true;
+    case 1:
+        return false;
+    default:
+        throw std::runtime_error("Asynchronous writer has stopped.");
+    }
+}
+
+inline void AsyncConFrameWriter::flush() {
+    if (!writer_handle_ || rkr_async_writer_flush(writer_handle_.get()) != 0) {
+        throw std::runtime_error("Failed to write queued frames.");
+    }
+}
+
+inline void AsyncConFrameWriter::close() {
+    if (!writer_handle_)
+        return;
+    if (rkr_async_writer_close(writer_handle_.release()) != 0) {
+        throw std::runtime_error("Failed to write queued frames.");
+    }
+}
+
 // --- Implementation of ConFrameBuilder methods ---
 
 inline ConFrameBuilder::ConFrameBuilder(
@@ -464,6 +1502,14 @@ inline ConFrameBuilder::ConFrameBuilder(
     }
 }
 
+inline ConFrameBuilder::ConFrameBuilder(
+    const std::array<double, 3> &cell, const std::array<double, 3> &angles,
+    size_t num_atoms, const std::array<std::string, 2> &prebox,
+    const std::array<std::string, 2> &postbox)
+    : ConFrameBuilder(cell, angles, prebox, postbox) {
+    rkr_frame_builder_reserve(builder_handle_, num_atoms);
+}
+
 inline ConFrameBuilder::~ConFrameBuilder() {
     if (builder_handle_) {
         free_rkr_frame_builder(builder_handle_);
@@ -507,6 +1553,28 @@ inline void ConFrameBuilder::add_atom_with_velocity(
     }
 }
 
+#ifdef READCON_HAS_SPAN
+inline void ConFrameBuilder::add_component(const std::string &symbol,
+                                           double mass,
+                                           std::span<const double> xyz,
+                                           std::span<const uint64_t> atom_ids,
+                                           std::span<const bool> fixed,
+                                           std::span<const double> velocities) {
+    const size_t n = atom_ids.size();
+    if (xyz.size() != 3 * n || (!fixed.empty() && fixed.size() != n) ||
+        (!velocities.empty() && velocities.size() != 3 * n)) {
+        throw std::invalid_argument(
+            "add_component: array sizes do not match the atom count.");
+    }
+    if (rkr_frame_add_atoms_bulk(
+            builder_handle_, symbol.c_str(), n, xyz.data(), atom_ids.data(),
+            fixed.empty() ? nullptr : fixed.data(), mass,
+            velocities.empty() ? nullptr : velocities.data()) != 0) {
+        throw std::runtime_error("Failed to add atoms to frame builder.");
+    }
+}
+#endif
+
 inline ConFrame ConFrameBuilder::build() {
     RKRConFrame *frame = rkr_frame_builder_build(builder_handle_);
     builder_handle_ = nullptr; // ownership transferred
@@ -516,6 +1584,79 @@ inline ConFrame ConFrameBuilder::build() {
     return ConFrame(frame);
 }
 
+// --- Implementation of Trajectory ---
+
+inline void Trajectory::check_index(size_t frame_no) const {
+    if (frame_no >= size()) {
+        throw std::out_of_range("Trajectory frame index out of range.");
+    }
+}
+
+inline size_t Trajectory::num_atoms(size_t frame_no) const {
+    check_index(frame_no);
+    return rkr_trajectory_num_atoms(handle_.get(), frame_no);
+}
+
+inline std::array<double, 3> Trajectory::cell(size_t frame_no) const {
+    check_index(frame_no);
+    std::array<double, 3> cell{};
+    rkr_trajectory_get_cell(handle_.get(), frame_no, cell.data(), nullptr);
+    return cell;
+}
+
+inline std::array<double, 3> Trajectory::angles(size_t frame_no) const {
+    check_index(frame_no);
+    std::array<double, 3> angles{};
+    rkr_trajectory_get_cell(handle_.get(), frame_no, nullptr, angles.data());
+    return angles;
+}
+
+inline ConFrame Trajectory::frame(size_t frame_no) const {
+    check_index(frame_no);
+    RKRConFrame *handle = rkr_trajectory_frame(handle_.get(), frame_no);
+    if (!handle) {
+        throw std::runtime_error("Failed to build trajectory frame.");
+    }
+    return ConFrame(handle);
+}
+
+#ifdef READCON_HAS_SPAN
+inline std::span<const double> Trajectory::positions(size_t frame_no) const {
+    check_index(frame_no);
+    size_t len = 0;
+    const double *ptr =
+        rkr_trajectory_get_positions(handle_.get(), frame_no, &len);
+    return ptr ? std::span<const double>(ptr, 3 * len)
+               : std::span<const double>();
+}
+
+inline std::span<const double> Trajectory::velocities(size_t frame_no) const {
+    check_index(frame_no);
+    size_t len = 0;
+    const double *ptr =
+        rkr_trajectory_get_velocities(handle_.get(), frame_no, &len);
+    return ptr ? std::span<const double>(ptr, 3 * len)
+               : std::span<const double>();
+}
+
+inline std::span<const uint64_t> Trajectory::atom_ids(size_t frame_no) const {
+    check_index(frame_no);
+    size_t len = 0;
+    const uint64_t *ptr =
+        rkr_trajectory_get_atom_ids(handle_.get(), frame_no, &len);
+    return ptr ? std::span<const uint64_t>(ptr, len)
+               : std::span<const uint64_t>();
+}
+
+inline std::span<const bool> Trajectory::fixed_mask(size_t frame_no) const {
+    check_index(frame_no);
+    size_t len = 0;
+    const bool *ptr =
+        rkr_trajectory_get_fixed_mask(handle_.get(), frame_no, &len);
+    return ptr ? std::span<const bool>(ptr, len) : std::span<const bool>();
+}
+#endif
+
 } // namespace readcon
 
 #endif // READCON_PLUS_PLUS_H
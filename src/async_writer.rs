@@ -0,0 +1,237 @@
+//! A `.con` writer that formats and writes frames on a background thread.
+//!
+//! Producers hand frames over through a bounded channel
+//! (`std::sync::mpsc::sync_channel`, a lock-free array queue), so pushing a
+//! frame costs one move. When the queue is full the producer either blocks
+//! or gets the frame back, depending on [`Backpressure`].
+
+use crate::types::ConFrame;
+use crate::writer::ConFrameWriter;
+use std::borrow::Borrow;
+use std::fs::File;
+use std::io;
+use std::path::Path;
+use std::sync::mpsc::{self, Receiver, SyncSender, TrySendError};
+use std::thread::JoinHandle;
+
+/// What `push` does when the queue is full.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Backpressure {
+    /// Wait until the writer thread has made room.
+    Block,
+    /// Return the frame to the caller immediately.
+    Reject,
+}
+
+/// When the writer thread calls `fsync` on the output file.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum FsyncPolicy {
+    /// Never; data reaches the OS on `flush`/close but is not synced.
+    Never,
+    /// After every N frames written (0 behaves like `OnClose`), and on close.
+    EveryNFrames(usize),
+    /// Once, when the writer is closed.
+    OnClose,
+}
+
+/// Configuration for [`AsyncConFrameWriter`].
+#[derive(Debug, Clone, Copy)]
+pub struct AsyncWriterOptions {
+    /// Number of decimal places for floating-point output.
+    pub precision: usize,
+    /// Maximum number of frames waiting to be written.
+    pub queue_capacity: usize,
+    pub backpressure: Backpressure,
+    pub fsync: FsyncPolicy,
+}
+
+impl Default for AsyncWriterOptions {
+    fn default() -> Self {
+        Self {
+            precision: 6,
+            queue_capacity: 64,
+            backpressure: Backpressure::Block,
+            fsync: FsyncPolicy::Never,
+        }
+    }
+}
+
+/// Why a frame could not be queued. The frame is handed back either way.
+#[derive(Debug)]
+pub enum PushError<F> {
+    /// The queue is full and the writer uses [`Backpressure::Reject`].
+    Full(F),
+    /// The writer thread is no longer running.
+    Closed(F),
+}
+
+impl<F> PushError<F> {
+    /// Recovers the frame that was not queued.
+    pub fn into_inner(self) -> F {
+        match self {
+            PushError::Full(f) | PushError::Closed(f) => f,
+        }
+    }
+}
+
+enum AsyncMessage<F> {
+    Frame(F),
+    Flush(SyncSender<io::Result<()>>),
+}
+
+/// Writes frames to a file from a dedicated thread.
+///
+/// Frames are written in push order. The first I/O error stops writing;
+/// it is reported by the next `flush()` and by `close()`, and later frames
+/// are discarded. Dropping the writer closes it and ignores any error.
+///
+/// `F` is the owned frame type moved through the queue; anything that
+/// borrows as a `ConFrame` works, which lets the FFI queue its heap handles
+/// without unboxing them.
+///
+/// # Example
+/// ```no_run
+/// # use readcon_core::async_writer::{AsyncConFrameWriter, AsyncWriterOptions};
+/// # use readcon_core::types::ConFrame;
+/// # let frames: Vec<ConFrame> = Vec::new();
+/// let writer = AsyncConFrameWriter::from_path("traj.con", AsyncWriterOptions::default()).unwrap();
+/// for frame in frames {
+///     writer.push(frame).unwrap();
+/// }
+/// writer.close().unwrap();
+/// ```
+pub struct AsyncConFrameWriter<F: Borrow<ConFrame> + Send + 'static = ConFrame> {
+    sender: Option<SyncSender<AsyncMessage<F>>>,
+    thread: Option<JoinHandle<io::Result<()>>>,
+    backpressure: Backpressure,
+}
+
+impl<F: Borrow<ConFrame> + Send + 'static> AsyncConFrameWriter<F> {
+    /// Creates the output file and starts the writer thread.
+    ///
+    /// The file is created on the calling thread, so a bad path is reported
+    /// here rather than on the first flush.
+    pub fn from_path<P: AsRef<Path>>(path: P, options: AsyncWriterOptions) -> io::Result<Self> {
+        let writer = ConFrameWriter::from_path_with_precision(path, options.precision)?;
+        let (sender, receiver) = mpsc::sync_channel(options.queue_capacity.max(1));
+        let fsync = options.fsync;
+        let thread = std::thread::Builder::new()
+            .name("readcon-writer".into())
+            .spawn(move || run_writer(writer, receiver, fsync))?;
+        Ok(Self {
+            sender: Some(sender),
+            thread: Some(thread),
+            backpressure: options.backpressure,
+        })
+    }
+
+    /// Queues a frame for writing.
+    pub fn push(&self, frame: F) -> Result<(), PushError<F>> {
+        let Some(sender) = &self.sender else {
+            return Err(PushError::Closed(frame));
+        };
+        let message = AsyncMessage::Frame(frame);
+        let unsent = match self.backpressure {
+            Backpressure::Block => match sender.send(message) {
+                Ok(()) => return Ok(()),
+                Err(mpsc::SendError(m)) => (m, false),
+            },
+            Backpressure::Reject => match sender.try_send(message) {
+                Ok(()) => return Ok(()),
+                Err(TrySendError::Full(m)) => (m, true),
+                Err(TrySendError::Disconnected(m)) => (m, false),
+            },
+        };
+        match unsent {
+            (AsyncMessage::Frame(f), true) => Err(PushError::Full(f)),
+            (AsyncMessage::Frame(f), false) => Err(PushError::Closed(f)),
+            (AsyncMessage::Flush(_), _) => unreachable!("only frames are pushed"),
+        }
+    }
+
+    /// Blocks until every frame pushed so far has been written and the
+    /// output buffer handed to the OS. Returns the writer's first I/O error,
+    /// if any.
+    pub fn flush(&self) -> io::Result<()> {
+        let closed = || io::Error::other("writer thread is not running");
+        let sender = self.sender.as_ref().ok_or_else(closed)?;
+        let (reply, done) = mpsc::sync_channel(1);
+        sender
+            .send(AsyncMessage::Flush(reply))
+            .map_err(|_| closed())?;
+        done.recv().map_err(|_| closed())?
+    }
+
+    /// Writes the remaining frames, applies the fsync policy, and stops the
+    /// writer thread.
+    pub fn close(mut self) -> io::Result<()> {
+        self.shutdown()
+    }
+
+    fn shutdown(&mut self) -> io::Result<()> {
+        // Dropping the sender ends the thread's receive loop.
+        self.sender = None;
+        match self.thread.take() {
+            Some(thread) => thread
+                .join()
+                .unwrap_or_else(|_| Err(io::Error::other("writer thread panicked"))),
+            None => Ok(()),
+        }
+    }
+}
+
+impl<F: Borrow<ConFrame> + Send + 'static> Drop for AsyncConFrameWriter<F> {
+    fn drop(&mut self) {
+        let _ = self.shutdown();
+    }
+}
+
+/// Copies an error so it can be reported more than once.
+fn duplicate_error(e: &io::Error) -> io::Error {
+    io::Error::new(e.kind(), e.to_string())
+}
+
+fn run_writer<F: Borrow<ConFrame>>(
+    mut writer: ConFrameWriter<File>,
+    receiver: Receiver<AsyncMessage<F>>,
+    fsync: FsyncPolicy,
+) -> io::Result<()> {
+    let mut error: Option<io::Error> = None;
+    let mut unsynced = 0usize;
+    for message in receiver {
+        match message {
+            AsyncMessage::Frame(frame) => {
+                if error.is_some() {
+                    continue;
+                }
+                let mut result = writer.write_frame(frame.borrow());
+                if let FsyncPolicy::EveryNFrames(n) = fsync {
+                    unsynced += 1;
+                    if n > 0 && unsynced >= n && result.is_ok() {
+                        unsynced = 0;
+                        result = writer.sync_data();
+                    }
+                }
+                error = result.err();
+            }
+            AsyncMessage::Flush(reply) => {
+                let result = match &error {
+                    Some(e) => Err(duplicate_error(e)),
+                    None => writer.flush(),
+                };
+                if let Err(e) = &result {
+                    error.get_or_insert_with(|| duplicate_error(e));
+                }
+                let _ = reply.send(result);
+            }
+        }
+    }
+    if let Some(e) = error {
+        return Err(e);
+    }
+    writer.finish()?;
+    match fsync {
+        FsyncPolicy::Never => Ok(()),
+        FsyncPolicy::EveryNFrames(_) | FsyncPolicy::OnClose => writer.sync_data(),
+    }
+}
@@ -0,0 +1,407 @@
+//=============================================================================
+// Compressed trajectories - .con.zst / .con.gz
+//=============================================================================
+//
+// The writer collects whole frames into groups of at least
+// `DEFAULT_GROUP_BYTES` of text and compresses each group independently: one
+// zstd frame or one gzip member per group. zstd output ends with
+//
+//   skippable frame  u32 magic 0x184D2A5A, u32 size, "RCONGRP1",
+//                    u32 trajectory frames per group
+//   seek table       the zstd seekable format: skippable frame
+//                    0x184D2A5E with (compressed, decompressed) u32 sizes
+//                    per group, frame count, descriptor and magic 0x8F92EAB1
+//
+// so a reader can list the groups, count trajectory frames, and decompress
+// any group on its own. Both trailers are skippable frames, which plain
+// `zstd -d` ignores. Gzip members concatenate into a valid multi-member
+// stream but carry no table, so gzip input is decompressed as a whole.
+//
+// The codecs need the `compression` feature; without it, compressed paths
+// are rejected with `ErrorKind::Unsupported` rather than read or written
+// as plain text.
+
+use std::io;
+use std::path::Path;
+
+/// Compression applied to a trajectory file, chosen from its extension.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Compression {
+    None,
+    /// `.gz`
+    Gzip,
+    /// `.zst` or `.zstd`
+    Zstd,
+}
+
+impl Compression {
+    /// Selects the codec for `path` from its final extension.
+    pub fn from_path(path: &Path) -> Self {
+        match path.extension().and_then(|e| e.to_str()) {
+            Some("gz") => Compression::Gzip,
+            Some("zst" | "zstd") => Compression::Zstd,
+            _ => Compression::None,
+        }
+    }
+
+    /// Fails with `ErrorKind::Unsupported` for a codec this build lacks.
+    pub(crate) fn check_supported(self) -> io::Result<Self> {
+        if self == Compression::None || cfg!(feature = "compression") {
+            Ok(self)
+        } else {
+            Err(io::Error::new(
+                io::ErrorKind::Unsupported,
+                "compressed trajectories require the `compression` feature",
+            ))
+        }
+    }
+}
+
+/// Minimum uncompressed size of one compression group.
+pub const DEFAULT_GROUP_BYTES: usize = 1 << 20;
+
+#[cfg(feature = "compression")]
+pub(crate) use codec::*;
+
+/// Stand-in for the codec when the feature is off; never constructed, since
+/// compressed paths are rejected by `check_supported` first.
+#[cfg(not(feature = "compression"))]
+pub(crate) enum GroupCompressor {}
+
+#[cfg(not(feature = "compression"))]
+impl GroupCompressor {
+    pub(crate) fn push_frame<W: io::Write>(&mut self, _: &mut W, _: &[u8]) -> io::Result<()> {
+        match *self {}
+    }
+
+    pub(crate) fn flush_group<W: io::Write>(&mut self, _: &mut W) -> io::Result<()> {
+        match *self {}
+    }
+
+    pub(crate) fn finish<W: io::Write>(&mut self, _: &mut W) -> io::Result<()> {
+        match *self {}
+    }
+}
+
+impl GroupCompressor {
+    /// Returns a compressor for `compression`, or `None` for plain output.
+    pub(crate) fn for_compression(compression: Compression) -> Option<Self> {
+        match compression {
+            Compression::None => None,
+            #[cfg(feature = "compression")]
+            c => Some(GroupCompressor::new(c)),
+            #[cfg(not(feature = "compression"))]
+            _ => None,
+        }
+    }
+}
+
+#[cfg(feature = "compression")]
+mod codec {
+    use super::{Compression, DEFAULT_GROUP_BYTES};
+    use crate::error::ParseError;
+    use std::io::{self, BufRead, BufReader, Read, Write};
+
+    const SKIPPABLE_GROUPS_MAGIC: u32 = 0x184D_2A5A;
+    const GROUPS_TAG: &[u8; 8] = b"RCONGRP1";
+    const SKIPPABLE_SEEK_TABLE_MAGIC: u32 = 0x184D_2A5E;
+    const SEEKABLE_MAGIC: u32 = 0x8F92_EAB1;
+    /// Number_Of_Frames, Seek_Table_Descriptor, Seekable_Magic_Number.
+    const SEEK_TABLE_FOOTER_LEN: usize = 9;
+    const ZSTD_LEVEL: i32 = 3;
+
+    /// Compresses frame text group by group (see the module comment).
+    pub(crate) struct GroupCompressor {
+        compression: Compression,
+        pending: Vec<u8>,
+        pending_frames: u32,
+        /// (compressed, decompressed, frames) per written group.
+        groups: Vec<(u32, u32, u32)>,
+        finished: bool,
+    }
+
+    impl GroupCompressor {
+        pub(crate) fn new(compression: Compression) -> Self {
+            Self {
+                compression,
+                pending: Vec::new(),
+                pending_frames: 0,
+                groups: Vec::new(),
+                finished: false,
+            }
+        }
+
+        /// Adds the text of one frame, writing a group once it is large
+        /// enough.
+        pub(crate) fn push_frame<W: Write>(&mut self, out: &mut W, text: &[u8]) -> io::Result<()> {
+            if self.finished {
+                return Err(io::Error::other("compressed output already finished"));
+            }
+            self.pending.extend_from_slice(text);
+            self.pending_frames += 1;
+            if self.pending.len() >= DEFAULT_GROUP_BYTES {
+                self.flush_group(out)?;
+            }
+            Ok(())
+        }
+
+        /// Compresses and writes the pending frames, if any, as one group.
+        pub(crate) fn flush_group<W: Write>(&mut self, out: &mut W) -> io::Result<()> {
+            if self.pending.is_empty() {
+                return Ok(());
+            }
+            let too_large = || io::Error::other("compression group exceeds 4 GiB");
+            let d_len = u32::try_from(self.pending.len()).map_err(|_| too_large())?;
+            let compressed = match self.compression {
+                Compression::Zstd => zstd::bulk::compress(&self.pending, ZSTD_LEVEL)?,
+                Compression::Gzip => {
+                    let mut gz = flate2::write::GzEncoder::new(
+                        Vec::with_capacity(self.pending.len() / 4),
+                        flate2::Compression::default(),
+                    );
+                    gz.write_all(&self.pending)?;
+                    gz.finish()?
+                }
+                Compression::None => std::mem::take(&mut self.pending),
+            };
+            let c_len = u32::try_from(compressed.len()).map_err(|_| too_large())?;
+            out.write_all(&compressed)?;
+            self.groups.push((c_len, d_len, self.pending_frames));
+            self.pending.clear();
+            self.pending_frames = 0;
+            Ok(())
+        }
+
+        /// Writes the last group and, for zstd, the group and seek tables.
+        /// Later frames are refused.
+        pub(crate) fn finish<W: Write>(&mut self, out: &mut W) -> io::Result<()> {
+            if self.finished {
+                return Ok(());
+            }
+            self.flush_group(out)?;
+            self.finished = true;
+            if self.compression != Compression::Zstd {
+                return Ok(());
+            }
+            let mut trailer = Vec::new();
+            let counts_len = GROUPS_TAG.len() + 4 * self.groups.len();
+            trailer.extend_from_slice(&SKIPPABLE_GROUPS_MAGIC.to_le_bytes());
+            trailer.extend_from_slice(&(counts_len as u32).to_le_bytes());
+            trailer.extend_from_slice(GROUPS_TAG);
+            for &(_, _, frames) in &self.groups {
+                trailer.extend_from_slice(&frames.to_le_bytes());
+            }
+            let table_len = 8 * self.groups.len() + SEEK_TABLE_FOOTER_LEN;
+            trailer.extend_from_slice(&SKIPPABLE_SEEK_TABLE_MAGIC.to_le_bytes());
+            trailer.extend_from_slice(&(table_len as u32).to_le_bytes());
+            for &(c_len, d_len, _) in &self.groups {
+                trailer.extend_from_slice(&c_len.to_le_bytes());
+                trailer.extend_from_slice(&d_len.to_le_bytes());
+            }
+            trailer.extend_from_slice(&(self.groups.len() as u32).to_le_bytes());
+            trailer.push(0); // no checksums
+            trailer.extend_from_slice(&SEEKABLE_MAGIC.to_le_bytes());
+            out.write_all(&trailer)
+        }
+    }
+
+    /// One independently compressed group of whole frames.
+    #[derive(Debug, Clone, Copy)]
+    pub(crate) struct Group {
+        pub(crate) c_offset: usize,
+        pub(crate) c_len: usize,
+        pub(crate) d_len: usize,
+        pub(crate) first_frame: usize,
+        pub(crate) num_frames: usize,
+    }
+
+    /// The groups of a zstd file written by [`GroupCompressor`].
+    #[derive(Debug, Clone)]
+    pub(crate) struct SeekTable {
+        pub(crate) groups: Vec<Group>,
+        pub(crate) num_frames: usize,
+    }
+
+    impl SeekTable {
+        /// Reads the trailers, or returns `None` for zstd data without
+        /// them (e.g. produced by the `zstd` tool).
+        pub(crate) fn read(bytes: &[u8]) -> Option<Self> {
+            let u32_at = |at: usize| -> Option<usize> {
+                Some(u32::from_le_bytes(bytes.get(at..at + 4)?.try_into().ok()?) as usize)
+            };
+            let footer = bytes.len().checked_sub(SEEK_TABLE_FOOTER_LEN)?;
+            if u32_at(footer + 5)? != SEEKABLE_MAGIC as usize {
+                return None;
+            }
+            let n = u32_at(footer)?;
+            let entry_len = if bytes[footer + 4] & 0x80 != 0 { 12 } else { 8 };
+            let table = footer.checked_sub(n.checked_mul(entry_len)?.checked_add(8)?)?;
+            if u32_at(table)? != SKIPPABLE_SEEK_TABLE_MAGIC as usize {
+                return None;
+            }
+            let mut groups = Vec::with_capacity(n);
+            let mut c_offset = 0;
+            for i in 0..n {
+                let at = table + 8 + i * entry_len;
+                let (c_len, d_len) = (u32_at(at)?, u32_at(at + 4)?);
+                groups.push(Group {
+                    c_offset,
+                    c_len,
+                    d_len,
+                    first_frame: 0,
+                    num_frames: 0,
+                });
+                c_offset += c_len;
+            }
+            // The frame counts sit between the last group and the table.
+            let counts = c_offset;
+            if u32_at(counts)? != SKIPPABLE_GROUPS_MAGIC as usize
+                || bytes.get(counts + 8..counts + 16)? != GROUPS_TAG
+                || counts + 16 + 4 * n != table
+            {
+                return None;
+            }
+            let mut num_frames = 0;
+            for (i, group) in groups.iter_mut().enumerate() {
+                group.first_frame = num_frames;
+                group.num_frames = u32_at(counts + 16 + 4 * i)?;
+                num_frames += group.num_frames;
+            }
+            Some(SeekTable { groups, num_frames })
+        }
+
+        /// Returns the index of the group holding trajectory frame `frame_no`.
+        pub(crate) fn group_of(&self, frame_no: usize) -> Option<usize> {
+            let i = self
+                .groups
+                .partition_point(|g| g.first_frame + g.num_frames <= frame_no);
+            (i < self.groups.len()).then_some(i)
+        }
+    }
+
+    fn utf8_text(bytes: Vec<u8>) -> Result<String, ParseError> {
+        String::from_utf8(bytes).map_err(|e| ParseError::InvalidUtf8 {
+            offset: e.utf8_error().valid_up_to(),
+        })
+    }
+
+    /// Decompresses one group to text.
+    ///
+    /// The group's sizes come from the file, so its decompressed size must
+    /// agree with the zstd frame header and the output buffer grows with
+    /// the data actually decoded rather than being sized up front.
+    pub(crate) fn decompress_group(bytes: &[u8], group: &Group) -> Result<String, ParseError> {
+        let mismatch = || ParseError::InvalidBinaryFormat("seek table disagrees with zstd frame".into());
+        let data = group
+            .c_offset
+            .checked_add(group.c_len)
+            .and_then(|end| bytes.get(group.c_offset..end))
+            .ok_or(ParseError::IncompleteFrame)?;
+        let d_len = group.d_len as u64;
+        if matches!(zstd::zstd_safe::get_frame_content_size(data), Ok(Some(n)) if n != d_len) {
+            return Err(mismatch());
+        }
+        let mut text = Vec::with_capacity(group.d_len.min(2 * DEFAULT_GROUP_BYTES));
+        zstd::stream::read::Decoder::with_buffer(data)?
+            .single_frame()
+            .take(d_len + 1)
+            .read_to_end(&mut text)?;
+        if text.len() != group.d_len {
+            return Err(mismatch());
+        }
+        utf8_text(text)
+    }
+
+    /// Decompresses a whole file to text.
+    pub(crate) fn decompress_all(bytes: &[u8], compression: Compression) -> Result<String, ParseError> {
+        let mut text = Vec::new();
+        match compression {
+            Compression::Zstd => {
+                zstd::stream::read::Decoder::new(bytes)?.read_to_end(&mut text)?;
+            }
+            Compression::Gzip => {
+                flate2::read::MultiGzDecoder::new(bytes).read_to_end(&mut text)?;
+            }
+            Compression::None => text.extend_from_slice(bytes),
+        }
+        utf8_text(text)
+    }
+
+    /// Opens a decompressing stream over `reader`.
+    pub(crate) fn decoder<'a, R: BufRead + 'a>(
+        reader: R,
+        compression: Compression,
+    ) -> io::Result<Box<dyn BufRead + 'a>> {
+        Ok(match compression {
+            Compression::Zstd => Box::new(BufReader::new(zstd::stream::read::Decoder::with_buffer(
+                reader,
+            )?)),
+            Compression::Gzip => Box::new(BufReader::new(flate2::bufread::MultiGzDecoder::new(reader))),
+            Compression::None => Box::new(reader),
+        })
+    }
+
+    #[cfg(test)]
+    mod tests {
+        use super::*;
+
+        fn compress(compression: Compression, frames: &[&[u8]]) -> Vec<u8> {
+            let mut out = Vec::new();
+            let mut c = GroupCompressor::new(compression);
+            for (i, f) in frames.iter().enumerate() {
+                c.push_frame(&mut out, f).unwrap();
+                if i % 2 == 1 {
+                    c.flush_group(&mut out).unwrap();
+                }
+            }
+            c.finish(&mut out).unwrap();
+            out
+        }
+
+        #[test]
+        fn test_zstd_groups_and_seek_table() {
+            let frames: [&[u8]; 5] = [b"a\n", b"bb\n", b"ccc\n", b"dddd\n", b"e\n"];
+            let bytes = compress(Compression::Zstd, &frames);
+            let table = SeekTable::read(&bytes).unwrap();
+            assert_eq!(table.num_frames, 5);
+            assert_eq!(table.groups.len(), 3);
+            assert_eq!(table.group_of(3), Some(1));
+            assert_eq!(table.group_of(4), Some(2));
+            assert_eq!(table.group_of(5), None);
+            assert_eq!(decompress_group(&bytes, &table.groups[1]).unwrap(), "ccc\ndddd\n");
+            // The trailers are skippable frames for a plain decoder.
+            assert_eq!(
+                decompress_all(&bytes, Compression::Zstd).unwrap(),
+                "a\nbb\nccc\ndddd\ne\n"
+            );
+        }
+
+        #[test]
+        fn test_group_sizes_must_match_the_data() {
+            let bytes = compress(Compression::Zstd, &[b"a\n", b"bb\n"]);
+            let table = SeekTable::read(&bytes).unwrap();
+            for d_len in [0, 4, u32::MAX as usize] {
+                let group = Group { d_len, ..table.groups[0] };
+                assert!(matches!(
+                    decompress_group(&bytes, &group),
+                    Err(ParseError::InvalidBinaryFormat(_))
+                ));
+            }
+            let group = Group { c_len: usize::MAX, ..table.groups[0] };
+            assert!(decompress_group(&bytes, &group).is_err());
+        }
+
+        #[test]
+        fn test_gzip_members_concatenate() {
+            let bytes = compress(Compression::Gzip, &[b"a\n", b"b\n", b"c\n"]);
+            assert!(SeekTable::read(&bytes).is_none());
+            assert_eq!(decompress_all(&bytes, Compression::Gzip).unwrap(), "a\nb\nc\n");
+            let mut text = String::new();
+            decoder(&bytes[..], Compression::Gzip)
+                .unwrap()
+                .read_to_string(&mut text)
+                .unwrap();
+            assert_eq!(text, "a\nb\nc\n");
+        }
+    }
+}
@@ -0,0 +1,743 @@
+//=============================================================================
+// .conb - binary companion format
+//=============================================================================
+//
+// Layout (all integers and floats little-endian, every record 8-aligned):
+//
+//   file header   magic "RCONBIN2" (or "RCONBIN1", read only)
+//   frame record  u64 natm_types (T), u64 num_atoms (N), u64 flags
+//                 f64 boxl[3], f64 angles[3]
+//                 u64 keyframe_offset                 (flags & SHARED_TOPOLOGY)
+//                 u64 natms_per_type[T], f64 masses[T] (topology)
+//                 f64 x[N], f64 y[N], f64 z[N]
+//                 u64 atom_id[N]                      (topology)
+//                 f64 vx[N], f64 vy[N], f64 vz[N]     (flags & HAS_VELOCITIES)
+//                 u8 is_fixed[N]                      (topology)
+//                 u32 len + bytes: prebox[0..2], postbox[0..2],
+//                                  symbol[T]          (topology)
+//                 zero padding to a multiple of 8
+//   ...
+//   offset table  u64 offset[F]
+//   footer        u64 F, u64 table_offset, magic "RCONBEND"
+//
+// Numeric columns come first, so every f64/u64 array starts 8-aligned
+// relative to the file; in a page-aligned memory map they can be viewed in
+// place.
+//
+// A keyframe record stores the fields marked (topology). A record whose
+// counts, masses, ids, flags and symbols equal those of the last keyframe
+// sets SHARED_TOPOLOGY instead and points at that keyframe, which always
+// precedes it; every record is still one lookup away from its full data.
+
+use crate::error::ParseError;
+use crate::index::{FrameEntry, FrameIndex};
+use crate::trajectory::Topology;
+use crate::types::{AtomDatum, ConFrame, FrameHeader};
+use std::borrow::Cow;
+use std::fs::File;
+use std::io::{self, BufWriter, Write};
+use std::path::Path;
+use std::sync::Arc;
+
+/// Magic bytes at the start of every `.conb` file, including a format version.
+pub const CONB_MAGIC: &[u8; 8] = b"RCONBIN2";
+/// Magic of version 1 files, which have no shared-topology records.
+const CONB_MAGIC_V1: &[u8; 8] = b"RCONBIN1";
+/// Magic bytes closing the footer.
+const FOOTER_MAGIC: &[u8; 8] = b"RCONBEND";
+/// Footer size: frame count, table offset and magic.
+const FOOTER_LEN: usize = 24;
+/// Fixed part of a frame record: counts, flags, box and angles.
+const RECORD_FIXED_LEN: usize = 3 * 8 + 6 * 8;
+const HAS_VELOCITIES: u64 = 1;
+const SHARED_TOPOLOGY: u64 = 2;
+
+/// Returns `true` if `bytes` start with a `.conb` magic of any version.
+pub fn is_conb(bytes: &[u8]) -> bool {
+    bytes.starts_with(CONB_MAGIC) || bytes.starts_with(CONB_MAGIC_V1)
+}
+
+fn invalid(msg: &str) -> ParseError {
+    ParseError::InvalidBinaryFormat(msg.to_string())
+}
+
+fn padding(len: usize) -> usize {
+    (8 - len % 8) % 8
+}
+
+//=============================================================================
+// Writer
+//=============================================================================
+
+/// Writes frames in the `.conb` format to any output stream.
+///
+/// Frames are streamed as they arrive; the offset table is written by
+/// [`ConbWriter::finish`], which must be called for the file to be readable.
+/// A frame with the same [`Topology`] as the last fully stored one (its
+/// keyframe) is written as a shared-topology record holding only the cell,
+/// header lines, positions and velocities.
+///
+/// # Example
+/// ```no_run
+/// # use readcon_core::conb::ConbWriter;
+/// # use readcon_core::types::ConFrame;
+/// # let frames: Vec<ConFrame> = Vec::new();
+/// let mut writer = ConbWriter::from_path("traj.conb").unwrap();
+/// writer.extend(frames.iter()).unwrap();
+/// writer.finish().unwrap();
+/// ```
+pub struct ConbWriter<W: Write> {
+    writer: BufWriter<W>,
+    offsets: Vec<u64>,
+    pos: u64,
+    buf: Vec<u8>,
+    /// Offset and topology of the last keyframe record.
+    keyframe: Option<(u64, Topology)>,
+}
+
+impl<W: Write> ConbWriter<W> {
+    /// Wraps `writer` and emits the file header.
+    pub fn new(writer: W) -> io::Result<Self> {
+        let mut writer = BufWriter::new(writer);
+        writer.write_all(CONB_MAGIC)?;
+        Ok(Self {
+            writer,
+            offsets: Vec::new(),
+            pos: CONB_MAGIC.len() as u64,
+            buf: Vec::new(),
+            keyframe: None,
+        })
+    }
+
+    /// Appends one frame record.
+    pub fn write_frame(&mut self, frame: &ConFrame) -> io::Result<()> {
+        self.buf.clear();
+        match &self.keyframe {
+            Some((offset, topology)) if topology.matches(frame) => {
+                encode_frame(&mut self.buf, frame, Some(*offset))
+            }
+            _ => {
+                encode_frame(&mut self.buf, frame, None);
+                self.keyframe = Some((self.pos, Topology::of(frame)));
+            }
+        }
+        self.writer.write_all(&self.buf)?;
+        self.offsets.push(self.pos);
+        self.pos += self.buf.len() as u64;
+        Ok(())
+    }
+
+    /// Appends all frames from an iterator.
+    pub fn extend<'a>(&mut self, frames: impl Iterator<Item = &'a ConFrame>) -> io::Result<()> {
+        for frame in frames {
+            self.write_frame(frame)?;
+        }
+        Ok(())
+    }
+
+    /// Writes the offset table and footer, flushes, and returns the inner
+    /// writer.
+    pub fn finish(mut self) -> io::Result<W> {
+        let table_offset = self.pos;
+        for offset in &self.offsets {
+            self.writer.write_all(&offset.to_le_bytes())?;
+        }
+        self.writer
+            .write_all(&(self.offsets.len() as u64).to_le_bytes())?;
+        self.writer.write_all(&table_offset.to_le_bytes())?;
+        self.writer.write_all(FOOTER_MAGIC)?;
+        self.writer.into_inner().map_err(|e| e.into_error())
+    }
+}
+
+impl ConbWriter<File> {
+    /// Creates (truncating) a `.conb` file at `path`.
+    pub fn from_path<P: AsRef<Path>>(path: P) -> io::Result<Self> {
+        Self::new(File::create(path)?)
+    }
+}
+
+fn push_u64(buf: &mut Vec<u8>, v: u64) {
+    buf.extend_from_slice(&v.to_le_bytes());
+}
+
+fn push_f64(buf: &mut Vec<u8>, v: f64) {
+    buf.extend_from_slice(&v.to_le_bytes());
+}
+
+fn push_str(buf: &mut Vec<u8>, s: &str) {
+    buf.extend_from_slice(&(s.len() as u32).to_le_bytes());
+    buf.extend_from_slice(s.as_bytes());
+}
+
+/// Appends the record for `frame`. Velocities are stored when
+/// `frame.has_velocities()`, with missing components as 0.0, exactly as
+/// `ConFrameWriter` would print them. With a `keyframe` offset the topology
+/// fields are left out and the record refers to that keyframe instead.
+fn encode_frame(buf: &mut Vec<u8>, frame: &ConFrame, keyframe: Option<u64>) {
+    let header = &frame.header;
+    let atoms = &frame.atom_data;
+    let has_velocities = frame.has_velocities();
+    let mut flags = if has_velocities { HAS_VELOCITIES } else { 0 };
+    if keyframe.is_some() {
+        flags |= SHARED_TOPOLOGY;
+    }
+    push_u64(buf, header.natms_per_type.len() as u64);
+    push_u64(buf, atoms.len() as u64);
+    push_u64(buf, flags);
+    header.boxl.iter().for_each(|&v| push_f64(buf, v));
+    header.angles.iter().for_each(|&v| push_f64(buf, v));
+    if let Some(offset) = keyframe {
+        push_u64(buf, offset);
+    } else {
+        header
+            .natms_per_type
+            .iter()
+            .for_each(|&n| push_u64(buf, n as u64));
+        for i in 0..header.natms_per_type.len() {
+            push_f64(buf, header.masses_per_type.get(i).copied().unwrap_or(0.0));
+        }
+    }
+    atoms.iter().for_each(|a| push_f64(buf, a.x));
+    atoms.iter().for_each(|a| push_f64(buf, a.y));
+    atoms.iter().for_each(|a| push_f64(buf, a.z));
+    if keyframe.is_none() {
+        atoms.iter().for_each(|a| push_u64(buf, a.atom_id));
+    }
+    if has_velocities {
+        atoms.iter().for_each(|a| push_f64(buf, a.vx.unwrap_or(0.0)));
+        atoms.iter().for_each(|a| push_f64(buf, a.vy.unwrap_or(0.0)));
+        atoms.iter().for_each(|a| push_f64(buf, a.vz.unwrap_or(0.0)));
+    }
+    if keyframe.is_none() {
+        buf.extend(atoms.iter().map(|a| a.is_fixed as u8));
+    }
+    for line in header.prebox_header.iter().chain(&header.postbox_header) {
+        push_str(buf, line);
+    }
+    if keyframe.is_none() {
+        let mut first = 0;
+        for &count in &header.natms_per_type {
+            push_str(buf, atoms.get(first).map_or("", |a| a.symbol.as_str()));
+            first += count;
+        }
+    }
+    buf.resize(buf.len() + padding(buf.len()), 0);
+}
+
+//=============================================================================
+// Reader
+//=============================================================================
+
+/// Bounds-checked little-endian reads over a byte slice.
+struct Cursor<'a> {
+    bytes: &'a [u8],
+    pos: usize,
+}
+
+impl<'a> Cursor<'a> {
+    fn take(&mut self, len: usize) -> Result<&'a [u8], ParseError> {
+        let end = self
+            .pos
+            .checked_add(len)
+            .filter(|&end| end <= self.bytes.len())
+            .ok_or_else(|| invalid("truncated frame record"))?;
+        let slice = &self.bytes[self.pos..end];
+        self.pos = end;
+        Ok(slice)
+    }
+
+    fn u64(&mut self) -> Result<u64, ParseError> {
+        Ok(u64::from_le_bytes(self.take(8)?.try_into().unwrap()))
+    }
+
+    fn count(&mut self) -> Result<usize, ParseError> {
+        usize::try_from(self.u64()?).map_err(|_| invalid("count does not fit in memory"))
+    }
+
+    fn f64(&mut self) -> Result<f64, ParseError> {
+        Ok(f64::from_le_bytes(self.take(8)?.try_into().unwrap()))
+    }
+
+    fn array(&mut self, n: usize) -> Result<&'a [u8], ParseError> {
+        let len = n.checked_mul(8).ok_or_else(|| invalid("array too large"))?;
+        self.take(len)
+    }
+
+    fn str(&mut self) -> Result<&'a str, ParseError> {
+        let start = self.pos;
+        let len = u32::from_le_bytes(self.take(4)?.try_into().unwrap());
+        let len = usize::try_from(len).map_err(|_| invalid("string too long"))?;
+        std::str::from_utf8(self.take(len)?).map_err(|e| ParseError::InvalidUtf8 {
+            offset: start + 4 + e.valid_up_to(),
+        })
+    }
+}
+
+/// A little-endian `f64` column, borrowed in place when the host is
+/// little-endian and the bytes are 8-aligned, decoded otherwise.
+fn f64_column(bytes: &[u8]) -> Cow<'_, [f64]> {
+    #[cfg(target_endian = "little")]
+    {
+        // SAFETY: every bit pattern is a valid f64, and align_to only hands
+        // out the correctly aligned middle part.
+        let (head, mid, tail) = unsafe { bytes.align_to::<f64>() };
+        if head.is_empty() && tail.is_empty() {
+            return Cow::Borrowed(mid);
+        }
+    }
+    Cow::Owned(
+        bytes
+            .chunks_exact(8)
+            .map(|c| f64::from_le_bytes(c.try_into().unwrap()))
+            .collect(),
+    )
+}
+
+fn u64_column(bytes: &[u8]) -> Cow<'_, [u64]> {
+    #[cfg(target_endian = "little")]
+    {
+        // SAFETY: as for f64_column.
+        let (head, mid, tail) = unsafe { bytes.align_to::<u64>() };
+        if head.is_empty() && tail.is_empty() {
+            return Cow::Borrowed(mid);
+        }
+    }
+    Cow::Owned(
+        bytes
+            .chunks_exact(8)
+            .map(|c| u64::from_le_bytes(c.try_into().unwrap()))
+            .collect(),
+    )
+}
+
+/// A frame record borrowed from `.conb` bytes.
+///
+/// The columns are views into the record when possible (see
+/// [`ConbFrameView::x`]); building a [`ConFrame`] is only needed for APIs
+/// that take one.
+#[derive(Debug, Clone)]
+pub struct ConbFrameView<'a> {
+    pub prebox_header: [&'a str; 2],
+    pub postbox_header: [&'a str; 2],
+    pub boxl: [f64; 3],
+    pub angles: [f64; 3],
+    /// One symbol per atom type.
+    pub symbols: Vec<&'a str>,
+    natms_per_type: &'a [u8],
+    masses: &'a [u8],
+    x: &'a [u8],
+    y: &'a [u8],
+    z: &'a [u8],
+    atom_id: &'a [u8],
+    velocities: Option<[&'a [u8]; 3]>,
+    /// One byte per atom, 0 or 1.
+    pub is_fixed: &'a [u8],
+}
+
+impl<'a> ConbFrameView<'a> {
+    /// Returns the total number of atoms.
+    pub fn num_atoms(&self) -> usize {
+        self.is_fixed.len()
+    }
+
+    /// Returns `true` if the record carries a velocity block.
+    pub fn has_velocities(&self) -> bool {
+        self.velocities.is_some()
+    }
+
+    /// Atom counts per type.
+    pub fn natms_per_type(&self) -> Cow<'a, [u64]> {
+        u64_column(self.natms_per_type)
+    }
+
+    /// Masses per type.
+    pub fn masses_per_type(&self) -> Cow<'a, [f64]> {
+        f64_column(self.masses)
+    }
+
+    /// The x coordinates. Borrowed without copying on little-endian hosts
+    /// when the underlying bytes are 8-aligned (always the case for a
+    /// memory-mapped file).
+    pub fn x(&self) -> Cow<'a, [f64]> {
+        f64_column(self.x)
+    }
+
+    /// The y coordinates; see [`ConbFrameView::x`].
+    pub fn y(&self) -> Cow<'a, [f64]> {
+        f64_column(self.y)
+    }
+
+    /// The z coordinates; see [`ConbFrameView::x`].
+    pub fn z(&self) -> Cow<'a, [f64]> {
+        f64_column(self.z)
+    }
+
+    /// The atom ids; see [`ConbFrameView::x`].
+    pub fn atom_ids(&self) -> Cow<'a, [u64]> {
+        u64_column(self.atom_id)
+    }
+
+    /// The velocity columns, if present; see [`ConbFrameView::x`].
+    pub fn velocities(&self) -> Option<[Cow<'a, [f64]>; 3]> {
+        self.velocities
+            .map(|[vx, vy, vz]| [f64_column(vx), f64_column(vy), f64_column(vz)])
+    }
+
+    /// Builds the equivalent [`ConFrame`].
+    pub fn to_frame(&self) -> Result<ConFrame, ParseError> {
+        let natms_per_type = self
+            .natms_per_type()
+            .iter()
+            .map(|&n| usize::try_from(n).map_err(|_| invalid("count does not fit in memory")))
+            .collect::<Result<Vec<usize>, _>>()?;
+        let total = natms_per_type
+            .iter()
+            .try_fold(0usize, |total, &n| total.checked_add(n));
+        if total != Some(self.num_atoms()) {
+            return Err(invalid("per-type atom counts do not match the atom total"));
+        }
+        let (x, y, z, ids) = (self.x(), self.y(), self.z(), self.atom_ids());
+        let velocities = self.velocities();
+        let mut atom_data = Vec::with_capacity(self.num_atoms());
+        for (&count, symbol) in natms_per_type.iter().zip(&self.symbols) {
+            let symbol = Arc::new(symbol.to_string());
+            for i in atom_data.len()..atom_data.len() + count {
+                let v = velocities.as_ref().map(|[vx, vy, vz]| (vx[i], vy[i], vz[i]));
+                atom_data.push(AtomDatum {
+                    symbol: Arc::clone(&symbol),
+                    x: x[i],
+                    y: y[i],
+                    z: z[i],
+                    is_fixed: self.is_fixed[i] != 0,
+                    atom_id: ids[i],
+                    vx: v.map(|v| v.0),
+                    vy: v.map(|v| v.1),
+                    vz: v.map(|v| v.2),
+                });
+            }
+        }
+        Ok(ConFrame {
+            header: FrameHeader {
+                prebox_header: self.prebox_header.map(str::to_string),
+                boxl: self.boxl,
+                angles: self.angles,
+                postbox_header: self.postbox_header.map(str::to_string),
+                natm_types: natms_per_type.len(),
+                natms_per_type,
+                masses_per_type: self.masses_per_type().into_owned(),
+            },
+            atom_data,
+        })
+    }
+}
+
+/// Decodes the frame record starting at `offset`, returning it together with
+/// the offset just past the record. A shared-topology record borrows its
+/// topology fields from its keyframe.
+pub(crate) fn view_frame_at(
+    bytes: &[u8],
+    offset: usize,
+) -> Result<(ConbFrameView<'_>, usize), ParseError> {
+    view_record_at(bytes, offset, true)
+}
+
+fn view_record_at(
+    bytes: &[u8],
+    offset: usize,
+    allow_shared: bool,
+) -> Result<(ConbFrameView<'_>, usize), ParseError> {
+    if offset % 8 != 0 || offset > bytes.len() {
+        return Err(invalid("misaligned frame offset"));
+    }
+    let mut c = Cursor { bytes, pos: offset };
+    let natm_types = c.count()?;
+    let num_atoms = c.count()?;
+    let flags = c.u64()?;
+    let boxl = [c.f64()?, c.f64()?, c.f64()?];
+    let angles = [c.f64()?, c.f64()?, c.f64()?];
+    let keyframe = if flags & SHARED_TOPOLOGY != 0 {
+        let key_offset = c.count()?;
+        if !allow_shared || key_offset >= offset {
+            return Err(invalid("shared topology does not point to an earlier keyframe"));
+        }
+        let (key, _) = view_record_at(bytes, key_offset, false)?;
+        if natm_types.checked_mul(8) != Some(key.natms_per_type.len())
+            || key.num_atoms() != num_atoms
+        {
+            return Err(invalid("keyframe counts do not match the record"));
+        }
+        Some(key)
+    } else {
+        None
+    };
+    let (natms_per_type, masses) = match &keyframe {
+        Some(key) => (key.natms_per_type, key.masses),
+        None => (c.array(natm_types)?, c.array(natm_types)?),
+    };
+    let x = c.array(num_atoms)?;
+    let y = c.array(num_atoms)?;
+    let z = c.array(num_atoms)?;
+    let atom_id = match &keyframe {
+        Some(key) => key.atom_id,
+        None => c.array(num_atoms)?,
+    };
+    let velocities = if flags & HAS_VELOCITIES != 0 {
+        Some([c.array(num_atoms)?, c.array(num_atoms)?, c.array(num_atoms)?])
+    } else {
+        None
+    };
+    let is_fixed = match &keyframe {
+        Some(key) => key.is_fixed,
+        None => c.take(num_atoms)?,
+    };
+    let prebox_header = [c.str()?, c.str()?];
+    let postbox_header = [c.str()?, c.str()?];
+    let symbols = match keyframe {
+        Some(key) => key.symbols,
+        None => (0..natm_types).map(|_| c.str()).collect::<Result<_, _>>()?,
+    };
+    let end = c.pos + padding(c.pos - offset);
+    Ok((
+        ConbFrameView {
+            prebox_header,
+            postbox_header,
+            boxl,
+            angles,
+            symbols,
+            natms_per_type,
+            masses,
+            x,
+            y,
+            z,
+            atom_id,
+            velocities,
+            is_fixed,
+        },
+        end,
+    ))
+}
+
+/// Decodes the frame record starting at `offset` into a [`ConFrame`].
+pub(crate) fn decode_frame_at(bytes: &[u8], offset: usize) -> Result<(ConFrame, usize), ParseError> {
+    let (view, end) = view_frame_at(bytes, offset)?;
+    Ok((view.to_frame()?, end))
+}
+
+/// Random access to the frames of `.conb` bytes (typically a memory map).
+///
+/// Opening reads only the footer and offset table; each frame is decoded on
+/// demand.
+pub struct ConbReader<'a> {
+    bytes: &'a [u8],
+    entries: Vec<FrameEntry>,
+    table_offset: usize,
+}
+
+impl<'a> ConbReader<'a> {
+    /// Validates the header and footer and loads the offset table.
+    pub fn new(bytes: &'a [u8]) -> Result<Self, ParseError> {
+        if !is_conb(bytes) {
+            return Err(invalid("missing RCONBIN header"));
+        }
+        if bytes.len() < CONB_MAGIC.len() + FOOTER_LEN
+            || &bytes[bytes.len() - 8..] != FOOTER_MAGIC
+        {
+            return Err(invalid("missing footer; was the writer finished?"));
+        }
+        let footer = bytes.len() - FOOTER_LEN;
+        let usize_at = |at: usize| {
+            let value = u64::from_le_bytes(bytes[at..at + 8].try_into().unwrap());
+            usize::try_from(value).map_err(|_| invalid("offset does not fit in memory"))
+        };
+        let num_frames = usize_at(footer)?;
+        let table_offset = usize_at(footer + 8)?;
+        if num_frames.checked_mul(8).and_then(|l| l.checked_add(table_offset)) != Some(footer) {
+            return Err(invalid("offset table does not match the footer"));
+        }
+        // The table ends at `footer`, so `table_offset + i * 8` cannot overflow.
+        let entries = (0..num_frames)
+            .map(|i| {
+                let offset = usize_at(table_offset + i * 8)?;
+                let in_bounds = offset >= CONB_MAGIC.len()
+                    && offset
+                        .checked_add(RECORD_FIXED_LEN)
+                        .is_some_and(|end| end <= table_offset);
+                if !in_bounds {
+                    return Err(invalid("frame offset outside the record area"));
+                }
+                let num_atoms = usize_at(offset + 8)?;
+                Ok(FrameEntry { offset, num_atoms })
+            })
+            .collect::<Result<Vec<_>, ParseError>>()?;
+        Ok(ConbReader {
+            bytes,
+            entries,
+            table_offset,
+        })
+    }
+
+    /// Returns the number of frames.
+    pub fn len(&self) -> usize {
+        self.entries.len()
+    }
+
+    /// Returns `true` if the file holds no frames.
+    pub fn is_empty(&self) -> bool {
+        self.entries.is_empty()
+    }
+
+    /// Borrows frame `frame_no` without building a [`ConFrame`].
+    pub fn view(&self, frame_no: usize) -> Result<ConbFrameView<'a>, ParseError> {
+        let offset = self.offset(frame_no)?;
+        Ok(view_frame_at(&self.bytes[..self.table_offset], offset)?.0)
+    }
+
+    /// Decodes frame `frame_no`.
+    pub fn frame(&self, frame_no: usize) -> Result<ConFrame, ParseError> {
+        self.view(frame_no)?.to_frame()
+    }
+
+    /// Decodes every frame in order.
+    pub fn frames(&self) -> impl Iterator<Item = Result<ConFrame, ParseError>> + '_ {
+        (0..self.len()).map(|i| self.frame(i))
+    }
+
+    /// Builds a [`FrameIndex`] from the offset table, so that the usual
+    /// `seek()`/`len()` machinery works on binary files.
+    pub fn frame_index(&self) -> FrameIndex {
+        FrameIndex::from_entries(self.entries.clone(), self.table_offset)
+    }
+
+    fn offset(&self, frame_no: usize) -> Result<usize, ParseError> {
+        self.entries
+            .get(frame_no)
+            .map(|entry| entry.offset)
+            .ok_or(ParseError::FrameOutOfRange {
+                requested: frame_no,
+                available: self.len(),
+            })
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::iterators::ConFrameIterator;
+
+    const CONVEL: &str = "\
+p1
+p2
+10 10 10
+90 90 90
+q1
+q2
+2
+1 1
+63.546 1.008
+Cu
+Coordinates of Component 1
+0.1 0.2 0.3 1 0
+H
+Coordinates of Component 2
+1.1 1.2 1.3 0 1
+
+Cu
+Velocities of Component 1
+0.01 0.02 0.03 1 0
+H
+Velocities of Component 2
+0.11 0.12 0.13 0 1
+";
+
+    #[test]
+    fn test_roundtrip_is_lossless() {
+        let mut frames: Vec<ConFrame> = ConFrameIterator::new(CONVEL).map(|r| r.unwrap()).collect();
+        let mut plain = frames[0].clone();
+        for atom in &mut plain.atom_data {
+            atom.vx = None;
+            atom.vy = None;
+            atom.vz = None;
+            atom.x = -0.0;
+        }
+        frames.push(plain);
+
+        let mut writer = ConbWriter::new(Vec::new()).unwrap();
+        writer.extend(frames.iter()).unwrap();
+        let bytes = writer.finish().unwrap();
+
+        let reader = ConbReader::new(&bytes).unwrap();
+        assert_eq!(reader.len(), 2);
+        let decoded: Vec<ConFrame> = reader.frames().map(|r| r.unwrap()).collect();
+        assert_eq!(decoded, frames);
+        assert_eq!(decoded[1].atom_data[0].x.to_bits(), (-0.0f64).to_bits());
+        assert_eq!(reader.frame_index().get(1).unwrap().num_atoms, 2);
+    }
+
+    #[test]
+    fn test_matching_frames_share_keyframe_topology() {
+        let first: ConFrame = ConFrameIterator::new(CONVEL).next().unwrap().unwrap();
+        let mut moved = first.clone();
+        moved.atom_data[1].x = 2.5;
+        moved.header.prebox_header[1] = "t=1".to_string();
+        let mut refixed = moved.clone();
+        refixed.atom_data[1].is_fixed = true;
+        let frames = vec![first.clone(), moved, refixed, first];
+
+        let mut writer = ConbWriter::new(Vec::new()).unwrap();
+        writer.extend(frames.iter()).unwrap();
+        let mut bytes = writer.finish().unwrap();
+
+        let reader = ConbReader::new(&bytes).unwrap();
+        let decoded: Vec<ConFrame> = reader.frames().map(|r| r.unwrap()).collect();
+        assert_eq!(decoded, frames);
+        let index = reader.frame_index();
+        let record_len = |i: usize| index.get(i + 1).unwrap().offset - index.get(i).unwrap().offset;
+        assert!(record_len(1) < record_len(0));
+        assert_eq!(record_len(2), record_len(0));
+        assert_eq!(record_len(0), index.end() - index.get(3).unwrap().offset);
+        assert_eq!(*reader.view(1).unwrap().atom_ids(), [0, 1]);
+
+        // Files without shared records are still read under the old magic.
+        bytes[..8].copy_from_slice(CONB_MAGIC_V1);
+        assert_eq!(ConbReader::new(&bytes).unwrap().frame(0).unwrap(), frames[0]);
+    }
+
+    #[test]
+    fn test_truncated_file_is_rejected() {
+        let frames: Vec<ConFrame> = ConFrameIterator::new(CONVEL).map(|r| r.unwrap()).collect();
+        let mut writer = ConbWriter::new(Vec::new()).unwrap();
+        writer.extend(frames.iter()).unwrap();
+        let bytes = writer.finish().unwrap();
+        assert!(ConbReader::new(&bytes[..bytes.len() - 1]).is_err());
+        assert!(ConbReader::new(&bytes[..40]).is_err());
+    }
+
+    #[test]
+    fn test_overflowing_counts_and_offsets_are_rejected() {
+        let frames: Vec<ConFrame> = ConFrameIterator::new(CONVEL).map(|r| r.unwrap()).collect();
+        let mut writer = ConbWriter::new(Vec::new()).unwrap();
+        writer.extend(frames.iter()).unwrap();
+        let bytes = writer.finish().unwrap();
+
+        // Per-type counts that wrap around to the atom total.
+        let mut counts = bytes.clone();
+        let natms_per_type = CONB_MAGIC.len() + RECORD_FIXED_LEN;
+        counts[natms_per_type..natms_per_type + 8].copy_from_slice(&u64::MAX.to_le_bytes());
+        counts[natms_per_type + 8..natms_per_type + 16].copy_from_slice(&3u64.to_le_bytes());
+        assert!(matches!(
+            ConbReader::new(&counts).unwrap().frame(0),
+            Err(ParseError::InvalidBinaryFormat(_))
+        ));
+
+        // A table entry pointing just below the end of the address space.
+        let mut offsets = bytes.clone();
+        let footer = offsets.len() - FOOTER_LEN;
+        let table = u64::from_le_bytes(offsets[footer + 8..footer + 16].try_into().unwrap()) as usize;
+        offsets[table..table + 8].copy_from_slice(&(u64::MAX - 7).to_le_bytes());
+        assert!(matches!(
+            ConbReader::new(&offsets),
+            Err(ParseError::InvalidBinaryFormat(_))
+        ));
+    }
+}
@@ -1,4 +1,5 @@
 use std::fmt;
+use std::io;
 use std::num::{ParseFloatError, ParseIntError};
 
 #[derive(Debug)]
@@ -8,6 +9,10 @@ pub enum ParseError {
     IncompleteVelocitySection,
     InvalidVectorLength { expected: usize, found: usize },
     InvalidNumberFormat(String),
+    FrameOutOfRange { requested: usize, available: usize },
+    InvalidUtf8 { offset: usize },
+    InvalidBinaryFormat(String),
+    Io(io::Error),
 }
 
 impl fmt::Display for ParseError {
@@ -28,11 +33,31 @@ impl fmt::Display for ParseError {
             ParseError::InvalidNumberFormat(msg) => {
                 write!(f, "invalid number format: {msg}")
             }
+            ParseError::FrameOutOfRange {
+                requested,
+                available,
+            } => {
+                write!(f, "frame {requested} out of range, file has {available} frames")
+            }
+            ParseError::InvalidUtf8 { offset } => {
+                write!(f, "invalid UTF-8 at byte offset {offset}")
+            }
+            ParseError::InvalidBinaryFormat(msg) => {
+                write!(f, "invalid .conb data: {msg}")
+            }
+            ParseError::Io(e) => write!(f, "read failed: {e}"),
         }
     }
 }
 
-impl std::error::Error for ParseError {}
+impl std::error::Error for ParseError {
+    fn source(&self) -> Option<&(dyn std::error::Error + 'static)> {
+        match self {
+            ParseError::Io(e) => Some(e),
+            _ => None,
+        }
+    }
+}
 
 impl From<ParseFloatError> for ParseError {
     fn from(e: ParseFloatError) -> Self {
@@ -45,3 +70,9 @@ impl From<ParseIntError> for ParseError {
         ParseError::InvalidNumberFormat(e.to_string())
     }
 }
+
+impl From<io::Error> for ParseError {
+    fn from(e: io::Error) -> Self {
+        ParseError::Io(e)
+    }
+}
@@ -1,11 +1,16 @@
-use crate::helpers::symbol_to_atomic_number;
-use crate::iterators::{self, ConFrameIterator};
-use crate::types::{ConFrame, ConFrameBuilder};
+use crate::iterators::{self, ConFrameFileIterator, ConFrameStreamReader};
+use crate::parser::ParseOptions;
+use crate::stats::{self, Stage};
+use crate::trajectory::{read_trajectory, Trajectory, TrajectoryFrame};
+use crate::types::{AtomColumns, ComponentRun, ConFrame, ConFrameBuilder, FrameView, PerTypeVec};
 use crate::writer::ConFrameWriter;
-use std::ffi::{c_char, CStr, CString};
-use std::fs::{self, File};
+use std::ffi::{c_char, c_void, CStr, CString};
+use std::fs::File;
+use std::io::{self, BufReader, Read};
+use std::ops::ControlFlow;
 use std::path::Path;
 use std::ptr;
+use std::sync::OnceLock;
 
 //=============================================================================
 // C-Compatible Structs & Handles
@@ -52,10 +57,88 @@ pub struct CAtom {
     pub has_velocity: bool,
 }
 
+/// One component's run of atoms, as returned by `rkr_frame_get_components`.
+/// Atoms `offset .. offset + count` of the frame (and of its columns) all
+/// have this atomic number (0 if the symbol is unknown) and mass.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct CComponent {
+    pub atomic_number: u64,
+    pub mass: f64,
+    pub offset: usize,
+    pub count: usize,
+}
+
+impl From<ComponentRun> for CComponent {
+    fn from(run: ComponentRun) -> Self {
+        CComponent {
+            atomic_number: run.atomic_number,
+            mass: run.mass,
+            offset: run.offset,
+            count: run.count,
+        }
+    }
+}
+
+/// The Rust object behind every `RKRConFrame` handle.
+///
+/// Besides the frame itself it holds a lazily built column (SoA) copy of the
+/// atom data and the per-component runs, so the accessors can return
+/// pointers that stay valid for exactly as long as the handle does.
+struct FrameHandle {
+    frame: ConFrame,
+    columns: OnceLock<AtomColumns>,
+    components: OnceLock<Vec<CComponent>>,
+}
+
+// Frame and trajectory handles are documented as shareable across threads.
+const _: fn() = || {
+    fn assert_send_sync<T: Send + Sync>() {}
+    assert_send_sync::<FrameHandle>();
+    assert_send_sync::<Trajectory>();
+};
+
+impl FrameHandle {
+    /// Moves a frame onto the heap and returns it as an opaque handle.
+    fn into_raw(frame: ConFrame) -> *mut RKRConFrame {
+        let handle = FrameHandle {
+            frame,
+            columns: OnceLock::new(),
+            components: OnceLock::new(),
+        };
+        Box::into_raw(Box::new(handle)) as *mut RKRConFrame
+    }
+
+    /// Mutably borrows the handle behind an opaque pointer, or `None` if it is null.
+    unsafe fn from_ptr_mut<'a>(frame_handle: *mut RKRConFrame) -> Option<&'a mut FrameHandle> {
+        unsafe { (frame_handle as *mut FrameHandle).as_mut() }
+    }
+
+    /// Borrows the handle behind an opaque pointer, or `None` if it is null.
+    unsafe fn from_ptr<'a>(frame_handle: *const RKRConFrame) -> Option<&'a FrameHandle> {
+        unsafe { (frame_handle as *const FrameHandle).as_ref() }
+    }
+
+    /// Returns the handle's SoA copy of the atoms, building it on first use.
+    fn columns(&self) -> &AtomColumns {
+        self.columns.get_or_init(|| self.frame.columns())
+    }
+
+    /// Returns the component runs, resolving their symbols on first use.
+    fn components(&self) -> &[CComponent] {
+        self.components
+            .get_or_init(|| self.frame.components().into_iter().map(CComponent::from).collect())
+    }
+}
+
+/// Borrows the `ConFrame` behind an opaque handle, or `None` if it is null.
+unsafe fn frame_ref<'a>(frame_handle: *const RKRConFrame) -> Option<&'a ConFrame> {
+    unsafe { FrameHandle::from_ptr(frame_handle) }.map(|h| &h.frame)
+}
+
 #[repr(C)]
 pub struct CConFrameIterator {
-    iterator: *mut ConFrameIterator<'static>,
-    file_contents: *mut String,
+    iterator: *mut ConFrameFileIterator,
 }
 
 //=============================================================================
@@ -63,31 +146,163 @@ pub struct CConFrameIterator {
 //=============================================================================
 
 /// Creates a new iterator for a .con file.
+/// Files of 64 KiB and above are memory-mapped rather than read into memory,
+/// and each frame is UTF-8 validated only when it is reached.
 /// The caller OWNS the returned pointer and MUST call `free_con_frame_iterator`.
 /// Returns NULL if there are no more frames or on error.
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn read_con_file_iterator(
     filename_c: *const c_char,
 ) -> *mut CConFrameIterator {
-    if filename_c.is_null() {
-        return ptr::null_mut();
+    match unsafe { open_con_file_iterator(filename_c) } {
+        Some(c_iterator) => c_iterator,
+        None => ptr::null_mut(),
     }
-    let filename = match unsafe { CStr::from_ptr(filename_c).to_str() } {
-        Ok(s) => s,
-        Err(_) => return ptr::null_mut(),
+}
+
+/// Creates a new iterator for a .con file with a ready-built frame index,
+/// so that `con_frame_iterator_seek` and `con_frame_iterator_len` are O(1).
+///
+/// If `persist_index` is true, the index is loaded from the `<file>.idx`
+/// sidecar when it matches the file's size and modification time, and is
+/// otherwise rebuilt and written back to the sidecar. Seekable `.con.zst`
+/// files need no index: their seek table already serves `seek` and `len`.
+/// The caller OWNS the returned pointer and MUST call `free_con_frame_iterator`.
+/// Returns NULL on error, including a malformed frame found while indexing.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn read_con_file_iterator_indexed(
+    filename_c: *const c_char,
+    persist_index: bool,
+) -> *mut CConFrameIterator {
+    let c_iterator = match unsafe { open_con_file_iterator(filename_c) } {
+        Some(c_iterator) => c_iterator,
+        None => return ptr::null_mut(),
     };
-    let file_contents_box = match fs::read_to_string(filename) {
-        Ok(contents) => Box::new(contents),
-        Err(_) => return ptr::null_mut(),
+    let iter = unsafe { &mut *(*c_iterator).iterator };
+    let indexed = if iter.is_seekable_compressed() {
+        true
+    } else if persist_index {
+        iter.load_or_build_index().is_ok()
+    } else {
+        iter.build_index().is_ok()
     };
-    let file_contents_ptr = Box::into_raw(file_contents_box);
-    let static_file_contents: &'static str = unsafe { &*file_contents_ptr };
-    let iterator = Box::new(ConFrameIterator::new(static_file_contents));
+    if indexed {
+        c_iterator
+    } else {
+        unsafe { free_con_frame_iterator(c_iterator) };
+        ptr::null_mut()
+    }
+}
+
+/// Opens a file and wraps it in a heap-allocated `CConFrameIterator`.
+unsafe fn open_con_file_iterator(filename_c: *const c_char) -> Option<*mut CConFrameIterator> {
+    if filename_c.is_null() {
+        return None;
+    }
+    let filename = unsafe { CStr::from_ptr(filename_c).to_str() }.ok()?;
+    let iterator = Box::new(ConFrameFileIterator::open(Path::new(filename)).ok()?);
     let c_iterator = Box::new(CConFrameIterator {
         iterator: Box::into_raw(iterator),
-        file_contents: file_contents_ptr,
     });
-    Box::into_raw(c_iterator)
+    Some(Box::into_raw(c_iterator))
+}
+
+/// Repositions the iterator so the next `con_frame_iterator_next` call returns
+/// frame `frame_no` (zero-based). Seeking to the frame count positions the
+/// iterator at the end. Builds the frame index on first use.
+/// Returns 0 on success, -1 on error or if `frame_no` is out of range.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn con_frame_iterator_seek(
+    iterator: *mut CConFrameIterator,
+    frame_no: usize,
+) -> i32 {
+    if iterator.is_null() {
+        return -1;
+    }
+    let iter = unsafe { &mut *(*iterator).iterator };
+    match iter.seek(frame_no) {
+        Ok(()) => 0,
+        Err(_) => -1,
+    }
+}
+
+/// Writes the total number of frames in the file to `num_frames`.
+/// Builds the frame index on first use.
+/// Returns 0 on success, -1 on error.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn con_frame_iterator_len(
+    iterator: *mut CConFrameIterator,
+    num_frames: *mut usize,
+) -> i32 {
+    if iterator.is_null() || num_frames.is_null() {
+        return -1;
+    }
+    let iter = unsafe { &mut *(*iterator).iterator };
+    match iter.len() {
+        Ok(n) => {
+            unsafe { *num_frames = n };
+            0
+        }
+        Err(_) => -1,
+    }
+}
+
+/// Selects which parts of each frame `con_frame_iterator_set_options`
+/// parses. Zero-initialised options parse everything.
+#[repr(C)]
+pub struct RKRParseOptions {
+    /// Parse only the frame headers; frames have no atoms.
+    pub header_only: bool,
+    /// Skip velocity sections; frames report no velocities.
+    pub skip_velocities: bool,
+    /// Symbols of the components to keep (NULL or none: keep all).
+    pub components: *const *const c_char,
+    pub num_components: usize,
+    /// If true, keep only atoms with `atom_id_min <= id < atom_id_max`.
+    pub filter_atom_ids: bool,
+    pub atom_id_min: u64,
+    pub atom_id_max: u64,
+}
+
+/// Sets the options used to parse subsequent frames. NULL `options`
+/// restores full parsing. Filtered frames describe only the kept atoms, so
+/// their per-type counts and masses may differ from the file's.
+/// Returns 0 on success, -1 on a NULL iterator or an invalid symbol string.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn con_frame_iterator_set_options(
+    iterator: *mut CConFrameIterator,
+    options: *const RKRParseOptions,
+) -> i32 {
+    if iterator.is_null() {
+        return -1;
+    }
+    let iter = unsafe { &mut *(*iterator).iterator };
+    let Some(options) = (unsafe { options.as_ref() }) else {
+        iter.set_options(ParseOptions::default());
+        return 0;
+    };
+    let mut components = Vec::with_capacity(options.num_components);
+    if !options.components.is_null() {
+        for i in 0..options.num_components {
+            let symbol = unsafe { *options.components.add(i) };
+            if symbol.is_null() {
+                return -1;
+            }
+            match unsafe { CStr::from_ptr(symbol) }.to_str() {
+                Ok(symbol) => components.push(symbol.to_string()),
+                Err(_) => return -1,
+            }
+        }
+    }
+    iter.set_options(ParseOptions {
+        header_only: options.header_only,
+        skip_velocities: options.skip_velocities,
+        components,
+        atom_ids: options
+            .filter_atom_ids
+            .then_some(options.atom_id_min..options.atom_id_max),
+    });
+    0
 }
 
 /// Reads the next frame from the iterator, returning an opaque handle.
@@ -101,16 +316,46 @@ pub unsafe extern "C" fn con_frame_iterator_next(
     }
     let iter = unsafe { &mut *(*iterator).iterator };
     match iter.next() {
-        Some(Ok(frame)) => Box::into_raw(Box::new(frame)) as *mut RKRConFrame,
+        Some(Ok(frame)) => FrameHandle::into_raw(frame),
         _ => ptr::null_mut(),
     }
 }
 
+/// Parses the next frame into an existing handle, reusing its memory.
+/// `frame_handle` may be any live handle, typically the one returned by the
+/// previous `con_frame_iterator_next`. Pointers obtained from the handle's
+/// column accessors are invalidated.
+/// Returns 0 on success, 1 at the end of the file (the handle is untouched),
+/// and -1 on error, in which case the handle's contents are unspecified but
+/// it must still be freed with `free_rkr_frame`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn con_frame_iterator_next_into(
+    iterator: *mut CConFrameIterator,
+    frame_handle: *mut RKRConFrame,
+) -> i32 {
+    if iterator.is_null() {
+        return -1;
+    }
+    let handle = match unsafe { FrameHandle::from_ptr_mut(frame_handle) } {
+        Some(h) => h,
+        None => return -1,
+    };
+    let iter = unsafe { &mut *(*iterator).iterator };
+    // The column view and component runs describe the old contents.
+    handle.columns.take();
+    handle.components.take();
+    match iter.next_into(&mut handle.frame) {
+        Some(Ok(())) => 0,
+        None => 1,
+        Some(Err(_)) => -1,
+    }
+}
+
 /// Frees the memory for an opaque `RKRConFrame` handle.
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn free_rkr_frame(frame_handle: *mut RKRConFrame) {
     if !frame_handle.is_null() {
-        let _ = unsafe { Box::from_raw(frame_handle as *mut ConFrame) };
+        let _ = unsafe { Box::from_raw(frame_handle as *mut FrameHandle) };
     }
 }
 
@@ -123,7 +368,6 @@ pub unsafe extern "C" fn free_con_frame_iterator(iterator: *mut CConFrameIterato
     unsafe {
         let c_iterator_box = Box::from_raw(iterator);
         let _ = Box::from_raw(c_iterator_box.iterator);
-        let _ = Box::from_raw(c_iterator_box.file_contents);
     }
 }
 
@@ -135,38 +379,34 @@ pub unsafe extern "C" fn free_con_frame_iterator(iterator: *mut CConFrameIterato
 /// The caller OWNS the returned pointer and MUST call `free_c_frame` on it.
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn rkr_frame_to_c_frame(frame_handle: *const RKRConFrame) -> *mut CFrame {
-    let frame = match unsafe { (frame_handle as *const ConFrame).as_ref() } {
-        Some(f) => f,
+    let handle = match unsafe { FrameHandle::from_ptr(frame_handle) } {
+        Some(h) => h,
         None => return ptr::null_mut(),
     };
-
-    let masses_iter = frame
-        .header
-        .natms_per_type
-        .iter()
-        .zip(frame.header.masses_per_type.iter())
-        .flat_map(|(num_atoms, mass)| std::iter::repeat_n(*mass, *num_atoms));
-
+    let _timer = stats::time(Stage::FrameToCFrame);
+    let frame = &handle.frame;
     let has_velocities = frame.has_velocities();
 
-    let mut c_atoms: Vec<CAtom> = frame
-        .atom_data
-        .iter()
-        .zip(masses_iter)
-        .map(|(atom_datum, mass)| CAtom {
-            atomic_number: symbol_to_atomic_number(&atom_datum.symbol),
+    // Element and mass are per component, so resolve them once per run.
+    let mut c_atoms: Vec<CAtom> = Vec::with_capacity(frame.atom_data.len());
+    stats::allocation();
+    for run in handle.components() {
+        let end = (run.offset + run.count).min(frame.atom_data.len());
+        let atoms = frame.atom_data.get(run.offset..end).unwrap_or_default();
+        c_atoms.extend(atoms.iter().map(|atom_datum| CAtom {
+            atomic_number: run.atomic_number,
             x: atom_datum.x,
             y: atom_datum.y,
             z: atom_datum.z,
             is_fixed: atom_datum.is_fixed,
             atom_id: atom_datum.atom_id,
-            mass,
+            mass: run.mass,
             vx: atom_datum.vx.unwrap_or(0.0),
             vy: atom_datum.vy.unwrap_or(0.0),
             vz: atom_datum.vz.unwrap_or(0.0),
             has_velocity: atom_datum.has_velocity(),
-        })
-        .collect();
+        }));
+    }
 
     let atoms_ptr = c_atoms.as_mut_ptr();
     let num_atoms = c_atoms.len();
@@ -206,7 +446,7 @@ pub unsafe extern "C" fn rkr_frame_get_header_line(
     buffer: *mut c_char,
     buffer_len: usize,
 ) -> i32 {
-    let frame = match unsafe { (frame_handle as *const ConFrame).as_ref() } {
+    let frame = match unsafe { frame_ref(frame_handle) } {
         Some(f) => f,
         None => return -1,
     };
@@ -238,7 +478,7 @@ pub unsafe extern "C" fn rkr_frame_get_header_line_cpp(
     is_prebox: bool,
     line_index: usize,
 ) -> *mut c_char {
-    let frame = match unsafe { (frame_handle as *const ConFrame).as_ref() } {
+    let frame = match unsafe { frame_ref(frame_handle) } {
         Some(f) => f,
         None => return ptr::null_mut(),
     };
@@ -269,6 +509,318 @@ pub unsafe extern "C" fn rkr_free_string(s: *mut c_char) {
     }
 }
 
+//=============================================================================
+// Column Accessors (cached SoA copy per handle)
+//=============================================================================
+
+/// Returns a pointer to one contiguous coordinate column of the frame.
+///
+/// `axis` selects x (0), y (1) or z (2). The number of elements is written
+/// to `len`. The column is built on the first column access and is OWNED by
+/// the frame handle: the pointer stays valid until `free_rkr_frame` and must
+/// not be freed by the caller.
+/// Returns NULL on error or if `axis` is out of range.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_frame_get_positions(
+    frame_handle: *const RKRConFrame,
+    axis: usize,
+    len: *mut usize,
+) -> *const f64 {
+    let handle = match unsafe { FrameHandle::from_ptr(frame_handle) } {
+        Some(h) => h,
+        None => return ptr::null(),
+    };
+    let columns = handle.columns();
+    let column = match axis {
+        0 => &columns.x,
+        1 => &columns.y,
+        2 => &columns.z,
+        _ => return ptr::null(),
+    };
+    unsafe { write_column_len(len, column.len()) };
+    column.as_ptr()
+}
+
+/// Returns a pointer to one contiguous velocity column of the frame.
+///
+/// `axis` selects vx (0), vy (1) or vz (2). Ownership and lifetime follow
+/// `rkr_frame_get_positions`. If the frame has no velocities, `len` is set to
+/// 0 and NULL is returned.
+/// Returns NULL on error or if `axis` is out of range.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_frame_get_velocities(
+    frame_handle: *const RKRConFrame,
+    axis: usize,
+    len: *mut usize,
+) -> *const f64 {
+    let handle = match unsafe { FrameHandle::from_ptr(frame_handle) } {
+        Some(h) => h,
+        None => return ptr::null(),
+    };
+    let columns = handle.columns();
+    let column = match axis {
+        0 => &columns.vx,
+        1 => &columns.vy,
+        2 => &columns.vz,
+        _ => return ptr::null(),
+    };
+    unsafe { write_column_len(len, column.len()) };
+    if column.is_empty() {
+        ptr::null()
+    } else {
+        column.as_ptr()
+    }
+}
+
+/// Returns a pointer to the contiguous atom ID column of the frame.
+/// Ownership and lifetime follow `rkr_frame_get_positions`.
+/// Returns NULL on error.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_frame_get_atom_ids(
+    frame_handle: *const RKRConFrame,
+    len: *mut usize,
+) -> *const u64 {
+    let handle = match unsafe { FrameHandle::from_ptr(frame_handle) } {
+        Some(h) => h,
+        None => return ptr::null(),
+    };
+    let column = &handle.columns().atom_id;
+    unsafe { write_column_len(len, column.len()) };
+    column.as_ptr()
+}
+
+/// Returns a pointer to the contiguous fixed-atom flag column of the frame.
+/// Ownership and lifetime follow `rkr_frame_get_positions`.
+/// Returns NULL on error.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_frame_get_fixed_mask(
+    frame_handle: *const RKRConFrame,
+    len: *mut usize,
+) -> *const bool {
+    let handle = match unsafe { FrameHandle::from_ptr(frame_handle) } {
+        Some(h) => h,
+        None => return ptr::null(),
+    };
+    let column = &handle.columns().is_fixed;
+    unsafe { write_column_len(len, column.len()) };
+    column.as_ptr()
+}
+
+/// Returns the frame's per-component atom runs, in header order.
+///
+/// Each run gives the atomic number, mass, first atom index and atom count
+/// of one component, so per-species work can slice the column accessors
+/// directly. The number of runs is written to `len`. Ownership and lifetime
+/// follow `rkr_frame_get_positions`.
+/// Returns NULL on error; a frame without components also yields NULL with
+/// `len` set to 0.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_frame_get_components(
+    frame_handle: *const RKRConFrame,
+    len: *mut usize,
+) -> *const CComponent {
+    let handle = match unsafe { FrameHandle::from_ptr(frame_handle) } {
+        Some(h) => h,
+        None => return ptr::null(),
+    };
+    let components = handle.components();
+    unsafe { write_column_len(len, components.len()) };
+    if components.is_empty() {
+        ptr::null()
+    } else {
+        components.as_ptr()
+    }
+}
+
+//=============================================================================
+// Bulk Copies into Caller Memory
+//=============================================================================
+
+/// Returns the number of atoms in the frame, or 0 if the handle is NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_frame_num_atoms(frame_handle: *const RKRConFrame) -> usize {
+    unsafe { frame_ref(frame_handle) }.map_or(0, |f| f.atom_data.len())
+}
+
+/// Returns `true` if the frame carries velocities, `false` otherwise or if
+/// the handle is NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_frame_has_velocities(frame_handle: *const RKRConFrame) -> bool {
+    unsafe { frame_ref(frame_handle) }.is_some_and(|f| f.has_velocities())
+}
+
+/// Copies the box lengths and angles into caller-provided 3-element arrays.
+/// Either pointer may be NULL to skip that quantity.
+/// Returns 0 on success, -1 if the handle is NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_frame_get_cell(
+    frame_handle: *const RKRConFrame,
+    cell: *mut f64,
+    angles: *mut f64,
+) -> i32 {
+    let frame = match unsafe { frame_ref(frame_handle) } {
+        Some(f) => f,
+        None => return -1,
+    };
+    unsafe {
+        if !cell.is_null() {
+            ptr::copy_nonoverlapping(frame.header.boxl.as_ptr(), cell, 3);
+        }
+        if !angles.is_null() {
+            ptr::copy_nonoverlapping(frame.header.angles.as_ptr(), angles, 3);
+        }
+    }
+    0
+}
+
+/// Copies the atom positions into caller memory without allocating.
+///
+/// `stride` is the distance, in doubles, between consecutive atoms:
+/// - `stride >= 3` writes interleaved records, atom `i` at
+///   `xyz[i * stride + 0..3]` (a C `double[n][3]` or Fortran `xyz(3, n)`
+///   for `stride == 3`; larger strides leave padding untouched);
+/// - `stride == 1` writes structure-of-arrays blocks, x in `xyz[0..n]`,
+///   y in `xyz[n..2n]` and z in `xyz[2n..3n]` (Fortran `xyz(n, 3)`).
+///
+/// `n` is `rkr_frame_num_atoms`, and the buffer must hold at least
+/// `(n - 1) * stride + 3` (interleaved) or `3 * n` (blocks) doubles.
+/// Returns 0 on success, -1 on a NULL argument or a stride of 0 or 2.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_frame_copy_positions(
+    frame_handle: *const RKRConFrame,
+    xyz: *mut f64,
+    stride: usize,
+) -> i32 {
+    let frame = match unsafe { frame_ref(frame_handle) } {
+        Some(f) => f,
+        None => return -1,
+    };
+    let values = frame.atom_data.iter().map(|a| [a.x, a.y, a.z]);
+    unsafe { copy_vectors(xyz, stride, frame.atom_data.len(), values) }
+}
+
+/// Copies the atom velocities into caller memory without allocating, using
+/// the layout described for `rkr_frame_copy_positions`. An atom without a
+/// velocity reads 0.0, as in `CAtom`; `rkr_frame_copy_velocity_mask` tells
+/// which atoms have one.
+/// Returns 0 on success, 1 if no atom has a velocity (nothing is written),
+/// and -1 on a NULL argument or an invalid stride.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_frame_copy_velocities(
+    frame_handle: *const RKRConFrame,
+    vxyz: *mut f64,
+    stride: usize,
+) -> i32 {
+    let frame = match unsafe { frame_ref(frame_handle) } {
+        Some(f) => f,
+        None => return -1,
+    };
+    if !frame.atom_data.iter().any(|a| a.has_velocity()) {
+        return 1;
+    }
+    let values = frame.atom_data.iter().map(|a| {
+        [
+            a.vx.unwrap_or(0.0),
+            a.vy.unwrap_or(0.0),
+            a.vz.unwrap_or(0.0),
+        ]
+    });
+    unsafe { copy_vectors(vxyz, stride, frame.atom_data.len(), values) }
+}
+
+/// Copies the atom IDs into caller memory without allocating, writing atom
+/// `i`'s ID to `ids[i * stride]` (`stride == 1` for a contiguous array).
+/// Returns 0 on success, -1 on a NULL argument or a zero stride.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_frame_copy_ids(
+    frame_handle: *const RKRConFrame,
+    ids: *mut u64,
+    stride: usize,
+) -> i32 {
+    let frame = match unsafe { frame_ref(frame_handle) } {
+        Some(f) => f,
+        None => return -1,
+    };
+    let values = frame.atom_data.iter().map(|a| a.atom_id);
+    unsafe { copy_strided(ids, stride, values) }
+}
+
+/// Copies the fixed-atom flags into caller memory without allocating,
+/// writing atom `i`'s flag to `fixed[i * stride]`.
+/// Returns 0 on success, -1 on a NULL argument or a zero stride.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_frame_copy_fixed_mask(
+    frame_handle: *const RKRConFrame,
+    fixed: *mut bool,
+    stride: usize,
+) -> i32 {
+    let frame = match unsafe { frame_ref(frame_handle) } {
+        Some(f) => f,
+        None => return -1,
+    };
+    let values = frame.atom_data.iter().map(|a| a.is_fixed);
+    unsafe { copy_strided(fixed, stride, values) }
+}
+
+/// Copies the per-atom velocity flags (`CAtom::has_velocity`) into caller
+/// memory without allocating, writing atom `i`'s flag to
+/// `has_velocity[i * stride]`.
+/// Returns 0 on success, -1 on a NULL argument or a zero stride.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_frame_copy_velocity_mask(
+    frame_handle: *const RKRConFrame,
+    has_velocity: *mut bool,
+    stride: usize,
+) -> i32 {
+    let frame = match unsafe { frame_ref(frame_handle) } {
+        Some(f) => f,
+        None => return -1,
+    };
+    let values = frame.atom_data.iter().map(|a| a.has_velocity());
+    unsafe { copy_strided(has_velocity, stride, values) }
+}
+
+/// Writes one 3-vector per atom in the layout of `rkr_frame_copy_positions`.
+unsafe fn copy_vectors(
+    out: *mut f64,
+    stride: usize,
+    num_atoms: usize,
+    values: impl Iterator<Item = [f64; 3]>,
+) -> i32 {
+    if out.is_null() || stride == 0 || stride == 2 {
+        return -1;
+    }
+    let (atom_step, axis_step) = if stride == 1 {
+        (1, num_atoms)
+    } else {
+        (stride, 1)
+    };
+    for (i, vector) in values.enumerate() {
+        for (axis, value) in vector.into_iter().enumerate() {
+            unsafe { out.add(i * atom_step + axis * axis_step).write(value) };
+        }
+    }
+    0
+}
+
+/// Writes one value per atom, `stride` elements apart.
+unsafe fn copy_strided<T>(out: *mut T, stride: usize, values: impl Iterator<Item = T>) -> i32 {
+    if out.is_null() || stride == 0 {
+        return -1;
+    }
+    for (i, value) in values.enumerate() {
+        unsafe { out.add(i * stride).write(value) };
+    }
+    0
+}
+
+/// Stores a column length through an optional out-pointer.
+unsafe fn write_column_len(len: *mut usize, value: usize) {
+    if !len.is_null() {
+        unsafe { *len = value };
+    }
+}
+
 //=============================================================================
 // FFI Writer Functions (Writer Object Model)
 //=============================================================================
@@ -300,6 +852,22 @@ pub unsafe extern "C" fn free_rkr_writer(writer_handle: *mut RKRConFrameWriter)
     }
 }
 
+/// Flushes the writer and completes compressed output with its last group
+/// and seek table; nothing can be written afterwards. `free_rkr_writer`
+/// does this too but cannot report a failure, so call this first when the
+/// output is compressed. Returns 0 on success, -1 on a NULL handle or an
+/// I/O error.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_writer_finish(writer_handle: *mut RKRConFrameWriter) -> i32 {
+    match unsafe { (writer_handle as *mut ConFrameWriter<File>).as_mut() } {
+        Some(writer) => match writer.finish() {
+            Ok(()) => 0,
+            Err(_) => -1,
+        },
+        None => -1,
+    }
+}
+
 /// Writes multiple frames from an array of handles to the file managed by the writer.
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn rkr_writer_extend(
@@ -324,7 +892,7 @@ pub unsafe extern "C" fn rkr_writer_extend(
     }
     for &handle in handles_slice.iter() {
         // Assume the handle is valid.
-        match unsafe { (handle as *const ConFrame).as_ref() } {
+        match unsafe { frame_ref(handle) } {
             Some(frame) => rust_frames.push(frame),
             // This case should be unreachable if the handle is not null, but we handle it for safety.
             None => return -1,
@@ -337,30 +905,250 @@ pub unsafe extern "C" fn rkr_writer_extend(
     }
 }
 
-//=============================================================================
-// Writer with Precision
-//=============================================================================
+/// Frame-level metadata for `rkr_writer_write_arrays`.
+#[repr(C)]
+pub struct RKRFrameHeader {
+    pub cell: [f64; 3],
+    pub angles: [f64; 3],
+    /// The two lines before the cell line; NULL entries are written empty.
+    pub prebox: [*const c_char; 2],
+    /// The two lines after the angles line; NULL entries are written empty.
+    pub postbox: [*const c_char; 2],
+}
 
-/// Creates a new frame writer with custom floating-point precision.
-/// The caller OWNS the returned pointer and MUST call `free_rkr_writer`.
-#[unsafe(no_mangle)]
-pub unsafe extern "C" fn create_writer_from_path_with_precision_c(
-    filename_c: *const c_char,
-    precision: u8,
-) -> *mut RKRConFrameWriter {
-    if filename_c.is_null() {
-        return ptr::null_mut();
+/// Borrows a C string as UTF-8, with NULL read as "".
+unsafe fn optional_str<'a>(p: *const c_char) -> Option<&'a str> {
+    if p.is_null() {
+        Some("")
+    } else {
+        unsafe { CStr::from_ptr(p) }.to_str().ok()
     }
-    let filename = match unsafe { CStr::from_ptr(filename_c).to_str() } {
-        Ok(s) => s,
-        Err(_) => return ptr::null_mut(),
-    };
+}
+
+/// Borrows `len` elements at `p`; `p` may be NULL when `len` is 0.
+unsafe fn slice_or_empty<'a, T>(p: *const T, len: usize) -> &'a [T] {
+    if len == 0 {
+        &[]
+    } else {
+        unsafe { std::slice::from_raw_parts(p, len) }
+    }
+}
+
+/// Writes one frame straight from caller-owned arrays, without building a
+/// frame handle.
+///
+/// Atoms are grouped by component: `component_counts`, `symbols` and
+/// `masses` hold `num_components` entries, and the first
+/// `component_counts[0]` atoms belong to `symbols[0]`. With `n` the sum of
+/// the counts, `xyz` holds `3 * n` interleaved coordinates and `ids` `n`
+/// atom ids. `vel` (`3 * n` interleaved velocities) may be NULL for a
+/// `.con` frame and `fixed` (`n` flags) may be NULL for all free atoms.
+/// The output matches `rkr_writer_extend` on the equivalent frame.
+/// Returns 0 on success, or -1 on a NULL argument, a NULL or non-UTF-8
+/// symbol or header line, or a write error.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_writer_write_arrays(
+    writer_handle: *mut RKRConFrameWriter,
+    header: *const RKRFrameHeader,
+    num_components: usize,
+    component_counts: *const usize,
+    symbols: *const *const c_char,
+    masses: *const f64,
+    xyz: *const f64,
+    vel: *const f64,
+    ids: *const u64,
+    fixed: *const bool,
+) -> i32 {
+    let writer = match unsafe { (writer_handle as *mut ConFrameWriter<File>).as_mut() } {
+        Some(w) => w,
+        None => return -1,
+    };
+    let Some(header) = (unsafe { header.as_ref() }) else {
+        return -1;
+    };
+    if num_components > 0 && (component_counts.is_null() || symbols.is_null() || masses.is_null())
+    {
+        return -1;
+    }
+    let counts = unsafe { slice_or_empty(component_counts, num_components) };
+    let masses = unsafe { slice_or_empty(masses, num_components) };
+    let mut symbol_strs: PerTypeVec<&str> = PerTypeVec::with_capacity(num_components);
+    for &p in unsafe { slice_or_empty(symbols, num_components) } {
+        if p.is_null() {
+            return -1;
+        }
+        match unsafe { CStr::from_ptr(p) }.to_str() {
+            Ok(s) => symbol_strs.push(s),
+            Err(_) => return -1,
+        }
+    }
+    let text = |p: *const c_char| unsafe { optional_str(p) };
+    let (Some(pre0), Some(pre1), Some(post0), Some(post1)) = (
+        text(header.prebox[0]),
+        text(header.prebox[1]),
+        text(header.postbox[0]),
+        text(header.postbox[1]),
+    ) else {
+        return -1;
+    };
+
+    let n: usize = counts.iter().sum();
+    if n > 0 && (xyz.is_null() || ids.is_null()) {
+        return -1;
+    }
+    // `[f64; 3]` has the alignment of `f64`, so interleaved triples can be
+    // viewed in place.
+    let view = FrameView {
+        prebox_header: [pre0, pre1],
+        boxl: header.cell,
+        angles: header.angles,
+        postbox_header: [post0, post1],
+        symbols: &symbol_strs,
+        natms_per_type: counts,
+        masses_per_type: masses,
+        positions: unsafe { slice_or_empty(xyz as *const [f64; 3], n) },
+        velocities: (!vel.is_null()).then(|| unsafe { slice_or_empty(vel as *const [f64; 3], n) }),
+        atom_ids: unsafe { slice_or_empty(ids, n) },
+        fixed: (!fixed.is_null()).then(|| unsafe { slice_or_empty(fixed, n) }),
+    };
+    match writer.write_view(&view) {
+        Ok(()) => 0,
+        Err(_) => -1,
+    }
+}
+
+//=============================================================================
+// Writer with Precision
+//=============================================================================
+
+/// Creates a new frame writer with custom floating-point precision.
+/// The caller OWNS the returned pointer and MUST call `free_rkr_writer`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn create_writer_from_path_with_precision_c(
+    filename_c: *const c_char,
+    precision: u8,
+) -> *mut RKRConFrameWriter {
+    if filename_c.is_null() {
+        return ptr::null_mut();
+    }
+    let filename = match unsafe { CStr::from_ptr(filename_c).to_str() } {
+        Ok(s) => s,
+        Err(_) => return ptr::null_mut(),
+    };
     match ConFrameWriter::from_path_with_precision(filename, precision as usize) {
         Ok(writer) => Box::into_raw(Box::new(writer)) as *mut RKRConFrameWriter,
         Err(_) => ptr::null_mut(),
     }
 }
 
+/// Creates a new frame writer whose `rkr_writer_extend` serializes frames in
+/// parallel. `n_threads` bounds the writer's worker pool (0 means one thread
+/// per logical CPU) and `max_in_flight_bytes` caps the formatted text held
+/// before it is written (0 selects a 64 MiB default). Output order and bytes
+/// match the serial writer. When the library is built without the `parallel`
+/// feature, both options are ignored and frames are written serially.
+/// The caller OWNS the returned pointer and MUST call `free_rkr_writer`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn create_writer_from_path_parallel_c(
+    filename_c: *const c_char,
+    precision: u8,
+    n_threads: usize,
+    max_in_flight_bytes: usize,
+) -> *mut RKRConFrameWriter {
+    if filename_c.is_null() {
+        return ptr::null_mut();
+    }
+    let filename = match unsafe { CStr::from_ptr(filename_c).to_str() } {
+        Ok(s) => s,
+        Err(_) => return ptr::null_mut(),
+    };
+    let writer = ConFrameWriter::from_path_with_precision(filename, precision as usize);
+    #[cfg(feature = "parallel")]
+    let writer = writer.and_then(|w| w.with_parallel(n_threads, max_in_flight_bytes));
+    #[cfg(not(feature = "parallel"))]
+    let _ = (n_threads, max_in_flight_bytes);
+    match writer {
+        Ok(writer) => Box::into_raw(Box::new(writer)) as *mut RKRConFrameWriter,
+        Err(_) => ptr::null_mut(),
+    }
+}
+
+/// Opens an existing trajectory for appending (creating it if missing).
+/// The last frame already in the file is parsed in full first, so nothing
+/// is appended after a truncated frame.
+/// The caller OWNS the returned pointer and MUST call `free_rkr_writer`.
+/// Returns NULL on error, including a file that does not end in a complete
+/// frame.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn create_writer_append_c(
+    filename_c: *const c_char,
+    precision: u8,
+) -> *mut RKRConFrameWriter {
+    if filename_c.is_null() {
+        return ptr::null_mut();
+    }
+    let filename = match unsafe { CStr::from_ptr(filename_c).to_str() } {
+        Ok(s) => s,
+        Err(_) => return ptr::null_mut(),
+    };
+    match ConFrameWriter::from_path_append_with_precision(filename, precision as usize) {
+        Ok(writer) => Box::into_raw(Box::new(writer)) as *mut RKRConFrameWriter,
+        Err(_) => ptr::null_mut(),
+    }
+}
+
+/// Pads every coordinate written from now on to at least `width` bytes, so
+/// frames can later be patched in place with `rkr_patch_positions`.
+/// 0 disables padding. Returns 0 on success, -1 if the handle is NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_writer_set_coordinate_width(
+    writer_handle: *mut RKRConFrameWriter,
+    width: usize,
+) -> i32 {
+    match unsafe { (writer_handle as *mut ConFrameWriter<File>).as_mut() } {
+        Some(writer) => {
+            writer.set_coordinate_width(width);
+            0
+        }
+        None => -1,
+    }
+}
+
+/// Overwrites the coordinates of frame `frame_no` in place, without moving
+/// any other byte of the file. `positions` holds `num_atoms` interleaved
+/// x, y, z triples in file order; `precision` and `width` must match those
+/// the file was written with.
+/// Returns 0 on success, or -1 on error (nothing is written if a value
+/// does not fit the field width).
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_patch_positions(
+    filename_c: *const c_char,
+    frame_no: usize,
+    positions: *const f64,
+    num_atoms: usize,
+    precision: u8,
+    width: usize,
+) -> i32 {
+    if filename_c.is_null() || (positions.is_null() && num_atoms > 0) {
+        return -1;
+    }
+    let filename = match unsafe { CStr::from_ptr(filename_c).to_str() } {
+        Ok(s) => s,
+        Err(_) => return -1,
+    };
+    let xyz: &[[f64; 3]] = if num_atoms == 0 {
+        &[]
+    } else {
+        unsafe { std::slice::from_raw_parts(positions as *const [f64; 3], num_atoms) }
+    };
+    let result = crate::writer::FramePatcher::open(filename, precision as usize, width)
+        .and_then(|mut patcher| patcher.patch_positions(frame_no, xyz));
+    match result {
+        Ok(()) => 0,
+        Err(_) => -1,
+    }
+}
+
 //=============================================================================
 // Frame Builder FFI (construct ConFrame from C data)
 //=============================================================================
@@ -461,6 +1249,68 @@ pub unsafe extern "C" fn rkr_frame_add_atom_with_velocity(
     0
 }
 
+/// Adds `count` atoms of one component from caller arrays in one call.
+///
+/// `xyz` holds `3 * count` interleaved coordinates and `ids` `count` atom
+/// ids. `fixed` (`count` flags) may be NULL for all free atoms, and `vel`
+/// (`3 * count` interleaved velocities) may be NULL for none. The symbol is
+/// converted once for the whole run. Adding the components in order, one
+/// call each, lets `rkr_frame_builder_build` keep the atoms as added.
+/// Returns 0 on success, -1 on a NULL builder, symbol, `xyz` or `ids`, or
+/// an invalid symbol string.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_frame_add_atoms_bulk(
+    builder_handle: *mut RKRConFrameBuilder,
+    symbol: *const c_char,
+    count: usize,
+    xyz: *const f64,
+    ids: *const u64,
+    fixed: *const bool,
+    mass: f64,
+    vel: *const f64,
+) -> i32 {
+    if builder_handle.is_null() || symbol.is_null() {
+        return -1;
+    }
+    let builder = unsafe { &mut *(builder_handle as *mut ConFrameBuilder) };
+    let sym = match unsafe { CStr::from_ptr(symbol).to_str() } {
+        Ok(s) => s,
+        Err(_) => return -1,
+    };
+    if count == 0 {
+        return 0;
+    }
+    if xyz.is_null() || ids.is_null() {
+        return -1;
+    }
+    // `[f64; 3]` has the alignment of `f64`, so interleaved triples can be
+    // viewed in place.
+    let positions = unsafe { std::slice::from_raw_parts(xyz as *const [f64; 3], count) };
+    let atom_ids = unsafe { std::slice::from_raw_parts(ids, count) };
+    let fixed = (!fixed.is_null()).then(|| unsafe { std::slice::from_raw_parts(fixed, count) });
+    let velocities = (!vel.is_null())
+        .then(|| unsafe { std::slice::from_raw_parts(vel as *const [f64; 3], count) });
+    builder.add_component(sym, mass, positions, atom_ids, fixed, velocities);
+    0
+}
+
+/// Reserves room for at least `additional` more atoms in the builder, so
+/// adding them does not reallocate.
+/// Returns 0 on success, -1 on a NULL builder.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_frame_builder_reserve(
+    builder_handle: *mut RKRConFrameBuilder,
+    additional: usize,
+) -> i32 {
+    match unsafe { (builder_handle as *mut ConFrameBuilder).as_mut() } {
+        Some(builder) => {
+            builder.reserve(additional);
+            0
+        }
+        None => -1,
+    }
+}
+
 /// Consumes the builder and returns a finalized RKRConFrame handle.
 /// The builder handle is invalidated after this call.
 /// The caller OWNS the returned frame and MUST call `free_rkr_frame`.
@@ -473,8 +1323,7 @@ pub unsafe extern "C" fn rkr_frame_builder_build(
         return ptr::null_mut();
     }
     let builder = unsafe { *Box::from_raw(builder_handle as *mut ConFrameBuilder) };
-    let frame = builder.build();
-    Box::into_raw(Box::new(frame)) as *mut RKRConFrame
+    FrameHandle::into_raw(builder.build())
 }
 
 /// Frees a frame builder without building.
@@ -506,7 +1355,7 @@ pub unsafe extern "C" fn rkr_read_first_frame(
         Err(_) => return ptr::null_mut(),
     };
     match iterators::read_first_frame(Path::new(filename)) {
-        Ok(frame) => Box::into_raw(Box::new(frame)) as *mut RKRConFrame,
+        Ok(frame) => FrameHandle::into_raw(frame),
         Err(_) => ptr::null_mut(),
     }
 }
@@ -529,22 +1378,62 @@ pub unsafe extern "C" fn rkr_read_all_frames(
         Err(_) => return ptr::null_mut(),
     };
     match iterators::read_all_frames(Path::new(filename)) {
-        Ok(frames) => {
-            let count = frames.len();
-            let mut handles: Vec<*mut RKRConFrame> = frames
-                .into_iter()
-                .map(|f| Box::into_raw(Box::new(f)) as *mut RKRConFrame)
-                .collect();
-            let ptr = handles.as_mut_ptr();
-            std::mem::forget(handles);
-            unsafe { *num_frames = count };
-            ptr
-        }
+        Ok(frames) => unsafe { frames_into_handle_array(frames, num_frames) },
         Err(_) => ptr::null_mut(),
     }
 }
 
-/// Frees an array of frame handles returned by `rkr_read_all_frames`.
+/// Reads all frames from a .con file, parsing frames in parallel.
+/// `n_threads` bounds the worker pool used for this call; 0 means one
+/// thread per logical CPU. When the library is built without the `parallel`
+/// feature, `n_threads` is ignored and frames are parsed serially.
+/// The caller OWNS both the array and each frame handle.
+/// Free frames with `free_rkr_frame` and the array with `free_rkr_frame_array`.
+/// Returns NULL on error.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_read_all_frames_parallel(
+    filename_c: *const c_char,
+    n_threads: usize,
+    num_frames: *mut usize,
+) -> *mut *mut RKRConFrame {
+    if filename_c.is_null() || num_frames.is_null() {
+        return ptr::null_mut();
+    }
+    let filename = match unsafe { CStr::from_ptr(filename_c).to_str() } {
+        Ok(s) => s,
+        Err(_) => return ptr::null_mut(),
+    };
+    #[cfg(feature = "parallel")]
+    let result = iterators::read_all_frames_parallel(Path::new(filename), n_threads);
+    #[cfg(not(feature = "parallel"))]
+    let result = {
+        let _ = n_threads;
+        iterators::read_all_frames(Path::new(filename))
+    };
+    match result {
+        Ok(frames) => unsafe { frames_into_handle_array(frames, num_frames) },
+        Err(_) => ptr::null_mut(),
+    }
+}
+
+/// Converts frames into a heap array of handles for `free_rkr_frame_array`.
+unsafe fn frames_into_handle_array(
+    frames: Vec<ConFrame>,
+    num_frames: *mut usize,
+) -> *mut *mut RKRConFrame {
+    let count = frames.len();
+    // A boxed slice guarantees capacity == len, which free_rkr_frame_array
+    // relies on when it rebuilds the Vec.
+    let handles: Box<[*mut RKRConFrame]> = frames
+        .into_iter()
+        .map(FrameHandle::into_raw)
+        .collect();
+    unsafe { *num_frames = count };
+    Box::into_raw(handles) as *mut *mut RKRConFrame
+}
+
+/// Frees an array of frame handles returned by `rkr_read_all_frames` or
+/// `rkr_read_all_frames_parallel`.
 /// Each frame is freed individually, then the array itself.
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn free_rkr_frame_array(
@@ -558,8 +1447,589 @@ pub unsafe extern "C" fn free_rkr_frame_array(
         let handles = Vec::from_raw_parts(frames, num_frames, num_frames);
         for handle in handles {
             if !handle.is_null() {
-                let _ = Box::from_raw(handle as *mut ConFrame);
+                let _ = Box::from_raw(handle as *mut FrameHandle);
             }
         }
     }
 }
+
+/// A caller-supplied per-frame function for `rkr_for_each_frame`.
+///
+/// It receives `user_data`, the frame's index in the file and a frame handle
+/// that it OWNS and must free with `free_rkr_frame`. It returns 0 to
+/// continue, or any other value to stop delivering frames.
+pub type RKRFrameCallback = Option<
+    unsafe extern "C" fn(user_data: *mut c_void, frame_no: usize, frame: *mut RKRConFrame) -> i32,
+>;
+
+/// `user_data` for `rkr_for_each_frame`, which the caller has promised is
+/// safe to use from the worker threads.
+struct SharedUserData(*mut c_void);
+
+unsafe impl Send for SharedUserData {}
+unsafe impl Sync for SharedUserData {}
+
+/// Parses every frame of a file and passes each one to `callback` as soon as
+/// it is ready, without collecting them.
+/// `n_threads` bounds the worker pool used for this call; 0 means one
+/// thread per logical CPU. `callback` runs on the worker threads,
+/// concurrently and in no particular frame order, so it and `user_data`
+/// must be thread-safe. Without the `parallel` feature, frames are
+/// delivered in order on the calling thread and `n_threads` is ignored.
+/// Returns 0 once every frame was delivered, 1 if `callback` asked to stop,
+/// or -1 on a NULL argument or a read or parse error (frames before the
+/// error may or may not have been delivered).
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_for_each_frame(
+    filename_c: *const c_char,
+    n_threads: usize,
+    callback: RKRFrameCallback,
+    user_data: *mut c_void,
+) -> i32 {
+    let callback = match callback {
+        Some(cb) => cb,
+        None => return -1,
+    };
+    if filename_c.is_null() {
+        return -1;
+    }
+    let filename = match unsafe { CStr::from_ptr(filename_c).to_str() } {
+        Ok(s) => s,
+        Err(_) => return -1,
+    };
+    let user_data = SharedUserData(user_data);
+    let result = iterators::for_each_frame(Path::new(filename), n_threads, |frame_no, frame| {
+        let user_data = &user_data;
+        match unsafe { callback(user_data.0, frame_no, FrameHandle::into_raw(frame)) } {
+            0 => ControlFlow::Continue(()),
+            _ => ControlFlow::Break(()),
+        }
+    });
+    match result {
+        Ok(ControlFlow::Continue(())) => 0,
+        Ok(ControlFlow::Break(())) => 1,
+        Err(_) => -1,
+    }
+}
+
+//=============================================================================
+// Shared-Topology Trajectory FFI
+//=============================================================================
+
+/// An opaque handle to a Rust `Trajectory`: frames that share one copy of
+/// their counts, masses, symbols, ids and fixed flags.
+#[repr(C)]
+pub struct RKRTrajectory {
+    _private: [u8; 0],
+}
+
+unsafe fn trajectory_frame<'a>(
+    trajectory: *const RKRTrajectory,
+    frame_no: usize,
+) -> Option<&'a TrajectoryFrame> {
+    unsafe { (trajectory as *const Trajectory).as_ref() }?.frame(frame_no)
+}
+
+/// Reads a whole file into a shared-topology trajectory.
+/// Per-atom data that does not change between frames is stored once, so
+/// long trajectories take about a third of the memory of
+/// `rkr_read_all_frames`.
+/// The caller OWNS the returned handle and MUST call `free_rkr_trajectory`.
+/// Returns NULL on error.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_read_trajectory(filename_c: *const c_char) -> *mut RKRTrajectory {
+    if filename_c.is_null() {
+        return ptr::null_mut();
+    }
+    let filename = match unsafe { CStr::from_ptr(filename_c).to_str() } {
+        Ok(s) => s,
+        Err(_) => return ptr::null_mut(),
+    };
+    match read_trajectory(Path::new(filename)) {
+        Ok(trajectory) => Box::into_raw(Box::new(trajectory)) as *mut RKRTrajectory,
+        Err(_) => ptr::null_mut(),
+    }
+}
+
+/// Frees a trajectory returned by `rkr_read_trajectory`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn free_rkr_trajectory(trajectory: *mut RKRTrajectory) {
+    if !trajectory.is_null() {
+        let _ = unsafe { Box::from_raw(trajectory as *mut Trajectory) };
+    }
+}
+
+/// Returns the number of frames, or 0 if the handle is NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_trajectory_len(trajectory: *const RKRTrajectory) -> usize {
+    unsafe { (trajectory as *const Trajectory).as_ref() }.map_or(0, Trajectory::len)
+}
+
+/// Returns the number of distinct topologies (1 if the composition never
+/// changes), or 0 if the handle is NULL or the trajectory is empty.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_trajectory_num_topologies(
+    trajectory: *const RKRTrajectory,
+) -> usize {
+    unsafe { (trajectory as *const Trajectory).as_ref() }.map_or(0, Trajectory::num_topologies)
+}
+
+/// Returns the number of atoms in frame `frame_no`, or 0 if the handle is
+/// NULL or the frame is out of range.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_trajectory_num_atoms(
+    trajectory: *const RKRTrajectory,
+    frame_no: usize,
+) -> usize {
+    unsafe { trajectory_frame(trajectory, frame_no) }.map_or(0, TrajectoryFrame::num_atoms)
+}
+
+/// Builds a full frame handle for frame `frame_no`, for use with every
+/// `rkr_frame_*` function and the writers.
+/// The caller OWNS the returned handle and MUST call `free_rkr_frame`.
+/// Returns NULL if the handle is NULL or the frame is out of range.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_trajectory_frame(
+    trajectory: *const RKRTrajectory,
+    frame_no: usize,
+) -> *mut RKRConFrame {
+    match unsafe { trajectory_frame(trajectory, frame_no) } {
+        Some(frame) => FrameHandle::into_raw(frame.to_frame()),
+        None => ptr::null_mut(),
+    }
+}
+
+/// Copies the box lengths and angles of frame `frame_no` into
+/// caller-provided 3-element arrays. Either pointer may be NULL.
+/// Returns 0 on success, -1 if the handle is NULL or the frame is out of
+/// range.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_trajectory_get_cell(
+    trajectory: *const RKRTrajectory,
+    frame_no: usize,
+    cell: *mut f64,
+    angles: *mut f64,
+) -> i32 {
+    let frame = match unsafe { trajectory_frame(trajectory, frame_no) } {
+        Some(f) => f,
+        None => return -1,
+    };
+    unsafe {
+        if !cell.is_null() {
+            ptr::copy_nonoverlapping(frame.boxl.as_ptr(), cell, 3);
+        }
+        if !angles.is_null() {
+            ptr::copy_nonoverlapping(frame.angles.as_ptr(), angles, 3);
+        }
+    }
+    0
+}
+
+/// Returns the positions of frame `frame_no` as `3 * len` interleaved
+/// doubles (x, y, z per atom), writing the atom count to `len`.
+/// The array is OWNED by the trajectory: it stays valid until
+/// `free_rkr_trajectory` and must not be freed by the caller.
+/// Returns NULL if the handle is NULL or the frame is out of range.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_trajectory_get_positions(
+    trajectory: *const RKRTrajectory,
+    frame_no: usize,
+    len: *mut usize,
+) -> *const f64 {
+    let frame = match unsafe { trajectory_frame(trajectory, frame_no) } {
+        Some(f) => f,
+        None => return ptr::null(),
+    };
+    unsafe { write_column_len(len, frame.positions.len()) };
+    frame.positions.as_ptr() as *const f64
+}
+
+/// Returns the velocities of frame `frame_no` laid out as in
+/// `rkr_trajectory_get_positions`. If the frame has no velocities, `len` is
+/// set to 0 and NULL is returned.
+/// Returns NULL if the handle is NULL or the frame is out of range.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_trajectory_get_velocities(
+    trajectory: *const RKRTrajectory,
+    frame_no: usize,
+    len: *mut usize,
+) -> *const f64 {
+    let frame = match unsafe { trajectory_frame(trajectory, frame_no) } {
+        Some(f) => f,
+        None => return ptr::null(),
+    };
+    let velocities = frame.velocities.as_deref().unwrap_or_default();
+    unsafe { write_column_len(len, velocities.len()) };
+    if velocities.is_empty() {
+        ptr::null()
+    } else {
+        velocities.as_ptr() as *const f64
+    }
+}
+
+/// Returns the atom ids of frame `frame_no`. Frames that share a topology
+/// return the same pointer. Ownership and lifetime follow
+/// `rkr_trajectory_get_positions`.
+/// Returns NULL if the handle is NULL or the frame is out of range.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_trajectory_get_atom_ids(
+    trajectory: *const RKRTrajectory,
+    frame_no: usize,
+    len: *mut usize,
+) -> *const u64 {
+    let frame = match unsafe { trajectory_frame(trajectory, frame_no) } {
+        Some(f) => f,
+        None => return ptr::null(),
+    };
+    let column = &frame.topology.atom_ids;
+    unsafe { write_column_len(len, column.len()) };
+    column.as_ptr()
+}
+
+/// Returns the fixed-atom flags of frame `frame_no`. Ownership, lifetime and
+/// sharing follow `rkr_trajectory_get_atom_ids`.
+/// Returns NULL if the handle is NULL or the frame is out of range.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_trajectory_get_fixed_mask(
+    trajectory: *const RKRTrajectory,
+    frame_no: usize,
+    len: *mut usize,
+) -> *const bool {
+    let frame = match unsafe { trajectory_frame(trajectory, frame_no) } {
+        Some(f) => f,
+        None => return ptr::null(),
+    };
+    let column = &frame.topology.is_fixed;
+    unsafe { write_column_len(len, column.len()) };
+    column.as_ptr()
+}
+
+//=============================================================================
+// Streaming Reader FFI (read callback)
+//=============================================================================
+
+/// A caller-supplied read function for `rkr_stream_reader_new`.
+///
+/// It must copy up to `len` bytes into `buf` and return the number of bytes
+/// copied, 0 at end of input, or a negative value on error.
+pub type RKRReadCallback =
+    Option<unsafe extern "C" fn(user_data: *mut c_void, buf: *mut u8, len: usize) -> isize>;
+
+/// An opaque handle to a Rust `ConFrameStreamReader` object.
+#[repr(C)]
+pub struct RKRConFrameStreamReader {
+    _private: [u8; 0],
+}
+
+/// Adapts a C read callback to `std::io::Read`.
+struct CallbackReader {
+    callback: unsafe extern "C" fn(*mut c_void, *mut u8, usize) -> isize,
+    user_data: *mut c_void,
+}
+
+impl Read for CallbackReader {
+    fn read(&mut self, buf: &mut [u8]) -> io::Result<usize> {
+        let n = unsafe { (self.callback)(self.user_data, buf.as_mut_ptr(), buf.len()) };
+        if n < 0 {
+            return Err(io::Error::other("read callback reported an error"));
+        }
+        Ok((n as usize).min(buf.len()))
+    }
+}
+
+type StreamReader = ConFrameStreamReader<BufReader<CallbackReader>>;
+
+/// Creates a frame reader that pulls its input through `read_callback`,
+/// e.g. from a pipe, socket or decompression stream.
+/// Memory use is bounded by the largest frame, not the length of the input.
+/// `user_data` is passed unchanged to every callback invocation and must stay
+/// valid until the reader is freed.
+/// The caller OWNS the returned pointer and MUST call `free_rkr_stream_reader`.
+/// Returns NULL if `read_callback` is NULL.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_stream_reader_new(
+    read_callback: RKRReadCallback,
+    user_data: *mut c_void,
+) -> *mut RKRConFrameStreamReader {
+    let callback = match read_callback {
+        Some(cb) => cb,
+        None => return ptr::null_mut(),
+    };
+    let reader = BufReader::new(CallbackReader {
+        callback,
+        user_data,
+    });
+    let stream: Box<StreamReader> = Box::new(ConFrameStreamReader::new(reader));
+    Box::into_raw(stream) as *mut RKRConFrameStreamReader
+}
+
+/// Reads the next frame from the stream, returning an opaque handle.
+/// The caller OWNS the returned handle and must free it with `free_rkr_frame`.
+/// Returns NULL at end of input or on a read or parse error.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_stream_reader_next(
+    reader: *mut RKRConFrameStreamReader,
+) -> *mut RKRConFrame {
+    let stream = match unsafe { (reader as *mut StreamReader).as_mut() } {
+        Some(s) => s,
+        None => return ptr::null_mut(),
+    };
+    match stream.next() {
+        Some(Ok(frame)) => FrameHandle::into_raw(frame),
+        _ => ptr::null_mut(),
+    }
+}
+
+/// Frees a reader created by `rkr_stream_reader_new`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn free_rkr_stream_reader(reader: *mut RKRConFrameStreamReader) {
+    if !reader.is_null() {
+        let _ = unsafe { Box::from_raw(reader as *mut StreamReader) };
+    }
+}
+
+//=============================================================================
+// Asynchronous Writer FFI (background writer thread)
+//=============================================================================
+
+/// `RKRAsyncWriterOptions::fsync_policy`: never call fsync.
+pub const RKR_FSYNC_NONE: u32 = 0;
+/// `RKRAsyncWriterOptions::fsync_policy`: fsync every `fsync_every` frames
+/// and on close.
+pub const RKR_FSYNC_EVERY_N_FRAMES: u32 = 1;
+/// `RKRAsyncWriterOptions::fsync_policy`: fsync once, on close.
+pub const RKR_FSYNC_ON_CLOSE: u32 = 2;
+
+/// Configuration for `rkr_async_writer_new`.
+#[repr(C)]
+pub struct RKRAsyncWriterOptions {
+    /// Number of decimal places for floating-point output.
+    pub precision: u8,
+    /// Maximum number of queued frames (at least 1).
+    pub queue_capacity: usize,
+    /// If true, `rkr_async_writer_push` returns 1 instead of blocking when
+    /// the queue is full.
+    pub reject_when_full: bool,
+    /// One of the `RKR_FSYNC_*` constants.
+    pub fsync_policy: u32,
+    /// Frame interval for `RKR_FSYNC_EVERY_N_FRAMES`.
+    pub fsync_every: usize,
+}
+
+/// An opaque handle to a Rust `AsyncConFrameWriter` object.
+#[repr(C)]
+pub struct RKRAsyncConFrameWriter {
+    _private: [u8; 0],
+}
+
+/// A frame handle travelling through the writer queue. Keeping the box
+/// intact means a rejected push gives back the caller's original pointer.
+struct QueuedHandle(Box<FrameHandle>);
+
+impl std::borrow::Borrow<ConFrame> for QueuedHandle {
+    fn borrow(&self) -> &ConFrame {
+        &self.0.frame
+    }
+}
+
+type AsyncWriter = crate::async_writer::AsyncConFrameWriter<QueuedHandle>;
+
+/// Creates the output file and starts a background writer thread.
+/// `options` may be NULL for the defaults (precision 6, 64 queued frames,
+/// blocking push, no fsync).
+/// The caller OWNS the returned pointer and MUST call
+/// `rkr_async_writer_close` or `free_rkr_async_writer`.
+/// Returns NULL on error, including an unknown `fsync_policy`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_async_writer_new(
+    filename_c: *const c_char,
+    options: *const RKRAsyncWriterOptions,
+) -> *mut RKRAsyncConFrameWriter {
+    use crate::async_writer::{AsyncWriterOptions, Backpressure, FsyncPolicy};
+
+    if filename_c.is_null() {
+        return ptr::null_mut();
+    }
+    let filename = match unsafe { CStr::from_ptr(filename_c).to_str() } {
+        Ok(s) => s,
+        Err(_) => return ptr::null_mut(),
+    };
+    let mut rust_options = AsyncWriterOptions::default();
+    if let Some(opts) = unsafe { options.as_ref() } {
+        rust_options.precision = opts.precision as usize;
+        rust_options.queue_capacity = opts.queue_capacity;
+        if opts.reject_when_full {
+            rust_options.backpressure = Backpressure::Reject;
+        }
+        rust_options.fsync = match opts.fsync_policy {
+            RKR_FSYNC_NONE => FsyncPolicy::Never,
+            RKR_FSYNC_EVERY_N_FRAMES => FsyncPolicy::EveryNFrames(opts.fsync_every),
+            RKR_FSYNC_ON_CLOSE => FsyncPolicy::OnClose,
+            _ => return ptr::null_mut(),
+        };
+    }
+    match AsyncWriter::from_path(filename, rust_options) {
+        Ok(writer) => Box::into_raw(Box::new(writer)) as *mut RKRAsyncConFrameWriter,
+        Err(_) => ptr::null_mut(),
+    }
+}
+
+/// Queues a frame for writing.
+/// Returns 0 if the frame was queued, in which case the writer takes
+/// ownership of `frame_handle` and the caller must NOT free it.
+/// Returns 1 if the queue is full and the writer rejects instead of blocking,
+/// or -1 on error; in both cases the caller keeps ownership of the frame.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_async_writer_push(
+    writer_handle: *mut RKRAsyncConFrameWriter,
+    frame_handle: *mut RKRConFrame,
+) -> i32 {
+    use crate::async_writer::PushError;
+
+    let writer = match unsafe { (writer_handle as *const AsyncWriter).as_ref() } {
+        Some(w) => w,
+        None => return -1,
+    };
+    if frame_handle.is_null() {
+        return -1;
+    }
+    let queued = QueuedHandle(unsafe { Box::from_raw(frame_handle as *mut FrameHandle) });
+    match writer.push(queued) {
+        Ok(()) => 0,
+        Err(err) => {
+            let code = if matches!(err, PushError::Full(_)) { 1 } else { -1 };
+            // Same allocation, so the caller's pointer stays valid.
+            let _ = Box::into_raw(err.into_inner().0);
+            code
+        }
+    }
+}
+
+/// Blocks until every frame queued so far has been written to the file.
+/// Returns 0 on success, or -1 if the writer has hit an I/O error.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_async_writer_flush(writer_handle: *mut RKRAsyncConFrameWriter) -> i32 {
+    match unsafe { (writer_handle as *const AsyncWriter).as_ref() } {
+        Some(writer) => match writer.flush() {
+            Ok(()) => 0,
+            Err(_) => -1,
+        },
+        None => -1,
+    }
+}
+
+/// Writes the remaining queued frames, applies the fsync policy, stops the
+/// writer thread and frees the handle.
+/// Returns 0 once everything is on the file, or -1 on error. The handle is
+/// freed in both cases and must not be used again.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_async_writer_close(writer_handle: *mut RKRAsyncConFrameWriter) -> i32 {
+    if writer_handle.is_null() {
+        return -1;
+    }
+    let writer = unsafe { Box::from_raw(writer_handle as *mut AsyncWriter) };
+    match writer.close() {
+        Ok(()) => 0,
+        Err(_) => -1,
+    }
+}
+
+/// Frees an asynchronous writer, waiting for queued frames to be written.
+/// Errors are discarded; use `rkr_async_writer_close` to observe them.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn free_rkr_async_writer(writer_handle: *mut RKRAsyncConFrameWriter) {
+    if !writer_handle.is_null() {
+        let _ = unsafe { Box::from_raw(writer_handle as *mut AsyncWriter) };
+    }
+}
+
+//=============================================================================
+// Instrumentation
+//=============================================================================
+
+/// Calls and total wall-clock nanoseconds of one instrumented stage.
+#[repr(C)]
+#[derive(Clone, Copy, Default)]
+pub struct RKRStageStats {
+    pub calls: u64,
+    pub nanos: u64,
+}
+
+/// Process-wide parse, write and conversion counters, filled by
+/// `rkr_stats_snapshot`. All zero unless the library was built with the
+/// `instrumentation` feature.
+#[repr(C)]
+#[derive(Clone, Copy, Default)]
+pub struct RKRStats {
+    /// Bytes of frame text consumed by the parser.
+    pub bytes_scanned: u64,
+    pub frames_parsed: u64,
+    pub atoms_parsed: u64,
+    /// Bytes of frame text produced by the writer.
+    pub bytes_written: u64,
+    pub frames_written: u64,
+    pub atoms_written: u64,
+    /// Atom and output buffers allocated or grown.
+    pub allocations: u64,
+    /// The header stage; its time is included in `parse_single_frame`.
+    pub parse_frame_header: RKRStageStats,
+    pub parse_single_frame: RKRStageStats,
+    pub parse_velocity_section: RKRStageStats,
+    pub frame_to_c_frame: RKRStageStats,
+    /// Frame formatting, excluding the underlying file I/O.
+    pub write_frame: RKRStageStats,
+}
+
+impl From<stats::StageStats> for RKRStageStats {
+    fn from(s: stats::StageStats) -> Self {
+        RKRStageStats {
+            calls: s.calls,
+            nanos: s.nanos,
+        }
+    }
+}
+
+impl From<stats::Stats> for RKRStats {
+    fn from(s: stats::Stats) -> Self {
+        RKRStats {
+            bytes_scanned: s.bytes_scanned,
+            frames_parsed: s.frames_parsed,
+            atoms_parsed: s.atoms_parsed,
+            bytes_written: s.bytes_written,
+            frames_written: s.frames_written,
+            atoms_written: s.atoms_written,
+            allocations: s.allocations,
+            parse_frame_header: s.parse_frame_header.into(),
+            parse_single_frame: s.parse_single_frame.into(),
+            parse_velocity_section: s.parse_velocity_section.into(),
+            frame_to_c_frame: s.frame_to_c_frame.into(),
+            write_frame: s.write_frame.into(),
+        }
+    }
+}
+
+/// Copies the current counters into `out`.
+/// Returns 0 on success, or -1 on a NULL `out`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn rkr_stats_snapshot(out: *mut RKRStats) -> i32 {
+    match unsafe { out.as_mut() } {
+        Some(out) => {
+            *out = stats::snapshot().into();
+            0
+        }
+        None => -1,
+    }
+}
+
+/// Sets every counter back to zero.
+#[unsafe(no_mangle)]
+pub extern "C" fn rkr_stats_reset() {
+    stats::reset();
+}
+
+/// Returns true if the library was built with the `instrumentation`
+/// feature, i.e. if `rkr_stats_snapshot` reports anything.
+#[unsafe(no_mangle)]
+pub extern "C" fn rkr_stats_enabled() -> bool {
+    stats::enabled()
+}
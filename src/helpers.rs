@@ -1,197 +1,86 @@
 // TODO(rg): Drop the comparisons in matter, integrate with readcon
+
+/// Element symbols, indexed by atomic number minus one.
+const ELEMENTS: [&str; 118] = [
+    "H", "He", "Li", "Be", "B", "C", "N", "O", "F", "Ne", "Na", "Mg", "Al", "Si", "P", "S", "Cl",
+    "Ar", "K", "Ca", "Sc", "Ti", "V", "Cr", "Mn", "Fe", "Co", "Ni", "Cu", "Zn", "Ga", "Ge", "As",
+    "Se", "Br", "Kr", "Rb", "Sr", "Y", "Zr", "Nb", "Mo", "Tc", "Ru", "Rh", "Pd", "Ag", "Cd", "In",
+    "Sn", "Sb", "Te", "I", "Xe", "Cs", "Ba", "La", "Ce", "Pr", "Nd", "Pm", "Sm", "Eu", "Gd", "Tb",
+    "Dy", "Ho", "Er", "Tm", "Yb", "Lu", "Hf", "Ta", "W", "Re", "Os", "Ir", "Pt", "Au", "Hg", "Tl",
+    "Pb", "Bi", "Po", "At", "Rn", "Fr", "Ra", "Ac", "Th", "Pa", "U", "Np", "Pu", "Am", "Cm", "Bk",
+    "Cf", "Es", "Fm", "Md", "No", "Lr", "Rf", "Db", "Sg", "Bh", "Hs", "Mt", "Ds", "Rg", "Cn", "Nh",
+    "Fl", "Mc", "Lv", "Ts", "Og",
+];
+
+/// One slot per uppercase letter, optionally followed by a lowercase one.
+const SYMBOL_SLOTS: usize = 26 * 27;
+
+/// Hashes a one- or two-letter symbol to its slot in `SYMBOL_TABLE`, or
+/// `None` if it cannot be an element symbol.
+///
+/// Distinct symbols always get distinct slots, so the table needs no
+/// collision handling and a lookup is a single indexed load.
+const fn symbol_slot(symbol: &[u8]) -> Option<usize> {
+    let first = match symbol.first() {
+        Some(&c) if c.is_ascii_uppercase() => (c - b'A') as usize,
+        _ => return None,
+    };
+    let second = match symbol.len() {
+        1 => 0,
+        2 if symbol[1].is_ascii_lowercase() => (symbol[1] - b'a') as usize + 1,
+        _ => return None,
+    };
+    Some(first * 27 + second)
+}
+
+/// Atomic numbers by `symbol_slot`, built at compile time; 0 marks a slot
+/// with no element.
+const SYMBOL_TABLE: [u8; SYMBOL_SLOTS] = {
+    let mut table = [0u8; SYMBOL_SLOTS];
+    let mut i = 0;
+    while i < ELEMENTS.len() {
+        match symbol_slot(ELEMENTS[i].as_bytes()) {
+            Some(slot) => table[slot] = (i + 1) as u8,
+            None => panic!("malformed element symbol"),
+        }
+        i += 1;
+    }
+    table
+};
+
+/// Converts a chemical symbol to its atomic number, or 0 if it is unknown.
 pub fn symbol_to_atomic_number(symbol: &str) -> u64 {
-    match symbol {
-        "H" => 1,
-        "He" => 2,
-        "Li" => 3,
-        "Be" => 4,
-        "B" => 5,
-        "C" => 6,
-        "N" => 7,
-        "O" => 8,
-        "F" => 9,
-        "Ne" => 10,
-        "Na" => 11,
-        "Mg" => 12,
-        "Al" => 13,
-        "Si" => 14,
-        "P" => 15,
-        "S" => 16,
-        "Cl" => 17,
-        "Ar" => 18,
-        "K" => 19,
-        "Ca" => 20,
-        "Sc" => 21,
-        "Ti" => 22,
-        "V" => 23,
-        "Cr" => 24,
-        "Mn" => 25,
-        "Fe" => 26,
-        "Co" => 27,
-        "Ni" => 28,
-        "Cu" => 29,
-        "Zn" => 30,
-        "Ga" => 31,
-        "Ge" => 32,
-        "As" => 33,
-        "Se" => 34,
-        "Br" => 35,
-        "Kr" => 36,
-        "Rb" => 37,
-        "Sr" => 38,
-        "Y" => 39,
-        "Zr" => 40,
-        "Nb" => 41,
-        "Mo" => 42,
-        "Tc" => 43,
-        "Ru" => 44,
-        "Rh" => 45,
-        "Pd" => 46,
-        "Ag" => 47,
-        "Cd" => 48,
-        "In" => 49,
-        "Sn" => 50,
-        "Sb" => 51,
-        "Te" => 52,
-        "I" => 53,
-        "Xe" => 54,
-        "Cs" => 55,
-        "Ba" => 56,
-        "La" => 57,
-        "Ce" => 58,
-        "Pr" => 59,
-        "Nd" => 60,
-        "Pm" => 61,
-        "Sm" => 62,
-        "Eu" => 63,
-        "Gd" => 64,
-        "Tb" => 65,
-        "Dy" => 66,
-        "Ho" => 67,
-        "Er" => 68,
-        "Tm" => 69,
-        "Yb" => 70,
-        "Lu" => 71,
-        "Hf" => 72,
-        "Ta" => 73,
-        "W" => 74,
-        "Re" => 75,
-        "Os" => 76,
-        "Ir" => 77,
-        "Pt" => 78,
-        "Au" => 79,
-        "Hg" => 80,
-        "Tl" => 81,
-        "Pb" => 82,
-        "Bi" => 83,
-        "Po" => 84,
-        "At" => 85,
-        "Rn" => 86,
-        "Fr" => 87,
-        "Ra" => 88,
-        "Ac" => 89,
-        "Th" => 90,
-        "Pa" => 91,
-        "U" => 92,
-        _ => 0, // Unknown
+    match symbol_slot(symbol.as_bytes()) {
+        Some(slot) => SYMBOL_TABLE[slot] as u64,
+        None => 0,
     }
 }
 
 /// Converts an atomic number to its corresponding chemical symbol.
 pub fn atomic_number_to_symbol(atomic_number: u64) -> &'static str {
-    match atomic_number {
-        1 => "H",
-        2 => "He",
-        3 => "Li",
-        4 => "Be",
-        5 => "B",
-        6 => "C",
-        7 => "N",
-        8 => "O",
-        9 => "F",
-        10 => "Ne",
-        11 => "Na",
-        12 => "Mg",
-        13 => "Al",
-        14 => "Si",
-        15 => "P",
-        16 => "S",
-        17 => "Cl",
-        18 => "Ar",
-        19 => "K",
-        20 => "Ca",
-        21 => "Sc",
-        22 => "Ti",
-        23 => "V",
-        24 => "Cr",
-        25 => "Mn",
-        26 => "Fe",
-        27 => "Co",
-        28 => "Ni",
-        29 => "Cu",
-        30 => "Zn",
-        31 => "Ga",
-        32 => "Ge",
-        33 => "As",
-        34 => "Se",
-        35 => "Br",
-        36 => "Kr",
-        37 => "Rb",
-        38 => "Sr",
-        39 => "Y",
-        40 => "Zr",
-        41 => "Nb",
-        42 => "Mo",
-        43 => "Tc",
-        44 => "Ru",
-        45 => "Rh",
-        46 => "Pd",
-        47 => "Ag",
-        48 => "Cd",
-        49 => "In",
-        50 => "Sn",
-        51 => "Sb",
-        52 => "Te",
-        53 => "I",
-        54 => "Xe",
-        55 => "Cs",
-        56 => "Ba",
-        57 => "La",
-        58 => "Ce",
-        59 => "Pr",
-        60 => "Nd",
-        61 => "Pm",
-        62 => "Sm",
-        63 => "Eu",
-        64 => "Gd",
-        65 => "Tb",
-        66 => "Dy",
-        67 => "Ho",
-        68 => "Er",
-        69 => "Tm",
-        70 => "Yb",
-        71 => "Lu",
-        72 => "Hf",
-        73 => "Ta",
-        74 => "W",
-        75 => "Re",
-        76 => "Os",
-        77 => "Ir",
-        78 => "Pt",
-        79 => "Au",
-        80 => "Hg",
-        81 => "Tl",
-        82 => "Pb",
-        83 => "Bi",
-        84 => "Po",
-        85 => "At",
-        86 => "Rn",
-        87 => "Fr",
-        88 => "Ra",
-        89 => "Ac",
-        90 => "Th",
-        91 => "Pa",
-        92 => "U",
-        _ => "X", // Represents an unknown element
+    usize::try_from(atomic_number)
+        .ok()
+        .and_then(|n| n.checked_sub(1))
+        .and_then(|i| ELEMENTS.get(i))
+        .copied()
+        .unwrap_or("X") // Represents an unknown element
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn element_table_round_trips() {
+        for (i, symbol) in ELEMENTS.iter().enumerate() {
+            let z = i as u64 + 1;
+            assert_eq!(symbol_to_atomic_number(symbol), z);
+            assert_eq!(atomic_number_to_symbol(z), *symbol);
+        }
+        for unknown in ["", "X", "Xx", "cu", "CU", "Cuu", "é"] {
+            assert_eq!(symbol_to_atomic_number(unknown), 0);
+        }
+        assert_eq!(atomic_number_to_symbol(0), "X");
+        assert_eq!(atomic_number_to_symbol(119), "X");
     }
 }
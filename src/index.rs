@@ -0,0 +1,528 @@
+//=============================================================================
+// Frame Index - byte offsets of every frame for random access
+//=============================================================================
+
+use crate::error::ParseError;
+use crate::parser::parse_frame_header_ref;
+use std::fs;
+use std::io::{self, Write};
+use std::path::{Path, PathBuf};
+use std::time::UNIX_EPOCH;
+
+/// Magic bytes identifying a `.idx` sidecar, including a format version.
+const SIDECAR_MAGIC: &[u8; 8] = b"RCONIDX1";
+/// Size of the fixed sidecar header: magic, file size, mtime (secs, nanos,
+/// padding), frame count and end offset.
+const SIDECAR_HEADER_LEN: usize = 8 + 8 + 8 + 4 + 4 + 8 + 8;
+
+/// The location and size of a single frame within a file.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct FrameEntry {
+    /// Byte offset of the frame's first header line.
+    pub offset: usize,
+    /// Total number of atoms in the frame (sum of `natms_per_type`).
+    pub num_atoms: usize,
+}
+
+/// A byte-offset index over all frames in a `.con` or `.convel` file.
+///
+/// The index is built with a single header-only scan: for each frame only
+/// the nine header lines are parsed (into an allocation-free
+/// `FrameHeaderRef`), and the coordinate and velocity blocks are skipped by
+/// counting newlines. It enables O(1) seeking to any frame via
+/// `ConFrameIterator::seek`.
+///
+/// # Example
+///
+/// ```
+/// use readcon_core::index::FrameIndex;
+///
+/// let text = "a\nb\n1 1 1\n90 90 90\nc\nd\n1\n1\n1.0\nH\nCoordinates of Component 1\n0 0 0 0 0\n";
+/// let index = FrameIndex::build(text).unwrap();
+/// assert_eq!(index.len(), 1);
+/// assert_eq!(index.get(0).unwrap().num_atoms, 1);
+/// ```
+#[derive(Debug, Clone, Default, PartialEq, Eq)]
+pub struct FrameIndex {
+    entries: Vec<FrameEntry>,
+    end: usize,
+}
+
+impl FrameIndex {
+    /// Scans file contents and records the offset and atom count of every frame.
+    ///
+    /// # Errors
+    ///
+    /// Returns the same errors as `ConFrameIterator::forward()` if any frame's
+    /// header is malformed or the file ends inside a frame.
+    pub fn build(file_contents: &str) -> Result<Self, ParseError> {
+        Self::build_from_bytes(file_contents.as_bytes())
+    }
+
+    /// Like [`FrameIndex::build`], but over raw bytes such as a memory map.
+    ///
+    /// Only the header lines need to be valid UTF-8; other bytes are not
+    /// inspected beyond locating newlines.
+    pub fn build_from_bytes(file_contents: &[u8]) -> Result<Self, ParseError> {
+        let scan = scan_frames(file_contents);
+        match scan.error {
+            Some(e) => Err(e),
+            None => Ok(FrameIndex {
+                entries: scan.entries,
+                end: scan.end,
+            }),
+        }
+    }
+
+    /// Assembles an index from entries located by other means (the `.conb`
+    /// offset table).
+    pub(crate) fn from_entries(entries: Vec<FrameEntry>, end: usize) -> Self {
+        FrameIndex { entries, end }
+    }
+
+    /// Returns the number of frames in the index.
+    pub fn len(&self) -> usize {
+        self.entries.len()
+    }
+
+    /// Returns `true` if the index holds no frames.
+    pub fn is_empty(&self) -> bool {
+        self.entries.is_empty()
+    }
+
+    /// Returns the entry for the given frame, or `None` if out of range.
+    pub fn get(&self, frame_no: usize) -> Option<&FrameEntry> {
+        self.entries.get(frame_no)
+    }
+
+    /// Returns all entries in file order.
+    pub fn entries(&self) -> &[FrameEntry] {
+        &self.entries
+    }
+
+    /// Returns the byte offset just past the last indexed frame.
+    pub fn end(&self) -> usize {
+        self.end
+    }
+
+    /// Returns the byte range spanned by the given frame, or `None` if out of range.
+    pub fn byte_range(&self, frame_no: usize) -> Option<std::ops::Range<usize>> {
+        let start = self.entries.get(frame_no)?.offset;
+        let stop = self
+            .entries
+            .get(frame_no + 1)
+            .map_or(self.end, |e| e.offset);
+        Some(start..stop)
+    }
+
+    /// Returns `true` if the index can describe `file_contents`: offsets are
+    /// in order, and every offset and the end lie within the contents at the
+    /// start of a line (hence on a UTF-8 character boundary).
+    ///
+    /// This does not re-parse the frames; it guards against sidecars that
+    /// are corrupt or belong to a different file.
+    pub fn fits(&self, file_contents: &[u8]) -> bool {
+        let at_line_start = |offset: usize| {
+            offset == 0 || file_contents.get(offset - 1) == Some(&b'\n')
+        };
+        let mut previous = 0;
+        self.entries.iter().all(|entry| {
+            let ok = entry.offset >= previous && at_line_start(entry.offset);
+            previous = entry.offset;
+            ok
+        }) && self.end >= previous
+            && (self.end == file_contents.len() || at_line_start(self.end))
+    }
+
+    /// Returns the sidecar path used for a trajectory file (`<file>.idx`).
+    pub fn sidecar_path(path: &Path) -> PathBuf {
+        let mut name = path.as_os_str().to_owned();
+        name.push(".idx");
+        PathBuf::from(name)
+    }
+
+    /// Writes the index to the sidecar of `path`, stamped with the file's
+    /// current size and modification time.
+    pub fn save_sidecar(&self, path: &Path) -> io::Result<()> {
+        let (size, secs, nanos) = file_stamp(path)?;
+        let mut buf =
+            Vec::with_capacity(SIDECAR_HEADER_LEN + self.entries.len() * 16);
+        buf.extend_from_slice(SIDECAR_MAGIC);
+        buf.extend_from_slice(&size.to_le_bytes());
+        buf.extend_from_slice(&secs.to_le_bytes());
+        buf.extend_from_slice(&nanos.to_le_bytes());
+        buf.extend_from_slice(&0u32.to_le_bytes());
+        buf.extend_from_slice(&(self.entries.len() as u64).to_le_bytes());
+        buf.extend_from_slice(&(self.end as u64).to_le_bytes());
+        for entry in &self.entries {
+            buf.extend_from_slice(&(entry.offset as u64).to_le_bytes());
+            buf.extend_from_slice(&(entry.num_atoms as u64).to_le_bytes());
+        }
+        let mut file = fs::File::create(Self::sidecar_path(path))?;
+        file.write_all(&buf)
+    }
+
+    /// Loads the sidecar of `path` if it exists and is still current.
+    ///
+    /// Returns `Ok(None)` if there is no sidecar, or if its recorded size or
+    /// modification time no longer match the file (i.e. the index is stale).
+    pub fn load_sidecar(path: &Path) -> io::Result<Option<Self>> {
+        let bytes = match fs::read(Self::sidecar_path(path)) {
+            Ok(b) => b,
+            Err(e) if e.kind() == io::ErrorKind::NotFound => return Ok(None),
+            Err(e) => return Err(e),
+        };
+        if bytes.len() < SIDECAR_HEADER_LEN || &bytes[..8] != SIDECAR_MAGIC {
+            return Ok(None);
+        }
+        let u64_at = |at: usize| u64::from_le_bytes(bytes[at..at + 8].try_into().unwrap());
+        let u32_at = |at: usize| u32::from_le_bytes(bytes[at..at + 4].try_into().unwrap());
+
+        let (size, secs, nanos) = file_stamp(path)?;
+        if u64_at(8) != size || u64_at(16) != secs || u32_at(24) != nanos {
+            return Ok(None);
+        }
+        let usize_at = |at: usize| usize::try_from(u64_at(at)).ok();
+        let body = &bytes[SIDECAR_HEADER_LEN..];
+        let (Some(num_frames), Some(end)) = (usize_at(32), usize_at(40)) else {
+            return Ok(None);
+        };
+        if num_frames.checked_mul(16) != Some(body.len()) {
+            return Ok(None);
+        }
+        let entries = (0..num_frames)
+            .map(|i| {
+                Some(FrameEntry {
+                    offset: usize_at(SIDECAR_HEADER_LEN + i * 16)?,
+                    num_atoms: usize_at(SIDECAR_HEADER_LEN + i * 16 + 8)?,
+                })
+            })
+            .collect::<Option<Vec<_>>>();
+        Ok(entries.map(|entries| FrameIndex { entries, end }))
+    }
+
+    /// Loads a current sidecar for `path`, or builds the index from
+    /// `file_contents` and tries to persist it. A sidecar whose offsets do
+    /// not [fit](FrameIndex::fits) the contents is discarded and rebuilt.
+    ///
+    /// Failure to write the sidecar (e.g. a read-only directory) is not an
+    /// error; the freshly built index is returned regardless.
+    pub fn load_or_build(
+        path: &Path,
+        file_contents: &[u8],
+    ) -> Result<Self, Box<dyn std::error::Error>> {
+        if let Some(index) = Self::load_sidecar(path)?.filter(|i| i.fits(file_contents)) {
+            return Ok(index);
+        }
+        let index = Self::build_from_bytes(file_contents)?;
+        let _ = index.save_sidecar(path);
+        Ok(index)
+    }
+}
+
+/// The error for an index whose offsets do not fall inside the contents it
+/// was installed for.
+pub(crate) fn index_mismatch() -> ParseError {
+    ParseError::Io(io::Error::new(
+        io::ErrorKind::InvalidData,
+        "frame index does not match the file",
+    ))
+}
+
+/// Returns the size and modification time (seconds, nanoseconds) of a file.
+fn file_stamp(path: &Path) -> io::Result<(u64, u64, u32)> {
+    let metadata = fs::metadata(path)?;
+    let mtime = metadata
+        .modified()?
+        .duration_since(UNIX_EPOCH)
+        .unwrap_or_default();
+    Ok((metadata.len(), mtime.as_secs(), mtime.subsec_nanos()))
+}
+
+/// A forward-only line reader over raw bytes that tracks its byte position.
+///
+/// Lines are split exactly like `str::lines()`: on `\n`, with an optional
+/// trailing `\r` removed, and without a final empty line. Newlines are located
+/// with `memchr`, so skipping whole blocks never looks at the bytes in between
+/// beyond the vectorized newline search. Working on bytes means the text does
+/// not have to be UTF-8 validated up front; only the lines that are actually
+/// parsed are checked.
+pub(crate) struct LineCursor<'a> {
+    text: &'a [u8],
+    pub(crate) pos: usize,
+}
+
+impl<'a> LineCursor<'a> {
+    pub(crate) fn new(text: &'a [u8]) -> Self {
+        LineCursor { text, pos: 0 }
+    }
+
+    pub(crate) fn is_at_end(&self) -> bool {
+        self.pos >= self.text.len()
+    }
+
+    /// Returns the next line and advances past it.
+    pub(crate) fn next_line(&mut self) -> Option<&'a [u8]> {
+        if self.is_at_end() {
+            return None;
+        }
+        let rest = &self.text[self.pos..];
+        let (line, advance) = match memchr::memchr(b'\n', rest) {
+            Some(nl) => (&rest[..nl], nl + 1),
+            None => (rest, rest.len()),
+        };
+        self.pos += advance;
+        Some(line.strip_suffix(b"\r").unwrap_or(line))
+    }
+
+    /// Returns the next line as a `&str`, failing if it is not valid UTF-8.
+    pub(crate) fn next_str_line(&mut self) -> Option<Result<&'a str, ParseError>> {
+        let start = self.pos;
+        let line = self.next_line()?;
+        Some(std::str::from_utf8(line).map_err(|e| ParseError::InvalidUtf8 {
+            offset: start + e.valid_up_to(),
+        }))
+    }
+
+    /// Returns the next line without advancing.
+    pub(crate) fn peek_line(&self) -> Option<&'a [u8]> {
+        let mut probe = LineCursor {
+            text: self.text,
+            pos: self.pos,
+        };
+        probe.next_line()
+    }
+
+    /// Skips `n` lines, returning `false` if the text ends first.
+    pub(crate) fn skip_lines(&mut self, n: usize) -> bool {
+        if n == 0 {
+            return true;
+        }
+        let rest = &self.text[self.pos..];
+        if let Some(nl) = memchr::memchr_iter(b'\n', rest).nth(n - 1) {
+            self.pos += nl + 1;
+            return true;
+        }
+        // Fewer than `n` newlines remain; an unterminated final line still
+        // counts as a line, exactly as with `str::lines()`.
+        let newlines = memchr::memchr_iter(b'\n', rest).count();
+        let has_tail = rest.last().is_some_and(|&b| b != b'\n');
+        self.pos = self.text.len();
+        newlines + usize::from(has_tail) >= n
+    }
+}
+
+/// The outcome of a boundary scan over file contents.
+pub(crate) struct FrameScan {
+    /// Entries for every frame that was skipped successfully.
+    pub(crate) entries: Vec<FrameEntry>,
+    /// Byte offset just past the last complete frame.
+    pub(crate) end: usize,
+    /// The error that stopped the scan early, if any. The malformed frame
+    /// starts at `end`.
+    pub(crate) error: Option<ParseError>,
+}
+
+/// Finds every frame boundary in a single O(n) pass over the bytes.
+///
+/// Only the header lines are parsed (and UTF-8 validated); all other lines,
+/// including whole coordinate and velocity blocks, are skipped by counting
+/// newlines. Scanning stops at the first
+/// malformed frame.
+pub(crate) fn scan_frames(file_contents: &[u8]) -> FrameScan {
+    let mut cursor = LineCursor::new(file_contents);
+    let mut entries = Vec::new();
+    let mut end = 0;
+    while !cursor.is_at_end() {
+        match skip_frame(&mut cursor) {
+            Ok(num_atoms) => {
+                entries.push(FrameEntry {
+                    offset: end,
+                    num_atoms,
+                });
+                end = cursor.pos;
+            }
+            Err(e) => {
+                return FrameScan {
+                    entries,
+                    end,
+                    error: Some(e),
+                };
+            }
+        }
+    }
+    FrameScan {
+        entries,
+        end,
+        error: None,
+    }
+}
+
+/// Skips one frame, parsing its header into a borrowed `FrameHeaderRef`.
+///
+/// Returns the frame's total atom count. Mirrors `ConFrameIterator::forward()`;
+/// only the nine header lines are UTF-8 validated.
+pub(crate) fn skip_frame(cursor: &mut LineCursor<'_>) -> Result<usize, ParseError> {
+    let mut header_lines = [""; 9];
+    for line in &mut header_lines {
+        *line = cursor.next_str_line().ok_or(ParseError::IncompleteHeader)??;
+    }
+    let header = parse_frame_header_ref(&mut header_lines.into_iter())?;
+
+    let total_atoms = header.total_atoms();
+    let block_lines = total_atoms + header.natm_types * 2;
+    if !cursor.skip_lines(block_lines) {
+        return Err(ParseError::IncompleteFrame);
+    }
+    let is_blank = |l: &[u8]| std::str::from_utf8(l).is_ok_and(|l| l.trim().is_empty());
+    if cursor.peek_line().is_some_and(is_blank) {
+        cursor.next_line();
+        if !cursor.skip_lines(block_lines) {
+            return Err(ParseError::IncompleteVelocitySection);
+        }
+    }
+    Ok(total_atoms)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    const TWO_FRAMES: &str = "\
+p1
+p2
+10 10 10
+90 90 90
+q1
+q2
+1
+2
+1.0
+H
+Coordinates of Component 1
+0 0 0 0 0
+1 1 1 0 1
+p1
+p2
+10 10 10
+90 90 90
+q1
+q2
+1
+1
+1.0
+H
+Coordinates of Component 1
+2 2 2 0 0
+
+H
+Velocities of Component 1
+0.1 0.2 0.3 0 0
+";
+
+    #[test]
+    fn test_build_offsets() {
+        let index = FrameIndex::build(TWO_FRAMES).unwrap();
+        assert_eq!(index.len(), 2);
+        assert_eq!(index.get(0).unwrap().offset, 0);
+        assert_eq!(index.get(0).unwrap().num_atoms, 2);
+        let second = index.get(1).unwrap();
+        assert!(TWO_FRAMES[second.offset..].starts_with("p1\n"));
+        assert_eq!(second.num_atoms, 1);
+        assert_eq!(index.end(), TWO_FRAMES.len());
+        assert_eq!(index.byte_range(1), Some(second.offset..TWO_FRAMES.len()));
+    }
+
+    #[test]
+    fn test_build_incomplete_frame() {
+        let truncated = &TWO_FRAMES[..TWO_FRAMES.len() - 30];
+        assert!(FrameIndex::build(truncated).is_err());
+    }
+
+    #[test]
+    fn test_line_cursor_matches_lines() {
+        let text = "a\r\nbb\n\nccc";
+        let mut cursor = LineCursor::new(text.as_bytes());
+        let mut via_cursor = Vec::new();
+        while let Some(line) = cursor.next_str_line() {
+            via_cursor.push(line.unwrap());
+        }
+        assert_eq!(via_cursor, text.lines().collect::<Vec<_>>());
+
+        let mut skipper = LineCursor::new(text.as_bytes());
+        assert!(skipper.skip_lines(2));
+        assert_eq!(skipper.peek_line(), Some(&b""[..]));
+        assert!(skipper.skip_lines(2));
+        assert!(skipper.is_at_end());
+        assert!(!LineCursor::new(text.as_bytes()).skip_lines(5));
+    }
+
+    #[test]
+    fn test_scan_stops_at_malformed_frame() {
+        let mut text = TWO_FRAMES.to_string();
+        text.push_str("p1\np2\n");
+        let scan = scan_frames(text.as_bytes());
+        assert_eq!(scan.entries.len(), 2);
+        assert_eq!(scan.end, TWO_FRAMES.len());
+        assert!(matches!(scan.error, Some(ParseError::IncompleteHeader)));
+    }
+
+    #[test]
+    fn test_scan_reports_invalid_utf8_offset() {
+        let mut bytes = TWO_FRAMES.as_bytes().to_vec();
+        // Corrupt the second frame's natm_types line ("1").
+        let second = FrameIndex::build(TWO_FRAMES).unwrap().get(1).unwrap().offset;
+        let natm_line = second + "p1\np2\n10 10 10\n90 90 90\nq1\nq2\n".len();
+        bytes[natm_line] = 0xff;
+        let scan = scan_frames(&bytes);
+        assert_eq!(scan.entries.len(), 1);
+        assert!(matches!(
+            scan.error,
+            Some(ParseError::InvalidUtf8 { offset }) if offset == natm_line
+        ));
+    }
+
+    #[test]
+    fn test_sidecar_roundtrip() {
+        let dir = std::env::temp_dir().join(format!("readcon-idx-{}", std::process::id()));
+        fs::create_dir_all(&dir).unwrap();
+        let path = dir.join("two.con");
+        fs::write(&path, TWO_FRAMES).unwrap();
+
+        assert_eq!(FrameIndex::load_sidecar(&path).unwrap(), None);
+        let built = FrameIndex::load_or_build(&path, TWO_FRAMES.as_bytes()).unwrap();
+        assert!(FrameIndex::sidecar_path(&path).exists());
+        assert_eq!(FrameIndex::load_sidecar(&path).unwrap(), Some(built));
+
+        // Changing the file size invalidates the sidecar.
+        fs::write(&path, &TWO_FRAMES[..TWO_FRAMES.len() - 1]).unwrap();
+        assert_eq!(FrameIndex::load_sidecar(&path).unwrap(), None);
+
+        fs::remove_dir_all(&dir).unwrap();
+    }
+
+    #[test]
+    fn test_sidecar_with_bad_offsets_is_rebuilt() {
+        let dir = std::env::temp_dir().join(format!("readcon-idx-bad-{}", std::process::id()));
+        fs::create_dir_all(&dir).unwrap();
+        let path = dir.join("two.con");
+        fs::write(&path, TWO_FRAMES).unwrap();
+        let built = FrameIndex::load_or_build(&path, TWO_FRAMES.as_bytes()).unwrap();
+        let sidecar = FrameIndex::sidecar_path(&path);
+        let good = fs::read(&sidecar).unwrap();
+
+        // Mid-line and past-the-end offsets, with the file stamp still current.
+        let second = SIDECAR_HEADER_LEN + 16;
+        for offset in [built.get(1).unwrap().offset as u64 + 1, u64::MAX] {
+            let mut bad = good.clone();
+            bad[second..second + 8].copy_from_slice(&offset.to_le_bytes());
+            fs::write(&sidecar, &bad).unwrap();
+            let loaded = FrameIndex::load_sidecar(&path).unwrap();
+            assert!(loaded.is_none_or(|index| !index.fits(TWO_FRAMES.as_bytes())));
+            let rebuilt = FrameIndex::load_or_build(&path, TWO_FRAMES.as_bytes()).unwrap();
+            assert_eq!(rebuilt, built);
+        }
+
+        fs::remove_dir_all(&dir).unwrap();
+    }
+}
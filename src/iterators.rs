@@ -2,10 +2,21 @@
 // The Public API - A clean iterator for users of our library
 //=============================================================================
 
-use crate::parser::{parse_single_frame, parse_velocity_section};
-use crate::{error, types};
+use crate::parser::{
+    ParseOptions, parse_frame_header_ref, parse_single_frame, parse_single_frame_into,
+    parse_single_frame_soa, parse_single_frame_with, parse_velocity_section,
+    parse_velocity_section_soa, project_frame,
+};
+#[cfg(feature = "compression")]
+use crate::compression;
+use crate::compression::Compression;
+use crate::index::{self, FrameIndex, LineCursor};
+use crate::{conb, error, types};
+use std::io::BufRead;
 use std::iter::Peekable;
-use std::path::Path;
+use std::ops::{ControlFlow, Range};
+use std::path::{Path, PathBuf};
+use std::sync::Arc;
 
 /// An iterator that lazily parses simulation frames from a `.con` or `.convel`
 /// file's contents.
@@ -17,8 +28,17 @@ use std::path::Path;
 ///
 /// The iterator yields items of type `Result<ConFrame, ParseError>`, allowing for
 /// robust error handling for each frame.
+///
+/// Random access is available through `seek()` and `len()`, which use a
+/// [`FrameIndex`] built on first use (or supplied via `set_index()`).
+///
+/// [`ParseOptions`] restrict what is parsed (headers only, no velocities,
+/// selected components or atom ids); see [`ConFrameIterator::with_options`].
 pub struct ConFrameIterator<'a> {
+    contents: &'a str,
     lines: Peekable<std::str::Lines<'a>>,
+    index: Option<FrameIndex>,
+    options: ParseOptions,
 }
 
 impl<'a> ConFrameIterator<'a> {
@@ -29,15 +49,100 @@ impl<'a> ConFrameIterator<'a> {
     /// * `file_contents` - A string slice containing the text of one or more `.con` frames.
     pub fn new(file_contents: &'a str) -> Self {
         ConFrameIterator {
+            contents: file_contents,
             lines: file_contents.lines().peekable(),
+            index: None,
+            options: ParseOptions::default(),
         }
     }
 
+    /// Creates an iterator that parses frames under `options`.
+    pub fn with_options(file_contents: &'a str, options: ParseOptions) -> Self {
+        let mut iter = Self::new(file_contents);
+        iter.options = options;
+        iter
+    }
+
+    /// Replaces the options used for subsequent frames.
+    pub fn set_options(&mut self, options: ParseOptions) {
+        self.options = options;
+    }
+
+    /// Returns the options frames are parsed with.
+    pub fn options(&self) -> &ParseOptions {
+        &self.options
+    }
+
+    /// Returns the frame index, building it with a header-only scan on first use.
+    ///
+    /// # Errors
+    ///
+    /// Propagates any error from `FrameIndex::build` if a frame is malformed.
+    pub fn build_index(&mut self) -> Result<&FrameIndex, error::ParseError> {
+        if self.index.is_none() {
+            self.index = Some(FrameIndex::build(self.contents)?);
+        }
+        Ok(self.index.as_ref().unwrap())
+    }
+
+    /// Installs a previously built or loaded index (e.g. from a sidecar file).
+    ///
+    /// The index must describe the same contents this iterator was created with.
+    pub fn set_index(&mut self, index: FrameIndex) {
+        self.index = Some(index);
+    }
+
+    /// Returns the index if it has already been built or installed.
+    pub fn index(&self) -> Option<&FrameIndex> {
+        self.index.as_ref()
+    }
+
+    /// Returns the total number of frames in the underlying contents.
+    ///
+    /// This counts all frames, not just the ones remaining, and builds the
+    /// index if necessary.
+    pub fn len(&mut self) -> Result<usize, error::ParseError> {
+        Ok(self.build_index()?.len())
+    }
+
+    /// Returns `true` if the underlying contents hold no frames.
+    pub fn is_empty(&mut self) -> Result<bool, error::ParseError> {
+        Ok(self.build_index()?.is_empty())
+    }
+
+    /// Repositions the iterator so that the next call to `next()` yields
+    /// frame `frame_no` (zero-based).
+    ///
+    /// Seeking to `len()` positions the iterator at the end.
+    ///
+    /// # Errors
+    ///
+    /// * `ParseError::FrameOutOfRange` if `frame_no` is greater than `len()`.
+    /// * Propagates any error from building the index.
+    pub fn seek(&mut self, frame_no: usize) -> Result<(), error::ParseError> {
+        let index = self.build_index()?;
+        let offset = match index.get(frame_no) {
+            Some(entry) => entry.offset,
+            None if frame_no == index.len() => index.end(),
+            None => {
+                return Err(error::ParseError::FrameOutOfRange {
+                    requested: frame_no,
+                    available: index.len(),
+                });
+            }
+        };
+        let rest = self.contents.get(offset..).ok_or_else(index::index_mismatch)?;
+        self.lines = rest.lines().peekable();
+        Ok(())
+    }
+
     /// Skips the next frame without fully parsing its atomic data.
     ///
     /// This is more efficient than `next()` if you only need to advance the
-    /// iterator. It reads the frame's header to determine how many lines to skip,
-    /// including any velocity section if present.
+    /// iterator. It parses the frame's header into a borrowed
+    /// [`FrameHeaderRef`](types::FrameHeaderRef), which does not allocate, to
+    /// determine how many lines to skip, including any velocity section if
+    /// present. The header is validated exactly as `next()` would validate it.
     ///
     /// # Returns
     ///
@@ -45,46 +150,16 @@ impl<'a> ConFrameIterator<'a> {
     /// * `Some(Err(ParseError::...))` if there's an error parsing the header.
     /// * `None` if the iterator is already at the end.
     pub fn forward(&mut self) -> Option<Result<(), error::ParseError>> {
-        // Skip frame by parsing only required header fields to avoid full parsing overhead
         if self.lines.peek().is_none() {
             return None;
         }
-
-        // Manually consume the first 6 lines of the header, which we don't need for skipping.
-        for _ in 0..6 {
-            if self.lines.next().is_none() {
-                return Some(Err(error::ParseError::IncompleteHeader));
-            }
-        }
-
-        // Line 7: natm_types. We need to parse this.
-        let natm_types: usize = match self.lines.next() {
-            Some(line) => match crate::parser::parse_line_of_n::<usize>(line, 1) {
-                Ok(v) => v[0],
-                Err(e) => return Some(Err(e)),
-            },
-            None => return Some(Err(error::ParseError::IncompleteHeader)),
-        };
-
-        // Line 8: natms_per_type. We need this to sum the total number of atoms.
-        let natms_per_type: Vec<usize> = match self.lines.next() {
-            Some(line) => match crate::parser::parse_line_of_n(line, natm_types) {
-                Ok(v) => v,
-                Err(e) => return Some(Err(e)),
-            },
-            None => return Some(Err(error::ParseError::IncompleteHeader)),
+        let header = match parse_frame_header_ref(&mut self.lines) {
+            Ok(h) => h,
+            Err(e) => return Some(Err(e)),
         };
 
-        // Line 9: masses_per_type. We just need to consume this line.
-        if self.lines.next().is_none() {
-            return Some(Err(error::ParseError::IncompleteHeader));
-        }
-
-        // Calculate how many more lines to skip for coordinate blocks.
-        let total_atoms: usize = natms_per_type.iter().sum();
         // For each atom type, there is a symbol line and a "Coordinates..." line.
-        let non_atom_lines = natm_types * 2;
-        let lines_to_skip = total_atoms + non_atom_lines;
+        let lines_to_skip = header.total_atoms() + header.natm_types * 2;
 
         // Advance the iterator by skipping the coordinate block lines.
         for _ in 0..lines_to_skip {
@@ -100,9 +175,7 @@ impl<'a> ConFrameIterator<'a> {
             if line.trim().is_empty() {
                 // Consume the blank separator
                 self.lines.next();
-                // Skip the velocity blocks: same structure as coordinate blocks
-                let vel_lines_to_skip = total_atoms + non_atom_lines;
-                for _ in 0..vel_lines_to_skip {
+                for _ in 0..lines_to_skip {
                     if self.lines.next().is_none() {
                         return Some(Err(error::ParseError::IncompleteVelocitySection));
                     }
@@ -114,6 +187,67 @@ impl<'a> ConFrameIterator<'a> {
     }
 }
 
+impl ConFrameIterator<'_> {
+    /// Parses the next frame into the columnar `ConFrameSoA` layout.
+    ///
+    /// This is the structure-of-arrays counterpart of `next()` and can be
+    /// freely interleaved with it and with `forward()`. Under non-default
+    /// [`ParseOptions`] the projected frame is converted after parsing.
+    ///
+    /// # Returns
+    ///
+    /// * `Some(Ok(frame))` on a successful parse.
+    /// * `Some(Err(ParseError::...))` if the frame is malformed.
+    /// * `None` if the iterator is already at the end.
+    pub fn next_soa(&mut self) -> Option<Result<types::ConFrameSoA, error::ParseError>> {
+        if !self.options.is_full() {
+            return self.next().map(|r| r.map(|f| types::ConFrameSoA::from(&f)));
+        }
+        self.lines.peek()?;
+        let mut frame = match parse_single_frame_soa(&mut self.lines) {
+            Ok(f) => f,
+            Err(e) => return Some(Err(e)),
+        };
+        if let Err(e) =
+            parse_velocity_section_soa(&mut self.lines, &frame.header, &mut frame.columns)
+        {
+            return Some(Err(e));
+        }
+        Some(Ok(frame))
+    }
+
+    /// Parses the next frame into `frame`, reusing its allocations.
+    ///
+    /// This is the buffer-recycling counterpart of `next()`: the header
+    /// strings, per-type vectors and atom vector of `frame` keep their
+    /// capacity, and unchanged component symbols are kept as-is. Streaming a
+    /// trajectory with a constant atom count through one `ConFrame` therefore
+    /// allocates only for the first frame.
+    ///
+    /// # Returns
+    ///
+    /// * `Some(Ok(()))` if `frame` now holds the next frame.
+    /// * `Some(Err(ParseError::...))` if the frame is malformed; the contents
+    ///   of `frame` are then unspecified.
+    /// * `None` if the iterator is already at the end; `frame` is untouched.
+    ///
+    /// Under non-default [`ParseOptions`] the projected frame replaces
+    /// `frame` rather than reusing it.
+    pub fn next_into(&mut self, frame: &mut types::ConFrame) -> Option<Result<(), error::ParseError>> {
+        if !self.options.is_full() {
+            return Some(self.next()?.map(|parsed| *frame = parsed));
+        }
+        self.lines.peek()?;
+        if let Err(e) = parse_single_frame_into(&mut self.lines, frame) {
+            return Some(Err(e));
+        }
+        match parse_velocity_section(&mut self.lines, &frame.header, &mut frame.atom_data) {
+            Ok(_) => Some(Ok(())),
+            Err(e) => Some(Err(e)),
+        }
+    }
+}
+
 impl<'a> Iterator for ConFrameIterator<'a> {
     /// The type of item yielded by the iterator.
     ///
@@ -131,6 +265,9 @@ impl<'a> Iterator for ConFrameIterator<'a> {
         if self.lines.peek().is_none() {
             return None;
         }
+        if !self.options.is_full() {
+            return Some(parse_single_frame_with(&mut self.lines, &self.options));
+        }
         // Otherwise, attempt to parse the next frame from the available lines.
         let mut frame = match parse_single_frame(&mut self.lines) {
             Ok(f) => f,
@@ -151,23 +288,63 @@ impl<'a> Iterator for ConFrameIterator<'a> {
 /// 64 KiB is a conservative cutoff used by ripgrep and similar tools.
 const MMAP_THRESHOLD: u64 = 64 * 1024;
 
-/// Reads file contents, choosing between `read_to_string` (small files) and
-/// mmap (large files) based on [`MMAP_THRESHOLD`].
+/// Reads file contents, choosing between `read` (small files) and mmap
+/// (large files) based on [`MMAP_THRESHOLD`].
+///
+/// Small files must be valid UTF-8 unless they are `.conb` files, which are
+/// kept as raw bytes. Compressed files (by extension) are decompressed
+/// whole into an owned string.
 fn read_file_contents(path: &Path) -> Result<FileContents, Box<dyn std::error::Error>> {
+    match Compression::from_path(path).check_supported()? {
+        Compression::None => {}
+        #[cfg(feature = "compression")]
+        c => {
+            let raw = read_raw_contents(path)?;
+            return Ok(FileContents::Owned(compression::decompress_all(raw.as_bytes(), c)?));
+        }
+        #[cfg(not(feature = "compression"))]
+        _ => unreachable!("rejected by check_supported"),
+    }
     let file = std::fs::File::open(path)?;
     let metadata = file.metadata()?;
     if metadata.len() < MMAP_THRESHOLD {
-        let contents = std::fs::read_to_string(path)?;
-        Ok(FileContents::Owned(contents))
+        match String::from_utf8(std::fs::read(path)?) {
+            Ok(contents) => Ok(FileContents::Owned(contents)),
+            Err(e) if conb::is_conb(e.as_bytes()) => Ok(FileContents::Bytes(e.into_bytes())),
+            Err(e) => Err(Box::new(e.utf8_error())),
+        }
     } else {
         let mmap = unsafe { memmap2::Mmap::map(&file)? };
         Ok(FileContents::Mapped(mmap))
     }
 }
 
-/// Holds file contents either as an owned String or a memory-mapped region.
+/// Reads file contents without any UTF-8 requirement, for compressed input.
+#[cfg(feature = "compression")]
+fn read_raw_contents(path: &Path) -> std::io::Result<FileContents> {
+    let file = std::fs::File::open(path)?;
+    if file.metadata()?.len() < MMAP_THRESHOLD {
+        Ok(FileContents::Bytes(std::fs::read(path)?))
+    } else {
+        Ok(FileContents::Mapped(unsafe { memmap2::Mmap::map(&file)? }))
+    }
+}
+
+/// Reading state for a seekable zstd file: one decompressed group at a time.
+#[cfg(feature = "compression")]
+struct CompressedGroups {
+    table: compression::SeekTable,
+    /// Group to decompress once `text` is used up.
+    next_group: usize,
+    text: String,
+    pos: usize,
+}
+
+/// Holds file contents as an owned String, owned `.conb` bytes, or a
+/// memory-mapped region.
 enum FileContents {
     Owned(String),
+    Bytes(Vec<u8>),
     Mapped(memmap2::Mmap),
 }
 
@@ -175,9 +352,595 @@ impl FileContents {
     fn as_str(&self) -> Result<&str, std::str::Utf8Error> {
         match self {
             FileContents::Owned(s) => Ok(s.as_str()),
+            FileContents::Bytes(b) => std::str::from_utf8(b),
             FileContents::Mapped(m) => std::str::from_utf8(m),
         }
     }
+
+    fn as_bytes(&self) -> &[u8] {
+        match self {
+            FileContents::Owned(s) => s.as_bytes(),
+            FileContents::Bytes(b) => b,
+            FileContents::Mapped(m) => m,
+        }
+    }
+
+    /// Returns `true` if the contents are in the binary `.conb` format.
+    fn is_conb(&self) -> bool {
+        conb::is_conb(self.as_bytes())
+    }
+
+    /// Returns a line-aligned sub-range as `&str`, validating UTF-8 only for
+    /// mapped contents (owned contents were validated by `read_to_string`).
+    /// A range outside the contents, or splitting a character, means the
+    /// index does not belong to them.
+    fn str_range(&self, range: Range<usize>) -> Result<&str, error::ParseError> {
+        match self {
+            FileContents::Owned(s) => s.get(range).ok_or_else(index::index_mismatch),
+            _ => {
+                let bytes = self
+                    .as_bytes()
+                    .get(range.clone())
+                    .ok_or_else(index::index_mismatch)?;
+                std::str::from_utf8(bytes).map_err(|e| error::ParseError::InvalidUtf8 {
+                    offset: range.start + e.valid_up_to(),
+                })
+            }
+        }
+    }
+
+    /// Tells the kernel the mapping will be read front to back, enabling
+    /// aggressive readahead. A no-op for owned contents and non-Unix targets.
+    fn advise_sequential(&self) {
+        #[cfg(unix)]
+        if let FileContents::Mapped(m) = self {
+            let _ = m.advise(memmap2::Advice::Sequential);
+        }
+    }
+
+    /// Asks the kernel to start paging in `len` bytes from `offset`.
+    /// A no-op for owned contents and non-Unix targets.
+    fn advise_willneed(&self, offset: usize, len: usize) {
+        #[cfg(unix)]
+        if let FileContents::Mapped(m) = self {
+            let len = len.min(m.len().saturating_sub(offset));
+            if len > 0 {
+                let _ = m.advise_range(memmap2::Advice::WillNeed, offset, len);
+            }
+        }
+        #[cfg(not(unix))]
+        let _ = (offset, len);
+    }
+}
+
+/// A frame iterator that owns the contents of a file.
+///
+/// Unlike [`ConFrameIterator`], it does not need the whole file as a `&str`:
+/// files above [`MMAP_THRESHOLD`] are memory-mapped and UTF-8 is validated one
+/// frame at a time, just before the frame is parsed. The time to the first
+/// frame therefore does not depend on the file size, and only pages that have
+/// been consumed need to be resident. The mapping is advised as sequential,
+/// and the expected extent of the next frame is prefetched as each frame is
+/// yielded.
+///
+/// Frame boundaries are found with the same header-only scan that builds a
+/// [`FrameIndex`]; `seek()` and `len()` work as on [`ConFrameIterator`].
+///
+/// `.conb` files are detected by their magic bytes; their offset table
+/// serves as the index and frames are decoded instead of parsed.
+///
+/// Compressed files are recognised by extension (`compression` feature).
+/// zstd files written by [`crate::writer::ConFrameWriter`] carry a seek
+/// table, so they are decompressed one frame group at a time and `len()`
+/// and `seek()` use the table without decompressing ahead; other
+/// compressed files are decompressed whole on open.
+pub struct ConFrameFileIterator {
+    path: PathBuf,
+    contents: FileContents,
+    pos: usize,
+    index: Option<FrameIndex>,
+    binary: bool,
+    /// Shared so that a frame's text can be parsed while borrowed from `self`.
+    options: Arc<ParseOptions>,
+    #[cfg(feature = "compression")]
+    groups: Option<CompressedGroups>,
+}
+
+impl ConFrameFileIterator {
+    /// Opens a `.con`, `.convel` or `.conb` file for iteration.
+    pub fn open(path: &Path) -> Result<Self, Box<dyn std::error::Error>> {
+        #[cfg(feature = "compression")]
+        if Compression::from_path(path) == Compression::Zstd {
+            let raw = read_raw_contents(path)?;
+            if let Some(table) = compression::SeekTable::read(raw.as_bytes()) {
+                return Ok(ConFrameFileIterator {
+                    path: path.to_path_buf(),
+                    contents: raw,
+                    pos: 0,
+                    index: None,
+                    binary: false,
+                    options: Arc::default(),
+                    groups: Some(CompressedGroups {
+                        table,
+                        next_group: 0,
+                        text: String::new(),
+                        pos: 0,
+                    }),
+                });
+            }
+        }
+        let contents = read_file_contents(path)?;
+        contents.advise_sequential();
+        let binary = contents.is_conb();
+        let (pos, index) = if binary {
+            let index = conb::ConbReader::new(contents.as_bytes())?.frame_index();
+            let pos = index.get(0).map_or(index.end(), |e| e.offset);
+            (pos, Some(index))
+        } else {
+            (0, None)
+        };
+        Ok(ConFrameFileIterator {
+            path: path.to_path_buf(),
+            contents,
+            pos,
+            index,
+            binary,
+            options: Arc::default(),
+            #[cfg(feature = "compression")]
+            groups: None,
+        })
+    }
+
+    /// Replaces the [`ParseOptions`] used for subsequent frames.
+    pub fn set_options(&mut self, options: ParseOptions) {
+        self.options = Arc::new(options);
+    }
+
+    /// Returns the options frames are parsed with.
+    pub fn options(&self) -> &ParseOptions {
+        &self.options
+    }
+
+    /// Returns `true` for a seekable zstd file, whose `len()` and `seek()`
+    /// are answered from the compressed file's seek table rather than a
+    /// [`FrameIndex`].
+    pub fn is_seekable_compressed(&self) -> bool {
+        #[cfg(feature = "compression")]
+        return self.groups.is_some();
+        #[cfg(not(feature = "compression"))]
+        false
+    }
+
+    /// Returns the frame index, building it with a header-only scan on first use.
+    ///
+    /// # Errors
+    ///
+    /// Propagates any error from `FrameIndex::build_from_bytes` if a frame is
+    /// malformed.
+    ///
+    /// For seekable zstd files the index is built group by group over the
+    /// decompressed text, which decompresses the whole file once.
+    pub fn build_index(&mut self) -> Result<&FrameIndex, error::ParseError> {
+        if self.index.is_none() {
+            #[cfg(feature = "compression")]
+            if let Some(groups) = &self.groups {
+                self.index = Some(index_groups(self.contents.as_bytes(), &groups.table)?);
+                return Ok(self.index.as_ref().unwrap());
+            }
+            self.index = Some(FrameIndex::build_from_bytes(self.contents.as_bytes())?);
+        }
+        Ok(self.index.as_ref().unwrap())
+    }
+
+    /// Loads the index from the file's `.idx` sidecar if it is current, or
+    /// builds it and tries to write the sidecar (see
+    /// [`FrameIndex::load_or_build`]).
+    pub fn load_or_build_index(&mut self) -> Result<&FrameIndex, Box<dyn std::error::Error>> {
+        if self.is_seekable_compressed() {
+            return Ok(self.build_index()?);
+        }
+        if self.index.is_none() {
+            self.index = Some(FrameIndex::load_or_build(
+                &self.path,
+                self.contents.as_bytes(),
+            )?);
+        }
+        Ok(self.index.as_ref().unwrap())
+    }
+
+    /// Installs a previously built or loaded index.
+    ///
+    /// The index must describe the file this iterator was opened on; check
+    /// a loaded one with [`ConFrameFileIterator::index_fits`].
+    pub fn set_index(&mut self, index: FrameIndex) {
+        self.index = Some(index);
+    }
+
+    /// Returns `true` if `index` [fits](FrameIndex::fits) this file's
+    /// contents.
+    pub fn index_fits(&self, index: &FrameIndex) -> bool {
+        index.fits(self.contents.as_bytes())
+    }
+
+    /// Returns the index if it has already been built or installed.
+    pub fn index(&self) -> Option<&FrameIndex> {
+        self.index.as_ref()
+    }
+
+    /// Returns the total number of frames in the file, building the index if
+    /// necessary.
+    pub fn len(&mut self) -> Result<usize, error::ParseError> {
+        #[cfg(feature = "compression")]
+        if let Some(groups) = &self.groups {
+            return Ok(groups.table.num_frames);
+        }
+        Ok(self.build_index()?.len())
+    }
+
+    /// Returns `true` if the file holds no frames.
+    pub fn is_empty(&mut self) -> Result<bool, error::ParseError> {
+        Ok(self.len()? == 0)
+    }
+
+    /// Repositions the iterator so that the next call to `next()` yields
+    /// frame `frame_no` (zero-based). Seeking to `len()` positions the
+    /// iterator at the end.
+    ///
+    /// # Errors
+    ///
+    /// * `ParseError::FrameOutOfRange` if `frame_no` is greater than `len()`.
+    /// * Propagates any error from building the index.
+    pub fn seek(&mut self, frame_no: usize) -> Result<(), error::ParseError> {
+        #[cfg(feature = "compression")]
+        if let Some(groups) = &mut self.groups {
+            return seek_groups(self.contents.as_bytes(), groups, frame_no);
+        }
+        let index = self.build_index()?;
+        self.pos = match index.get(frame_no) {
+            Some(entry) => entry.offset,
+            None if frame_no == index.len() => index.end(),
+            None => {
+                return Err(error::ParseError::FrameOutOfRange {
+                    requested: frame_no,
+                    available: index.len(),
+                });
+            }
+        };
+        Ok(())
+    }
+
+    /// Returns the validated text of the next frame and advances past it.
+    ///
+    /// If the frame boundary cannot be found, the remainder of the file is
+    /// returned so that the parser reports the same error as
+    /// [`ConFrameIterator`] would, and the iterator is left at the end.
+    fn next_frame_text(&mut self) -> Option<Result<&str, error::ParseError>> {
+        debug_assert!(!self.binary);
+        #[cfg(feature = "compression")]
+        if let Some(groups) = &mut self.groups {
+            return next_group_frame_text(self.contents.as_bytes(), groups);
+        }
+        let bytes = self.contents.as_bytes();
+        let start = self.pos;
+        if start >= bytes.len() {
+            return None;
+        }
+        let mut cursor = LineCursor::new(&bytes[start..]);
+        let stop = match index::skip_frame(&mut cursor) {
+            Ok(_) => start + cursor.pos,
+            Err(_) => bytes.len(),
+        };
+        self.pos = stop;
+        // Assume the next frame is about as large as this one.
+        self.contents.advise_willneed(stop, stop - start);
+        Some(self.contents.str_range(start..stop))
+    }
+
+    /// Decodes the `.conb` record at the current position and advances past
+    /// it. After an error the iterator is left at the end.
+    fn next_binary_frame(&mut self) -> Option<Result<types::ConFrame, error::ParseError>> {
+        // Always present for binary files.
+        let end = self.index.as_ref()?.end();
+        if self.pos >= end {
+            return None;
+        }
+        let bytes = &self.contents.as_bytes()[..end];
+        Some(match conb::decode_frame_at(bytes, self.pos) {
+            Ok((frame, stop)) => {
+                self.pos = stop;
+                Ok(frame)
+            }
+            Err(e) => {
+                self.pos = end;
+                Err(e)
+            }
+        })
+    }
+}
+
+/// Returns the text of the next frame of a seekable zstd file,
+/// decompressing the next group when the current one is used up.
+#[cfg(feature = "compression")]
+fn next_group_frame_text<'a>(
+    bytes: &[u8],
+    groups: &'a mut CompressedGroups,
+) -> Option<Result<&'a str, error::ParseError>> {
+    while groups.pos >= groups.text.len() {
+        let group = *groups.table.groups.get(groups.next_group)?;
+        groups.next_group += 1;
+        match compression::decompress_group(bytes, &group) {
+            Ok(text) => groups.text = text,
+            Err(e) => {
+                groups.next_group = groups.table.groups.len();
+                return Some(Err(e));
+            }
+        }
+        groups.pos = 0;
+    }
+    let start = groups.pos;
+    let mut cursor = LineCursor::new(&groups.text.as_bytes()[start..]);
+    let stop = match index::skip_frame(&mut cursor) {
+        Ok(_) => start + cursor.pos,
+        Err(_) => groups.text.len(),
+    };
+    groups.pos = stop;
+    Some(Ok(&groups.text[start..stop]))
+}
+
+/// Positions a seekable zstd file at `frame_no` by decompressing only the
+/// group that holds it.
+#[cfg(feature = "compression")]
+fn seek_groups(
+    bytes: &[u8],
+    groups: &mut CompressedGroups,
+    frame_no: usize,
+) -> Result<(), error::ParseError> {
+    let table = &groups.table;
+    if frame_no == table.num_frames {
+        groups.next_group = table.groups.len();
+        groups.text.clear();
+        groups.pos = 0;
+        return Ok(());
+    }
+    let Some(g) = table.group_of(frame_no) else {
+        return Err(error::ParseError::FrameOutOfRange {
+            requested: frame_no,
+            available: table.num_frames,
+        });
+    };
+    let group = table.groups[g];
+    groups.text = compression::decompress_group(bytes, &group)?;
+    groups.next_group = g + 1;
+    let mut cursor = LineCursor::new(groups.text.as_bytes());
+    for _ in group.first_frame..frame_no {
+        index::skip_frame(&mut cursor)?;
+    }
+    groups.pos = cursor.pos;
+    Ok(())
+}
+
+/// Builds a [`FrameIndex`] over the decompressed text of a seekable zstd
+/// file, one group at a time.
+#[cfg(feature = "compression")]
+fn index_groups(
+    bytes: &[u8],
+    table: &compression::SeekTable,
+) -> Result<FrameIndex, error::ParseError> {
+    let mut entries = Vec::with_capacity(table.num_frames);
+    let mut base = 0;
+    for group in &table.groups {
+        let text = compression::decompress_group(bytes, group)?;
+        let scan = index::scan_frames(text.as_bytes());
+        if let Some(e) = scan.error {
+            return Err(e);
+        }
+        entries.extend(scan.entries.into_iter().map(|e| index::FrameEntry {
+            offset: base + e.offset,
+            ..e
+        }));
+        base += text.len();
+    }
+    Ok(FrameIndex::from_entries(entries, base))
+}
+
+impl ConFrameFileIterator {
+    /// Parses the next frame into `frame`, reusing its allocations.
+    ///
+    /// See [`ConFrameIterator::next_into`]. Frames decoded from `.conb`
+    /// files replace `frame` outright.
+    pub fn next_into(&mut self, frame: &mut types::ConFrame) -> Option<Result<(), error::ParseError>> {
+        if self.binary || !self.options.is_full() {
+            return Some(self.next()?.map(|decoded| *frame = decoded));
+        }
+        let text = match self.next_frame_text()? {
+            Ok(text) => text,
+            Err(e) => return Some(Err(e)),
+        };
+        ConFrameIterator::new(text).next_into(frame)
+    }
+}
+
+impl Iterator for ConFrameFileIterator {
+    type Item = Result<types::ConFrame, error::ParseError>;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        if self.binary {
+            let frame = self.next_binary_frame()?;
+            if self.options.is_full() {
+                return Some(frame);
+            }
+            return Some(frame.map(|f| project_frame(f, &self.options)));
+        }
+        let options = Arc::clone(&self.options);
+        let text = match self.next_frame_text()? {
+            Ok(text) => text,
+            Err(e) => return Some(Err(e)),
+        };
+        if options.is_full() {
+            return ConFrameIterator::new(text).next();
+        }
+        let mut lines = text.lines().peekable();
+        lines.peek()?;
+        Some(parse_single_frame_with(&mut lines, &options))
+    }
+}
+
+/// A frame iterator over any buffered reader, for input that cannot be held
+/// in memory as a whole (pipes, sockets, decompression streams).
+///
+/// Lines are read into a single rolling buffer until one complete frame is
+/// available; the frame is parsed from that buffer and then discarded. The
+/// buffer keeps its capacity, so memory use is bounded by the largest frame
+/// seen rather than by the length of the stream.
+///
+/// Frame extents are determined from the `natm_types` and `natms_per_type`
+/// header lines, exactly as in `ConFrameIterator::forward()`. One line of
+/// look-ahead decides whether a velocity section follows.
+///
+/// I/O errors (including non-UTF-8 input) are yielded as `ParseError::Io`.
+/// After any error the reader yields `None`.
+///
+/// # Example
+///
+/// ```
+/// use readcon_core::iterators::ConFrameStreamReader;
+///
+/// let text = "a\nb\n1 1 1\n90 90 90\nc\nd\n1\n1\n1.0\nH\nCoordinates of Component 1\n0 0 0 0 0\n";
+/// let frames: Vec<_> = ConFrameStreamReader::new(text.as_bytes()).collect();
+/// assert_eq!(frames.len(), 1);
+/// ```
+pub struct ConFrameStreamReader<R> {
+    reader: R,
+    buf: String,
+    /// A line already read into `buf` that belongs to the next frame.
+    carried: Option<Range<usize>>,
+    done: bool,
+}
+
+impl<R: BufRead> ConFrameStreamReader<R> {
+    /// Creates a stream reader; wrap unbuffered sources in `std::io::BufReader`.
+    pub fn new(reader: R) -> Self {
+        ConFrameStreamReader {
+            reader,
+            buf: String::new(),
+            carried: None,
+            done: false,
+        }
+    }
+
+    /// Returns the wrapped reader.
+    pub fn into_inner(self) -> R {
+        self.reader
+    }
+
+    /// Returns the byte range of the next line in `buf`, reading it if needed.
+    fn next_line(&mut self) -> std::io::Result<Option<Range<usize>>> {
+        if let Some(range) = self.carried.take() {
+            return Ok(Some(range));
+        }
+        let start = self.buf.len();
+        if self.reader.read_line(&mut self.buf)? == 0 {
+            return Ok(None);
+        }
+        Ok(Some(start..self.buf.len()))
+    }
+
+    /// Reads `n` further lines, returning `false` at end of input.
+    fn read_lines(&mut self, n: usize) -> std::io::Result<bool> {
+        for _ in 0..n {
+            if self.next_line()?.is_none() {
+                return Ok(false);
+            }
+        }
+        Ok(true)
+    }
+
+    /// Fills `buf` with the next frame and returns its length, or `None` at
+    /// a clean end of input.
+    ///
+    /// If the frame is truncated or its atom counts cannot be read, whatever
+    /// was read is returned as-is and the reader is marked done, so that the
+    /// parser reports the same error `ConFrameIterator` would.
+    fn fill_frame(&mut self) -> std::io::Result<Option<usize>> {
+        if self.next_line()?.is_none() {
+            return Ok(None);
+        }
+        // prebox2, boxl, angles, postbox1, postbox2
+        if !self.read_lines(5)? {
+            self.done = true;
+            return Ok(Some(self.buf.len()));
+        }
+        let natm_types = match self.next_line()? {
+            Some(r) => crate::parser::parse_line_of_n::<usize>(&self.buf[r], 1).map(|v| v[0]),
+            None => Err(error::ParseError::IncompleteHeader),
+        };
+        let natms_per_type = match (natm_types, self.next_line()?) {
+            (Ok(n), Some(r)) => {
+                crate::parser::parse_line_of_n::<usize>(&self.buf[r], n).map(|v| (n, v))
+            }
+            _ => Err(error::ParseError::IncompleteHeader),
+        };
+        let (natm_types, natms_per_type) = match natms_per_type {
+            Ok(counts) => counts,
+            Err(_) => {
+                self.done = true;
+                return Ok(Some(self.buf.len()));
+            }
+        };
+        let block_lines = natms_per_type.iter().sum::<usize>() + natm_types * 2;
+        // masses_per_type, then the coordinate blocks
+        if !self.read_lines(1 + block_lines)? {
+            self.done = true;
+            return Ok(Some(self.buf.len()));
+        }
+        match self.next_line()? {
+            None => Ok(Some(self.buf.len())),
+            Some(r) if self.buf[r.clone()].trim().is_empty() => {
+                if !self.read_lines(block_lines)? {
+                    self.done = true;
+                }
+                Ok(Some(self.buf.len()))
+            }
+            Some(r) => {
+                let frame_len = r.start;
+                self.carried = Some(r);
+                Ok(Some(frame_len))
+            }
+        }
+    }
+}
+
+impl<R: BufRead> Iterator for ConFrameStreamReader<R> {
+    type Item = Result<types::ConFrame, error::ParseError>;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        if self.done {
+            return None;
+        }
+        let frame_len = match self.fill_frame() {
+            Ok(Some(len)) => len,
+            Ok(None) => {
+                self.done = true;
+                return None;
+            }
+            Err(e) => {
+                self.done = true;
+                return Some(Err(e.into()));
+            }
+        };
+        let result = ConFrameIterator::new(&self.buf[..frame_len])
+            .next()
+            .unwrap_or(Err(error::ParseError::IncompleteFrame));
+        if result.is_err() {
+            self.done = true;
+        }
+        // Keep only the carried look-ahead line, shifted to the front.
+        self.buf.drain(..frame_len);
+        if let Some(r) = self.carried.as_mut() {
+            *r = r.start - frame_len..r.end - frame_len;
+        }
+        Some(result)
+    }
 }
 
 /// Reads all frames from a file.
@@ -185,9 +948,14 @@ impl FileContents {
 /// For files smaller than 64 KiB, uses a simple `read_to_string` to avoid
 /// the fixed overhead of mmap (VMA creation, page fault, munmap). For larger
 /// trajectory files, uses memory-mapped I/O to let the OS page cache handle
-/// the data.
+/// the data. `.conb` files are detected and decoded from their records.
 pub fn read_all_frames(path: &Path) -> Result<Vec<types::ConFrame>, Box<dyn std::error::Error>> {
     let contents = read_file_contents(path)?;
+    contents.advise_sequential();
+    if contents.is_conb() {
+        let frames: Result<Vec<_>, _> = conb::ConbReader::new(contents.as_bytes())?.frames().collect();
+        return Ok(frames?);
+    }
     let text = contents.as_str()?;
     let iter = ConFrameIterator::new(text);
     let frames: Result<Vec<_>, _> = iter.collect();
@@ -199,7 +967,24 @@ pub fn read_all_frames(path: &Path) -> Result<Vec<types::ConFrame>, Box<dyn std:
 /// More efficient than `read_all_frames` for single-frame access because it
 /// stops parsing after the first frame rather than collecting all of them.
 pub fn read_first_frame(path: &Path) -> Result<types::ConFrame, Box<dyn std::error::Error>> {
+    // Compressed input is decompressed only as far as the first frame.
+    #[cfg(feature = "compression")]
+    if let c @ (Compression::Gzip | Compression::Zstd) = Compression::from_path(path) {
+        let file = std::io::BufReader::new(std::fs::File::open(path)?);
+        return match ConFrameStreamReader::new(compression::decoder(file, c)?).next() {
+            Some(Ok(frame)) => Ok(frame),
+            Some(Err(e)) => Err(Box::new(e)),
+            None => Err("No frames found in file".into()),
+        };
+    }
     let contents = read_file_contents(path)?;
+    if contents.is_conb() {
+        let reader = conb::ConbReader::new(contents.as_bytes())?;
+        if reader.is_empty() {
+            return Err("No frames found in file".into());
+        }
+        return Ok(reader.frame(0)?);
+    }
     let text = contents.as_str()?;
     let mut iter = ConFrameIterator::new(text);
     match iter.next() {
@@ -209,11 +994,74 @@ pub fn read_first_frame(path: &Path) -> Result<types::ConFrame, Box<dyn std::err
     }
 }
 
+/// Reads all frames from a file, parsing them in parallel.
+///
+/// Uses the same `read_to_string`/mmap split as [`read_all_frames`], then
+/// hands the text to [`parse_frames_parallel`] on a dedicated rayon pool of
+/// `n_threads` workers, so callers sharing a node (e.g. several MPI ranks)
+/// can stay within their core allotment. `n_threads == 0` uses rayon's
+/// default of one thread per logical CPU. `.conb` records are decoded on
+/// the same pool, as are the frame groups of seekable zstd files.
+///
+/// Requires the `parallel` feature.
+#[cfg(feature = "parallel")]
+pub fn read_all_frames_parallel(
+    path: &Path,
+    n_threads: usize,
+) -> Result<Vec<types::ConFrame>, Box<dyn std::error::Error>> {
+    use rayon::prelude::*;
+
+    let pool = rayon::ThreadPoolBuilder::new()
+        .num_threads(n_threads)
+        .build()?;
+    #[cfg(feature = "compression")]
+    if Compression::from_path(path) == Compression::Zstd {
+        let raw = read_raw_contents(path)?;
+        if let Some(table) = compression::SeekTable::read(raw.as_bytes()) {
+            let groups: Result<Vec<Vec<_>>, error::ParseError> = pool.install(|| {
+                table
+                    .groups
+                    .par_iter()
+                    .map(|group| {
+                        let text = compression::decompress_group(raw.as_bytes(), group)?;
+                        ConFrameIterator::new(&text).collect()
+                    })
+                    .collect()
+            });
+            return Ok(groups?.into_iter().flatten().collect());
+        }
+    }
+    let contents = read_file_contents(path)?;
+    // Workers touch the whole file at once, out of order.
+    contents.advise_willneed(0, usize::MAX);
+    if contents.is_conb() {
+        let reader = conb::ConbReader::new(contents.as_bytes())?;
+        let frames: Result<Vec<_>, _> = pool.install(|| {
+            (0..reader.len())
+                .into_par_iter()
+                .map(|i| reader.frame(i))
+                .collect()
+        });
+        return Ok(frames?);
+    }
+    let text = contents.as_str()?;
+    let frames: Result<Vec<_>, _> = pool
+        .install(|| parse_frames_parallel(text))
+        .into_iter()
+        .collect();
+    Ok(frames?)
+}
+
 /// Parses frames in parallel using rayon, splitting on frame boundaries.
 ///
-/// Phase 1: sequential scan to find byte offsets of each frame's start.
+/// Phase 1: a single O(n) byte-level scan finds each frame's start, parsing
+/// only the header lines and skipping atom blocks by counting newlines (see
+/// [`FrameIndex`]).
 /// Phase 2: parallel parse of each frame slice using rayon.
 ///
+/// If the scan hits a malformed frame, everything from that frame onwards is
+/// handed to phase 2 as one final chunk, so its error is reported in order.
+///
 /// Requires the `parallel` feature.
 #[cfg(feature = "parallel")]
 pub fn parse_frames_parallel(
@@ -221,100 +1069,145 @@ pub fn parse_frames_parallel(
 ) -> Vec<Result<types::ConFrame, error::ParseError>> {
     use rayon::prelude::*;
 
-    // Phase 1: find frame byte boundaries by scanning for header patterns.
-    // Each frame starts with a header: 2 comment lines, then a line with 3 floats (box).
-    // We identify boundaries by walking through the file with a ConFrameIterator
-    // and recording byte positions.
-    let mut boundaries: Vec<usize> = Vec::new();
-    let mut offset = 0;
-    boundaries.push(0);
-
-    // Walk through the file using the forward() method to find frame boundaries
-    let mut scanner = ConFrameIterator::new(file_contents);
-    while scanner.forward().is_some() {
-        // After forward(), the internal iterator is positioned right after the frame.
-        // We need to figure out the byte offset of the next frame start.
-        // Since Peekable<Lines> doesn't expose byte offsets, we use a different approach:
-        // count lines consumed per frame and convert to byte offsets.
-    }
-
-    // Simpler approach: split into frame text chunks by parsing sequentially,
-    // recording where each frame starts and ends in the string.
-    boundaries.clear();
-    let lines: Vec<&str> = file_contents.lines().collect();
-    let mut line_idx = 0;
-    let total_lines = lines.len();
-
-    while line_idx < total_lines {
-        // Record the byte offset of this frame's start
-        let byte_offset: usize = lines[..line_idx]
-            .iter()
-            .map(|l| l.len() + 1) // +1 for newline
-            .sum();
-        boundaries.push(byte_offset);
-
-        // Skip 6 header lines (prebox1, prebox2, boxl, angles, postbox1, postbox2)
-        if line_idx + 6 >= total_lines {
-            break;
-        }
-        line_idx += 6;
-
-        // Line 7: natm_types
-        let natm_types: usize = match lines.get(line_idx) {
-            Some(l) => match crate::parser::parse_line_of_n::<usize>(l, 1) {
-                Ok(v) => v[0],
-                Err(_) => break,
-            },
-            None => break,
+    // Phase 1: find frame byte boundaries.
+    let chunks = frame_chunks(file_contents);
+
+    // Phase 2: parallel parse each frame chunk
+    chunks
+        .into_par_iter()
+        .map(|range| parse_chunk(&file_contents[range]))
+        .collect()
+}
+
+/// Byte ranges of every frame of `file_contents`, from the boundary scan.
+/// If the scan hits a malformed frame, the rest of the text is one final
+/// range.
+#[cfg(feature = "parallel")]
+fn frame_chunks(file_contents: &str) -> Vec<Range<usize>> {
+    let scan = crate::index::scan_frames(file_contents.as_bytes());
+    let mut chunks: Vec<Range<usize>> = scan
+        .entries
+        .iter()
+        .zip(scan.entries.iter().skip(1).map(|e| e.offset).chain([scan.end]))
+        .map(|(entry, stop)| entry.offset..stop)
+        .collect();
+    if scan.error.is_some() {
+        chunks.push(scan.end..file_contents.len());
+    }
+    chunks
+}
+
+/// Parses the single frame in `text`, one range from [`frame_chunks`].
+#[cfg(feature = "parallel")]
+fn parse_chunk(text: &str) -> Result<types::ConFrame, error::ParseError> {
+    match ConFrameIterator::new(text).next() {
+        Some(result) => result,
+        None => Err(error::ParseError::IncompleteFrame),
+    }
+}
+
+/// Parses every frame of a file and hands each one to `f` as soon as it is
+/// ready, together with its index in the file.
+///
+/// With the `parallel` feature, frames are parsed and passed to `f` on a
+/// dedicated rayon pool of `n_threads` workers (0 means one per logical
+/// CPU), so `f` runs concurrently and sees frames in no particular order;
+/// nothing is collected, so memory stays at about one frame per worker.
+/// Without the feature, frames are parsed and delivered in order on the
+/// calling thread and `n_threads` is ignored. Text, `.conb` and compressed
+/// files are read as by [`read_all_frames_parallel`].
+///
+/// `f` returns [`ControlFlow::Break`] to stop early, in which case
+/// `Ok(ControlFlow::Break(()))` is returned once in-flight frames are done.
+/// On a parse error, frames other than the failing one may or may not have
+/// been delivered.
+///
+/// ```no_run
+/// use readcon_core::iterators::for_each_frame;
+/// use std::ops::ControlFlow;
+/// use std::path::Path;
+/// use std::sync::atomic::{AtomicUsize, Ordering};
+///
+/// let atoms = AtomicUsize::new(0);
+/// for_each_frame(Path::new("traj.con"), 4, |_frame_no, frame| {
+///     atoms.fetch_add(frame.atom_data.len(), Ordering::Relaxed);
+///     ControlFlow::Continue(())
+/// })
+/// .unwrap();
+/// ```
+pub fn for_each_frame<F>(
+    path: &Path,
+    n_threads: usize,
+    f: F,
+) -> Result<ControlFlow<()>, Box<dyn std::error::Error>>
+where
+    F: Fn(usize, types::ConFrame) -> ControlFlow<()> + Sync,
+{
+    #[cfg(feature = "parallel")]
+    {
+        use rayon::prelude::*;
+
+        enum Stop {
+            Parse(error::ParseError),
+            Break,
+        }
+        let deliver = |frame_no: usize, frame: Result<types::ConFrame, error::ParseError>| {
+            match f(frame_no, frame.map_err(Stop::Parse)?) {
+                ControlFlow::Continue(()) => Ok(()),
+                ControlFlow::Break(()) => Err(Stop::Break),
+            }
         };
-        line_idx += 1;
-
-        // Line 8: natms_per_type
-        let natms_per_type: Vec<usize> = match lines.get(line_idx) {
-            Some(l) => match crate::parser::parse_line_of_n(l, natm_types) {
-                Ok(v) => v,
-                Err(_) => break,
-            },
-            None => break,
+        let finish = |outcome: Result<(), Stop>| match outcome {
+            Ok(()) => Ok(ControlFlow::Continue(())),
+            Err(Stop::Break) => Ok(ControlFlow::Break(())),
+            Err(Stop::Parse(e)) => Err(e.into()),
         };
-        line_idx += 1;
-
-        // Line 9: masses (just skip)
-        line_idx += 1;
-
-        // Skip coordinate blocks
-        let total_atoms: usize = natms_per_type.iter().sum();
-        let coord_lines = total_atoms + natm_types * 2;
-        line_idx += coord_lines;
-
-        // Check for velocity section (blank separator)
-        if line_idx < total_lines {
-            if let Some(l) = lines.get(line_idx) {
-                if l.trim().is_empty() {
-                    line_idx += 1; // blank separator
-                    line_idx += coord_lines; // velocity blocks same size
-                }
+
+        let pool = rayon::ThreadPoolBuilder::new()
+            .num_threads(n_threads)
+            .build()?;
+        #[cfg(feature = "compression")]
+        if Compression::from_path(path) == Compression::Zstd {
+            let raw = read_raw_contents(path)?;
+            if let Some(table) = compression::SeekTable::read(raw.as_bytes()) {
+                return finish(pool.install(|| {
+                    table.groups.par_iter().try_for_each(|group| {
+                        let text = compression::decompress_group(raw.as_bytes(), group)
+                            .map_err(Stop::Parse)?;
+                        ConFrameIterator::new(&text)
+                            .enumerate()
+                            .try_for_each(|(k, frame)| deliver(group.first_frame + k, frame))
+                    })
+                }));
             }
         }
+        let contents = read_file_contents(path)?;
+        contents.advise_willneed(0, usize::MAX);
+        if contents.is_conb() {
+            let reader = conb::ConbReader::new(contents.as_bytes())?;
+            return finish(pool.install(|| {
+                (0..reader.len())
+                    .into_par_iter()
+                    .try_for_each(|i| deliver(i, reader.frame(i)))
+            }));
+        }
+        let text = contents.as_str()?;
+        let chunks = frame_chunks(text);
+        finish(pool.install(|| {
+            chunks
+                .into_par_iter()
+                .enumerate()
+                .try_for_each(|(i, range)| deliver(i, parse_chunk(&text[range])))
+        }))
     }
-
-    // Phase 2: parallel parse each frame chunk
-    let num_frames = boundaries.len();
-    (0..num_frames)
-        .into_par_iter()
-        .map(|i| {
-            let start = boundaries[i];
-            let end = if i + 1 < num_frames {
-                boundaries[i + 1]
-            } else {
-                file_contents.len()
-            };
-            let chunk = &file_contents[start..end];
-            let mut iter = ConFrameIterator::new(chunk);
-            match iter.next() {
-                Some(result) => result,
-                None => Err(error::ParseError::IncompleteFrame),
+    #[cfg(not(feature = "parallel"))]
+    {
+        let _ = n_threads;
+        for (frame_no, frame) in ConFrameFileIterator::open(path)?.enumerate() {
+            if f(frame_no, frame?).is_break() {
+                return Ok(ControlFlow::Break(()));
             }
-        })
-        .collect()
+        }
+        Ok(ControlFlow::Continue(()))
+    }
 }
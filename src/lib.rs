@@ -1,8 +1,15 @@
+pub mod async_writer;
+pub mod compression;
+pub mod conb;
 pub mod error;
 pub mod ffi;
 pub mod helpers;
+pub mod index;
 pub mod iterators;
+mod numfmt;
 pub mod parser;
+pub mod stats;
+pub mod trajectory;
 pub mod types;
 pub mod writer;
 
@@ -1,3 +1,4 @@
+use readcon_core::conb::{self, ConbReader, ConbWriter};
 use readcon_core::iterators::ConFrameIterator;
 use readcon_core::types::ConFrame;
 use readcon_core::writer::ConFrameWriter;
@@ -7,11 +8,24 @@ use std::path::Path;
 
 fn main() {
     let args: Vec<String> = env::args().collect();
-    // One mandatory argument (input) and one optional (output).
-    if args.len() < 2 || args.len() > 3 {
-        eprintln!("Usage: {} <input.con> [output.con]", args[0]);
+    // One mandatory argument (input), an optional output and precision.
+    // Either file may be a binary .conb; the output format follows its
+    // extension and the input format is detected.
+    if args.len() < 2 || args.len() > 4 {
+        eprintln!(
+            "Usage: {} <input.con|input.conb> [output.con|output.conb] [precision]",
+            args[0]
+        );
         std::process::exit(1);
     }
+    let precision: usize = match args.get(3).map(|p| p.parse()) {
+        None => 6,
+        Some(Ok(p)) => p,
+        Some(Err(_)) => {
+            eprintln!("Error: precision must be a non-negative integer.");
+            std::process::exit(1);
+        }
+    };
 
     // --- Reading Logic ---
     let input_fname = Path::new(&args[1]);
@@ -21,19 +35,26 @@ fn main() {
     }
 
     println!("-> Reading from '{}'...", input_fname.display());
-    let fdat = fs::read_to_string(input_fname).expect("Failed to read input file.");
-    let parser = ConFrameIterator::new(&fdat);
+    let fdat = fs::read(input_fname).expect("Failed to read input file.");
+    let keep_valid = |result: Result<ConFrame, _>| match result {
+        Ok(frame) => Some(frame),
+        Err(e) => {
+            eprintln!("-> Note: Discarding an incomplete frame. Error: {:?}", e);
+            None
+        }
+    };
 
     // Collect all valid frames from the input file.
-    let all_frames: Vec<ConFrame> = parser
-        .filter_map(|result| match result {
-            Ok(frame) => Some(frame),
-            Err(e) => {
-                eprintln!("-> Note: Discarding an incomplete frame. Error: {:?}", e);
-                None
-            }
-        })
-        .collect();
+    let all_frames: Vec<ConFrame> = if conb::is_conb(&fdat) {
+        let reader = ConbReader::new(&fdat).unwrap_or_else(|e| {
+            eprintln!("Error: {}", e);
+            std::process::exit(1);
+        });
+        reader.frames().filter_map(keep_valid).collect()
+    } else {
+        let text = std::str::from_utf8(&fdat).expect("Input file is not valid UTF-8.");
+        ConFrameIterator::new(text).filter_map(keep_valid).collect()
+    };
 
     if all_frames.is_empty() {
         eprintln!("Error: No valid frames found in the input file.");
@@ -62,16 +83,18 @@ fn main() {
     if let Some(output_fname_str) = args.get(2) {
         println!("\n-> Writing all frames to '{}'...", output_fname_str);
 
-        // Use the new, more ergonomic writer API.
-        match ConFrameWriter::from_path(output_fname_str) {
-            Ok(mut writer) => {
-                if let Err(e) = writer.extend(all_frames.iter()) {
-                    eprintln!("Error writing to output file: {}", e);
-                } else {
-                    println!("-> Successfully wrote all frames to the output file.");
-                }
-            }
-            Err(e) => eprintln!("Failed to create output file: {}", e),
+        let written = if output_fname_str.ends_with(".conb") {
+            ConbWriter::from_path(output_fname_str).and_then(|mut writer| {
+                writer.extend(all_frames.iter())?;
+                writer.finish().map(drop)
+            })
+        } else {
+            ConFrameWriter::from_path_with_precision(output_fname_str, precision)
+                .and_then(|mut writer| writer.extend(all_frames.iter()))
+        };
+        match written {
+            Ok(()) => println!("-> Successfully wrote all frames to the output file."),
+            Err(e) => eprintln!("Error writing to output file: {}", e),
         }
     }
 }
@@ -0,0 +1,253 @@
+//! Allocation-free number formatting for the writer.
+//!
+//! `push_fixed` reproduces `format!("{:.prec$}", x)` byte for byte without
+//! going through `core::fmt`. For precisions up to `MAX_FAST_PRECISION` the
+//! exact binary value of `x` is scaled by `10^prec` in 128-bit integer
+//! arithmetic and rounded half-to-even, which is exactly what the standard
+//! library's exact-mode formatter does. Non-finite values, precisions beyond
+//! the table, and magnitudes whose scaled value overflows `u64` fall back to
+//! `write!`.
+
+use std::io::Write;
+
+/// Largest precision served by the integer fast path.
+pub(crate) const MAX_FAST_PRECISION: usize = 17;
+
+const POW10: [u64; MAX_FAST_PRECISION + 1] = [
+    1,
+    10,
+    100,
+    1_000,
+    10_000,
+    100_000,
+    1_000_000,
+    10_000_000,
+    100_000_000,
+    1_000_000_000,
+    10_000_000_000,
+    100_000_000_000,
+    1_000_000_000_000,
+    10_000_000_000_000,
+    100_000_000_000_000,
+    1_000_000_000_000_000,
+    10_000_000_000_000_000,
+    100_000_000_000_000_000,
+];
+
+/// "00" .. "99", two ASCII digits per entry.
+const DIGIT_PAIRS: &[u8; 200] = b"\
+0001020304050607080910111213141516171819\
+2021222324252627282930313233343536373839\
+4041424344454647484950515253545556575859\
+6061626364656667686970717273747576777879\
+8081828384858687888990919293949596979899";
+
+/// Writes exactly `width` decimal digits of `n` (zero padded) into `out`,
+/// which must be `width` bytes long. Digits beyond `width` are dropped.
+#[inline]
+fn fill_digits(out: &mut [u8], mut n: u64) {
+    let mut i = out.len();
+    while i >= 2 {
+        let pair = (n % 100) as usize * 2;
+        n /= 100;
+        out[i - 2..i].copy_from_slice(&DIGIT_PAIRS[pair..pair + 2]);
+        i -= 2;
+    }
+    if i == 1 {
+        out[0] = b'0' + (n % 10) as u8;
+    }
+}
+
+#[inline]
+fn decimal_len(n: u64) -> usize {
+    // u64 values reach 20 digits, past the end of POW10.
+    let mut len = 1;
+    let mut t = n;
+    while t >= 10_000 {
+        t /= 10_000;
+        len += 4;
+    }
+    while t >= 10 {
+        t /= 10;
+        len += 1;
+    }
+    len
+}
+
+/// Appends the decimal representation of `n`, as `{}` would print it.
+#[inline]
+pub(crate) fn push_u64(buf: &mut Vec<u8>, n: u64) {
+    let len = decimal_len(n);
+    let start = buf.len();
+    buf.resize(start + len, 0);
+    fill_digits(&mut buf[start..], n);
+}
+
+/// Scales the exact value of the finite, non-negative `x` by `10^prec` and
+/// rounds half-to-even. Returns `None` if the result does not fit in `u64`.
+#[inline]
+fn scaled_round(x: f64, prec: usize) -> Option<u64> {
+    let bits = x.to_bits();
+    let biased_exp = ((bits >> 52) & 0x7ff) as i32;
+    let fraction = bits & ((1u64 << 52) - 1);
+    let (mant, exp) = if biased_exp == 0 {
+        (fraction, -1074)
+    } else {
+        (fraction | (1u64 << 52), biased_exp - 1075)
+    };
+    // mant < 2^53 and 10^17 < 2^57, so the product fits comfortably.
+    let prod = mant as u128 * POW10[prec] as u128;
+    let q = if exp >= 0 {
+        if exp >= 64 || prod.leading_zeros() <= exp as u32 + 64 {
+            return None;
+        }
+        prod << exp
+    } else {
+        let shift = (-exp) as u32;
+        if shift >= 128 {
+            // prod < 2^110 lies below half of 2^shift: rounds to zero.
+            0
+        } else {
+            let q = prod >> shift;
+            let rem = prod & ((1u128 << shift) - 1);
+            let half = 1u128 << (shift - 1);
+            if rem > half || (rem == half && q & 1 == 1) {
+                q + 1
+            } else {
+                q
+            }
+        }
+    };
+    u64::try_from(q).ok()
+}
+
+/// Appends `x` formatted as `{:.prec$}` would print it.
+#[inline]
+pub(crate) fn push_fixed(buf: &mut Vec<u8>, x: f64, prec: usize) {
+    if prec <= MAX_FAST_PRECISION && x.is_finite() {
+        if let Some(q) = scaled_round(x.abs(), prec) {
+            let scale = POW10[prec];
+            let int_part = q / scale;
+            let frac_part = q % scale;
+            let int_len = decimal_len(int_part);
+            let neg = x.is_sign_negative() as usize;
+            let dot = (prec > 0) as usize;
+            let start = buf.len();
+            buf.resize(start + neg + int_len + dot + prec, 0);
+            let out = &mut buf[start..];
+            if neg == 1 {
+                out[0] = b'-';
+            }
+            fill_digits(&mut out[neg..neg + int_len], int_part);
+            if dot == 1 {
+                out[neg + int_len] = b'.';
+                fill_digits(&mut out[neg + int_len + 1..], frac_part);
+            }
+            return;
+        }
+    }
+    // Writing into a Vec cannot fail.
+    let _ = write!(buf, "{:.1$}", x, prec);
+}
+
+/// Appends `x` formatted as `{:>width$.prec$}` would print it: right-aligned
+/// and space-padded to at least `width` bytes.
+#[inline]
+pub(crate) fn push_fixed_padded(buf: &mut Vec<u8>, x: f64, prec: usize, width: usize) {
+    let start = buf.len();
+    push_fixed(buf, x, prec);
+    let len = buf.len() - start;
+    if len < width {
+        let pad = width - len;
+        buf.resize(start + width, 0);
+        buf.copy_within(start..start + len, start + pad);
+        buf[start..start + pad].fill(b' ');
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn fixed(x: f64, prec: usize) -> String {
+        let mut buf = Vec::new();
+        push_fixed(&mut buf, x, prec);
+        String::from_utf8(buf).unwrap()
+    }
+
+    fn assert_matches_fmt(x: f64) {
+        for prec in 0..=MAX_FAST_PRECISION + 2 {
+            assert_eq!(fixed(x, prec), format!("{:.1$}", x, prec), "x={x:e} prec={prec}");
+        }
+    }
+
+    #[test]
+    fn test_push_fixed_padded_matches_fmt() {
+        for x in [0.0, -0.0, 1.5, -12.25, 123456.789, f64::NAN] {
+            for (prec, width) in [(0, 0), (3, 10), (6, 13), (6, 4)] {
+                let mut buf = Vec::new();
+                push_fixed_padded(&mut buf, x, prec, width);
+                assert_eq!(buf, format!("{x:>width$.prec$}").as_bytes());
+            }
+        }
+    }
+
+    #[test]
+    fn test_push_u64_matches_display() {
+        for n in [0u64, 1, 9, 10, 99, 100, 12345, 9_999_999_999, u64::MAX] {
+            let mut buf = Vec::new();
+            push_u64(&mut buf, n);
+            assert_eq!(buf, n.to_string().as_bytes());
+        }
+    }
+
+    #[test]
+    fn test_push_fixed_special_values() {
+        for x in [
+            0.0,
+            -0.0,
+            1.0,
+            -1.0,
+            0.5,
+            1.5,
+            2.5,
+            0.25,
+            0.125,
+            -0.0000001,
+            63.546,
+            1.00794,
+            90.0,
+            1e-300,
+            f64::MIN_POSITIVE,
+            5e-324,
+            1e15,
+            1.8e19,
+            1e22,
+            f64::MAX,
+            f64::INFINITY,
+            f64::NEG_INFINITY,
+            f64::NAN,
+        ] {
+            assert_matches_fmt(x);
+        }
+    }
+
+    #[test]
+    fn test_push_fixed_matches_fmt_on_pseudorandom_values() {
+        // xorshift64*, so the test is deterministic without a rand dependency.
+        let mut state = 0x9e37_79b9_7f4a_7c15u64;
+        let mut next = || {
+            state ^= state >> 12;
+            state ^= state << 25;
+            state ^= state >> 27;
+            state.wrapping_mul(0x2545_f491_4f6c_dd1d)
+        };
+        for _ in 0..5_000 {
+            let r = next();
+            // Coordinates in a 200 Å box, plus raw bit patterns for coverage.
+            let coord = (r >> 11) as f64 / (1u64 << 53) as f64 * 200.0 - 100.0;
+            assert_matches_fmt(coord);
+            assert_matches_fmt(f64::from_bits(next()));
+        }
+    }
+}
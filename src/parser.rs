@@ -1,7 +1,10 @@
 use crate::error::ParseError;
-use crate::types::{AtomDatum, ConFrame, FrameHeader};
+use crate::stats::{self, Stage};
+use crate::types::{
+    AtomColumns, AtomDatum, ConFrame, ConFrameSoA, FrameHeader, FrameHeaderRef, PerTypeVec,
+};
 use std::iter::Peekable;
-use std::rc::Rc;
+use std::sync::Arc;
 
 /// Parses a line of whitespace-separated f64 values using fast-float2.
 ///
@@ -15,19 +18,160 @@ use std::rc::Rc;
 /// * `n` - The exact number of f64 values expected on the line.
 pub fn parse_line_of_n_f64(line: &str, n: usize) -> Result<Vec<f64>, ParseError> {
     let mut values = Vec::with_capacity(n);
+    let found = for_each_f64(line, |val| values.push(val))?;
+    check_count(n, found)?;
+    Ok(values)
+}
+
+/// Parses each whitespace-separated float on `line` with fast-float2, in
+/// order, and returns how many there were.
+#[inline]
+fn for_each_f64(line: &str, mut f: impl FnMut(f64)) -> Result<usize, ParseError> {
+    let mut found = 0;
     for token in line.split_ascii_whitespace() {
         let val: f64 = fast_float2::parse(token)
             .map_err(|_| ParseError::InvalidNumberFormat(format!("invalid float: {token}")))?;
-        values.push(val);
+        f(val);
+        found += 1;
     }
-    if values.len() == n {
-        Ok(values)
+    Ok(found)
+}
+
+#[inline]
+fn check_count(expected: usize, found: usize) -> Result<(), ParseError> {
+    if found == expected {
+        Ok(())
     } else {
-        Err(ParseError::InvalidVectorLength {
-            expected: n,
-            found: values.len(),
-        })
+        Err(ParseError::InvalidVectorLength { expected, found })
+    }
+}
+
+/// Parses exactly `N` floats into an array, with the same tokenization and
+/// errors as [`parse_line_of_n_f64`].
+fn parse_array_f64<const N: usize>(line: &str) -> Result<[f64; N], ParseError> {
+    let mut values = [0.0; N];
+    let mut i = 0;
+    let found = for_each_f64(line, |val| {
+        if i < N {
+            values[i] = val;
+        }
+        i += 1;
+    })?;
+    check_count(N, found)?;
+    Ok(values)
+}
+
+/// The five fields of a coordinate or velocity line: `x y z fixed atom_id`.
+///
+/// For velocity lines the first three fields are `vx vy vz`.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct AtomLine {
+    pub x: f64,
+    pub y: f64,
+    pub z: f64,
+    pub is_fixed: bool,
+    pub atom_id: u64,
+}
+
+/// Parses one atom line without allocating.
+///
+/// This is the per-atom parser used by all frame parsers: a portable scalar
+/// loop, with no SIMD or per-target code. It walks the line's bytes once:
+/// the three coordinates are parsed in place with `fast_float2::parse_partial`,
+/// and the fixed flag and atom id are read as plain decimal integers. Anything outside that fast path (a float-formatted
+/// flag such as `1.0`, a malformed token, the wrong field count) is handed to
+/// [`parse_line_of_n_f64`], so accepted input, results and errors are the
+/// same as parsing the line as five floats.
+///
+/// # Example
+///
+/// ```
+/// use readcon_core::parser::parse_atom_line;
+/// let atom = parse_atom_line("  0.5  -1.25  3.0  1  42").unwrap();
+/// assert_eq!((atom.x, atom.y, atom.z), (0.5, -1.25, 3.0));
+/// assert!(atom.is_fixed);
+/// assert_eq!(atom.atom_id, 42);
+/// ```
+#[inline]
+pub fn parse_atom_line(line: &str) -> Result<AtomLine, ParseError> {
+    if let Some(atom) = parse_atom_line_fast(line.as_bytes()) {
+        return Ok(atom);
+    }
+    let vals = parse_line_of_n_f64(line, 5)?;
+    Ok(AtomLine {
+        x: vals[0],
+        y: vals[1],
+        z: vals[2],
+        is_fixed: vals[3] != 0.0,
+        atom_id: vals[4] as u64,
+    })
+}
+
+#[inline]
+fn parse_atom_line_fast(bytes: &[u8]) -> Option<AtomLine> {
+    let mut pos = 0;
+    let x = next_f64_field(bytes, &mut pos)?;
+    let y = next_f64_field(bytes, &mut pos)?;
+    let z = next_f64_field(bytes, &mut pos)?;
+    let fixed = next_u64_field(bytes, &mut pos)?;
+    let atom_id = next_u64_field(bytes, &mut pos)?;
+    if skip_ascii_whitespace(bytes, pos) != bytes.len() {
+        return None;
+    }
+    Some(AtomLine {
+        x,
+        y,
+        z,
+        is_fixed: fixed != 0,
+        atom_id,
+    })
+}
+
+#[inline]
+fn skip_ascii_whitespace(bytes: &[u8], mut pos: usize) -> usize {
+    while pos < bytes.len() && bytes[pos].is_ascii_whitespace() {
+        pos += 1;
+    }
+    pos
+}
+
+/// Returns `true` if `pos` is the end of a whitespace-delimited token.
+#[inline]
+fn at_token_end(bytes: &[u8], pos: usize) -> bool {
+    pos == bytes.len() || bytes[pos].is_ascii_whitespace()
+}
+
+/// Parses the next whitespace-delimited token as an `f64`.
+#[inline]
+fn next_f64_field(bytes: &[u8], pos: &mut usize) -> Option<f64> {
+    let start = skip_ascii_whitespace(bytes, *pos);
+    let (value, len) = fast_float2::parse_partial::<f64, _>(&bytes[start..]).ok()?;
+    let end = start + len;
+    if !at_token_end(bytes, end) {
+        return None;
     }
+    *pos = end;
+    Some(value)
+}
+
+/// Parses the next whitespace-delimited token as a decimal `u64`.
+///
+/// Only plain digit strings short enough not to overflow are accepted.
+#[inline]
+fn next_u64_field(bytes: &[u8], pos: &mut usize) -> Option<u64> {
+    let start = skip_ascii_whitespace(bytes, *pos);
+    let mut end = start;
+    let mut value: u64 = 0;
+    while end < bytes.len() && bytes[end].is_ascii_digit() {
+        value = value * 10 + u64::from(bytes[end] - b'0');
+        end += 1;
+    }
+    // 19 digits always fit in a u64.
+    if end == start || end - start > 19 || !at_token_end(bytes, end) {
+        return None;
+    }
+    *pos = end;
+    Some(value)
 }
 
 /// Parses a line of whitespace-separated values into a vector of a specific type.
@@ -80,6 +224,8 @@ where
 ///
 /// This function consumes the next 9 lines from the given line iterator to
 /// construct a `FrameHeader`. The iterator is advanced by 9 lines on success.
+/// It is [`parse_frame_header_ref`] followed by
+/// [`FrameHeaderRef::into_owned`].
 ///
 /// # Arguments
 ///
@@ -90,47 +236,58 @@ where
 /// * `ParseError::IncompleteHeader` if the iterator has fewer than 9 lines remaining.
 /// * Propagates any errors from `parse_line_of_n` if the numeric data within
 ///   the header is malformed.
-///
-/// # Panics
-///
-/// This function will panic if the intermediate vectors for box dimensions or angles,
-/// after being successfully parsed, cannot be converted into fixed-size arrays.
-/// This should not happen if `parse_line_of_n` is used correctly with `n=3`.
 pub fn parse_frame_header<'a>(
     lines: &mut impl Iterator<Item = &'a str>,
 ) -> Result<FrameHeader, ParseError> {
-    let prebox1 = lines
-        .next()
-        .ok_or(ParseError::IncompleteHeader)?
-        .to_string();
-    let prebox2 = lines
-        .next()
-        .ok_or(ParseError::IncompleteHeader)?
-        .to_string();
-    let boxl_vec = parse_line_of_n_f64(lines.next().ok_or(ParseError::IncompleteHeader)?, 3)?;
-    let angles_vec = parse_line_of_n_f64(lines.next().ok_or(ParseError::IncompleteHeader)?, 3)?;
-    let postbox1 = lines
-        .next()
-        .ok_or(ParseError::IncompleteHeader)?
-        .to_string();
-    let postbox2 = lines
-        .next()
-        .ok_or(ParseError::IncompleteHeader)?
-        .to_string();
-    let natm_types =
-        parse_line_of_n::<usize>(lines.next().ok_or(ParseError::IncompleteHeader)?, 1)?[0];
-    let natms_per_type = parse_line_of_n::<usize>(
-        lines.next().ok_or(ParseError::IncompleteHeader)?,
-        natm_types,
-    )?;
-    let masses_per_type = parse_line_of_n_f64(
-        lines.next().ok_or(ParseError::IncompleteHeader)?,
-        natm_types,
-    )?;
-    Ok(FrameHeader {
+    parse_frame_header_timed(lines).map(FrameHeaderRef::into_owned)
+}
+
+/// [`parse_frame_header_ref`] recorded as the `ParseFrameHeader` stage, for
+/// the frame parsers. The index scan and `forward()` go untimed.
+#[inline]
+fn parse_frame_header_timed<'a>(
+    lines: &mut impl Iterator<Item = &'a str>,
+) -> Result<FrameHeaderRef<'a>, ParseError> {
+    let mut timer = stats::time(Stage::ParseFrameHeader);
+    parse_frame_header_ref(&mut lines.by_ref().inspect(|line| timer.line(line)))
+}
+
+/// Parses the 9-line header of a frame into a borrowed `FrameHeaderRef`.
+///
+/// Accepts the same input and reports the same errors as
+/// [`parse_frame_header`], but borrows the text lines and keeps the per-type
+/// arrays inline, so it does not allocate for frames with up to four atom
+/// types.
+///
+/// # Example
+///
+/// ```
+/// use readcon_core::parser::parse_frame_header_ref;
+///
+/// let text = "a\nb\n10 10 10\n90 90 90\nc\nd\n2\n3 1\n63.5 1.0";
+/// let header = parse_frame_header_ref(&mut text.lines()).unwrap();
+/// assert_eq!(header.prebox_header, ["a", "b"]);
+/// assert_eq!(header.total_atoms(), 4);
+/// ```
+pub fn parse_frame_header_ref<'a>(
+    lines: &mut impl Iterator<Item = &'a str>,
+) -> Result<FrameHeaderRef<'a>, ParseError> {
+    let mut next_line = || lines.next().ok_or(ParseError::IncompleteHeader);
+    let prebox1 = next_line()?;
+    let prebox2 = next_line()?;
+    let boxl = parse_array_f64::<3>(next_line()?)?;
+    let angles = parse_array_f64::<3>(next_line()?)?;
+    let postbox1 = next_line()?;
+    let postbox2 = next_line()?;
+    let natm_types = parse_per_type::<usize>(next_line()?, 1)?[0];
+    let natms_per_type = parse_per_type::<usize>(next_line()?, natm_types)?;
+    let mut masses_per_type = PerTypeVec::new();
+    let found = for_each_f64(next_line()?, |val| masses_per_type.push(val))?;
+    check_count(natm_types, found)?;
+    Ok(FrameHeaderRef {
         prebox_header: [prebox1, prebox2],
-        boxl: boxl_vec.try_into().unwrap(),
-        angles: angles_vec.try_into().unwrap(),
+        boxl,
+        angles,
         postbox_header: [postbox1, postbox2],
         natm_types,
         natms_per_type,
@@ -138,6 +295,19 @@ pub fn parse_frame_header<'a>(
     })
 }
 
+/// Like [`parse_line_of_n`], but collects into inline storage.
+fn parse_per_type<T: std::str::FromStr>(line: &str, n: usize) -> Result<PerTypeVec<T>, ParseError>
+where
+    ParseError: From<<T as std::str::FromStr>::Err>,
+{
+    let values: PerTypeVec<T> = line
+        .split_whitespace()
+        .map(|s| s.parse::<T>())
+        .collect::<Result<_, _>>()?;
+    check_count(n, values.len())?;
+    Ok(values)
+}
+
 /// Parses a complete frame from a `.con` file, including its header and atomic data.
 ///
 /// This function first parses the complete frame header and then uses the information within it
@@ -189,41 +359,117 @@ pub fn parse_frame_header<'a>(
 pub fn parse_single_frame<'a>(
     lines: &mut impl Iterator<Item = &'a str>,
 ) -> Result<ConFrame, ParseError> {
+    let mut timer = stats::time(Stage::ParseSingleFrame);
     let header = parse_frame_header(lines)?;
     let total_atoms: usize = header.natms_per_type.iter().sum();
     let mut atom_data = Vec::with_capacity(total_atoms);
+    stats::allocation();
 
     for num_atoms in &header.natms_per_type {
+        let symbol_line = lines.next().ok_or(ParseError::IncompleteFrame)?;
         // Create a reference-counted string for the symbol once per component.
-        let symbol = Rc::new(
-            lines
-                .next()
-                .ok_or(ParseError::IncompleteFrame)?
-                .trim()
-                .to_string(),
-        );
+        let symbol = Arc::new(symbol_line.trim().to_string());
         // Consume and discard the "Coordinates of Component X" line.
-        lines.next().ok_or(ParseError::IncompleteFrame)?;
+        let comp_line = lines.next().ok_or(ParseError::IncompleteFrame)?;
+        timer.line(symbol_line);
+        timer.line(comp_line);
         for _ in 0..*num_atoms {
             let coord_line = lines.next().ok_or(ParseError::IncompleteFrame)?;
-            let vals = parse_line_of_n_f64(coord_line, 5)?;
+            timer.line(coord_line);
+            let vals = parse_atom_line(coord_line)?;
             atom_data.push(AtomDatum {
                 // This is now a cheap reference-count increment, not a full string clone.
-                symbol: Rc::clone(&symbol),
-                x: vals[0],
-                y: vals[1],
-                z: vals[2],
-                is_fixed: vals[3] != 0.0,
-                atom_id: vals[4] as u64,
+                symbol: Arc::clone(&symbol),
+                x: vals.x,
+                y: vals.y,
+                z: vals.z,
+                is_fixed: vals.is_fixed,
+                atom_id: vals.atom_id,
                 vx: None,
                 vy: None,
                 vz: None,
             });
         }
     }
+    timer.frame(atom_data.len());
     Ok(ConFrame { header, atom_data })
 }
 
+/// Parses a frame's header and coordinate blocks into an existing `ConFrame`.
+///
+/// Consumes exactly the same lines and reports the same errors as
+/// [`parse_single_frame`], but overwrites `frame` in place: header strings and
+/// vectors keep their capacity, and existing `AtomDatum` slots are reused.
+/// A slot keeps its symbol `Arc` when the component's symbol is unchanged, so
+/// a trajectory with a fixed topology is parsed without any allocation.
+///
+/// Velocities are reset to `None`; follow with [`parse_velocity_section`].
+/// If an error is returned, the contents of `frame` are unspecified.
+pub fn parse_single_frame_into<'a>(
+    lines: &mut impl Iterator<Item = &'a str>,
+    frame: &mut ConFrame,
+) -> Result<(), ParseError> {
+    let mut timer = stats::time(Stage::ParseSingleFrame);
+    let header = parse_frame_header_timed(lines)?;
+    header.write_to(&mut frame.header);
+    let total_atoms = header.total_atoms();
+    let atom_data = &mut frame.atom_data;
+    if atom_data.capacity() < total_atoms {
+        stats::allocation();
+    }
+    atom_data.reserve(total_atoms.saturating_sub(atom_data.len()));
+
+    let mut idx = 0;
+    for &num_atoms in &header.natms_per_type {
+        let symbol_line = lines.next().ok_or(ParseError::IncompleteFrame)?;
+        timer.line(symbol_line);
+        let symbol_line = symbol_line.trim();
+        // Reuse the slot's symbol if it already matches this component.
+        let symbol = match atom_data.get(idx) {
+            Some(atom) if atom.symbol.as_str() == symbol_line => Arc::clone(&atom.symbol),
+            _ => Arc::new(symbol_line.to_string()),
+        };
+        // Consume and discard the "Coordinates of Component X" line.
+        let comp_line = lines.next().ok_or(ParseError::IncompleteFrame)?;
+        timer.line(comp_line);
+        for _ in 0..num_atoms {
+            let coord_line = lines.next().ok_or(ParseError::IncompleteFrame)?;
+            timer.line(coord_line);
+            let vals = parse_atom_line(coord_line)?;
+            match atom_data.get_mut(idx) {
+                Some(atom) => {
+                    if !Arc::ptr_eq(&atom.symbol, &symbol) {
+                        atom.symbol = Arc::clone(&symbol);
+                    }
+                    atom.x = vals.x;
+                    atom.y = vals.y;
+                    atom.z = vals.z;
+                    atom.is_fixed = vals.is_fixed;
+                    atom.atom_id = vals.atom_id;
+                    atom.vx = None;
+                    atom.vy = None;
+                    atom.vz = None;
+                }
+                None => atom_data.push(AtomDatum {
+                    symbol: Arc::clone(&symbol),
+                    x: vals.x,
+                    y: vals.y,
+                    z: vals.z,
+                    is_fixed: vals.is_fixed,
+                    atom_id: vals.atom_id,
+                    vx: None,
+                    vy: None,
+                    vz: None,
+                }),
+            }
+            idx += 1;
+        }
+    }
+    atom_data.truncate(idx);
+    timer.frame(idx);
+    Ok(())
+}
+
 /// Attempts to parse an optional velocity section following coordinate blocks.
 ///
 /// In `.convel` files, after all coordinate blocks there is a blank separator line
@@ -244,10 +490,12 @@ pub fn parse_velocity_section<'a, I>(
 where
     I: Iterator<Item = &'a str>,
 {
+    let mut timer = stats::time(Stage::ParseVelocitySection);
     // Peek at the next line to check for blank separator
     match lines.peek() {
         Some(line) if line.trim().is_empty() => {
             // Consume the blank separator
+            timer.line(line);
             lines.next();
         }
         _ => return Ok(false),
@@ -256,10 +504,9 @@ where
     let mut atom_idx = 0;
     for (type_idx, &num_atoms) in header.natms_per_type.iter().enumerate() {
         // Symbol line
-        let _symbol = lines
+        let symbol_line = lines
             .next()
-            .ok_or(ParseError::IncompleteVelocitySection)?
-            .trim();
+            .ok_or(ParseError::IncompleteVelocitySection)?;
 
         // "Velocities of Component N" line
         let comp_line = lines
@@ -269,18 +516,21 @@ where
         if !comp_line.contains("Velocities of Component") {
             return Err(ParseError::IncompleteVelocitySection);
         }
+        timer.line(symbol_line);
+        timer.line(comp_line);
         let _ = type_idx; // suppress unused warning
 
         for _ in 0..num_atoms {
             let vel_line = lines
                 .next()
                 .ok_or(ParseError::IncompleteVelocitySection)?;
-            let vals = parse_line_of_n_f64(vel_line, 5)?;
+            timer.line(vel_line);
+            let vals = parse_atom_line(vel_line)?;
             if atom_idx < atom_data.len() {
-                atom_data[atom_idx].vx = Some(vals[0]);
-                atom_data[atom_idx].vy = Some(vals[1]);
-                atom_data[atom_idx].vz = Some(vals[2]);
-                // vals[3] is fixed flag, vals[4] is atom_id (redundant with coords)
+                atom_data[atom_idx].vx = Some(vals.x);
+                atom_data[atom_idx].vy = Some(vals.y);
+                atom_data[atom_idx].vz = Some(vals.z);
+                // The fixed flag and atom_id are redundant with the coordinates.
             }
             atom_idx += 1;
         }
@@ -289,10 +539,479 @@ where
     Ok(true)
 }
 
+/// Selects which parts of each frame are parsed.
+///
+/// The default parses everything. Skipped lines are stepped over as in
+/// `ConFrameIterator::forward()`, without parsing their numbers.
+///
+/// Filtering by component or atom id yields a self-consistent frame:
+/// `natms_per_type`, `masses_per_type` and `natm_types` describe only the
+/// kept atoms, and components left with no atoms are dropped, so the frame
+/// can be written back out. A header-only frame keeps the header exactly as
+/// read, with empty `atom_data`.
+///
+/// # Example
+///
+/// ```
+/// use readcon_core::iterators::ConFrameIterator;
+/// use readcon_core::parser::ParseOptions;
+///
+/// let text = "a\nb\n1 1 1\n90 90 90\nc\nd\n2\n1 1\n63.5 1.0\nCu\nCoordinates of Component 1\n0 0 0 0 1\nH\nCoordinates of Component 2\n1 1 1 0 2\n";
+/// let options = ParseOptions {
+///     components: vec!["H".to_string()],
+///     ..ParseOptions::default()
+/// };
+/// let frame = ConFrameIterator::with_options(text, options).next().unwrap().unwrap();
+/// assert_eq!(frame.header.natms_per_type, vec![1]);
+/// assert_eq!(frame.atom_data[0].atom_id, 2);
+/// ```
+#[derive(Debug, Clone, Default, PartialEq, Eq)]
+pub struct ParseOptions {
+    /// Parse only the nine header lines; `atom_data` is left empty.
+    pub header_only: bool,
+    /// Step over the velocity section; velocities stay `None`.
+    pub skip_velocities: bool,
+    /// Keep only components with these symbols. Empty keeps all.
+    pub components: Vec<String>,
+    /// Keep only atoms whose id lies in this half-open range.
+    pub atom_ids: Option<std::ops::Range<u64>>,
+}
+
+impl ParseOptions {
+    /// Returns `true` if these options parse every field of every frame.
+    pub fn is_full(&self) -> bool {
+        !self.header_only
+            && !self.skip_velocities
+            && self.components.is_empty()
+            && self.atom_ids.is_none()
+    }
+
+    fn filters_atoms(&self) -> bool {
+        !self.components.is_empty() || self.atom_ids.is_some()
+    }
+
+    fn keeps_component(&self, symbol: &str) -> bool {
+        self.components.is_empty() || self.components.iter().any(|c| c == symbol)
+    }
+}
+
+/// Consumes `n` lines, failing with `err` if the input ends first.
+#[inline]
+fn skip_lines<'a>(
+    lines: &mut impl Iterator<Item = &'a str>,
+    n: usize,
+    err: fn() -> ParseError,
+) -> Result<(), ParseError> {
+    if n > 0 && lines.nth(n - 1).is_none() {
+        return Err(err());
+    }
+    Ok(())
+}
+
+/// Reads the atom id (last field) of an atom line without parsing its
+/// floats; anything unusual goes through [`parse_atom_line`].
+#[inline]
+fn peek_atom_id(line: &str) -> Result<u64, ParseError> {
+    let bytes = line.trim_end().as_bytes();
+    let start = bytes
+        .iter()
+        .rposition(|b| b.is_ascii_whitespace())
+        .map_or(0, |i| i + 1);
+    let mut pos = start;
+    match next_u64_field(bytes, &mut pos) {
+        Some(id) if pos == bytes.len() && start > 0 => Ok(id),
+        _ => Ok(parse_atom_line(line)?.atom_id),
+    }
+}
+
+/// Parses one frame, including an optional velocity section, under
+/// `options`.
+///
+/// With [`ParseOptions::default()`] the result is the same as
+/// [`parse_single_frame`] followed by [`parse_velocity_section`]; the line
+/// grammar, the lines consumed and the errors for parsed lines are also the
+/// same. Lines that are skipped are only counted.
+pub fn parse_single_frame_with<'a, I>(
+    lines: &mut Peekable<I>,
+    options: &ParseOptions,
+) -> Result<ConFrame, ParseError>
+where
+    I: Iterator<Item = &'a str>,
+{
+    let mut timer = stats::time(Stage::ParseSingleFrame);
+    let mut header = parse_frame_header(lines)?;
+    let block_lines = header.natms_per_type.iter().sum::<usize>() + 2 * header.natm_types;
+    if options.header_only {
+        skip_lines(lines, block_lines, || ParseError::IncompleteFrame)?;
+        skip_velocity_section(lines, block_lines)?;
+        timer.frame(0);
+        return Ok(ConFrame {
+            header,
+            atom_data: Vec::new(),
+        });
+    }
+
+    let filtered = options.filters_atoms();
+    // One flag per atom in the file, so velocity lines can be matched to
+    // kept atoms without reparsing their ids.
+    let mut kept_mask: Vec<bool> = Vec::new();
+    let mut kept_per_type: Vec<usize> = Vec::with_capacity(header.natm_types);
+    let mut atom_data = Vec::new();
+    for &num_atoms in &header.natms_per_type {
+        let symbol_line = lines.next().ok_or(ParseError::IncompleteFrame)?;
+        // Consume and discard the "Coordinates of Component X" line.
+        let comp_line = lines.next().ok_or(ParseError::IncompleteFrame)?;
+        timer.line(symbol_line);
+        timer.line(comp_line);
+        let symbol_line = symbol_line.trim();
+        if !options.keeps_component(symbol_line) {
+            skip_lines(lines, num_atoms, || ParseError::IncompleteFrame)?;
+            kept_mask.resize(kept_mask.len() + num_atoms, false);
+            kept_per_type.push(0);
+            continue;
+        }
+        let symbol = Arc::new(symbol_line.to_string());
+        let mut kept = 0;
+        for _ in 0..num_atoms {
+            let coord_line = lines.next().ok_or(ParseError::IncompleteFrame)?;
+            timer.line(coord_line);
+            if let Some(ids) = &options.atom_ids {
+                if !ids.contains(&peek_atom_id(coord_line)?) {
+                    kept_mask.push(false);
+                    continue;
+                }
+            }
+            let vals = parse_atom_line(coord_line)?;
+            atom_data.push(AtomDatum {
+                symbol: Arc::clone(&symbol),
+                x: vals.x,
+                y: vals.y,
+                z: vals.z,
+                is_fixed: vals.is_fixed,
+                atom_id: vals.atom_id,
+                vx: None,
+                vy: None,
+                vz: None,
+            });
+            kept_mask.push(true);
+            kept += 1;
+        }
+        kept_per_type.push(kept);
+    }
+
+    if options.skip_velocities {
+        skip_velocity_section(lines, block_lines)?;
+    } else if filtered {
+        parse_velocity_section_masked(lines, &header, &kept_mask, &mut atom_data)?;
+    } else {
+        parse_velocity_section(lines, &header, &mut atom_data)?;
+    }
+
+    if filtered {
+        let mut masses = Vec::with_capacity(kept_per_type.len());
+        for (i, &kept) in kept_per_type.iter().enumerate() {
+            if kept > 0 {
+                masses.push(header.masses_per_type[i]);
+            }
+        }
+        kept_per_type.retain(|&kept| kept > 0);
+        header.natm_types = kept_per_type.len();
+        header.natms_per_type = kept_per_type;
+        header.masses_per_type = masses;
+    }
+    timer.frame(atom_data.len());
+    Ok(ConFrame { header, atom_data })
+}
+
+/// Applies `options` to an already decoded frame (e.g. from a `.conb`
+/// record), with the same result as parsing its text under `options`.
+pub(crate) fn project_frame(mut frame: ConFrame, options: &ParseOptions) -> ConFrame {
+    if options.header_only {
+        frame.atom_data.clear();
+        return frame;
+    }
+    if options.skip_velocities {
+        for atom in &mut frame.atom_data {
+            atom.vx = None;
+            atom.vy = None;
+            atom.vz = None;
+        }
+    }
+    if !options.filters_atoms() {
+        return frame;
+    }
+    let header = &mut frame.header;
+    let mut kept_per_type = Vec::with_capacity(header.natm_types);
+    let mut masses = Vec::with_capacity(header.natm_types);
+    let mut atoms = std::mem::take(&mut frame.atom_data).into_iter();
+    for (i, &num_atoms) in header.natms_per_type.iter().enumerate() {
+        let mut kept = 0;
+        for atom in atoms.by_ref().take(num_atoms) {
+            let keep = options.keeps_component(&atom.symbol)
+                && options.atom_ids.as_ref().is_none_or(|ids| ids.contains(&atom.atom_id));
+            if keep {
+                frame.atom_data.push(atom);
+                kept += 1;
+            }
+        }
+        if kept > 0 {
+            kept_per_type.push(kept);
+            masses.push(header.masses_per_type.get(i).copied().unwrap_or(0.0));
+        }
+    }
+    header.natm_types = kept_per_type.len();
+    header.natms_per_type = kept_per_type;
+    header.masses_per_type = masses;
+    frame
+}
+
+/// Steps over an optional velocity section of `block_lines` lines after its
+/// blank separator.
+fn skip_velocity_section<'a, I>(lines: &mut Peekable<I>, block_lines: usize) -> Result<(), ParseError>
+where
+    I: Iterator<Item = &'a str>,
+{
+    match lines.peek() {
+        Some(line) if line.trim().is_empty() => {
+            lines.next();
+            skip_lines(lines, block_lines, || ParseError::IncompleteVelocitySection)
+        }
+        _ => Ok(()),
+    }
+}
+
+/// [`parse_velocity_section`] for a filtered frame: only lines whose
+/// `kept_mask` entry is set are parsed, into consecutive `atom_data` slots.
+fn parse_velocity_section_masked<'a, I>(
+    lines: &mut Peekable<I>,
+    header: &FrameHeader,
+    kept_mask: &[bool],
+    atom_data: &mut [AtomDatum],
+) -> Result<(), ParseError>
+where
+    I: Iterator<Item = &'a str>,
+{
+    let mut timer = stats::time(Stage::ParseVelocitySection);
+    match lines.peek() {
+        Some(line) if line.trim().is_empty() => {
+            lines.next();
+        }
+        _ => return Ok(()),
+    }
+    let mut atoms = atom_data.iter_mut();
+    let mut flags = kept_mask.iter();
+    for &num_atoms in &header.natms_per_type {
+        lines.next().ok_or(ParseError::IncompleteVelocitySection)?;
+        let comp_line = lines.next().ok_or(ParseError::IncompleteVelocitySection)?;
+        if !comp_line.contains("Velocities of Component") {
+            return Err(ParseError::IncompleteVelocitySection);
+        }
+        for _ in 0..num_atoms {
+            let vel_line = lines.next().ok_or(ParseError::IncompleteVelocitySection)?;
+            if flags.next() != Some(&true) {
+                continue;
+            }
+            timer.line(vel_line);
+            let vals = parse_atom_line(vel_line)?;
+            if let Some(atom) = atoms.next() {
+                atom.vx = Some(vals.x);
+                atom.vy = Some(vals.y);
+                atom.vz = Some(vals.z);
+            }
+        }
+    }
+    Ok(())
+}
+
+/// Parses a complete frame directly into the columnar `ConFrameSoA` layout.
+///
+/// This is the structure-of-arrays counterpart of [`parse_single_frame`]: it
+/// consumes exactly the same lines and reports the same errors, but writes
+/// each atom's fields straight into the per-field columns instead of building
+/// an `AtomDatum` per atom.
+pub fn parse_single_frame_soa<'a>(
+    lines: &mut impl Iterator<Item = &'a str>,
+) -> Result<ConFrameSoA, ParseError> {
+    let mut timer = stats::time(Stage::ParseSingleFrame);
+    let header = parse_frame_header(lines)?;
+    let total_atoms: usize = header.natms_per_type.iter().sum();
+    let mut symbols = Vec::with_capacity(header.natm_types);
+    let mut columns = AtomColumns {
+        x: Vec::with_capacity(total_atoms),
+        y: Vec::with_capacity(total_atoms),
+        z: Vec::with_capacity(total_atoms),
+        atom_id: Vec::with_capacity(total_atoms),
+        is_fixed: Vec::with_capacity(total_atoms),
+        ..AtomColumns::default()
+    };
+    stats::allocation();
+
+    for num_atoms in &header.natms_per_type {
+        let symbol_line = lines.next().ok_or(ParseError::IncompleteFrame)?;
+        symbols.push(symbol_line.trim().to_string());
+        // Consume and discard the "Coordinates of Component X" line.
+        let comp_line = lines.next().ok_or(ParseError::IncompleteFrame)?;
+        timer.line(symbol_line);
+        timer.line(comp_line);
+        for _ in 0..*num_atoms {
+            let coord_line = lines.next().ok_or(ParseError::IncompleteFrame)?;
+            timer.line(coord_line);
+            let vals = parse_atom_line(coord_line)?;
+            columns.x.push(vals.x);
+            columns.y.push(vals.y);
+            columns.z.push(vals.z);
+            columns.is_fixed.push(vals.is_fixed);
+            columns.atom_id.push(vals.atom_id);
+        }
+    }
+    timer.frame(columns.x.len());
+    Ok(ConFrameSoA {
+        header,
+        symbols,
+        columns,
+    })
+}
+
+/// Attempts to parse an optional velocity section into columnar storage.
+///
+/// Behaves like [`parse_velocity_section`], but fills the `vx`/`vy`/`vz`
+/// columns of `columns` instead of per-atom fields. The velocity columns are
+/// left untouched when no velocity section follows.
+pub fn parse_velocity_section_soa<'a, I>(
+    lines: &mut Peekable<I>,
+    header: &FrameHeader,
+    columns: &mut AtomColumns,
+) -> Result<bool, ParseError>
+where
+    I: Iterator<Item = &'a str>,
+{
+    let mut timer = stats::time(Stage::ParseVelocitySection);
+    match lines.peek() {
+        Some(line) if line.trim().is_empty() => {
+            timer.line(line);
+            lines.next();
+        }
+        _ => return Ok(false),
+    }
+
+    let total_atoms: usize = header.natms_per_type.iter().sum();
+    columns.vx.reserve_exact(total_atoms);
+    columns.vy.reserve_exact(total_atoms);
+    columns.vz.reserve_exact(total_atoms);
+
+    for &num_atoms in &header.natms_per_type {
+        // Symbol line
+        let symbol_line = lines
+            .next()
+            .ok_or(ParseError::IncompleteVelocitySection)?;
+        let comp_line = lines
+            .next()
+            .ok_or(ParseError::IncompleteVelocitySection)?;
+        if !comp_line.contains("Velocities of Component") {
+            return Err(ParseError::IncompleteVelocitySection);
+        }
+        timer.line(symbol_line);
+        timer.line(comp_line);
+        for _ in 0..num_atoms {
+            let vel_line = lines
+                .next()
+                .ok_or(ParseError::IncompleteVelocitySection)?;
+            timer.line(vel_line);
+            let vals = parse_atom_line(vel_line)?;
+            columns.vx.push(vals.x);
+            columns.vy.push(vals.y);
+            columns.vz.push(vals.z);
+        }
+    }
+    // Keep the columns aligned with the coordinates even if the header
+    // promised more atoms than the coordinate blocks provided.
+    columns.vx.truncate(columns.x.len());
+    columns.vy.truncate(columns.x.len());
+    columns.vz.truncate(columns.x.len());
+
+    Ok(true)
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
 
+    #[test]
+    fn test_parse_single_frame_into_reuses_slots() {
+        let two_atoms = "p\np\n1 1 1\n90 90 90\nq\nq\n1\n2\n1.0\nH\nCoordinates of Component 1\n0 0 0 0 1\n1 1 1 1 2\n";
+        let one_atom = "p\np\n2 2 2\n90 90 90\nq\nq\n1\n1\n12.0\nC\nCoordinates of Component 1\n5 5 5 0 7\n";
+
+        let mut frame = parse_single_frame(&mut two_atoms.lines()).unwrap();
+        let symbol = Arc::clone(&frame.atom_data[0].symbol);
+        parse_single_frame_into(&mut two_atoms.lines(), &mut frame).unwrap();
+        assert!(Arc::ptr_eq(&frame.atom_data[1].symbol, &symbol));
+        assert_eq!(frame, parse_single_frame(&mut two_atoms.lines()).unwrap());
+
+        parse_single_frame_into(&mut one_atom.lines(), &mut frame).unwrap();
+        assert_eq!(frame, parse_single_frame(&mut one_atom.lines()).unwrap());
+    }
+
+    #[test]
+    fn test_frame_header_ref_into_owned() {
+        let text = "pre1\npre2\n10 20 30\n90 90 120\npost1\npost2\n2\n3 1\n63.546 1.008\n";
+        let header = parse_frame_header_ref(&mut text.lines()).unwrap();
+        assert_eq!(header.postbox_header, ["post1", "post2"]);
+        assert_eq!(header.angles, [90.0, 90.0, 120.0]);
+        assert!(!header.natms_per_type.spilled());
+        assert!(!header.masses_per_type.spilled());
+        assert_eq!(header.total_atoms(), 4);
+        let owned = parse_frame_header(&mut text.lines()).unwrap();
+        assert_eq!(header.into_owned(), owned);
+        assert!(matches!(
+            parse_frame_header_ref(&mut "a\nb\n1 2\n".lines()),
+            Err(ParseError::InvalidVectorLength {
+                expected: 3,
+                found: 2
+            })
+        ));
+    }
+
+    #[test]
+    fn test_parse_atom_line_matches_generic_path() {
+        let lines = [
+            "   0.63939999999999997    0.90449999999999997   -0.00009999999999977 1    0",
+            "1 2 3 0 7",
+            "1e-3\t-2.5E+2 .5 1.0 42.0",
+            "1 2 3 -1 5",
+            "1 2 3 0 00000000000000000000012",
+            "  4 5 6 1 8  \r",
+        ];
+        for line in lines {
+            let vals = parse_line_of_n_f64(line, 5).unwrap();
+            let atom = parse_atom_line(line).unwrap();
+            assert_eq!((atom.x, atom.y, atom.z), (vals[0], vals[1], vals[2]), "{line}");
+            assert_eq!(atom.is_fixed, vals[3] != 0.0, "{line}");
+            assert_eq!(atom.atom_id, vals[4] as u64, "{line}");
+        }
+    }
+
+    #[test]
+    fn test_parse_atom_line_errors() {
+        assert!(matches!(
+            parse_atom_line("1 2 3 0"),
+            Err(ParseError::InvalidVectorLength {
+                expected: 5,
+                found: 4
+            })
+        ));
+        assert!(matches!(
+            parse_atom_line("1 2 3 0 1 9"),
+            Err(ParseError::InvalidVectorLength {
+                expected: 5,
+                found: 6
+            })
+        ));
+        assert!(matches!(
+            parse_atom_line("1 2x 3 0 1"),
+            Err(ParseError::InvalidNumberFormat(_))
+        ));
+    }
+
     #[test]
     fn test_parse_line_of_n_success() {
         let line = "1.0 2.5 -3.0";
@@ -581,4 +1300,44 @@ mod tests {
         assert!(!has_vel);
         assert_eq!(frame.atom_data[0].vx, None);
     }
+
+    #[test]
+    fn test_parse_single_frame_soa_matches_aos() {
+        let lines = vec![
+            "PREBOX1",
+            "PREBOX2",
+            "10.0 20.0 30.0",
+            "90.0 90.0 90.0",
+            "POSTBOX1",
+            "POSTBOX2",
+            "2",
+            "1 1",
+            "63.546 1.008",
+            "Cu",
+            "Coordinates of Component 1",
+            "0.0 0.0 0.0 1.0 0",
+            "H",
+            "Coordinates of Component 2",
+            "1.0 2.0 3.0 0.0 1",
+            "",
+            "Cu",
+            "Velocities of Component 1",
+            "0.1 0.2 0.3 1.0 0",
+            "H",
+            "Velocities of Component 2",
+            "0.4 0.5 0.6 0.0 1",
+        ];
+        let mut aos_it = lines.iter().copied().peekable();
+        let mut frame = parse_single_frame(&mut aos_it).unwrap();
+        parse_velocity_section(&mut aos_it, &frame.header, &mut frame.atom_data).unwrap();
+
+        let mut soa_it = lines.iter().copied().peekable();
+        let mut soa = parse_single_frame_soa(&mut soa_it).unwrap();
+        let has_vel =
+            parse_velocity_section_soa(&mut soa_it, &soa.header, &mut soa.columns).unwrap();
+        assert!(has_vel);
+        assert_eq!(soa.symbols, vec!["Cu", "H"]);
+        assert_eq!(soa.columns.vz, vec![0.3, 0.6]);
+        assert_eq!(ConFrame::from(soa), frame);
+    }
 }
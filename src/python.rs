@@ -1,11 +1,162 @@
-use pyo3::prelude::*;
-use pyo3::exceptions::PyIOError;
-use pyo3::types::IntoPyDict;
+use std::ffi::{CStr, c_char, c_int};
+use std::path::Path;
+use std::ptr;
+use std::sync::Mutex;
 
-use crate::iterators::ConFrameIterator;
+use pyo3::prelude::*;
+use pyo3::exceptions::{PyBufferError, PyIOError, PyIndexError, PyValueError};
+use pyo3::ffi;
+use pyo3::types::{IntoPyDict, PyDict, PySlice};
+
+use crate::error::ParseError;
+use crate::helpers::symbol_to_atomic_number;
+#[cfg(feature = "parallel")]
+use crate::iterators::read_all_frames_parallel;
+use crate::iterators::{ConFrameFileIterator, ConFrameIterator, read_all_frames};
+use crate::stats::Stage;
 use crate::types::{AtomDatum, ConFrame, ConFrameBuilder};
 use crate::writer::ConFrameWriter;
 
+/// Element types that can be exported through `ArrayBuffer`.
+trait BufferElement: Copy + 'static {
+    /// The `struct` module format character for this type.
+    const FORMAT: &'static CStr;
+}
+
+impl BufferElement for f64 {
+    const FORMAT: &'static CStr = c"d";
+}
+
+impl BufferElement for u64 {
+    const FORMAT: &'static CStr = c"Q";
+}
+
+impl BufferElement for i64 {
+    const FORMAT: &'static CStr = c"q";
+}
+
+impl BufferElement for bool {
+    const FORMAT: &'static CStr = c"?";
+}
+
+/// A Rust-allocated, C-contiguous array of up to three dimensions, exported
+/// through the buffer protocol.
+///
+/// `numpy.asarray` views the allocation in place and keeps this object alive
+/// as the array's base, so handing columns to NumPy copies nothing and
+/// creates no per-element Python objects.
+#[pyclass(frozen)]
+struct ArrayBuffer {
+    ptr: *mut u8,
+    len: usize,
+    capacity: usize,
+    free: unsafe fn(*mut u8, usize, usize),
+    itemsize: isize,
+    format: &'static CStr,
+    ndim: usize,
+    shape: [isize; 3],
+    strides: [isize; 3],
+}
+
+// SAFETY: the buffer exclusively owns its allocation, which Rust never
+// touches again until `Drop`; all other access goes through buffer views.
+unsafe impl Send for ArrayBuffer {}
+unsafe impl Sync for ArrayBuffer {}
+
+unsafe fn free_vec<T>(ptr: *mut u8, len: usize, capacity: usize) {
+    drop(unsafe { Vec::from_raw_parts(ptr.cast::<T>(), len, capacity) });
+}
+
+impl ArrayBuffer {
+    /// Takes ownership of `data`, viewed with the given `shape`.
+    fn new<T: BufferElement>(data: Vec<T>, shape: &[usize]) -> Self {
+        assert!(shape.len() <= 3 && shape.iter().product::<usize>() == data.len());
+        let itemsize = std::mem::size_of::<T>() as isize;
+        let mut dims = [0isize; 3];
+        let mut strides = [0isize; 3];
+        let mut stride = itemsize;
+        for (axis, &extent) in shape.iter().enumerate().rev() {
+            dims[axis] = extent as isize;
+            strides[axis] = stride;
+            stride *= extent as isize;
+        }
+        let mut data = std::mem::ManuallyDrop::new(data);
+        ArrayBuffer {
+            ptr: data.as_mut_ptr().cast(),
+            len: data.len(),
+            capacity: data.capacity(),
+            free: free_vec::<T>,
+            itemsize,
+            format: T::FORMAT,
+            ndim: shape.len(),
+            shape: dims,
+            strides,
+        }
+    }
+
+    /// Wraps `data` in a NumPy array without copying it.
+    fn into_ndarray<'py, T: BufferElement>(
+        py: Python<'py>,
+        data: Vec<T>,
+        shape: &[usize],
+    ) -> PyResult<Bound<'py, PyAny>> {
+        let buffer = Bound::new(py, ArrayBuffer::new(data, shape))?;
+        py.import("numpy")?.call_method1("asarray", (buffer,))
+    }
+}
+
+impl Drop for ArrayBuffer {
+    fn drop(&mut self) {
+        unsafe { (self.free)(self.ptr, self.len, self.capacity) }
+    }
+}
+
+#[pymethods]
+impl ArrayBuffer {
+    unsafe fn __getbuffer__(
+        slf: Bound<'_, Self>,
+        view: *mut ffi::Py_buffer,
+        flags: c_int,
+    ) -> PyResult<()> {
+        if view.is_null() {
+            return Err(PyBufferError::new_err("buffer view is null"));
+        }
+        let this = slf.get();
+        let requested = |flag: c_int| flags & flag == flag;
+        if !requested(ffi::PyBUF_ND) && this.ndim > 1 {
+            // A failed export must leave no owner in the view.
+            unsafe { (*view).obj = ptr::null_mut() };
+            return Err(PyBufferError::new_err("array buffers need shape information"));
+        }
+        unsafe {
+            (*view).buf = this.ptr.cast();
+            (*view).len = this.len as isize * this.itemsize;
+            (*view).readonly = 0;
+            (*view).itemsize = this.itemsize;
+            (*view).format = if requested(ffi::PyBUF_FORMAT) {
+                this.format.as_ptr() as *mut c_char
+            } else {
+                ptr::null_mut()
+            };
+            (*view).ndim = this.ndim as c_int;
+            (*view).shape = if requested(ffi::PyBUF_ND) {
+                this.shape.as_ptr() as *mut isize
+            } else {
+                ptr::null_mut()
+            };
+            (*view).strides = if requested(ffi::PyBUF_STRIDES) {
+                this.strides.as_ptr() as *mut isize
+            } else {
+                ptr::null_mut()
+            };
+            (*view).suboffsets = ptr::null_mut();
+            (*view).internal = ptr::null_mut();
+            (*view).obj = slf.into_any().into_ptr();
+        }
+        Ok(())
+    }
+}
+
 /// Python-visible atom data.
 #[pyclass(name = "Atom", from_py_object)]
 #[derive(Clone)]
@@ -150,6 +301,59 @@ impl PyConFrame {
         self.atoms_inner.len()
     }
 
+    /// Positions as a new `(n_atoms, 3)` float64 array.
+    #[getter]
+    fn positions<'py>(&self, py: Python<'py>) -> PyResult<Bound<'py, PyAny>> {
+        let mut xyz = Vec::with_capacity(3 * self.atoms_inner.len());
+        for atom in &self.atoms_inner {
+            xyz.extend_from_slice(&[atom.x, atom.y, atom.z]);
+        }
+        ArrayBuffer::into_ndarray(py, xyz, &[self.atoms_inner.len(), 3])
+    }
+
+    /// Velocities as a new `(n_atoms, 3)` float64 array, or `None` for
+    /// frames without velocities.
+    #[getter]
+    fn velocities<'py>(&self, py: Python<'py>) -> PyResult<Option<Bound<'py, PyAny>>> {
+        if !self.has_velocities {
+            return Ok(None);
+        }
+        let mut v = Vec::with_capacity(3 * self.atoms_inner.len());
+        for atom in &self.atoms_inner {
+            v.extend_from_slice(&[
+                atom.vx.unwrap_or(0.0),
+                atom.vy.unwrap_or(0.0),
+                atom.vz.unwrap_or(0.0),
+            ]);
+        }
+        ArrayBuffer::into_ndarray(py, v, &[self.atoms_inner.len(), 3]).map(Some)
+    }
+
+    /// Atom ids as a new uint64 array.
+    #[getter]
+    fn atom_ids<'py>(&self, py: Python<'py>) -> PyResult<Bound<'py, PyAny>> {
+        let ids: Vec<u64> = self.atoms_inner.iter().map(|a| a.atom_id).collect();
+        ArrayBuffer::into_ndarray(py, ids, &[self.atoms_inner.len()])
+    }
+
+    /// Fixed-atom flags as a new bool array.
+    #[getter]
+    fn fixed<'py>(&self, py: Python<'py>) -> PyResult<Bound<'py, PyAny>> {
+        let fixed: Vec<bool> = self.atoms_inner.iter().map(|a| a.is_fixed).collect();
+        ArrayBuffer::into_ndarray(py, fixed, &[self.atoms_inner.len()])
+    }
+
+    /// Atomic numbers as a new int64 array; unknown symbols give 0.
+    #[getter]
+    fn atomic_numbers<'py>(&self, py: Python<'py>) -> PyResult<Bound<'py, PyAny>> {
+        let numbers: Vec<i64> = self
+            .atoms_inner
+            .iter()
+            .map(|a| symbol_to_atomic_number(&a.symbol) as i64)
+            .collect();
+        ArrayBuffer::into_ndarray(py, numbers, &[self.atoms_inner.len()])
+    }
+
     /// Convert this frame to an ASE Atoms object (requires ase package).
     fn to_ase(&self, py: Python<'_>) -> PyResult<Py<PyAny>> {
         ase_from_pyconframe(py, self)
@@ -243,24 +447,179 @@ impl PyConFrame {
     }
 }
 
-/// Read frames from a .con or .convel file path.
+fn parse_error(e: ParseError) -> PyErr {
+    PyIOError::new_err(format!("parse error: {e}"))
+}
+
+/// Maps a file-reading error to `OSError`, keeping the parse/read split of
+/// the messages.
+fn read_error(e: Box<dyn std::error::Error>) -> PyErr {
+    if e.is::<ParseError>() {
+        PyIOError::new_err(format!("parse error: {e}"))
+    } else {
+        PyIOError::new_err(format!("failed to read file: {e}"))
+    }
+}
+
+/// Read frames from a .con, .convel or .conb file path.
+///
+/// Large files are memory-mapped, and parsing runs with the GIL released.
+/// With `threads`, frames are parsed on a pool of that many workers (0 for
+/// one per CPU); without the `parallel` feature this falls back to serial
+/// parsing.
 #[pyfunction]
-fn read_con(path: &str) -> PyResult<Vec<PyConFrame>> {
-    let contents = std::fs::read_to_string(path)
-        .map_err(|e| PyIOError::new_err(format!("failed to read file: {e}")))?;
-    read_con_string(&contents)
+#[pyo3(signature = (path, threads=None))]
+fn read_con(py: Python<'_>, path: &str, threads: Option<usize>) -> PyResult<Vec<PyConFrame>> {
+    py.detach(|| {
+        let path = Path::new(path);
+        let frames = match threads {
+            #[cfg(feature = "parallel")]
+            Some(n_threads) => read_all_frames_parallel(path, n_threads),
+            _ => read_all_frames(path),
+        }
+        .map_err(read_error)?;
+        Ok(frames.iter().map(PyConFrame::from).collect())
+    })
 }
 
 /// Read frames from a string containing .con or .convel data.
 #[pyfunction]
-fn read_con_string(contents: &str) -> PyResult<Vec<PyConFrame>> {
-    let iter = ConFrameIterator::new(contents);
-    let mut frames = Vec::new();
-    for result in iter {
-        let frame = result.map_err(|e| PyIOError::new_err(format!("parse error: {e}")))?;
-        frames.push(PyConFrame::from(&frame));
+fn read_con_string(py: Python<'_>, contents: &str) -> PyResult<Vec<PyConFrame>> {
+    py.detach(|| {
+        let iter = ConFrameIterator::new(contents);
+        let mut frames = Vec::new();
+        for result in iter {
+            let frame = result.map_err(parse_error)?;
+            frames.push(PyConFrame::from(&frame));
+        }
+        Ok(frames)
+    })
+}
+
+/// Position state of a lazy `ConFrameIterator`.
+struct FrameCursor {
+    iter: ConFrameFileIterator,
+    /// The frame the underlying iterator parses next.
+    position: usize,
+    /// The frame `__next__` returns next.
+    next: usize,
+}
+
+impl FrameCursor {
+    /// Parses frame `frame_no`, seeking through the index only when it is
+    /// not the frame the iterator is already positioned at.
+    fn read(&mut self, frame_no: usize) -> Result<ConFrame, ParseError> {
+        if frame_no != self.position {
+            self.iter.seek(frame_no)?;
+            self.position = frame_no;
+        }
+        let frame = self.iter.next().unwrap_or(Err(ParseError::IncompleteFrame))?;
+        self.position += 1;
+        Ok(frame)
+    }
+}
+
+/// Lazy, random-access reader over a trajectory file.
+///
+/// Frames are parsed on demand with the GIL released. `len()`, indexing and
+/// slicing go through the frame index, built by one header-only scan on first
+/// use; iteration continues independently of indexing.
+#[pyclass(name = "ConFrameIterator", frozen)]
+struct PyConFrameIterator {
+    cursor: Mutex<FrameCursor>,
+}
+
+impl PyConFrameIterator {
+    fn lock(&self) -> std::sync::MutexGuard<'_, FrameCursor> {
+        self.cursor.lock().unwrap_or_else(|poisoned| poisoned.into_inner())
+    }
+
+    fn len(&self) -> PyResult<usize> {
+        self.lock().iter.len().map_err(parse_error)
+    }
+}
+
+#[pymethods]
+impl PyConFrameIterator {
+    #[new]
+    fn new(path: &str) -> PyResult<Self> {
+        let iter = ConFrameFileIterator::open(Path::new(path))
+            .map_err(|e| PyIOError::new_err(format!("failed to read file: {e}")))?;
+        Ok(PyConFrameIterator {
+            cursor: Mutex::new(FrameCursor {
+                iter,
+                position: 0,
+                next: 0,
+            }),
+        })
+    }
+
+    fn __len__(&self, py: Python<'_>) -> PyResult<usize> {
+        py.detach(|| self.len())
+    }
+
+    fn __iter__(slf: PyRef<'_, Self>) -> PyRef<'_, Self> {
+        slf
+    }
+
+    fn __next__(&self, py: Python<'_>) -> PyResult<Option<PyConFrame>> {
+        py.detach(|| {
+            let mut cursor = self.lock();
+            let frame_no = cursor.next;
+            if frame_no != cursor.position {
+                // Indexing moved the underlying iterator; return through the
+                // index to where iteration left off.
+                if frame_no >= cursor.iter.len().map_err(parse_error)? {
+                    return Ok(None);
+                }
+                cursor.iter.seek(frame_no).map_err(parse_error)?;
+                cursor.position = frame_no;
+            }
+            match cursor.iter.next() {
+                None => Ok(None),
+                Some(result) => {
+                    let frame = result.map_err(parse_error)?;
+                    cursor.position += 1;
+                    cursor.next += 1;
+                    Ok(Some(PyConFrame::from(&frame)))
+                }
+            }
+        })
+    }
+
+    /// Returns one frame for an integer index (negative counts from the end)
+    /// or a list of frames for a slice.
+    fn __getitem__(&self, py: Python<'_>, key: &Bound<'_, PyAny>) -> PyResult<Py<PyAny>> {
+        let len = py.detach(|| self.len())?;
+        if let Ok(index) = key.extract::<isize>() {
+            let frame_no = if index < 0 { index + len as isize } else { index };
+            if frame_no < 0 || frame_no >= len as isize {
+                return Err(PyIndexError::new_err("frame index out of range"));
+            }
+            let frame = py.detach(|| {
+                self.lock()
+                    .read(frame_no as usize)
+                    .map(|frame| PyConFrame::from(&frame))
+                    .map_err(parse_error)
+            })?;
+            return Ok(Py::new(py, frame)?.into_any());
+        }
+        let slice: Bound<'_, PySlice> = key.extract()?;
+        let indices = slice.indices(len as isize)?;
+        let frames = py.detach(|| {
+            let mut cursor = self.lock();
+            (0..indices.slicelength)
+                .map(|i| {
+                    let frame_no = (indices.start + i as isize * indices.step) as usize;
+                    cursor
+                        .read(frame_no)
+                        .map(|frame| PyConFrame::from(&frame))
+                        .map_err(parse_error)
+                })
+                .collect::<PyResult<Vec<_>>>()
+        })?;
+        Ok(frames.into_pyobject(py)?.into_any().unbind())
     }
-    Ok(frames)
 }
 
 /// Write frames to a .con or .convel file path.
@@ -291,11 +650,125 @@ fn write_con_string(frames: Vec<PyConFrame>, precision: usize) -> PyResult<Strin
     String::from_utf8(buffer).map_err(|e| PyIOError::new_err(format!("utf8 error: {e}")))
 }
 
+/// A fixed-composition trajectory flattened into per-field buffers.
+struct StackedFrames {
+    n_frames: usize,
+    n_atoms: usize,
+    positions: Vec<f64>,
+    velocities: Option<Vec<f64>>,
+    atom_ids: Vec<u64>,
+    fixed: Vec<bool>,
+    cells: Vec<f64>,
+    angles: Vec<f64>,
+    atomic_numbers: Vec<i64>,
+}
+
+/// Parses every frame of `path` straight into a `StackedFrames`, reusing one
+/// `ConFrame` throughout. Needs no GIL.
+fn stack_frames(path: &str) -> PyResult<StackedFrames> {
+    let mut iter = ConFrameFileIterator::open(Path::new(path))
+        .map_err(|e| PyIOError::new_err(format!("failed to read file: {e}")))?;
+
+    let mut stacked = StackedFrames {
+        n_frames: 0,
+        n_atoms: 0,
+        positions: Vec::new(),
+        velocities: None,
+        atom_ids: Vec::new(),
+        fixed: Vec::new(),
+        cells: Vec::new(),
+        angles: Vec::new(),
+        atomic_numbers: Vec::new(),
+    };
+    let Some(mut frame) = iter.next().transpose().map_err(parse_error)? else {
+        return Ok(stacked);
+    };
+    let components = frame.components();
+    for run in &components {
+        stacked
+            .atomic_numbers
+            .extend(std::iter::repeat_n(run.atomic_number as i64, run.count));
+    }
+    stacked.n_atoms = frame.atom_data.len();
+    let with_velocities = frame.has_velocities();
+    let mut velocities = Vec::new();
+    loop {
+        if frame.atom_data.len() != stacked.n_atoms
+            || frame.has_velocities() != with_velocities
+            || frame.components() != components
+        {
+            return Err(PyValueError::new_err(format!(
+                "frame {} does not match the composition of frame 0",
+                stacked.n_frames
+            )));
+        }
+        stacked.cells.extend_from_slice(&frame.header.boxl);
+        stacked.angles.extend_from_slice(&frame.header.angles);
+        for atom in &frame.atom_data {
+            stacked.positions.extend_from_slice(&[atom.x, atom.y, atom.z]);
+            stacked.atom_ids.push(atom.atom_id);
+            stacked.fixed.push(atom.is_fixed);
+        }
+        if with_velocities {
+            for atom in &frame.atom_data {
+                velocities.extend_from_slice(&[
+                    atom.vx.unwrap_or(0.0),
+                    atom.vy.unwrap_or(0.0),
+                    atom.vz.unwrap_or(0.0),
+                ]);
+            }
+        }
+        stacked.n_frames += 1;
+        match iter.next_into(&mut frame) {
+            Some(result) => result.map_err(parse_error)?,
+            None => break,
+        }
+    }
+    stacked.velocities = with_velocities.then_some(velocities);
+    Ok(stacked)
+}
+
+/// Read a fixed-composition trajectory into stacked NumPy arrays.
+///
+/// Returns a dict with `positions` and `velocities` of shape
+/// `(n_frames, n_atoms, 3)` (`velocities` is `None` without a velocity
+/// section), `atom_ids` and `fixed` of shape `(n_frames, n_atoms)`, `cell`
+/// and `angles` of shape `(n_frames, 3)` and `atomic_numbers` of shape
+/// `(n_atoms,)`. Frames are parsed straight into the arrays with the GIL
+/// released and without building any per-atom objects; a frame whose
+/// components differ from the first raises `ValueError`.
+#[pyfunction]
+fn read_con_arrays<'py>(py: Python<'py>, path: &str) -> PyResult<Bound<'py, PyDict>> {
+    let stacked = py.detach(|| stack_frames(path))?;
+    let (f, n) = (stacked.n_frames, stacked.n_atoms);
+    let arrays = PyDict::new(py);
+    arrays.set_item(
+        "positions",
+        ArrayBuffer::into_ndarray(py, stacked.positions, &[f, n, 3])?,
+    )?;
+    match stacked.velocities {
+        Some(velocities) => arrays.set_item(
+            "velocities",
+            ArrayBuffer::into_ndarray(py, velocities, &[f, n, 3])?,
+        )?,
+        None => arrays.set_item("velocities", py.None())?,
+    }
+    arrays.set_item("atom_ids", ArrayBuffer::into_ndarray(py, stacked.atom_ids, &[f, n])?)?;
+    arrays.set_item("fixed", ArrayBuffer::into_ndarray(py, stacked.fixed, &[f, n])?)?;
+    arrays.set_item("cell", ArrayBuffer::into_ndarray(py, stacked.cells, &[f, 3])?)?;
+    arrays.set_item("angles", ArrayBuffer::into_ndarray(py, stacked.angles, &[f, 3])?)?;
+    arrays.set_item(
+        "atomic_numbers",
+        ArrayBuffer::into_ndarray(py, stacked.atomic_numbers, &[n])?,
+    )?;
+    Ok(arrays)
+}
+
 /// Read a .con file and return a list of ASE Atoms objects.
 /// Requires the ase package.
 #[pyfunction]
 fn read_con_as_ase(py: Python<'_>, path: &str) -> PyResult<Vec<Py<PyAny>>> {
-    let frames = read_con(path)?;
+    let frames = read_con(py, path, None)?;
     frames
         .iter()
         .map(|f| ase_from_pyconframe(py, f))
@@ -310,11 +783,7 @@ fn ase_from_pyconframe(py: Python<'_>, frame: &PyConFrame) -> PyResult<Py<PyAny>
 
     // Build symbols list and positions array
     let symbols: Vec<&str> = frame.atoms_inner.iter().map(|a| a.symbol.as_str()).collect();
-    let positions: Vec<[f64; 3]> = frame
-        .atoms_inner
-        .iter()
-        .map(|a| [a.x, a.y, a.z])
-        .collect();
+    let positions = frame.positions(py)?;
 
     // Build cell from lengths + angles using ASE's cellpar_to_cell
     let cellpar: Vec<f64> = frame
@@ -334,7 +803,7 @@ fn ase_from_pyconframe(py: Python<'_>, frame: &PyConFrame) -> PyResult<Py<PyAny>
         Some(
             &[
                 ("symbols", symbols.into_pyobject(py)?.into_any()),
-                ("positions", positions.into_pyobject(py)?.into_any()),
+                ("positions", positions),
                 ("cell", cell.into_any()),
                 ("pbc", true.into_pyobject(py)?.to_owned().into_any()),
             ]
@@ -446,15 +915,61 @@ fn pyconframe_from_ase(_py: Python<'_>, ase_atoms: &Bound<'_, PyAny>) -> PyResul
     })
 }
 
+/// Return the library's instrumentation counters as a dict.
+///
+/// Holds `enabled`, the totals `bytes_scanned`, `frames_parsed`,
+/// `atoms_parsed`, `bytes_written`, `frames_written`, `atoms_written` and
+/// `allocations`, and a `{"calls", "nanos"}` dict per stage
+/// (`parse_frame_header`, `parse_single_frame`, `parse_velocity_section`,
+/// `rkr_frame_to_c_frame`, `write_frame`). Counters are all zero unless the
+/// extension was built with the `instrumentation` feature.
+#[pyfunction(name = "stats")]
+fn py_stats(py: Python<'_>) -> PyResult<Bound<'_, PyDict>> {
+    let s = crate::stats::snapshot();
+    let dict = PyDict::new(py);
+    dict.set_item("enabled", crate::stats::enabled())?;
+    dict.set_item("bytes_scanned", s.bytes_scanned)?;
+    dict.set_item("frames_parsed", s.frames_parsed)?;
+    dict.set_item("atoms_parsed", s.atoms_parsed)?;
+    dict.set_item("bytes_written", s.bytes_written)?;
+    dict.set_item("frames_written", s.frames_written)?;
+    dict.set_item("atoms_written", s.atoms_written)?;
+    dict.set_item("allocations", s.allocations)?;
+    for stage in [
+        Stage::ParseFrameHeader,
+        Stage::ParseSingleFrame,
+        Stage::ParseVelocitySection,
+        Stage::FrameToCFrame,
+        Stage::WriteFrame,
+    ] {
+        let counters = s.stage(stage);
+        let entry = PyDict::new(py);
+        entry.set_item("calls", counters.calls)?;
+        entry.set_item("nanos", counters.nanos)?;
+        dict.set_item(stage.name(), entry)?;
+    }
+    Ok(dict)
+}
+
+/// Reset every instrumentation counter to zero.
+#[pyfunction]
+fn reset_stats() {
+    crate::stats::reset();
+}
+
 /// readcon Python module implemented in Rust.
 #[pymodule]
 fn readcon(m: &Bound<'_, PyModule>) -> PyResult<()> {
     m.add_class::<PyAtomDatum>()?;
     m.add_class::<PyConFrame>()?;
+    m.add_class::<PyConFrameIterator>()?;
     m.add_function(wrap_pyfunction!(read_con, m)?)?;
     m.add_function(wrap_pyfunction!(read_con_string, m)?)?;
     m.add_function(wrap_pyfunction!(write_con, m)?)?;
     m.add_function(wrap_pyfunction!(write_con_string, m)?)?;
     m.add_function(wrap_pyfunction!(read_con_as_ase, m)?)?;
+    m.add_function(wrap_pyfunction!(read_con_arrays, m)?)?;
+    m.add_function(wrap_pyfunction!(py_stats, m)?)?;
+    m.add_function(wrap_pyfunction!(reset_stats, m)?)?;
     Ok(())
 }
@@ -1,8 +1,34 @@
-use capnp_rpc::{RpcSystem, twoparty, rpc_twoparty_capnp};
+use std::cell::RefCell;
+use std::ops::Range;
+use std::rc::Rc;
+
+use capnp::capability::Promise;
+use capnp_rpc::{RpcSystem, pry, twoparty, rpc_twoparty_capnp};
+use futures::AsyncReadExt;
 
 use crate::iterators::ConFrameIterator;
-use crate::types::ConFrame;
-use super::read_con_capnp::read_con_service;
+use crate::parser::ParseOptions;
+use crate::types::{ConFrame, FrameHeader};
+use super::packed;
+use super::read_con_capnp::{frame_sink, read_con_service, trajectory};
+use super::server::DEFAULT_STREAM_WINDOW;
+
+/// Collects the frames of a streamed parse.
+struct CollectingSink {
+    frames: Rc<RefCell<Vec<ConFrame>>>,
+}
+
+impl frame_sink::Server for CollectingSink {
+    fn frame(
+        &mut self,
+        params: frame_sink::FrameParams,
+        _: frame_sink::FrameResults,
+    ) -> Promise<(), capnp::Error> {
+        let frame = pry!(packed::decode_frame(pry!(pry!(params.get()).get_frame())));
+        self.frames.borrow_mut().push(frame);
+        Promise::ok(())
+    }
+}
 
 /// A synchronous RPC client that wraps the Cap'n Proto async transport.
 pub struct RpcClient {
@@ -78,6 +104,147 @@ impl RpcClient {
         })
     }
 
+    /// Parses raw file bytes through the server's streaming interface.
+    ///
+    /// The bytes are pushed in chunks of `chunk_size`, and the server sends
+    /// each frame back as a packed frame as soon as it is complete, so
+    /// neither side holds the whole trajectory in one message. Each push
+    /// waits for the server's flow-control window, bounding memory on both
+    /// ends. A malformed frame fails the call instead of being skipped.
+    pub fn parse_bytes_streamed(
+        &self,
+        data: &[u8],
+        chunk_size: usize,
+    ) -> Result<Vec<ConFrame>, Box<dyn std::error::Error>> {
+        let local = tokio::task::LocalSet::new();
+        local.block_on(&self.runtime, async {
+            let stream = tokio::net::TcpStream::connect(&self.addr).await?;
+            stream.set_nodelay(true)?;
+            let (reader, writer) =
+                tokio_util::compat::TokioAsyncReadCompatExt::compat(stream).split();
+            let network = twoparty::VatNetwork::new(
+                reader,
+                writer,
+                rpc_twoparty_capnp::Side::Client,
+                Default::default(),
+            );
+            let mut rpc_system = RpcSystem::new(Box::new(network), None);
+            let service: read_con_service::Client =
+                rpc_system.bootstrap(rpc_twoparty_capnp::Side::Server);
+            tokio::task::spawn_local(rpc_system);
+
+            let frames = Rc::new(RefCell::new(Vec::new()));
+            let sink: frame_sink::Client = capnp_rpc::new_client(CollectingSink {
+                frames: Rc::clone(&frames),
+            });
+            let mut request = service.open_parse_stream_request();
+            request.get().set_sink(sink);
+            request.get().set_window(DEFAULT_STREAM_WINDOW);
+            // Pipelined: pushes are queued before the stream is even returned.
+            let parser = request.send().pipeline.get_parser();
+
+            for chunk in data.chunks(chunk_size.max(1)) {
+                let mut push = parser.push_request();
+                push.get().set_chunk(chunk);
+                push.send().promise.await?;
+            }
+            let response = parser.finish_request().send().promise.await?;
+            let num_frames = response.get()?.get_num_frames();
+            let frames = frames.take();
+            if frames.len() as u64 != num_frames {
+                return Err(format!(
+                    "server sent {num_frames} frames but {} arrived",
+                    frames.len()
+                )
+                .into());
+            }
+            Ok(frames)
+        })
+    }
+
+    /// Returns the headers of every frame of a trajectory on the server's
+    /// filesystem.
+    ///
+    /// The server opens (or joins) a shared session for `path`, so repeated
+    /// calls from any client reuse its index and header scan.
+    pub fn fetch_headers(
+        &self,
+        path: &str,
+    ) -> Result<Vec<FrameHeader>, Box<dyn std::error::Error>> {
+        let local = tokio::task::LocalSet::new();
+        local.block_on(&self.runtime, async {
+            let trajectory = self.open_trajectory(path).await?;
+            let response = trajectory.get_headers_request().send().promise.await?;
+            let headers = response.get()?.get_headers()?;
+            let headers: Result<Vec<_>, _> = headers.iter().map(packed::decode_header).collect();
+            Ok(headers?)
+        })
+    }
+
+    /// Returns frames `range` of a trajectory on the server's filesystem,
+    /// projected by `options`.
+    ///
+    /// Frames come from the server's shared session cache when another
+    /// request already parsed them.
+    pub fn fetch_frames(
+        &self,
+        path: &str,
+        range: Range<usize>,
+        options: &ParseOptions,
+    ) -> Result<Vec<ConFrame>, Box<dyn std::error::Error>> {
+        let local = tokio::task::LocalSet::new();
+        local.block_on(&self.runtime, async {
+            let trajectory = self.open_trajectory(path).await?;
+            let mut request = trajectory.get_frames_request();
+            request.get().set_start(range.start as u64);
+            request.get().set_end(range.end as u64);
+            let mut projection = request.get().init_projection();
+            projection.set_header_only(options.header_only);
+            projection.set_skip_velocities(options.skip_velocities);
+            let mut components = projection
+                .reborrow()
+                .init_components(options.components.len() as u32);
+            for (i, symbol) in options.components.iter().enumerate() {
+                components.set(i as u32, symbol.as_str());
+            }
+            if let Some(ids) = &options.atom_ids {
+                projection.set_filter_atom_ids(true);
+                projection.set_atom_id_min(ids.start);
+                projection.set_atom_id_max(ids.end);
+            }
+            let response = request.send().promise.await?;
+            let frames = response.get()?.get_frames()?;
+            let frames: Result<Vec<_>, _> = frames.iter().map(packed::decode_frame).collect();
+            Ok(frames?)
+        })
+    }
+
+    /// Connects and returns a pipelined `Trajectory` for `path`. Must run
+    /// inside a `LocalSet`.
+    async fn open_trajectory(
+        &self,
+        path: &str,
+    ) -> Result<trajectory::Client, Box<dyn std::error::Error>> {
+        let stream = tokio::net::TcpStream::connect(&self.addr).await?;
+        stream.set_nodelay(true)?;
+        let (reader, writer) =
+            tokio_util::compat::TokioAsyncReadCompatExt::compat(stream).split();
+        let network = twoparty::VatNetwork::new(
+            reader,
+            writer,
+            rpc_twoparty_capnp::Side::Client,
+            Default::default(),
+        );
+        let mut rpc_system = RpcSystem::new(Box::new(network), None);
+        let service: read_con_service::Client =
+            rpc_system.bootstrap(rpc_twoparty_capnp::Side::Server);
+        tokio::task::spawn_local(rpc_system);
+
+        let mut request = service.open_trajectory_request();
+        request.get().set_path(path);
+        Ok(request.send().pipeline.get_trajectory())
+    }
+
     /// Writes frames by sending them to the RPC server, receiving serialized output.
     pub fn write_frames(
         &self,
@@ -2,5 +2,7 @@ pub mod read_con_capnp {
     include!(concat!(env!("OUT_DIR"), "/ReadCon_capnp.rs"));
 }
 
+pub mod packed;
 pub mod server;
+pub mod session;
 pub mod client;
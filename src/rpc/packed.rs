@@ -0,0 +1,244 @@
+//! Conversion between `ConFrame` and the schema's `PackedFrame`.
+//!
+//! A packed frame stores each per-atom field as one primitive list and the
+//! symbols once per component, so encoding is a handful of list fills and
+//! the message carries no per-atom text.
+
+use std::sync::Arc;
+
+use crate::types::{AtomDatum, ConFrame, FrameHeader};
+
+use super::read_con_capnp::{frame_header_data, packed_frame};
+
+/// Fills `builder` with `frame`.
+pub fn encode_frame(frame: &ConFrame, mut builder: packed_frame::Builder<'_>) {
+    let header = &frame.header;
+    let mut cell = builder.reborrow().init_cell(3);
+    for (i, &v) in header.boxl.iter().enumerate() {
+        cell.set(i as u32, v);
+    }
+    let mut angles = builder.reborrow().init_angles(3);
+    for (i, &v) in header.angles.iter().enumerate() {
+        angles.set(i as u32, v);
+    }
+    let mut prebox = builder.reborrow().init_prebox_header(2);
+    prebox.set(0, &header.prebox_header[0]);
+    prebox.set(1, &header.prebox_header[1]);
+    let mut postbox = builder.reborrow().init_postbox_header(2);
+    postbox.set(0, &header.postbox_header[0]);
+    postbox.set(1, &header.postbox_header[1]);
+
+    let mut components = builder
+        .reborrow()
+        .init_components(header.natms_per_type.len() as u32);
+    let mut offset = 0;
+    for (i, (&count, &mass)) in header
+        .natms_per_type
+        .iter()
+        .zip(&header.masses_per_type)
+        .enumerate()
+    {
+        let mut run = components.reborrow().get(i as u32);
+        let symbol = frame.atom_data.get(offset).map_or("", |a| a.symbol.as_str());
+        run.set_symbol(symbol);
+        run.set_mass(mass);
+        run.set_count(count as u64);
+        offset += count;
+    }
+
+    let atoms = &frame.atom_data;
+    let n = atoms.len() as u32;
+    let mut positions = builder.reborrow().init_positions(3 * n);
+    for (i, atom) in atoms.iter().enumerate() {
+        let i = 3 * i as u32;
+        positions.set(i, atom.x);
+        positions.set(i + 1, atom.y);
+        positions.set(i + 2, atom.z);
+    }
+    if frame.has_velocities() {
+        let mut velocities = builder.reborrow().init_velocities(3 * n);
+        for (i, atom) in atoms.iter().enumerate() {
+            let i = 3 * i as u32;
+            velocities.set(i, atom.vx.unwrap_or(0.0));
+            velocities.set(i + 1, atom.vy.unwrap_or(0.0));
+            velocities.set(i + 2, atom.vz.unwrap_or(0.0));
+        }
+    }
+    let mut ids = builder.reborrow().init_atom_ids(n);
+    for (i, atom) in atoms.iter().enumerate() {
+        ids.set(i as u32, atom.atom_id);
+    }
+    let mut fixed = builder.init_is_fixed(n);
+    for (i, atom) in atoms.iter().enumerate() {
+        fixed.set(i as u32, atom.is_fixed);
+    }
+}
+
+/// Fills `builder` with the metadata of `header`.
+pub fn encode_header(header: &FrameHeader, mut builder: frame_header_data::Builder<'_>) {
+    let mut cell = builder.reborrow().init_cell(3);
+    for (i, &v) in header.boxl.iter().enumerate() {
+        cell.set(i as u32, v);
+    }
+    let mut angles = builder.reborrow().init_angles(3);
+    for (i, &v) in header.angles.iter().enumerate() {
+        angles.set(i as u32, v);
+    }
+    let mut prebox = builder.reborrow().init_prebox_header(2);
+    prebox.set(0, &header.prebox_header[0]);
+    prebox.set(1, &header.prebox_header[1]);
+    let mut postbox = builder.reborrow().init_postbox_header(2);
+    postbox.set(0, &header.postbox_header[0]);
+    postbox.set(1, &header.postbox_header[1]);
+    let mut counts = builder
+        .reborrow()
+        .init_natms_per_type(header.natms_per_type.len() as u32);
+    for (i, &n) in header.natms_per_type.iter().enumerate() {
+        counts.set(i as u32, n as u64);
+    }
+    let mut masses = builder.init_masses_per_type(header.masses_per_type.len() as u32);
+    for (i, &m) in header.masses_per_type.iter().enumerate() {
+        masses.set(i as u32, m);
+    }
+}
+
+/// Rebuilds a `FrameHeader` from its schema form.
+pub fn decode_header(reader: frame_header_data::Reader<'_>) -> capnp::Result<FrameHeader> {
+    let natms_per_type: Vec<usize> = reader
+        .get_natms_per_type()?
+        .iter()
+        .map(|n| n as usize)
+        .collect();
+    let masses_per_type: Vec<f64> = reader.get_masses_per_type()?.iter().collect();
+    if masses_per_type.len() != natms_per_type.len() {
+        return Err(capnp::Error::failed(
+            "header has mismatched per-type lists".to_string(),
+        ));
+    }
+    Ok(FrameHeader {
+        prebox_header: header_lines(reader.get_prebox_header()?)?,
+        boxl: triple(reader.get_cell()?)?,
+        angles: triple(reader.get_angles()?)?,
+        postbox_header: header_lines(reader.get_postbox_header()?)?,
+        natm_types: natms_per_type.len(),
+        natms_per_type,
+        masses_per_type,
+    })
+}
+
+fn triple(list: capnp::primitive_list::Reader<'_, f64>) -> capnp::Result<[f64; 3]> {
+    if list.len() != 3 {
+        return Err(capnp::Error::failed("expected three values".to_string()));
+    }
+    Ok([list.get(0), list.get(1), list.get(2)])
+}
+
+fn header_lines(list: capnp::text_list::Reader<'_>) -> capnp::Result<[String; 2]> {
+    if list.len() != 2 {
+        return Err(capnp::Error::failed("expected two header lines".to_string()));
+    }
+    Ok([
+        list.get(0)?.to_str()?.to_string(),
+        list.get(1)?.to_str()?.to_string(),
+    ])
+}
+
+/// Rebuilds a `ConFrame` from a packed frame, checking that the lists agree
+/// with the component counts.
+pub fn decode_frame(reader: packed_frame::Reader<'_>) -> capnp::Result<ConFrame> {
+    let components = reader.get_components()?;
+    let mut natms_per_type = Vec::with_capacity(components.len() as usize);
+    let mut masses_per_type = Vec::with_capacity(components.len() as usize);
+    let mut symbols = Vec::with_capacity(components.len() as usize);
+    for run in components.iter() {
+        let count = usize::try_from(run.get_count()).map_err(|_| {
+            capnp::Error::failed("packed frame component count does not fit in memory".to_string())
+        })?;
+        natms_per_type.push(count);
+        masses_per_type.push(run.get_mass());
+        symbols.push(Arc::new(run.get_symbol()?.to_str()?.to_string()));
+    }
+
+    let positions = reader.get_positions()?;
+    let velocities = reader.get_velocities()?;
+    let ids = reader.get_atom_ids()?;
+    let fixed = reader.get_is_fixed()?;
+    let n = ids.len() as usize;
+    let with_velocities = velocities.len() != 0;
+    if positions.len() as usize != 3 * n
+        || fixed.len() as usize != n
+        || (with_velocities && velocities.len() as usize != 3 * n)
+    {
+        return Err(capnp::Error::failed(
+            "packed frame columns have inconsistent lengths".to_string(),
+        ));
+    }
+    // The counts come from the peer, so their sum must not wrap.
+    let total = natms_per_type
+        .iter()
+        .try_fold(0usize, |sum, &count| sum.checked_add(count))
+        .ok_or_else(|| {
+            capnp::Error::failed("packed frame component counts overflow".to_string())
+        })?;
+    // Header-only frames keep their counts but carry no atoms.
+    if n != 0 && total != n {
+        return Err(capnp::Error::failed(
+            "packed frame component counts do not match its atoms".to_string(),
+        ));
+    }
+
+    let mut atom_data = Vec::with_capacity(n);
+    for (symbol, &count) in symbols.iter().zip(&natms_per_type) {
+        for _ in 0..count.min(n - atom_data.len()) {
+            let i = atom_data.len() as u32;
+            atom_data.push(AtomDatum {
+                symbol: Arc::clone(symbol),
+                x: positions.get(3 * i),
+                y: positions.get(3 * i + 1),
+                z: positions.get(3 * i + 2),
+                is_fixed: fixed.get(i),
+                atom_id: ids.get(i),
+                vx: with_velocities.then(|| velocities.get(3 * i)),
+                vy: with_velocities.then(|| velocities.get(3 * i + 1)),
+                vz: with_velocities.then(|| velocities.get(3 * i + 2)),
+            });
+        }
+    }
+
+    let header = FrameHeader {
+        prebox_header: header_lines(reader.get_prebox_header()?)?,
+        boxl: triple(reader.get_cell()?)?,
+        angles: triple(reader.get_angles()?)?,
+        postbox_header: header_lines(reader.get_postbox_header()?)?,
+        natm_types: natms_per_type.len(),
+        natms_per_type,
+        masses_per_type,
+    };
+    Ok(ConFrame { header, atom_data })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn overflowing_component_counts_are_rejected() {
+        let mut message = capnp::message::Builder::new_default();
+        let mut frame = message.init_root::<packed_frame::Builder<'_>>();
+        let mut components = frame.reborrow().init_components(2);
+        for i in 0..2 {
+            let mut run = components.reborrow().get(i);
+            run.set_symbol("H");
+            run.set_count(u64::MAX / 2 + 1);
+        }
+        frame.reborrow().init_positions(3);
+        frame.reborrow().init_atom_ids(1);
+        frame.reborrow().init_is_fixed(1);
+        let reader = message
+            .get_root_as_reader::<packed_frame::Reader<'_>>()
+            .unwrap();
+        // Their sum is 2^64: unchecked, it panics in debug builds and wraps
+        // to 0 in release.
+        assert!(decode_frame(reader).is_err());
+    }
+}
@@ -1,12 +1,52 @@
+use std::cell::RefCell;
+use std::collections::VecDeque;
+use std::future::Future;
+use std::path::{Path, PathBuf};
+use std::pin::Pin;
+use std::rc::Rc;
+
 use capnp::capability::Promise;
-use capnp_rpc::{RpcSystem, twoparty, rpc_twoparty_capnp};
+use capnp_rpc::{RpcSystem, pry, twoparty, rpc_twoparty_capnp};
+use futures::future::Shared;
+use futures::{AsyncReadExt, FutureExt};
 
+use crate::error::ParseError;
 use crate::iterators::ConFrameIterator;
+use crate::parser::{ParseOptions, parse_line_of_n};
 use crate::writer::ConFrameWriter;
 
-use super::read_con_capnp::read_con_service;
+use super::packed;
+use super::read_con_capnp::{frame_sink, parse_stream, projection, read_con_service, trajectory};
+use super::session::{DEFAULT_CACHE_BYTES, SessionRegistry, TrajectorySession};
+
+/// Sink calls kept in flight when a client asks for the default window.
+pub const DEFAULT_STREAM_WINDOW: u32 = 16;
+
+/// Settings for `start_server_with_config`.
+#[derive(Debug, Clone)]
+pub struct ServerConfig {
+    /// The directory `openTrajectory` paths are resolved against; paths
+    /// that leave it are refused. Unset (the default), `openTrajectory` is
+    /// refused altogether, so a server never exposes its filesystem unless
+    /// asked to.
+    pub trajectory_root: Option<PathBuf>,
+    /// Byte budget of each trajectory session's parsed-frame cache.
+    pub cache_bytes: usize,
+}
+
+impl Default for ServerConfig {
+    fn default() -> Self {
+        ServerConfig {
+            trajectory_root: None,
+            cache_bytes: DEFAULT_CACHE_BYTES,
+        }
+    }
+}
 
-struct ReadConServiceImpl;
+struct ReadConServiceImpl {
+    /// Shared by every connection, so clients opening one file share a session.
+    sessions: Rc<SessionRegistry>,
+}
 
 impl read_con_service::Server for ReadConServiceImpl {
     fn parse_frames(
@@ -21,8 +61,10 @@ impl read_con_service::Server for ReadConServiceImpl {
             Err(e) => return Promise::err(capnp::Error::failed(e.to_string())),
         };
 
-        let iter = ConFrameIterator::new(file_str);
-        let frames: Vec<_> = iter.filter_map(|r| r.ok()).collect();
+        let frames = match ConFrameIterator::new(file_str).collect::<Result<Vec<_>, _>>() {
+            Ok(frames) => frames,
+            Err(e) => return Promise::err(capnp::Error::failed(e.to_string())),
+        };
 
         let mut result_builder = results.get().init_result();
         let mut frames_builder = result_builder.reborrow().init_frames(frames.len() as u32);
@@ -79,7 +121,7 @@ impl read_con_service::Server for ReadConServiceImpl {
         mut results: read_con_service::WriteFramesResults,
     ) -> Promise<(), capnp::Error> {
         use crate::types::{AtomDatum, ConFrame, FrameHeader};
-        use std::rc::Rc;
+        use std::sync::Arc;
 
         let req = pry!(params.get());
         let frame_data_list = pry!(pry!(req.get_req()).get_frames());
@@ -137,7 +179,7 @@ impl read_con_service::Server for ReadConServiceImpl {
 
                 let has_vel = a.get_has_velocity();
                 atom_data.push(AtomDatum {
-                    symbol: Rc::new(sym),
+                    symbol: Arc::new(sym),
                     x: a.get_x(),
                     y: a.get_y(),
                     z: a.get_z(),
@@ -180,27 +222,563 @@ impl read_con_service::Server for ReadConServiceImpl {
 
         Promise::ok(())
     }
+
+    fn open_parse_stream(
+        &mut self,
+        params: read_con_service::OpenParseStreamParams,
+        mut results: read_con_service::OpenParseStreamResults,
+    ) -> Promise<(), capnp::Error> {
+        let params = pry!(params.get());
+        let sink = pry!(params.get_sink());
+        let window = match params.get_window() {
+            0 => DEFAULT_STREAM_WINDOW,
+            w => w,
+        };
+        let parser: parse_stream::Client =
+            capnp_rpc::new_client(ParseStreamImpl::new(sink, window as usize));
+        results.get().set_parser(parser);
+        Promise::ok(())
+    }
+
+    fn open_trajectory(
+        &mut self,
+        params: read_con_service::OpenTrajectoryParams,
+        mut results: read_con_service::OpenTrajectoryResults,
+    ) -> Promise<(), capnp::Error> {
+        let path = pry!(pry!(pry!(params.get()).get_path()).to_str());
+        let session = match self.sessions.open(Path::new(path)) {
+            Ok(session) => session,
+            Err(e) => return Promise::err(capnp::Error::failed(format!("{path}: {e}"))),
+        };
+        let client: trajectory::Client = capnp_rpc::new_client(TrajectoryImpl { session });
+        results.get().set_trajectory(client);
+        Promise::ok(())
+    }
+}
+
+/// Converts a schema projection into parse options.
+fn parse_options(projection: projection::Reader<'_>) -> capnp::Result<ParseOptions> {
+    let mut components = Vec::new();
+    for symbol in projection.get_components()?.iter() {
+        components.push(symbol?.to_str()?.to_string());
+    }
+    Ok(ParseOptions {
+        header_only: projection.get_header_only(),
+        skip_velocities: projection.get_skip_velocities(),
+        components,
+        atom_ids: projection
+            .get_filter_atom_ids()
+            .then(|| projection.get_atom_id_min()..projection.get_atom_id_max()),
+    })
+}
+
+/// One client's handle on a shared `TrajectorySession`.
+struct TrajectoryImpl {
+    session: Rc<TrajectorySession>,
+}
+
+impl trajectory::Server for TrajectoryImpl {
+    fn num_frames(
+        &mut self,
+        _: trajectory::NumFramesParams,
+        mut results: trajectory::NumFramesResults,
+    ) -> Promise<(), capnp::Error> {
+        results.get().set_count(self.session.len() as u64);
+        Promise::ok(())
+    }
+
+    fn get_headers(
+        &mut self,
+        _: trajectory::GetHeadersParams,
+        mut results: trajectory::GetHeadersResults,
+    ) -> Promise<(), capnp::Error> {
+        let headers = match self.session.headers() {
+            Ok(headers) => headers,
+            Err(e) => return Promise::err(capnp::Error::failed(e.to_string())),
+        };
+        let mut list = results.get().init_headers(headers.len() as u32);
+        for (i, header) in headers.iter().enumerate() {
+            packed::encode_header(header, list.reborrow().get(i as u32));
+        }
+        Promise::ok(())
+    }
+
+    fn get_frames(
+        &mut self,
+        params: trajectory::GetFramesParams,
+        mut results: trajectory::GetFramesResults,
+    ) -> Promise<(), capnp::Error> {
+        let params = pry!(params.get());
+        let options = if params.has_projection() {
+            pry!(parse_options(pry!(params.get_projection())))
+        } else {
+            ParseOptions::default()
+        };
+        let range = params.get_start() as usize..params.get_end() as usize;
+        let frames = match self.session.frames(range, &options) {
+            Ok(frames) => frames,
+            Err(e) => return Promise::err(capnp::Error::failed(e.to_string())),
+        };
+        let mut list = results.get().init_frames(frames.len() as u32);
+        for (i, frame) in frames.iter().enumerate() {
+            packed::encode_frame(frame, list.reborrow().get(i as u32));
+        }
+        Promise::ok(())
+    }
+}
+
+/// A sink call that every waiter on the stream can await; it resolves to
+/// the call's error message, if any.
+type SinkCall = Shared<Pin<Box<dyn Future<Output = Result<(), String>>>>>;
+
+/// The state of one streamed parse, shared by its in-progress calls.
+struct StreamState {
+    /// Received bytes not yet consumed by a sent frame.
+    buf: Vec<u8>,
+    sink: frame_sink::Client,
+    /// Sink calls sent but not yet acknowledged, oldest first, by frame
+    /// index. A call leaves only once it has resolved.
+    pending: VecDeque<(u64, SinkCall)>,
+    /// The most sink calls kept in `pending`.
+    window: usize,
+    frames_sent: u64,
+    finished: bool,
+    /// The first error, repeated to any later call.
+    failed: Option<String>,
+}
+
+impl StreamState {
+    /// Parses complete frames in `buf` and sends them to the sink while the
+    /// window has room, returning whether every complete frame was sent.
+    ///
+    /// Before `at_end`, a multi-byte character split across chunks stays
+    /// buffered along with any incomplete frame.
+    fn send_complete_frames(&mut self, at_end: bool) -> Result<bool, String> {
+        let valid = match std::str::from_utf8(&self.buf) {
+            Ok(text) => text.len(),
+            Err(e) if e.error_len().is_none() && !at_end => e.valid_up_to(),
+            Err(e) => return Err(e.to_string()),
+        };
+        // SAFETY: the first `valid` bytes were validated just above.
+        let text = unsafe { std::str::from_utf8_unchecked(&self.buf[..valid]) };
+        let mut consumed = 0;
+        let mut next = buffered_frame_len(text, at_end);
+        while let Some(len) = next {
+            if self.pending.len() >= self.window {
+                break;
+            }
+            let frame = ConFrameIterator::new(&text[consumed..consumed + len])
+                .next()
+                .unwrap_or(Err(ParseError::IncompleteFrame))
+                .map_err(|e| format!("frame {}: {e}", self.frames_sent))?;
+            let mut request = self.sink.frame_request();
+            request.get().set_index(self.frames_sent);
+            packed::encode_frame(&frame, request.get().init_frame());
+            let call: Pin<Box<dyn Future<Output = Result<(), String>>>> = Box::pin(
+                request
+                    .send()
+                    .promise
+                    .map(|r| r.map(drop).map_err(|e| e.to_string())),
+            );
+            self.pending.push_back((self.frames_sent, call.shared()));
+            self.frames_sent += 1;
+            consumed += len;
+            next = buffered_frame_len(&text[consumed..], at_end);
+        }
+        self.buf.drain(..consumed);
+        Ok(next.is_none())
+    }
+
+    /// Records the first failure and returns it as an RPC error.
+    fn fail(&mut self, message: String) -> capnp::Error {
+        let message = self.failed.get_or_insert(message).clone();
+        capnp::Error::failed(message)
+    }
+}
+
+/// Sends buffered frames until every complete one has gone out and, with
+/// `drain`, until every sent one has also been acknowledged.
+///
+/// Sending stops while the window is full and resumes as the oldest call
+/// is acknowledged. That call is awaited in place and only then removed,
+/// so `finish` cannot see an empty queue while a `push` is still waiting
+/// on an acknowledgement.
+async fn drive_stream(state: Rc<RefCell<StreamState>>, drain: bool) -> Result<(), capnp::Error> {
+    loop {
+        let (index, oldest) = {
+            let mut state = state.borrow_mut();
+            if let Some(message) = &state.failed {
+                return Err(capnp::Error::failed(message.clone()));
+            }
+            let at_end = state.finished;
+            let caught_up = match state.send_complete_frames(at_end) {
+                Ok(caught_up) => caught_up,
+                Err(message) => return Err(state.fail(message)),
+            };
+            if caught_up && (!drain || state.pending.is_empty()) {
+                return Ok(());
+            }
+            // Not caught up means the window is full, so a call is pending.
+            state.pending.front().cloned().unwrap()
+        };
+        if let Err(message) = oldest.await {
+            return Err(state.borrow_mut().fail(message));
+        }
+        let mut state = state.borrow_mut();
+        if state.pending.front().is_some_and(|(i, _)| *i == index) {
+            state.pending.pop_front();
+        }
+    }
+}
+
+struct ParseStreamImpl {
+    state: Rc<RefCell<StreamState>>,
+}
+
+impl ParseStreamImpl {
+    fn new(sink: frame_sink::Client, window: usize) -> Self {
+        ParseStreamImpl {
+            state: Rc::new(RefCell::new(StreamState {
+                buf: Vec::new(),
+                sink,
+                pending: VecDeque::new(),
+                window,
+                frames_sent: 0,
+                finished: false,
+                failed: None,
+            })),
+        }
+    }
+
+    /// Returns the recorded failure, or an error if the input has ended.
+    fn check_open(state: &mut StreamState) -> Result<(), capnp::Error> {
+        if let Some(message) = &state.failed {
+            return Err(capnp::Error::failed(message.clone()));
+        }
+        if state.finished {
+            return Err(capnp::Error::failed("parse stream already finished".to_string()));
+        }
+        Ok(())
+    }
+}
+
+impl parse_stream::Server for ParseStreamImpl {
+    fn push(
+        &mut self,
+        params: parse_stream::PushParams,
+        _: parse_stream::PushResults,
+    ) -> Promise<(), capnp::Error> {
+        let chunk = pry!(pry!(params.get()).get_chunk());
+        {
+            let mut state = self.state.borrow_mut();
+            pry!(Self::check_open(&mut state));
+            state.buf.extend_from_slice(chunk);
+        }
+        Promise::from_future(drive_stream(self.state.clone(), false))
+    }
+
+    fn finish(
+        &mut self,
+        _: parse_stream::FinishParams,
+        mut results: parse_stream::FinishResults,
+    ) -> Promise<(), capnp::Error> {
+        {
+            let mut state = self.state.borrow_mut();
+            pry!(Self::check_open(&mut state));
+            state.finished = true;
+        }
+        let state = self.state.clone();
+        Promise::from_future(async move {
+            drive_stream(state.clone(), true).await?;
+            results.get().set_num_frames(state.borrow().frames_sent);
+            Ok(())
+        })
+    }
+}
+
+/// Advances `pos` past `n` lines of `buf`, returning the last one, or `None`
+/// if fewer are available. Before `at_end`, an unterminated line does not
+/// count.
+fn take_lines<'a>(buf: &'a str, pos: &mut usize, n: usize, at_end: bool) -> Option<&'a str> {
+    let mut line = "";
+    for _ in 0..n {
+        let rest = &buf[*pos..];
+        if rest.is_empty() {
+            return None;
+        }
+        let len = match memchr::memchr(b'\n', rest.as_bytes()) {
+            Some(i) => i + 1,
+            None if at_end => rest.len(),
+            None => return None,
+        };
+        line = &rest[..len];
+        *pos += len;
+    }
+    Some(line)
+}
+
+/// Returns the length of the first frame in `buf` once it is completely
+/// buffered, or `None` if more input is needed.
+///
+/// This is the push-driven counterpart of `ConFrameStreamReader`: the extent
+/// comes from the atom-count header lines, and one line of look-ahead after
+/// the coordinates decides whether a velocity section follows. With
+/// `at_end`, a truncated or malformed frame is returned whole so that
+/// parsing it reports the error.
+fn buffered_frame_len(buf: &str, at_end: bool) -> Option<usize> {
+    if buf.is_empty() {
+        return None;
+    }
+    let short = if at_end { Some(buf.len()) } else { None };
+    let mut pos = 0;
+    // prebox1, prebox2, boxl, angles, postbox1, postbox2
+    if take_lines(buf, &mut pos, 6, at_end).is_none() {
+        return short;
+    }
+    let counts_start = pos;
+    if take_lines(buf, &mut pos, 2, at_end).is_none() {
+        return short;
+    }
+    let mut count_lines = buf[counts_start..pos].lines();
+    let counts = parse_line_of_n::<usize>(count_lines.next().unwrap_or(""), 1).and_then(|n| {
+        parse_line_of_n::<usize>(count_lines.next().unwrap_or(""), n[0]).map(|c| (n[0], c))
+    });
+    let block_lines = match counts {
+        Ok((natm_types, natms_per_type)) => natms_per_type.iter().sum::<usize>() + natm_types * 2,
+        Err(_) => return Some(pos),
+    };
+    // masses_per_type, then the coordinate blocks
+    if take_lines(buf, &mut pos, 1 + block_lines, at_end).is_none() {
+        return short;
+    }
+    let coords_end = pos;
+    match take_lines(buf, &mut pos, 1, at_end) {
+        None if at_end => Some(coords_end),
+        None => None,
+        Some(line) if line.trim().is_empty() => {
+            if take_lines(buf, &mut pos, block_lines, at_end).is_none() {
+                return short;
+            }
+            Some(pos)
+        }
+        Some(_) => Some(coords_end),
+    }
 }
 
 /// Starts an RPC server on the given address.
 ///
 /// This function blocks until the server is shut down.
 pub async fn start_server(addr: &str) -> Result<(), Box<dyn std::error::Error>> {
+    start_server_with_config(addr, ServerConfig::default()).await
+}
+
+/// Starts an RPC server on the given address with explicit settings.
+///
+/// This function blocks until the server is shut down.
+pub async fn start_server_with_config(
+    addr: &str,
+    config: ServerConfig,
+) -> Result<(), Box<dyn std::error::Error>> {
     let listener = tokio::net::TcpListener::bind(addr).await?;
-    let service = read_con_service::ToClient::new(ReadConServiceImpl)
+    let sessions = Rc::new(SessionRegistry::new(config.trajectory_root, config.cache_bytes));
+    let service = read_con_service::ToClient::new(ReadConServiceImpl { sessions })
         .into_client::<capnp_rpc::Server>();
 
     loop {
         let (stream, _) = listener.accept().await?;
-        stream.set_nodelay(true)?;
-        let (reader, writer) = tokio_util::compat::TokioAsyncReadCompatExt::compat(stream).split();
+        serve_connection(stream, &service)?;
+    }
+}
+
+/// Serves `service` on one accepted connection. Must run inside a
+/// `LocalSet`.
+fn serve_connection(
+    stream: tokio::net::TcpStream,
+    service: &read_con_service::Client,
+) -> std::io::Result<()> {
+    stream.set_nodelay(true)?;
+    let (reader, writer) = tokio_util::compat::TokioAsyncReadCompatExt::compat(stream).split();
+    let network = twoparty::VatNetwork::new(
+        reader,
+        writer,
+        rpc_twoparty_capnp::Side::Server,
+        Default::default(),
+    );
+    let rpc_system = RpcSystem::new(Box::new(network), Some(service.clone().client));
+    tokio::task::spawn_local(rpc_system);
+    Ok(())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::cell::Cell;
+
+    use futures::StreamExt;
+    use futures::channel::{mpsc, oneshot};
+
+    const FRAME: &str = "a\nb\n1 1 1\n90 90 90\nc\nd\n1\n1\n1.0\nH\nCoordinates of Component 1\n0 0 0 0 0\n";
+
+    #[test]
+    fn frame_len_waits_for_look_ahead() {
+        // Without the next line it is unknown whether velocities follow.
+        assert_eq!(buffered_frame_len(FRAME, false), None);
+        assert_eq!(buffered_frame_len(FRAME, true), Some(FRAME.len()));
+        let two = format!("{FRAME}{FRAME}");
+        assert_eq!(buffered_frame_len(&two, false), Some(FRAME.len()));
+        assert_eq!(buffered_frame_len(&two[..FRAME.len() + 3], false), Some(FRAME.len()));
+        assert_eq!(buffered_frame_len(&FRAME[..20], false), None);
+        assert_eq!(buffered_frame_len(&FRAME[..20], true), Some(20));
+    }
+
+    #[test]
+    fn frame_len_includes_velocities() {
+        let velocities = "\nH\nVelocities of Component 1\n0 0 0 0 0\n";
+        let convel = format!("{FRAME}{velocities}");
+        assert_eq!(buffered_frame_len(&convel[..convel.len() - 1], false), None);
+        assert_eq!(buffered_frame_len(&convel, false), Some(convel.len()));
+    }
+
+    /// A sink that reports each call and holds its acknowledgement until
+    /// the test releases it.
+    struct HeldSink {
+        calls: mpsc::UnboundedSender<(u64, usize, oneshot::Sender<()>)>,
+        outstanding: Rc<Cell<usize>>,
+        max_outstanding: Rc<Cell<usize>>,
+    }
+
+    impl frame_sink::Server for HeldSink {
+        fn frame(
+            &mut self,
+            params: frame_sink::FrameParams,
+            _: frame_sink::FrameResults,
+        ) -> Promise<(), capnp::Error> {
+            let params = pry!(params.get());
+            let frame = pry!(packed::decode_frame(pry!(params.get_frame())));
+            let (ack, acked) = oneshot::channel();
+            self.outstanding.set(self.outstanding.get() + 1);
+            self.max_outstanding
+                .set(self.max_outstanding.get().max(self.outstanding.get()));
+            let _ = self
+                .calls
+                .unbounded_send((params.get_index(), frame.atom_data.len(), ack));
+            let outstanding = Rc::clone(&self.outstanding);
+            Promise::from_future(async move {
+                acked
+                    .await
+                    .map_err(|_| capnp::Error::failed("acknowledgement dropped".to_string()))?;
+                outstanding.set(outstanding.get() - 1);
+                Ok(())
+            })
+        }
+    }
+
+    fn run_local(test: impl Future<Output = ()>) {
+        let runtime = tokio::runtime::Builder::new_current_thread()
+            .enable_all()
+            .build()
+            .unwrap();
+        tokio::task::LocalSet::new().block_on(&runtime, test);
+    }
+
+    /// Connects a client to a fresh service over loopback TCP. Must run
+    /// inside a `LocalSet`.
+    async fn connect() -> read_con_service::Client {
+        let listener = tokio::net::TcpListener::bind("127.0.0.1:0").await.unwrap();
+        let addr = listener.local_addr().unwrap();
+        let (accepted, stream) =
+            futures::join!(listener.accept(), tokio::net::TcpStream::connect(addr));
+        let sessions = Rc::new(SessionRegistry::new(None, DEFAULT_CACHE_BYTES));
+        let service = read_con_service::ToClient::new(ReadConServiceImpl { sessions })
+            .into_client::<capnp_rpc::Server>();
+        serve_connection(accepted.unwrap().0, &service).unwrap();
+
+        let (reader, writer) =
+            tokio_util::compat::TokioAsyncReadCompatExt::compat(stream.unwrap()).split();
         let network = twoparty::VatNetwork::new(
             reader,
             writer,
-            rpc_twoparty_capnp::Side::Server,
+            rpc_twoparty_capnp::Side::Client,
             Default::default(),
         );
-        let rpc_system = RpcSystem::new(Box::new(network), Some(service.clone().client));
+        let mut rpc_system = RpcSystem::new(Box::new(network), None);
+        let client = rpc_system.bootstrap(rpc_twoparty_capnp::Side::Server);
         tokio::task::spawn_local(rpc_system);
+        client
+    }
+
+    #[test]
+    fn stream_keeps_window_and_finish_waits_for_every_ack() {
+        run_local(async {
+            let service = connect().await;
+            let (calls_tx, mut calls) = mpsc::unbounded();
+            let outstanding = Rc::new(Cell::new(0));
+            let max_outstanding = Rc::new(Cell::new(0));
+            let sink: frame_sink::Client = capnp_rpc::new_client(HeldSink {
+                calls: calls_tx,
+                outstanding: Rc::clone(&outstanding),
+                max_outstanding: Rc::clone(&max_outstanding),
+            });
+            let mut request = service.open_parse_stream_request();
+            request.get().set_sink(sink);
+            request.get().set_window(2);
+            let parser = request.send().pipeline.get_parser();
+
+            // Four complete frames, the fourth ended by the next frame's
+            // first line.
+            let first = format!("{FRAME}{FRAME}{FRAME}{FRAME}a\n");
+            let mut push = parser.push_request();
+            push.get().set_chunk(first.as_bytes());
+            let push = push.send().promise;
+            let pushed = Rc::new(Cell::new(false));
+            let done = Rc::clone(&pushed);
+            let push = tokio::task::spawn_local(async move {
+                push.await.unwrap();
+                done.set(true);
+            });
+
+            let mut acks = Vec::new();
+            for expected in 0..2 {
+                let (index, atoms, ack) = calls.next().await.unwrap();
+                assert_eq!((index, atoms), (expected, 1));
+                acks.push(ack);
+            }
+            // The window is full: frames 2 and 3 wait, and so does the push.
+            assert!(!pushed.get());
+            for expected in 2..4 {
+                acks.remove(0).send(()).unwrap();
+                let (index, _, ack) = calls.next().await.unwrap();
+                assert_eq!(index, expected);
+                acks.push(ack);
+            }
+            push.await.unwrap();
+
+            // The rest of frame 4 completes nothing before the input ends.
+            let mut push = parser.push_request();
+            push.get().set_chunk(FRAME[2..].as_bytes());
+            push.send().promise.await.unwrap();
+
+            let finish = parser.finish_request().send().promise;
+            let finished = Rc::new(Cell::new(None));
+            let done = Rc::clone(&finished);
+            let finish = tokio::task::spawn_local(async move {
+                let response = finish.await.unwrap();
+                done.set(Some(response.get().unwrap().get_num_frames()));
+            });
+            acks.remove(0).send(()).unwrap();
+            let (index, _, ack) = calls.next().await.unwrap();
+            assert_eq!(index, 4);
+            acks.push(ack);
+            acks.remove(0).send(()).unwrap();
+            // Frame 4 is still unacknowledged.
+            assert_eq!(finished.get(), None);
+            acks.remove(0).send(()).unwrap();
+            finish.await.unwrap();
+
+            assert_eq!(finished.get(), Some(5));
+            assert_eq!(outstanding.get(), 0);
+            assert_eq!(max_outstanding.get(), 2);
+            assert!(calls.try_next().is_err());
+        });
     }
 }
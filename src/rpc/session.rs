@@ -0,0 +1,366 @@
+//! Server-side trajectory sessions.
+//!
+//! A `TrajectorySession` keeps one server-local file open (memory-mapped
+//! above 64 KiB) together with its frame index, the headers of every frame
+//! and an LRU of parsed frames bounded by a byte budget. A
+//! `SessionRegistry` hands the same session to every client that opens the
+//! same file, so concurrent viewers of a trajectory pay the index and parse
+//! cost once. The RPC server runs on a single thread, so sessions use `Rc`
+//! and `RefCell` rather than locks.
+
+use std::cell::RefCell;
+use std::collections::{BTreeMap, HashMap};
+use std::ops::Range;
+use std::path::{Path, PathBuf};
+use std::rc::{Rc, Weak};
+
+use crate::error::ParseError;
+use crate::iterators::ConFrameFileIterator;
+use crate::parser::{ParseOptions, project_frame};
+use crate::types::{AtomDatum, ConFrame, FrameHeader};
+
+/// Byte budget of each session's frame cache unless configured otherwise.
+pub const DEFAULT_CACHE_BYTES: usize = 256 << 20;
+
+/// Approximate heap footprint of a parsed frame, used for the cache budget.
+fn frame_bytes(frame: &ConFrame) -> usize {
+    let header = &frame.header;
+    let text: usize = header
+        .prebox_header
+        .iter()
+        .chain(&header.postbox_header)
+        .map(String::capacity)
+        .sum();
+    std::mem::size_of::<ConFrame>()
+        + text
+        + header.natms_per_type.capacity() * std::mem::size_of::<usize>()
+        + header.masses_per_type.capacity() * std::mem::size_of::<f64>()
+        + frame.atom_data.capacity() * std::mem::size_of::<AtomDatum>()
+}
+
+struct CacheEntry {
+    frame: Rc<ConFrame>,
+    bytes: usize,
+    last_use: u64,
+}
+
+/// A least-recently-used cache of parsed frames, bounded by total bytes.
+struct FrameCache {
+    budget: usize,
+    used: usize,
+    clock: u64,
+    entries: HashMap<usize, CacheEntry>,
+    /// Frame numbers by last use, oldest first.
+    by_use: BTreeMap<u64, usize>,
+}
+
+impl FrameCache {
+    fn new(budget: usize) -> Self {
+        FrameCache {
+            budget,
+            used: 0,
+            clock: 0,
+            entries: HashMap::new(),
+            by_use: BTreeMap::new(),
+        }
+    }
+
+    /// Returns a cached frame and marks it as most recently used.
+    fn get(&mut self, frame_no: usize) -> Option<Rc<ConFrame>> {
+        let entry = self.entries.get_mut(&frame_no)?;
+        self.by_use.remove(&entry.last_use);
+        self.clock += 1;
+        entry.last_use = self.clock;
+        self.by_use.insert(self.clock, frame_no);
+        Some(Rc::clone(&entry.frame))
+    }
+
+    /// Caches a frame, evicting the least recently used ones to stay within
+    /// the budget. A frame larger than the whole budget is not cached.
+    fn insert(&mut self, frame_no: usize, frame: Rc<ConFrame>) {
+        let bytes = frame_bytes(&frame);
+        if bytes > self.budget || self.entries.contains_key(&frame_no) {
+            return;
+        }
+        while self.used + bytes > self.budget {
+            let Some((_, oldest)) = self.by_use.pop_first() else {
+                break;
+            };
+            if let Some(evicted) = self.entries.remove(&oldest) {
+                self.used -= evicted.bytes;
+            }
+        }
+        self.clock += 1;
+        self.by_use.insert(self.clock, frame_no);
+        self.entries.insert(
+            frame_no,
+            CacheEntry {
+                frame,
+                bytes,
+                last_use: self.clock,
+            },
+        );
+        self.used += bytes;
+    }
+}
+
+/// One open trajectory shared by all clients that opened its path.
+pub struct TrajectorySession {
+    path: PathBuf,
+    iter: RefCell<ConFrameFileIterator>,
+    num_frames: usize,
+    headers: RefCell<Option<Rc<Vec<FrameHeader>>>>,
+    cache: RefCell<FrameCache>,
+}
+
+impl TrajectorySession {
+    /// Opens `path` and builds its frame index in memory. No `<file>.idx`
+    /// sidecar is read or written: a sidecar in the served tree could be
+    /// planted by someone else, and writing one would let clients create
+    /// files on the server.
+    pub fn open(path: &Path, cache_bytes: usize) -> Result<Self, Box<dyn std::error::Error>> {
+        let mut iter = ConFrameFileIterator::open(path)?;
+        let num_frames = iter.len()?;
+        Ok(TrajectorySession {
+            path: path.to_path_buf(),
+            iter: RefCell::new(iter),
+            num_frames,
+            headers: RefCell::new(None),
+            cache: RefCell::new(FrameCache::new(cache_bytes)),
+        })
+    }
+
+    /// Returns the path the session was opened with.
+    pub fn path(&self) -> &Path {
+        &self.path
+    }
+
+    /// Returns the number of frames in the trajectory.
+    pub fn len(&self) -> usize {
+        self.num_frames
+    }
+
+    /// Returns `true` if the trajectory holds no frames.
+    pub fn is_empty(&self) -> bool {
+        self.num_frames == 0
+    }
+
+    /// Returns the header of every frame, parsed once per session without
+    /// touching the atom lines.
+    pub fn headers(&self) -> Result<Rc<Vec<FrameHeader>>, ParseError> {
+        if let Some(headers) = self.headers.borrow().as_ref() {
+            return Ok(Rc::clone(headers));
+        }
+        let mut iter = self.iter.borrow_mut();
+        iter.set_options(ParseOptions {
+            header_only: true,
+            ..Default::default()
+        });
+        let scanned: Result<Vec<FrameHeader>, ParseError> = iter
+            .seek(0)
+            .and_then(|()| iter.by_ref().map(|r| r.map(|f| f.header)).collect());
+        iter.set_options(ParseOptions::default());
+        let headers = Rc::new(scanned?);
+        *self.headers.borrow_mut() = Some(Rc::clone(&headers));
+        Ok(headers)
+    }
+
+    /// Returns one fully parsed frame, from the cache when possible.
+    pub fn frame(&self, frame_no: usize) -> Result<Rc<ConFrame>, ParseError> {
+        if frame_no >= self.num_frames {
+            return Err(ParseError::FrameOutOfRange {
+                requested: frame_no,
+                available: self.num_frames,
+            });
+        }
+        if let Some(frame) = self.cache.borrow_mut().get(frame_no) {
+            return Ok(frame);
+        }
+        let frame = {
+            let mut iter = self.iter.borrow_mut();
+            iter.seek(frame_no)?;
+            Rc::new(iter.next().unwrap_or(Err(ParseError::IncompleteFrame))?)
+        };
+        self.cache.borrow_mut().insert(frame_no, Rc::clone(&frame));
+        Ok(frame)
+    }
+
+    /// Returns the frames in `range`, projected by `options`.
+    ///
+    /// Full frames are cached and projected per request, so every projection
+    /// of a frame shares one parse. Header-only requests are answered from
+    /// `headers()` without parsing atoms.
+    pub fn frames(
+        &self,
+        range: Range<usize>,
+        options: &ParseOptions,
+    ) -> Result<Vec<ConFrame>, ParseError> {
+        if range.start > range.end || range.end > self.num_frames {
+            return Err(ParseError::FrameOutOfRange {
+                requested: range.end.max(range.start),
+                available: self.num_frames,
+            });
+        }
+        if options.header_only {
+            let headers = self.headers()?;
+            return Ok(headers[range]
+                .iter()
+                .map(|header| ConFrame {
+                    header: header.clone(),
+                    atom_data: Vec::new(),
+                })
+                .collect());
+        }
+        range
+            .map(|frame_no| {
+                let frame = (*self.frame(frame_no)?).clone();
+                Ok(if options.is_full() {
+                    frame
+                } else {
+                    project_frame(frame, options)
+                })
+            })
+            .collect()
+    }
+}
+
+/// Hands out one shared `TrajectorySession` per canonical path.
+///
+/// Sessions live as long as some client holds them; the registry only keeps
+/// weak references.
+pub struct SessionRegistry {
+    root: Option<PathBuf>,
+    cache_bytes: usize,
+    sessions: RefCell<HashMap<PathBuf, Weak<TrajectorySession>>>,
+}
+
+impl SessionRegistry {
+    /// Creates a registry whose sessions cache up to `cache_bytes` of frames
+    /// each. Paths are resolved against `root` and refused if they resolve
+    /// outside it; without a root every `open` is refused.
+    pub fn new(root: Option<PathBuf>, cache_bytes: usize) -> Self {
+        SessionRegistry {
+            root,
+            cache_bytes,
+            sessions: RefCell::new(HashMap::new()),
+        }
+    }
+
+    /// Returns the session for `path`, opening it if no client holds one.
+    pub fn open(&self, path: &Path) -> Result<Rc<TrajectorySession>, Box<dyn std::error::Error>> {
+        let root = self
+            .root
+            .as_ref()
+            .ok_or("opening trajectories is disabled: the server has no trajectory root")?
+            .canonicalize()?;
+        let key = root.join(path).canonicalize()?;
+        if !key.starts_with(&root) {
+            return Err(format!("{} is outside the trajectory root", path.display()).into());
+        }
+        if let Some(session) = self.sessions.borrow().get(&key).and_then(Weak::upgrade) {
+            return Ok(session);
+        }
+        let session = Rc::new(TrajectorySession::open(&key, self.cache_bytes)?);
+        let mut sessions = self.sessions.borrow_mut();
+        sessions.retain(|_, weak| weak.strong_count() > 0);
+        sessions.insert(key, Rc::downgrade(&session));
+        Ok(session)
+    }
+}
+
+impl Default for SessionRegistry {
+    fn default() -> Self {
+        SessionRegistry::new(None, DEFAULT_CACHE_BYTES)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::iterators::ConFrameIterator;
+    use std::fs;
+
+    fn write_trajectory(name: &str) -> (PathBuf, Vec<ConFrame>) {
+        let text = fs::read_to_string(
+            Path::new(env!("CARGO_MANIFEST_DIR")).join("resources/test/tiny_multi_cuh2.convel"),
+        )
+        .unwrap();
+        let text = text.repeat(3);
+        let dir = std::env::temp_dir().join(format!("readcon-session-{}-{name}", std::process::id()));
+        fs::create_dir_all(&dir).unwrap();
+        let path = dir.join("traj.convel");
+        fs::write(&path, &text).unwrap();
+        let frames = ConFrameIterator::new(&text).map(|r| r.unwrap()).collect();
+        (path, frames)
+    }
+
+    #[test]
+    fn sessions_are_shared_and_answer_ranges() {
+        let (path, expected) = write_trajectory("shared");
+        let root = path.parent().unwrap().to_path_buf();
+        let registry = SessionRegistry::new(Some(root), DEFAULT_CACHE_BYTES);
+        let a = registry.open(Path::new("traj.convel")).unwrap();
+        let b = registry.open(&path).unwrap();
+        assert!(Rc::ptr_eq(&a, &b));
+        assert_eq!(a.len(), expected.len());
+
+        let frames = a.frames(1..4, &ParseOptions::default()).unwrap();
+        assert_eq!(frames, expected[1..4]);
+        let headers = b.headers().unwrap();
+        assert_eq!(headers.len(), expected.len());
+        assert_eq!(headers[2], expected[2].header);
+
+        let projected = b
+            .frames(
+                0..2,
+                &ParseOptions {
+                    skip_velocities: true,
+                    ..Default::default()
+                },
+            )
+            .unwrap();
+        assert!(!projected[0].has_velocities());
+        assert!(a.frames(5..7, &ParseOptions::default()).is_err());
+
+        drop((a, b));
+        assert!(registry.sessions.borrow()[&path.canonicalize().unwrap()]
+            .upgrade()
+            .is_none());
+        fs::remove_dir_all(path.parent().unwrap()).unwrap();
+    }
+
+    #[test]
+    fn opening_needs_a_root_and_stays_inside_it() {
+        let (path, _) = write_trajectory("root");
+        let dir = path.parent().unwrap();
+        assert!(SessionRegistry::default().open(&path).is_err());
+
+        let registry = SessionRegistry::new(Some(dir.join("sub")), DEFAULT_CACHE_BYTES);
+        fs::create_dir_all(dir.join("sub")).unwrap();
+        assert!(registry.open(Path::new("../traj.convel")).is_err());
+        assert!(registry.open(&path).is_err());
+
+        // Sessions index in memory and leave no sidecar behind.
+        let registry = SessionRegistry::new(Some(dir.to_path_buf()), DEFAULT_CACHE_BYTES);
+        registry.open(&path).unwrap();
+        assert!(!crate::index::FrameIndex::sidecar_path(&path).exists());
+        fs::remove_dir_all(dir).unwrap();
+    }
+
+    #[test]
+    fn cache_stays_within_budget() {
+        let (path, expected) = write_trajectory("budget");
+        let one_frame = frame_bytes(&expected[0]);
+        let session = TrajectorySession::open(&path, 2 * one_frame).unwrap();
+        for frame_no in 0..session.len() {
+            assert_eq!(*session.frame(frame_no).unwrap(), expected[frame_no]);
+        }
+        let cache = session.cache.borrow();
+        assert!(cache.used <= 2 * one_frame);
+        assert_eq!(cache.entries.len(), 2);
+        // The two most recently used frames survive.
+        assert!(cache.entries.contains_key(&(session.len() - 1)));
+        drop(cache);
+        fs::remove_dir_all(path.parent().unwrap()).unwrap();
+    }
+}
@@ -0,0 +1,327 @@
+//! Optional per-stage counters for parsing, writing and the C API.
+//!
+//! With the `instrumentation` feature, the parser, the writer and
+//! `rkr_frame_to_c_frame` add to process-wide counters: bytes, frames and
+//! atoms handled, buffer allocations, and calls and wall-clock nanoseconds
+//! per [`Stage`]. Counters are relaxed atomics updated once per stage call,
+//! never per line, so they can stay enabled in production runs. Without the
+//! feature every hook is an empty inline function and [`snapshot`] returns
+//! zeros.
+//!
+//! The `tracing` feature (which implies `instrumentation`) additionally
+//! enters a `TRACE`-level span named after the stage for each timed call.
+//!
+//! # Example
+//!
+//! ```
+//! use readcon_core::iterators::ConFrameIterator;
+//!
+//! let text = "a\nb\n1 1 1\n90 90 90\nc\nd\n1\n1\n1.0\nH\nCoordinates of Component 1\n0 0 0 0 0\n";
+//! let before = readcon_core::stats::snapshot();
+//! let frames: Vec<_> = ConFrameIterator::new(text).collect();
+//! let after = readcon_core::stats::snapshot();
+//! if readcon_core::stats::enabled() {
+//!     assert!(after.frames_parsed > before.frames_parsed);
+//! }
+//! # drop(frames);
+//! ```
+
+/// An instrumented stage of the library.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Stage {
+    /// The 9 header lines of a frame.
+    ParseFrameHeader,
+    /// A frame's header and coordinate blocks (includes `ParseFrameHeader`).
+    ParseSingleFrame,
+    /// The optional velocity blocks after the coordinates.
+    ParseVelocitySection,
+    /// Building a `CFrame` in `rkr_frame_to_c_frame`.
+    FrameToCFrame,
+    /// Formatting one frame in `ConFrameWriter`, excluding the I/O.
+    WriteFrame,
+}
+
+impl Stage {
+    /// The stage's function name, also used for its `tracing` span.
+    pub fn name(self) -> &'static str {
+        match self {
+            Stage::ParseFrameHeader => "parse_frame_header",
+            Stage::ParseSingleFrame => "parse_single_frame",
+            Stage::ParseVelocitySection => "parse_velocity_section",
+            Stage::FrameToCFrame => "rkr_frame_to_c_frame",
+            Stage::WriteFrame => "write_frame",
+        }
+    }
+}
+
+/// Calls and total wall-clock time of one stage.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct StageStats {
+    pub calls: u64,
+    pub nanos: u64,
+}
+
+/// A snapshot of all counters since start-up or the last [`reset`].
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct Stats {
+    /// Bytes of frame text consumed by the parser.
+    pub bytes_scanned: u64,
+    pub frames_parsed: u64,
+    pub atoms_parsed: u64,
+    /// Bytes of frame text produced by the writer.
+    pub bytes_written: u64,
+    pub frames_written: u64,
+    pub atoms_written: u64,
+    /// Atom and output buffers allocated or grown by the parser, writer and
+    /// `rkr_frame_to_c_frame`.
+    pub allocations: u64,
+    pub parse_frame_header: StageStats,
+    pub parse_single_frame: StageStats,
+    pub parse_velocity_section: StageStats,
+    pub frame_to_c_frame: StageStats,
+    pub write_frame: StageStats,
+}
+
+impl Stats {
+    /// Returns the counters of `stage`.
+    pub fn stage(&self, stage: Stage) -> StageStats {
+        match stage {
+            Stage::ParseFrameHeader => self.parse_frame_header,
+            Stage::ParseSingleFrame => self.parse_single_frame,
+            Stage::ParseVelocitySection => self.parse_velocity_section,
+            Stage::FrameToCFrame => self.frame_to_c_frame,
+            Stage::WriteFrame => self.write_frame,
+        }
+    }
+}
+
+/// Returns `true` if the library was built with the `instrumentation`
+/// feature, i.e. if [`snapshot`] reports anything.
+pub const fn enabled() -> bool {
+    cfg!(feature = "instrumentation")
+}
+
+#[cfg(feature = "instrumentation")]
+mod counters {
+    use std::sync::atomic::AtomicU64;
+
+    pub static BYTES_SCANNED: AtomicU64 = AtomicU64::new(0);
+    pub static FRAMES_PARSED: AtomicU64 = AtomicU64::new(0);
+    pub static ATOMS_PARSED: AtomicU64 = AtomicU64::new(0);
+    pub static BYTES_WRITTEN: AtomicU64 = AtomicU64::new(0);
+    pub static FRAMES_WRITTEN: AtomicU64 = AtomicU64::new(0);
+    pub static ATOMS_WRITTEN: AtomicU64 = AtomicU64::new(0);
+    pub static ALLOCATIONS: AtomicU64 = AtomicU64::new(0);
+    /// Calls and nanoseconds, indexed by `Stage as usize`.
+    pub static STAGES: [[AtomicU64; 2]; 5] = [const { [const { AtomicU64::new(0) }; 2] }; 5];
+}
+
+/// Returns the current value of every counter.
+pub fn snapshot() -> Stats {
+    #[cfg(feature = "instrumentation")]
+    {
+        use counters::*;
+        use std::sync::atomic::Ordering::Relaxed;
+
+        let stage = |s: Stage| StageStats {
+            calls: STAGES[s as usize][0].load(Relaxed),
+            nanos: STAGES[s as usize][1].load(Relaxed),
+        };
+        Stats {
+            bytes_scanned: BYTES_SCANNED.load(Relaxed),
+            frames_parsed: FRAMES_PARSED.load(Relaxed),
+            atoms_parsed: ATOMS_PARSED.load(Relaxed),
+            bytes_written: BYTES_WRITTEN.load(Relaxed),
+            frames_written: FRAMES_WRITTEN.load(Relaxed),
+            atoms_written: ATOMS_WRITTEN.load(Relaxed),
+            allocations: ALLOCATIONS.load(Relaxed),
+            parse_frame_header: stage(Stage::ParseFrameHeader),
+            parse_single_frame: stage(Stage::ParseSingleFrame),
+            parse_velocity_section: stage(Stage::ParseVelocitySection),
+            frame_to_c_frame: stage(Stage::FrameToCFrame),
+            write_frame: stage(Stage::WriteFrame),
+        }
+    }
+    #[cfg(not(feature = "instrumentation"))]
+    Stats::default()
+}
+
+/// Sets every counter back to zero. Calls still running on other threads
+/// are added when they finish.
+pub fn reset() {
+    #[cfg(feature = "instrumentation")]
+    {
+        use counters::*;
+        use std::sync::atomic::Ordering::Relaxed;
+
+        for counter in [
+            &BYTES_SCANNED,
+            &FRAMES_PARSED,
+            &ATOMS_PARSED,
+            &BYTES_WRITTEN,
+            &FRAMES_WRITTEN,
+            &ATOMS_WRITTEN,
+            &ALLOCATIONS,
+        ] {
+            counter.store(0, Relaxed);
+        }
+        for stage in &STAGES {
+            stage[0].store(0, Relaxed);
+            stage[1].store(0, Relaxed);
+        }
+    }
+}
+
+/// Records one allocated or grown buffer.
+#[inline(always)]
+pub(crate) fn allocation() {
+    #[cfg(feature = "instrumentation")]
+    counters::ALLOCATIONS.fetch_add(1, std::sync::atomic::Ordering::Relaxed);
+}
+
+/// Starts timing one call of `stage`; the call is recorded when the returned
+/// timer is dropped.
+#[inline(always)]
+pub(crate) fn time(stage: Stage) -> StageTimer {
+    let _ = stage;
+    StageTimer {
+        #[cfg(feature = "instrumentation")]
+        stage,
+        #[cfg(feature = "instrumentation")]
+        start: std::time::Instant::now(),
+        #[cfg(feature = "instrumentation")]
+        bytes: 0,
+        #[cfg(feature = "instrumentation")]
+        last_line: None,
+        #[cfg(feature = "instrumentation")]
+        frame_atoms: None,
+        #[cfg(feature = "tracing")]
+        _span: match stage {
+            Stage::ParseFrameHeader => tracing::trace_span!("parse_frame_header"),
+            Stage::ParseSingleFrame => tracing::trace_span!("parse_single_frame"),
+            Stage::ParseVelocitySection => tracing::trace_span!("parse_velocity_section"),
+            Stage::FrameToCFrame => tracing::trace_span!("rkr_frame_to_c_frame"),
+            Stage::WriteFrame => tracing::trace_span!("write_frame"),
+        }
+        .entered(),
+    }
+}
+
+/// Guard for one timed stage call, from [`time`]. Zero-sized without the
+/// `instrumentation` feature.
+///
+/// Bytes and frames are accumulated locally and added to the global
+/// counters once, on drop: as parsed for the parse stages, as written for
+/// `WriteFrame`.
+pub(crate) struct StageTimer {
+    #[cfg(feature = "instrumentation")]
+    stage: Stage,
+    #[cfg(feature = "instrumentation")]
+    start: std::time::Instant,
+    #[cfg(feature = "instrumentation")]
+    bytes: u64,
+    /// End address and terminator length of the last line passed to
+    /// [`StageTimer::line`].
+    #[cfg(feature = "instrumentation")]
+    last_line: Option<(usize, usize)>,
+    #[cfg(feature = "instrumentation")]
+    frame_atoms: Option<usize>,
+    #[cfg(feature = "tracing")]
+    _span: tracing::span::EnteredSpan,
+}
+
+impl StageTimer {
+    /// Adds `n` bytes of text handled by this call.
+    #[inline(always)]
+    pub(crate) fn bytes(&mut self, n: usize) {
+        let _ = n;
+        #[cfg(feature = "instrumentation")]
+        {
+            self.bytes += n as u64;
+        }
+    }
+
+    /// Adds one parsed line and its terminator.
+    ///
+    /// Lines split from one buffer are contiguous, so the gap between the
+    /// end of a line and the start of the next is that line's terminator:
+    /// 1 for `\n`, 2 for `\r\n`. The call's last line is counted with the
+    /// terminator seen before it (1 if none was), and lines that do not
+    /// come from one buffer with 1.
+    #[inline(always)]
+    pub(crate) fn line(&mut self, line: &str) {
+        let _ = line;
+        #[cfg(feature = "instrumentation")]
+        {
+            let start = line.as_ptr() as usize;
+            let eol = match self.last_line {
+                Some((end, eol)) => {
+                    let gap = start.wrapping_sub(end);
+                    let eol = if gap == 1 || gap == 2 { gap } else { eol };
+                    self.bytes += eol as u64;
+                    eol
+                }
+                None => 1,
+            };
+            self.bytes += line.len() as u64;
+            self.last_line = Some((start + line.len(), eol));
+        }
+    }
+
+    /// Marks this call as having completed a frame of `atoms` atoms.
+    #[inline(always)]
+    pub(crate) fn frame(&mut self, atoms: usize) {
+        let _ = atoms;
+        #[cfg(feature = "instrumentation")]
+        {
+            self.frame_atoms = Some(atoms);
+        }
+    }
+}
+
+#[cfg(feature = "instrumentation")]
+impl Drop for StageTimer {
+    fn drop(&mut self) {
+        use counters::*;
+        use std::sync::atomic::Ordering::Relaxed;
+
+        let nanos = self.start.elapsed().as_nanos() as u64;
+        let stage = &STAGES[self.stage as usize];
+        stage[0].fetch_add(1, Relaxed);
+        stage[1].fetch_add(nanos, Relaxed);
+        let (bytes, frames, atoms) = match self.stage {
+            Stage::WriteFrame => (&BYTES_WRITTEN, &FRAMES_WRITTEN, &ATOMS_WRITTEN),
+            _ => (&BYTES_SCANNED, &FRAMES_PARSED, &ATOMS_PARSED),
+        };
+        // The last line's terminator; see `line`.
+        let last_eol = self.last_line.map_or(0, |(_, eol)| eol as u64);
+        if self.bytes + last_eol != 0 {
+            bytes.fetch_add(self.bytes + last_eol, Relaxed);
+        }
+        if let Some(n) = self.frame_atoms {
+            frames.fetch_add(1, Relaxed);
+            atoms.fetch_add(n as u64, Relaxed);
+        }
+    }
+}
+
+#[cfg(all(test, feature = "instrumentation"))]
+mod tests {
+    use super::*;
+
+    fn counted(lines: &[&str]) -> u64 {
+        let mut timer = time(Stage::ParseSingleFrame);
+        lines.iter().for_each(|line| timer.line(line));
+        let eol = timer.last_line.map_or(0, |(_, eol)| eol as u64);
+        timer.bytes + eol
+    }
+
+    #[test]
+    fn test_line_counts_lf_and_crlf_terminators() {
+        for text in ["ab\nc\n\nd\n", "ab\r\nc\r\n\r\nd\r\n"] {
+            assert_eq!(counted(&text.lines().collect::<Vec<_>>()), text.len() as u64);
+        }
+        // Lines from separate buffers count one byte per terminator.
+        assert_eq!(counted(&[&String::from("ab"), &String::from("c")]), 5);
+    }
+}
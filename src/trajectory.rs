@@ -0,0 +1,311 @@
+//! Trajectories that store the unchanging part of their frames once.
+//!
+//! In a typical MD or NEB trajectory the atom counts, masses, symbols, ids
+//! and fixed flags are the same in every frame. A [`Trajectory`] keeps them
+//! in one [`Topology`] shared through an `Arc` by every frame that matches
+//! it, and stores only positions, velocities, the cell and the header lines
+//! per frame. In memory this is about a third of a `Vec<ConFrame>`.
+//!
+//! # Example
+//!
+//! ```
+//! use readcon_core::iterators::ConFrameIterator;
+//! use readcon_core::trajectory::Trajectory;
+//!
+//! let frame = "a\nb\n1 1 1\n90 90 90\nc\nd\n1\n1\n1.0\nH\nCoordinates of Component 1\n0 0 0 0 0\n";
+//! let text = frame.repeat(3);
+//! let trajectory: Trajectory = ConFrameIterator::new(&text).map(|r| r.unwrap()).collect();
+//! assert_eq!(trajectory.len(), 3);
+//! assert_eq!(trajectory.num_topologies(), 1);
+//! assert_eq!(trajectory.frame(2).unwrap().to_frame().atom_data.len(), 1);
+//! ```
+
+use crate::iterators::ConFrameFileIterator;
+use crate::types::{AtomDatum, ConFrame, FrameHeader};
+use std::path::Path;
+use std::sync::Arc;
+
+/// The per-atom and per-component data that frames of a trajectory share.
+#[derive(Debug, Clone, PartialEq)]
+pub struct Topology {
+    pub natms_per_type: Vec<usize>,
+    pub masses_per_type: Vec<f64>,
+    /// One symbol per component.
+    pub symbols: Vec<Arc<String>>,
+    pub atom_ids: Vec<u64>,
+    pub is_fixed: Vec<bool>,
+}
+
+impl Topology {
+    /// Extracts the topology of `frame`.
+    pub fn of(frame: &ConFrame) -> Self {
+        let atoms = &frame.atom_data;
+        let mut first = 0;
+        let symbols = frame
+            .header
+            .natms_per_type
+            .iter()
+            .map(|&count| {
+                let symbol = atoms
+                    .get(first)
+                    .map_or_else(|| Arc::new(String::new()), |a| Arc::clone(&a.symbol));
+                first += count;
+                symbol
+            })
+            .collect();
+        Topology {
+            natms_per_type: frame.header.natms_per_type.clone(),
+            masses_per_type: frame.header.masses_per_type.clone(),
+            symbols,
+            atom_ids: atoms.iter().map(|a| a.atom_id).collect(),
+            is_fixed: atoms.iter().map(|a| a.is_fixed).collect(),
+        }
+    }
+
+    /// Returns `true` if `frame` has exactly this topology. Masses are
+    /// compared bit for bit, so a shared topology is always lossless.
+    pub fn matches(&self, frame: &ConFrame) -> bool {
+        let header = &frame.header;
+        let atoms = &frame.atom_data;
+        if header.natms_per_type != self.natms_per_type
+            || header.masses_per_type.len() != self.masses_per_type.len()
+            || atoms.len() != self.atom_ids.len()
+        {
+            return false;
+        }
+        let masses_equal = header
+            .masses_per_type
+            .iter()
+            .zip(&self.masses_per_type)
+            .all(|(a, b)| a.to_bits() == b.to_bits());
+        let mut first = 0;
+        let symbols_equal = self.natms_per_type.iter().zip(&self.symbols).all(|(&count, symbol)| {
+            let equal = atoms
+                .get(first)
+                .is_none_or(|a| Arc::ptr_eq(&a.symbol, symbol) || a.symbol == *symbol);
+            first += count;
+            equal
+        });
+        masses_equal
+            && symbols_equal
+            && atoms
+                .iter()
+                .zip(self.atom_ids.iter().zip(&self.is_fixed))
+                .all(|(a, (&id, &fixed))| a.atom_id == id && a.is_fixed == fixed)
+    }
+
+    /// Returns the number of atoms.
+    pub fn num_atoms(&self) -> usize {
+        self.atom_ids.len()
+    }
+}
+
+/// One frame of a [`Trajectory`]: its own coordinates and header lines,
+/// plus a shared [`Topology`].
+#[derive(Debug, Clone)]
+pub struct TrajectoryFrame {
+    pub topology: Arc<Topology>,
+    pub prebox_header: [String; 2],
+    pub boxl: [f64; 3],
+    pub angles: [f64; 3],
+    pub postbox_header: [String; 2],
+    pub positions: Vec<[f64; 3]>,
+    /// Present when the source frame had velocities; components an atom
+    /// lacked are stored as 0.0, as the writers print them.
+    pub velocities: Option<Vec<[f64; 3]>>,
+}
+
+impl TrajectoryFrame {
+    /// Splits `frame` into per-frame data and `topology`, which the caller
+    /// has checked with [`Topology::matches`].
+    fn new(frame: &ConFrame, topology: Arc<Topology>) -> Self {
+        let atoms = &frame.atom_data;
+        let header = &frame.header;
+        TrajectoryFrame {
+            topology,
+            prebox_header: header.prebox_header.clone(),
+            boxl: header.boxl,
+            angles: header.angles,
+            postbox_header: header.postbox_header.clone(),
+            positions: atoms.iter().map(|a| [a.x, a.y, a.z]).collect(),
+            velocities: frame.has_velocities().then(|| {
+                atoms
+                    .iter()
+                    .map(|a| {
+                        [
+                            a.vx.unwrap_or(0.0),
+                            a.vy.unwrap_or(0.0),
+                            a.vz.unwrap_or(0.0),
+                        ]
+                    })
+                    .collect()
+            }),
+        }
+    }
+
+    /// Returns the number of atoms.
+    pub fn num_atoms(&self) -> usize {
+        self.positions.len()
+    }
+
+    /// Rebuilds the full [`ConFrame`]. Atoms of one component share the
+    /// topology's symbol.
+    pub fn to_frame(&self) -> ConFrame {
+        let topology = &*self.topology;
+        let mut atom_data = Vec::with_capacity(self.num_atoms());
+        for (&count, symbol) in topology.natms_per_type.iter().zip(&topology.symbols) {
+            for i in atom_data.len()..atom_data.len() + count {
+                let [x, y, z] = self.positions[i];
+                let v = self.velocities.as_ref().map(|v| v[i]);
+                atom_data.push(AtomDatum {
+                    symbol: Arc::clone(symbol),
+                    x,
+                    y,
+                    z,
+                    is_fixed: topology.is_fixed[i],
+                    atom_id: topology.atom_ids[i],
+                    vx: v.map(|v| v[0]),
+                    vy: v.map(|v| v[1]),
+                    vz: v.map(|v| v[2]),
+                });
+            }
+        }
+        ConFrame {
+            header: FrameHeader {
+                prebox_header: self.prebox_header.clone(),
+                boxl: self.boxl,
+                angles: self.angles,
+                postbox_header: self.postbox_header.clone(),
+                natm_types: topology.natms_per_type.len(),
+                natms_per_type: topology.natms_per_type.clone(),
+                masses_per_type: topology.masses_per_type.clone(),
+            },
+            atom_data,
+        }
+    }
+}
+
+/// A sequence of frames sharing their topologies.
+///
+/// Each pushed frame reuses the previous frame's [`Topology`] when it
+/// matches and starts a new one otherwise, so trajectories whose
+/// composition changes are still stored exactly.
+#[derive(Debug, Clone, Default)]
+pub struct Trajectory {
+    frames: Vec<TrajectoryFrame>,
+}
+
+impl Trajectory {
+    /// Creates an empty trajectory.
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Appends `frame`, sharing the last frame's topology if it matches.
+    pub fn push(&mut self, frame: &ConFrame) {
+        let topology = match self.frames.last() {
+            Some(last) if last.topology.matches(frame) => Arc::clone(&last.topology),
+            _ => Arc::new(Topology::of(frame)),
+        };
+        self.frames.push(TrajectoryFrame::new(frame, topology));
+    }
+
+    /// Returns the number of frames.
+    pub fn len(&self) -> usize {
+        self.frames.len()
+    }
+
+    /// Returns `true` if the trajectory holds no frames.
+    pub fn is_empty(&self) -> bool {
+        self.frames.is_empty()
+    }
+
+    /// Returns frame `frame_no`, or `None` if it is out of range.
+    pub fn frame(&self, frame_no: usize) -> Option<&TrajectoryFrame> {
+        self.frames.get(frame_no)
+    }
+
+    /// Returns all frames in order.
+    pub fn frames(&self) -> &[TrajectoryFrame] {
+        &self.frames
+    }
+
+    /// Returns the number of distinct topologies, i.e. 1 plus the number of
+    /// times the topology changes between consecutive frames (0 if empty).
+    pub fn num_topologies(&self) -> usize {
+        let changes = self
+            .frames
+            .windows(2)
+            .filter(|w| !Arc::ptr_eq(&w[0].topology, &w[1].topology))
+            .count();
+        changes + usize::from(!self.frames.is_empty())
+    }
+
+    /// Rebuilds every frame as a [`ConFrame`].
+    pub fn to_frames(&self) -> Vec<ConFrame> {
+        self.frames.iter().map(TrajectoryFrame::to_frame).collect()
+    }
+}
+
+impl<'a> Extend<&'a ConFrame> for Trajectory {
+    fn extend<I: IntoIterator<Item = &'a ConFrame>>(&mut self, frames: I) {
+        frames.into_iter().for_each(|frame| self.push(frame));
+    }
+}
+
+impl FromIterator<ConFrame> for Trajectory {
+    fn from_iter<I: IntoIterator<Item = ConFrame>>(frames: I) -> Self {
+        let mut trajectory = Trajectory::new();
+        frames.into_iter().for_each(|frame| trajectory.push(&frame));
+        trajectory
+    }
+}
+
+/// Reads a `.con`, `.convel` or `.conb` file (or a compressed one, with the
+/// `compression` feature) into a [`Trajectory`].
+///
+/// Frames are parsed one at a time into a single reused `ConFrame`, so peak
+/// memory is the trajectory plus one frame rather than every frame at full
+/// size.
+pub fn read_trajectory(path: &Path) -> Result<Trajectory, Box<dyn std::error::Error>> {
+    let mut iter = ConFrameFileIterator::open(path)?;
+    let mut trajectory = Trajectory::new();
+    let mut frame = match iter.next() {
+        Some(frame) => frame?,
+        None => return Ok(trajectory),
+    };
+    trajectory.push(&frame);
+    while let Some(result) = iter.next_into(&mut frame) {
+        result?;
+        trajectory.push(&frame);
+    }
+    Ok(trajectory)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::types::ConFrameBuilder;
+
+    fn frame(shift: f64, fixed_first: bool) -> ConFrame {
+        let mut builder = ConFrameBuilder::new([10.0; 3], [90.0; 3]);
+        builder.add_atom_with_velocity("Cu", shift, 0.0, 0.0, fixed_first, 0, 63.546, 0.1, 0.2, 0.3);
+        builder.add_atom_with_velocity("H", 1.0, shift, 1.0, false, 1, 1.008, 0.0, 0.0, -0.0);
+        builder.build()
+    }
+
+    #[test]
+    fn test_frames_share_matching_topology() {
+        let frames = vec![frame(0.0, true), frame(0.5, true), frame(1.0, false)];
+        let trajectory: Trajectory = frames.iter().cloned().collect();
+
+        assert_eq!(trajectory.len(), 3);
+        assert_eq!(trajectory.num_topologies(), 2);
+        let [a, b, c] = trajectory.frames() else {
+            panic!("expected three frames")
+        };
+        assert!(Arc::ptr_eq(&a.topology, &b.topology));
+        assert!(!Arc::ptr_eq(&b.topology, &c.topology));
+        assert_eq!(trajectory.to_frames(), frames);
+    }
+}
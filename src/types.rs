@@ -2,7 +2,9 @@
 // Data Structures - The shape of our parsed data
 //=============================================================================
 
-use std::rc::Rc;
+use crate::helpers::symbol_to_atomic_number;
+use smallvec::SmallVec;
+use std::sync::Arc;
 
 /// Holds all metadata from the 9-line header of a simulation frame.
 #[derive(Debug, PartialEq, Clone)]
@@ -23,12 +25,90 @@ pub struct FrameHeader {
     pub masses_per_type: Vec<f64>,
 }
 
+/// Inline storage for per-type header arrays: headers with up to four atom
+/// types never touch the heap.
+pub type PerTypeVec<T> = SmallVec<[T; 4]>;
+
+/// A borrowed, allocation-free view of a frame header.
+///
+/// The free-text header lines borrow from the input and the per-type arrays
+/// use inline storage, so parsing a `FrameHeaderRef` does not allocate for
+/// typical frames. This is what `ConFrameIterator::forward()` and frame
+/// indexing parse; call [`FrameHeaderRef::into_owned`] to get a
+/// [`FrameHeader`].
+#[derive(Debug, PartialEq, Clone)]
+pub struct FrameHeaderRef<'a> {
+    /// The two text lines preceding the box dimension data.
+    pub prebox_header: [&'a str; 2],
+    /// The three box dimensions, typically Lx, Ly, and Lz.
+    pub boxl: [f64; 3],
+    /// The three box angles, typically alpha, beta, and gamma.
+    pub angles: [f64; 3],
+    /// The two text lines following the box angle data.
+    pub postbox_header: [&'a str; 2],
+    /// The number of distinct atom types in the frame.
+    pub natm_types: usize,
+    /// The count of atoms for each respective type.
+    pub natms_per_type: PerTypeVec<usize>,
+    /// The mass for each respective atom type.
+    pub masses_per_type: PerTypeVec<f64>,
+}
+
+impl FrameHeaderRef<'_> {
+    /// Returns the total number of atoms over all types.
+    pub fn total_atoms(&self) -> usize {
+        self.natms_per_type.iter().sum()
+    }
+
+    /// Copies the borrowed header into an owned `FrameHeader`.
+    pub fn into_owned(self) -> FrameHeader {
+        FrameHeader {
+            prebox_header: self.prebox_header.map(str::to_string),
+            boxl: self.boxl,
+            angles: self.angles,
+            postbox_header: self.postbox_header.map(str::to_string),
+            natm_types: self.natm_types,
+            natms_per_type: self.natms_per_type.into_vec(),
+            masses_per_type: self.masses_per_type.into_vec(),
+        }
+    }
+}
+
+impl FrameHeaderRef<'_> {
+    /// Copies the borrowed header into an existing `FrameHeader`, reusing
+    /// its string and vector allocations.
+    pub fn write_to(&self, header: &mut FrameHeader) {
+        for (dst, src) in header.prebox_header.iter_mut().zip(self.prebox_header) {
+            dst.clear();
+            dst.push_str(src);
+        }
+        for (dst, src) in header.postbox_header.iter_mut().zip(self.postbox_header) {
+            dst.clear();
+            dst.push_str(src);
+        }
+        header.boxl = self.boxl;
+        header.angles = self.angles;
+        header.natm_types = self.natm_types;
+        header.natms_per_type.clear();
+        header.natms_per_type.extend_from_slice(&self.natms_per_type);
+        header.masses_per_type.clear();
+        header.masses_per_type.extend_from_slice(&self.masses_per_type);
+    }
+}
+
+impl From<FrameHeaderRef<'_>> for FrameHeader {
+    fn from(header: FrameHeaderRef<'_>) -> Self {
+        header.into_owned()
+    }
+}
+
 /// Represents the data for a single atom in a frame.
 #[derive(Debug, Clone)]
 pub struct AtomDatum {
     /// The chemical symbol of the atom (e.g., "C", "H", "O").
-    /// Using Rc<String> to avoid expensive clones for each atom of the same type.
-    pub symbol: Rc<String>,
+    /// Using Arc<String> to avoid expensive clones for each atom of the same type
+    /// while keeping frames `Send` for parallel parsing.
+    pub symbol: Arc<String>,
     /// The Cartesian x-coordinate.
     pub x: f64,
     /// The Cartesian y-coordinate.
@@ -54,7 +134,7 @@ impl AtomDatum {
     }
 }
 
-// Manual implementation of PartialEq because Rc<T> doesn't derive it by default.
+// Manual implementation of PartialEq because Arc<T> doesn't derive it by default.
 impl PartialEq for AtomDatum {
     fn eq(&self, other: &Self) -> bool {
         // Compare the string values, not the pointers.
@@ -86,6 +166,53 @@ impl ConFrame {
     }
 }
 
+/// One component's contiguous run of atoms within a frame.
+///
+/// Every atom of a component shares its element and mass, so consumers can
+/// process `atom_data[offset..offset + count]` (or the same range of the
+/// frame's columns) per species.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct ComponentRun {
+    /// The atomic number of the component's symbol, or 0 if it is unknown.
+    pub atomic_number: u64,
+    /// The mass of the component, from the header.
+    pub mass: f64,
+    /// The index of the component's first atom.
+    pub offset: usize,
+    /// The number of atoms in the component.
+    pub count: usize,
+}
+
+impl ConFrame {
+    /// Returns the atom runs of every component, in header order.
+    ///
+    /// The symbol is resolved once per component, not per atom. A component
+    /// without atoms in `atom_data` (as in header-only frames) has atomic
+    /// number 0.
+    pub fn components(&self) -> Vec<ComponentRun> {
+        let mut offset = 0;
+        self.header
+            .natms_per_type
+            .iter()
+            .zip(&self.header.masses_per_type)
+            .map(|(&count, &mass)| {
+                let atomic_number = self
+                    .atom_data
+                    .get(offset)
+                    .map_or(0, |atom| symbol_to_atomic_number(&atom.symbol));
+                let run = ComponentRun {
+                    atomic_number,
+                    mass,
+                    offset,
+                    count,
+                };
+                offset += count;
+                run
+            })
+            .collect()
+    }
+}
+
 // Manual implementation of PartialEq because of the change to AtomDatum.
 impl PartialEq for ConFrame {
     fn eq(&self, other: &Self) -> bool {
@@ -93,10 +220,237 @@ impl PartialEq for ConFrame {
     }
 }
 
+/// A column-oriented (structure-of-arrays) copy of a frame's per-atom data.
+///
+/// Every column is a contiguous array indexed in the same order as
+/// `ConFrame::atom_data`, so `x[i]`, `y[i]`, `z[i]` describe the same atom.
+/// The velocity columns are empty when the frame carries no velocity section.
+#[derive(Debug, Clone, Default, PartialEq)]
+pub struct AtomColumns {
+    /// Cartesian x-coordinates.
+    pub x: Vec<f64>,
+    /// Cartesian y-coordinates.
+    pub y: Vec<f64>,
+    /// Cartesian z-coordinates.
+    pub z: Vec<f64>,
+    /// x-components of velocity (empty without velocities).
+    pub vx: Vec<f64>,
+    /// y-components of velocity (empty without velocities).
+    pub vy: Vec<f64>,
+    /// z-components of velocity (empty without velocities).
+    pub vz: Vec<f64>,
+    /// Atom identifiers.
+    pub atom_id: Vec<u64>,
+    /// Fixed-atom flags.
+    pub is_fixed: Vec<bool>,
+}
+
+impl AtomColumns {
+    /// Splits a slice of atoms into contiguous per-field columns.
+    ///
+    /// Velocity columns are filled only when every atom carries velocity
+    /// data, matching the frame-level `ConFrame::has_velocities` semantics.
+    pub fn from_atoms(atoms: &[AtomDatum]) -> Self {
+        let n = atoms.len();
+        let with_velocities = atoms.first().is_some_and(|a| a.has_velocity());
+        let vel_cap = if with_velocities { n } else { 0 };
+        let mut columns = AtomColumns {
+            x: Vec::with_capacity(n),
+            y: Vec::with_capacity(n),
+            z: Vec::with_capacity(n),
+            vx: Vec::with_capacity(vel_cap),
+            vy: Vec::with_capacity(vel_cap),
+            vz: Vec::with_capacity(vel_cap),
+            atom_id: Vec::with_capacity(n),
+            is_fixed: Vec::with_capacity(n),
+        };
+        for atom in atoms {
+            columns.x.push(atom.x);
+            columns.y.push(atom.y);
+            columns.z.push(atom.z);
+            columns.atom_id.push(atom.atom_id);
+            columns.is_fixed.push(atom.is_fixed);
+            if with_velocities {
+                columns.vx.push(atom.vx.unwrap_or(0.0));
+                columns.vy.push(atom.vy.unwrap_or(0.0));
+                columns.vz.push(atom.vz.unwrap_or(0.0));
+            }
+        }
+        columns
+    }
+
+    /// Returns the number of atoms in the columns.
+    pub fn len(&self) -> usize {
+        self.x.len()
+    }
+
+    /// Returns `true` if the columns hold no atoms.
+    pub fn is_empty(&self) -> bool {
+        self.x.is_empty()
+    }
+
+    /// Returns `true` if the velocity columns are populated.
+    pub fn has_velocities(&self) -> bool {
+        !self.vx.is_empty()
+    }
+}
+
+impl ConFrame {
+    /// Returns a column-oriented copy of this frame's atom data.
+    pub fn columns(&self) -> AtomColumns {
+        AtomColumns::from_atoms(&self.atom_data)
+    }
+}
+
+/// A simulation frame stored in columnar (structure-of-arrays) layout.
+///
+/// This is an opt-in alternative to `ConFrame` for large systems. Instead of
+/// one `AtomDatum` per atom it keeps each per-atom field in its own contiguous
+/// array, and stores the chemical symbol once per component. Component `i`
+/// owns the atoms in `component_range(i)`, following `header.natms_per_type`.
+///
+/// Convert with `ConFrameSoA::from(&frame)` and `ConFrame::from(soa)` to use
+/// APIs that operate on `ConFrame`, such as `ConFrameWriter`.
+#[derive(Debug, Clone, PartialEq)]
+pub struct ConFrameSoA {
+    /// The `FrameHeader` containing the frame's metadata.
+    pub header: FrameHeader,
+    /// One chemical symbol per component, in header order.
+    pub symbols: Vec<String>,
+    /// Per-atom data as contiguous columns.
+    pub columns: AtomColumns,
+}
+
+impl ConFrameSoA {
+    /// Returns the number of atoms in the frame.
+    pub fn len(&self) -> usize {
+        self.columns.len()
+    }
+
+    /// Returns `true` if the frame holds no atoms.
+    pub fn is_empty(&self) -> bool {
+        self.columns.is_empty()
+    }
+
+    /// Returns `true` if the frame carries velocity data.
+    pub fn has_velocities(&self) -> bool {
+        self.columns.has_velocities()
+    }
+
+    /// Returns the range of atom indices belonging to the given component.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `component` is not less than `header.natm_types`.
+    pub fn component_range(&self, component: usize) -> std::ops::Range<usize> {
+        let start: usize = self.header.natms_per_type[..component].iter().sum();
+        start..start + self.header.natms_per_type[component]
+    }
+}
+
+impl From<&ConFrame> for ConFrameSoA {
+    fn from(frame: &ConFrame) -> Self {
+        let mut symbols = Vec::with_capacity(frame.header.natms_per_type.len());
+        let mut offset = 0;
+        for &count in &frame.header.natms_per_type {
+            let symbol = frame
+                .atom_data
+                .get(offset)
+                .map(|a| (*a.symbol).clone())
+                .unwrap_or_default();
+            symbols.push(symbol);
+            offset += count;
+        }
+        ConFrameSoA {
+            header: frame.header.clone(),
+            symbols,
+            columns: frame.columns(),
+        }
+    }
+}
+
+impl From<ConFrameSoA> for ConFrame {
+    fn from(soa: ConFrameSoA) -> Self {
+        let columns = &soa.columns;
+        let with_velocities = columns.has_velocities();
+        let mut atom_data = Vec::with_capacity(columns.len());
+        let mut i = 0;
+        for (symbol, &count) in soa.symbols.into_iter().zip(&soa.header.natms_per_type) {
+            // One shared symbol per component, as the parser does.
+            let symbol = Arc::new(symbol);
+            for _ in 0..count {
+                atom_data.push(AtomDatum {
+                    symbol: Arc::clone(&symbol),
+                    x: columns.x[i],
+                    y: columns.y[i],
+                    z: columns.z[i],
+                    is_fixed: columns.is_fixed[i],
+                    atom_id: columns.atom_id[i],
+                    vx: with_velocities.then(|| columns.vx[i]),
+                    vy: with_velocities.then(|| columns.vy[i]),
+                    vz: with_velocities.then(|| columns.vz[i]),
+                });
+                i += 1;
+            }
+        }
+        ConFrame {
+            header: soa.header,
+            atom_data,
+        }
+    }
+}
+
+/// A borrowed frame in structure-of-arrays form, written by
+/// [`ConFrameWriter::write_view`](crate::writer::ConFrameWriter::write_view)
+/// straight from caller-owned memory, without building a `ConFrame`.
+///
+/// Atoms are grouped by component: the first `natms_per_type[0]` entries of
+/// every per-atom slice belong to `symbols[0]`, the next
+/// `natms_per_type[1]` to `symbols[1]`, and so on.
+#[derive(Debug, Clone, Copy)]
+pub struct FrameView<'a> {
+    pub prebox_header: [&'a str; 2],
+    pub boxl: [f64; 3],
+    pub angles: [f64; 3],
+    pub postbox_header: [&'a str; 2],
+    /// One symbol per component.
+    pub symbols: &'a [&'a str],
+    pub natms_per_type: &'a [usize],
+    pub masses_per_type: &'a [f64],
+    pub positions: &'a [[f64; 3]],
+    /// Velocities, one per atom; `None` writes a `.con` frame.
+    pub velocities: Option<&'a [[f64; 3]]>,
+    pub atom_ids: &'a [u64],
+    /// Fixed flags, one per atom; `None` writes every atom as free.
+    pub fixed: Option<&'a [bool]>,
+}
+
+impl FrameView<'_> {
+    /// Returns the number of atoms in the view.
+    pub fn num_atoms(&self) -> usize {
+        self.positions.len()
+    }
+
+    /// Returns `true` if the per-component and per-atom slices agree in
+    /// length, which the writer requires.
+    pub fn is_consistent(&self) -> bool {
+        let n = self.positions.len();
+        self.symbols.len() == self.natms_per_type.len()
+            && self.masses_per_type.len() == self.natms_per_type.len()
+            && self.natms_per_type.iter().sum::<usize>() == n
+            && self.atom_ids.len() == n
+            && self.fixed.is_none_or(|f| f.len() == n)
+            && self.velocities.is_none_or(|v| v.len() == n)
+    }
+}
+
 /// A builder for constructing `ConFrame` objects from in-memory data.
 ///
 /// Atoms are accumulated and grouped by symbol on `build()` to compute the
-/// header fields (`natm_types`, `natms_per_type`, `masses_per_type`).
+/// header fields (`natm_types`, `natms_per_type`, `masses_per_type`). Each
+/// component's symbol is stored once and shared by its atoms. When every
+/// component's atoms are added contiguously, `build()` keeps them in
+/// insertion order without a regrouping pass.
 ///
 /// # Example
 ///
@@ -115,34 +469,48 @@ pub struct ConFrameBuilder {
     cell: [f64; 3],
     angles: [f64; 3],
     postbox_header: [String; 2],
-    atoms: Vec<BuilderAtom>,
+    /// Atoms in insertion order.
+    atoms: Vec<AtomDatum>,
+    /// Distinct components in encounter order.
+    components: Vec<BuilderComponent>,
+    /// Component of the most recently added atom.
+    current: usize,
+    /// `false` once a component receives atoms after another one started.
+    grouped: bool,
 }
 
-struct BuilderAtom {
-    symbol: String,
-    x: f64,
-    y: f64,
-    z: f64,
-    is_fixed: bool,
-    atom_id: u64,
+struct BuilderComponent {
+    symbol: Arc<String>,
+    /// Mass of the component's first atom.
     mass: f64,
-    vx: Option<f64>,
-    vy: Option<f64>,
-    vz: Option<f64>,
+    count: usize,
 }
 
 impl ConFrameBuilder {
     /// Creates a new builder with the given cell dimensions and angles.
     pub fn new(cell: [f64; 3], angles: [f64; 3]) -> Self {
+        Self::with_capacity(cell, angles, 0)
+    }
+
+    /// Creates a builder with room for `atoms` atoms.
+    pub fn with_capacity(cell: [f64; 3], angles: [f64; 3], atoms: usize) -> Self {
         Self {
             prebox_header: [String::new(), String::new()],
             cell,
             angles,
             postbox_header: [String::new(), String::new()],
-            atoms: Vec::new(),
+            atoms: Vec::with_capacity(atoms),
+            components: Vec::new(),
+            current: 0,
+            grouped: true,
         }
     }
 
+    /// Reserves room for at least `additional` more atoms.
+    pub fn reserve(&mut self, additional: usize) {
+        self.atoms.reserve(additional);
+    }
+
     /// Sets the two pre-box header lines.
     pub fn prebox_header(mut self, h: [String; 2]) -> Self {
         self.prebox_header = h;
@@ -155,6 +523,32 @@ impl ConFrameBuilder {
         self
     }
 
+    /// Returns the component `symbol` and counts `n` atoms into it,
+    /// registering it with `mass` on first use.
+    fn component(&mut self, symbol: &str, mass: f64, n: usize) -> Arc<String> {
+        let idx = match self.components.get(self.current) {
+            Some(c) if c.symbol.as_str() == symbol => self.current,
+            _ => match self.components.iter().position(|c| c.symbol.as_str() == symbol) {
+                Some(idx) => {
+                    self.grouped = false;
+                    idx
+                }
+                None => {
+                    self.components.push(BuilderComponent {
+                        symbol: Arc::new(symbol.to_string()),
+                        mass,
+                        count: 0,
+                    });
+                    self.components.len() - 1
+                }
+            },
+        };
+        self.current = idx;
+        let component = &mut self.components[idx];
+        component.count += n;
+        Arc::clone(&component.symbol)
+    }
+
     /// Adds an atom without velocity data.
     pub fn add_atom(
         &mut self,
@@ -166,14 +560,14 @@ impl ConFrameBuilder {
         atom_id: u64,
         mass: f64,
     ) {
-        self.atoms.push(BuilderAtom {
-            symbol: symbol.to_string(),
+        let symbol = self.component(symbol, mass, 1);
+        self.atoms.push(AtomDatum {
+            symbol,
             x,
             y,
             z,
             is_fixed,
             atom_id,
-            mass,
             vx: None,
             vy: None,
             vz: None,
@@ -194,76 +588,114 @@ impl ConFrameBuilder {
         vy: f64,
         vz: f64,
     ) {
-        self.atoms.push(BuilderAtom {
-            symbol: symbol.to_string(),
+        let symbol = self.component(symbol, mass, 1);
+        self.atoms.push(AtomDatum {
+            symbol,
             x,
             y,
             z,
             is_fixed,
             atom_id,
-            mass,
             vx: Some(vx),
             vy: Some(vy),
             vz: Some(vz),
         });
     }
 
-    /// Consumes the builder and produces a `ConFrame`.
+    /// Adds a run of atoms of one component from per-atom arrays.
     ///
-    /// Atoms are grouped by symbol (in encounter order) to compute
-    /// `natm_types`, `natms_per_type`, and `masses_per_type`.
-    pub fn build(self) -> ConFrame {
-        // Group atoms by symbol in encounter order
-        let mut type_order: Vec<String> = Vec::new();
-        let mut type_counts: Vec<usize> = Vec::new();
-        let mut type_masses: Vec<f64> = Vec::new();
-
-        for atom in &self.atoms {
-            if let Some(idx) = type_order.iter().position(|s| s == &atom.symbol) {
-                type_counts[idx] += 1;
-            } else {
-                type_order.push(atom.symbol.clone());
-                type_counts.push(1);
-                type_masses.push(atom.mass);
-            }
+    /// `fixed` defaults to all free and `velocities` to none. The symbol is
+    /// looked up once for the whole run, so adding each component in one
+    /// call builds a frame with one comparison per component.
+    ///
+    /// # Panics
+    ///
+    /// If `atom_ids`, `fixed` or `velocities` differ in length from
+    /// `positions`.
+    ///
+    /// # Example
+    ///
+    /// ```
+    /// use readcon_core::types::ConFrameBuilder;
+    ///
+    /// let mut builder = ConFrameBuilder::with_capacity([10.0; 3], [90.0; 3], 3);
+    /// builder.add_component("Cu", 63.546, &[[0.0; 3], [1.0; 3]], &[0, 1], Some(&[true, true]), None);
+    /// builder.add_component("H", 1.008, &[[2.0; 3]], &[2], None, None);
+    /// let frame = builder.build();
+    /// assert_eq!(frame.header.natms_per_type, vec![2, 1]);
+    /// assert!(frame.atom_data[1].is_fixed);
+    /// ```
+    pub fn add_component(
+        &mut self,
+        symbol: &str,
+        mass: f64,
+        positions: &[[f64; 3]],
+        atom_ids: &[u64],
+        fixed: Option<&[bool]>,
+        velocities: Option<&[[f64; 3]]>,
+    ) {
+        let n = positions.len();
+        assert_eq!(atom_ids.len(), n, "atom_ids and positions differ in length");
+        assert!(fixed.is_none_or(|f| f.len() == n), "fixed and positions differ in length");
+        assert!(
+            velocities.is_none_or(|v| v.len() == n),
+            "velocities and positions differ in length"
+        );
+        if n == 0 {
+            return;
         }
-
-        // Sort atoms by type order (group same symbols together)
-        let mut sorted_atoms: Vec<&BuilderAtom> = Vec::with_capacity(self.atoms.len());
-        for symbol in &type_order {
-            for atom in &self.atoms {
-                if &atom.symbol == symbol {
-                    sorted_atoms.push(atom);
-                }
-            }
+        let symbol = self.component(symbol, mass, n);
+        self.atoms.reserve(n);
+        for (i, (&[x, y, z], &atom_id)) in positions.iter().zip(atom_ids).enumerate() {
+            let v = velocities.map(|v| v[i]);
+            self.atoms.push(AtomDatum {
+                symbol: Arc::clone(&symbol),
+                x,
+                y,
+                z,
+                is_fixed: fixed.is_some_and(|f| f[i]),
+                atom_id,
+                vx: v.map(|v| v[0]),
+                vy: v.map(|v| v[1]),
+                vz: v.map(|v| v[2]),
+            });
         }
+    }
 
-        let atom_data: Vec<AtomDatum> = sorted_atoms
-            .iter()
-            .map(|a| {
-                let symbol = Rc::new(a.symbol.clone());
-                AtomDatum {
-                    symbol,
-                    x: a.x,
-                    y: a.y,
-                    z: a.z,
-                    is_fixed: a.is_fixed,
-                    atom_id: a.atom_id,
-                    vx: a.vx,
-                    vy: a.vy,
-                    vz: a.vz,
-                }
-            })
-            .collect();
+    /// Consumes the builder and produces a `ConFrame`.
+    ///
+    /// Components are ordered by first appearance and atoms are grouped by
+    /// component, keeping their relative order.
+    pub fn build(self) -> ConFrame {
+        let atom_data = if self.grouped {
+            self.atoms
+        } else {
+            // Stable bucket pass: each atom's component is found by its
+            // shared symbol.
+            let mut buckets: Vec<Vec<AtomDatum>> = self
+                .components
+                .iter()
+                .map(|c| Vec::with_capacity(c.count))
+                .collect();
+            for atom in self.atoms {
+                let idx = self
+                    .components
+                    .iter()
+                    .position(|c| Arc::ptr_eq(&c.symbol, &atom.symbol))
+                    .unwrap_or(0);
+                buckets[idx].push(atom);
+            }
+            buckets.into_iter().flatten().collect()
+        };
 
         let header = FrameHeader {
             prebox_header: self.prebox_header,
             boxl: self.cell,
             angles: self.angles,
             postbox_header: self.postbox_header,
-            natm_types: type_order.len(),
-            natms_per_type: type_counts,
-            masses_per_type: type_masses,
+            natm_types: self.components.len(),
+            natms_per_type: self.components.iter().map(|c| c.count).collect(),
+            masses_per_type: self.components.iter().map(|c| c.mass).collect(),
         };
 
         ConFrame { header, atom_data }
@@ -337,4 +769,90 @@ mod tests {
         assert_eq!(&*frame.atom_data[1].symbol, "H");
         assert_eq!(&*frame.atom_data[2].symbol, "Cu");
     }
+
+    #[test]
+    fn test_builder_add_component_matches_add_atom() {
+        let mut bulk = ConFrameBuilder::with_capacity([10.0; 3], [90.0; 3], 3);
+        bulk.add_component(
+            "Cu",
+            63.546,
+            &[[0.0, 1.0, 2.0], [3.0, 4.0, 5.0]],
+            &[4, 5],
+            Some(&[true, false]),
+            Some(&[[0.1, 0.2, 0.3], [0.4, 0.5, 0.6]]),
+        );
+        bulk.add_component("H", 1.008, &[[6.0, 7.0, 8.0]], &[6], None, Some(&[[0.7, 0.8, 0.9]]));
+        bulk.add_component("O", 15.999, &[], &[], None, None);
+
+        let mut single = ConFrameBuilder::new([10.0; 3], [90.0; 3]);
+        single.add_atom_with_velocity("Cu", 0.0, 1.0, 2.0, true, 4, 63.546, 0.1, 0.2, 0.3);
+        single.add_atom_with_velocity("Cu", 3.0, 4.0, 5.0, false, 5, 63.546, 0.4, 0.5, 0.6);
+        single.add_atom_with_velocity("H", 6.0, 7.0, 8.0, false, 6, 1.008, 0.7, 0.8, 0.9);
+
+        let frame = bulk.build();
+        assert_eq!(frame, single.build());
+        assert!(Arc::ptr_eq(&frame.atom_data[0].symbol, &frame.atom_data[1].symbol));
+    }
+
+    #[test]
+    fn test_builder_regroups_split_components() {
+        let mut builder = ConFrameBuilder::new([10.0; 3], [90.0; 3]);
+        builder.add_component("Cu", 63.546, &[[0.0; 3]], &[0], None, None);
+        builder.add_component("H", 1.008, &[[1.0; 3]], &[1], None, None);
+        builder.add_component("Cu", 63.546, &[[2.0; 3]], &[2], None, None);
+        let frame = builder.build();
+
+        assert_eq!(frame.header.natms_per_type, vec![2, 1]);
+        let ids: Vec<u64> = frame.atom_data.iter().map(|a| a.atom_id).collect();
+        assert_eq!(ids, vec![0, 2, 1]);
+    }
+
+    #[test]
+    fn test_columns_layout() {
+        let mut builder = ConFrameBuilder::new([10.0, 10.0, 10.0], [90.0, 90.0, 90.0]);
+        builder.add_atom("Cu", 0.0, 1.0, 2.0, true, 0, 63.546);
+        builder.add_atom("H", 3.0, 4.0, 5.0, false, 7, 1.008);
+        let columns = builder.build().columns();
+
+        assert_eq!(columns.len(), 2);
+        assert_eq!(columns.x, vec![0.0, 3.0]);
+        assert_eq!(columns.y, vec![1.0, 4.0]);
+        assert_eq!(columns.z, vec![2.0, 5.0]);
+        assert_eq!(columns.atom_id, vec![0, 7]);
+        assert_eq!(columns.is_fixed, vec![true, false]);
+        assert!(!columns.has_velocities());
+        assert!(columns.vx.is_empty());
+    }
+
+    #[test]
+    fn test_columns_with_velocities() {
+        let mut builder = ConFrameBuilder::new([10.0, 10.0, 10.0], [90.0, 90.0, 90.0]);
+        builder.add_atom_with_velocity("Cu", 0.0, 0.0, 0.0, true, 0, 63.546, 0.1, 0.2, 0.3);
+        builder.add_atom_with_velocity("Cu", 1.0, 0.0, 0.0, true, 1, 63.546, 0.4, 0.5, 0.6);
+        let columns = builder.build().columns();
+
+        assert!(columns.has_velocities());
+        assert_eq!(columns.vx, vec![0.1, 0.4]);
+        assert_eq!(columns.vy, vec![0.2, 0.5]);
+        assert_eq!(columns.vz, vec![0.3, 0.6]);
+    }
+
+    #[test]
+    fn test_soa_roundtrip() {
+        let mut builder = ConFrameBuilder::new([10.0, 10.0, 10.0], [90.0, 90.0, 90.0]);
+        builder.add_atom_with_velocity("Cu", 0.0, 0.0, 0.0, true, 0, 63.546, 0.1, 0.2, 0.3);
+        builder.add_atom_with_velocity("Cu", 1.0, 0.0, 0.0, true, 1, 63.546, 0.4, 0.5, 0.6);
+        builder.add_atom_with_velocity("H", 2.0, 3.0, 4.0, false, 2, 1.008, 0.7, 0.8, 0.9);
+        let frame = builder.build();
+
+        let soa = ConFrameSoA::from(&frame);
+        assert_eq!(soa.len(), 3);
+        assert_eq!(soa.symbols, vec!["Cu", "H"]);
+        assert_eq!(soa.component_range(0), 0..2);
+        assert_eq!(soa.component_range(1), 2..3);
+        assert!(soa.has_velocities());
+
+        let back = ConFrame::from(soa);
+        assert_eq!(back, frame);
+    }
 }
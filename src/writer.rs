@@ -1,7 +1,14 @@
-use crate::types::ConFrame;
-use std::fs::File;
+use crate::compression::{Compression, GroupCompressor};
+use crate::error::ParseError;
+use crate::index::{FrameIndex, LineCursor};
+use crate::iterators::ConFrameFileIterator;
+use crate::numfmt;
+use crate::parser::parse_frame_header_ref;
+use crate::stats::{self, Stage};
+use crate::types::{ConFrame, FrameHeader, FrameView};
+use std::fs::{File, OpenOptions};
 use std::io::{self, BufWriter, Write};
-use std::path::Path;
+use std::path::{Path, PathBuf};
 
 /// Default floating-point precision used for writing coordinates, cell dimensions, and masses.
 const DEFAULT_FLOAT_PRECISION: usize = 6;
@@ -10,6 +17,209 @@ const DEFAULT_FLOAT_PRECISION: usize = 6;
 const FIXED_ATOM_FLAG: usize = 1;
 /// The value used to indicate a non-fixed (free) atom in the output file.
 const FREE_ATOM_FLAG: usize = 0;
+/// In-flight serialization budget used when `with_parallel` is given 0.
+#[cfg(feature = "parallel")]
+pub const DEFAULT_MAX_IN_FLIGHT_BYTES: usize = 64 << 20;
+
+fn push_line(buf: &mut Vec<u8>, line: &str) {
+    buf.extend_from_slice(line.as_bytes());
+    buf.push(b'\n');
+}
+
+/// Appends space-separated fixed-precision floats and a newline.
+fn push_f64_line(buf: &mut Vec<u8>, values: impl Iterator<Item = f64>, prec: usize) {
+    for (i, v) in values.enumerate() {
+        if i > 0 {
+            buf.push(b' ');
+        }
+        numfmt::push_fixed(buf, v, prec);
+    }
+    buf.push(b'\n');
+}
+
+/// Appends one `x y z flag id` coordinate or velocity line, padding each
+/// float to at least `width` bytes (0 for no padding).
+#[inline]
+fn push_atom_line(
+    buf: &mut Vec<u8>,
+    xyz: [f64; 3],
+    is_fixed: bool,
+    atom_id: u64,
+    prec: usize,
+    width: usize,
+) {
+    for v in xyz {
+        numfmt::push_fixed_padded(buf, v, prec, width);
+        buf.push(b' ');
+    }
+    let flag = if is_fixed { FIXED_ATOM_FLAG } else { FREE_ATOM_FLAG };
+    buf.push(b'0' + flag as u8);
+    buf.push(b' ');
+    numfmt::push_u64(buf, atom_id);
+    buf.push(b'\n');
+}
+
+/// The fields of the nine header lines, borrowed from a [`FrameHeader`] or
+/// a [`FrameView`].
+struct HeaderLines<'a> {
+    prebox: [&'a str; 2],
+    boxl: &'a [f64; 3],
+    angles: &'a [f64; 3],
+    postbox: [&'a str; 2],
+    natm_types: usize,
+    natms_per_type: &'a [usize],
+    masses_per_type: &'a [f64],
+}
+
+impl<'a> From<&'a FrameHeader> for HeaderLines<'a> {
+    fn from(header: &'a FrameHeader) -> Self {
+        HeaderLines {
+            prebox: [&header.prebox_header[0], &header.prebox_header[1]],
+            boxl: &header.boxl,
+            angles: &header.angles,
+            postbox: [&header.postbox_header[0], &header.postbox_header[1]],
+            natm_types: header.natm_types,
+            natms_per_type: &header.natms_per_type,
+            masses_per_type: &header.masses_per_type,
+        }
+    }
+}
+
+impl<'a> From<&'a FrameView<'a>> for HeaderLines<'a> {
+    fn from(view: &'a FrameView<'a>) -> Self {
+        HeaderLines {
+            prebox: view.prebox_header,
+            boxl: &view.boxl,
+            angles: &view.angles,
+            postbox: view.postbox_header,
+            natm_types: view.natms_per_type.len(),
+            natms_per_type: view.natms_per_type,
+            masses_per_type: view.masses_per_type,
+        }
+    }
+}
+
+/// Appends the nine header lines.
+fn push_header(buf: &mut Vec<u8>, header: HeaderLines<'_>, prec: usize) {
+    push_line(buf, header.prebox[0]);
+    push_line(buf, header.prebox[1]);
+    push_f64_line(buf, header.boxl.iter().copied(), prec);
+    push_f64_line(buf, header.angles.iter().copied(), prec);
+    push_line(buf, header.postbox[0]);
+    push_line(buf, header.postbox[1]);
+    numfmt::push_u64(buf, header.natm_types as u64);
+    buf.push(b'\n');
+    for (i, &n) in header.natms_per_type.iter().enumerate() {
+        if i > 0 {
+            buf.push(b' ');
+        }
+        numfmt::push_u64(buf, n as u64);
+    }
+    buf.push(b'\n');
+    push_f64_line(buf, header.masses_per_type.iter().copied(), prec);
+}
+
+/// Appends the symbol and "<label> of Component N" lines of a block.
+fn push_component_lines(buf: &mut Vec<u8>, symbol: &str, label: &[u8], type_idx: usize) {
+    push_line(buf, symbol);
+    buf.extend_from_slice(label);
+    buf.extend_from_slice(b" of Component ");
+    numfmt::push_u64(buf, type_idx as u64 + 1);
+    buf.push(b'\n');
+}
+
+/// Appends the `.con` text of `frame` to `buf`. Coordinates are padded to
+/// `coord_width` bytes (0 for none).
+fn serialize_frame(buf: &mut Vec<u8>, frame: &ConFrame, prec: usize, coord_width: usize) {
+    let mut timer = stats::time(Stage::WriteFrame);
+    let (start, capacity) = (buf.len(), buf.capacity());
+    // --- Write the 9-line Header ---
+    let header = &frame.header;
+    push_header(buf, header.into(), prec);
+
+    // --- Write the Atom Data ---
+    let mut atom_idx_offset = 0;
+    for (type_idx, &num_atoms_in_type) in header.natms_per_type.iter().enumerate() {
+        let symbol = &frame.atom_data[atom_idx_offset].symbol;
+        push_component_lines(buf, symbol, b"Coordinates", type_idx);
+
+        for atom in &frame.atom_data[atom_idx_offset..atom_idx_offset + num_atoms_in_type] {
+            push_atom_line(
+                buf,
+                [atom.x, atom.y, atom.z],
+                atom.is_fixed,
+                atom.atom_id,
+                prec,
+                coord_width,
+            );
+        }
+        atom_idx_offset += num_atoms_in_type;
+    }
+
+    // --- Write optional velocity section ---
+    if frame.has_velocities() {
+        // Blank separator line between coordinates and velocities
+        buf.push(b'\n');
+
+        let mut vel_idx_offset = 0;
+        for (type_idx, &num_atoms_in_type) in header.natms_per_type.iter().enumerate() {
+            let symbol = &frame.atom_data[vel_idx_offset].symbol;
+            push_component_lines(buf, symbol, b"Velocities", type_idx);
+
+            for atom in &frame.atom_data[vel_idx_offset..vel_idx_offset + num_atoms_in_type] {
+                let v = [
+                    atom.vx.unwrap_or(0.0),
+                    atom.vy.unwrap_or(0.0),
+                    atom.vz.unwrap_or(0.0),
+                ];
+                push_atom_line(buf, v, atom.is_fixed, atom.atom_id, prec, 0);
+            }
+            vel_idx_offset += num_atoms_in_type;
+        }
+    }
+
+    if buf.capacity() != capacity {
+        stats::allocation();
+    }
+    timer.bytes(buf.len() - start);
+    timer.frame(frame.atom_data.len());
+}
+
+/// Appends the `.con` text of a consistent `view` to `buf`; the output is
+/// the same as for the equivalent `ConFrame`.
+fn serialize_view(buf: &mut Vec<u8>, view: &FrameView<'_>, prec: usize, coord_width: usize) {
+    let mut timer = stats::time(Stage::WriteFrame);
+    let (start, capacity) = (buf.len(), buf.capacity());
+    push_header(buf, view.into(), prec);
+
+    let fixed = |i: usize| view.fixed.is_some_and(|f| f[i]);
+    let mut offset = 0;
+    for (type_idx, (&symbol, &n)) in view.symbols.iter().zip(view.natms_per_type).enumerate() {
+        push_component_lines(buf, symbol, b"Coordinates", type_idx);
+        for i in offset..offset + n {
+            push_atom_line(buf, view.positions[i], fixed(i), view.atom_ids[i], prec, coord_width);
+        }
+        offset += n;
+    }
+
+    if let Some(velocities) = view.velocities {
+        buf.push(b'\n');
+        let mut offset = 0;
+        for (type_idx, (&symbol, &n)) in view.symbols.iter().zip(view.natms_per_type).enumerate() {
+            push_component_lines(buf, symbol, b"Velocities", type_idx);
+            for i in offset..offset + n {
+                push_atom_line(buf, velocities[i], fixed(i), view.atom_ids[i], prec, 0);
+            }
+            offset += n;
+        }
+    }
+
+    if buf.capacity() != capacity {
+        stats::allocation();
+    }
+    timer.bytes(buf.len() - start);
+    timer.frame(view.num_atoms());
+}
 
 /// A writer that can serialize and write `ConFrame` objects to any output stream.
 ///
@@ -28,6 +238,52 @@ const FREE_ATOM_FLAG: usize = 0;
 pub struct ConFrameWriter<W: Write> {
     writer: BufWriter<W>,
     precision: usize,
+    /// Minimum width of each coordinate field; 0 writes them unpadded.
+    coordinate_width: usize,
+    /// Serialization buffer for one frame, reused across `write_frame` calls.
+    buf: Vec<u8>,
+    /// Frame-group compressor for `.con.zst`/`.con.gz` output.
+    compressor: Option<GroupCompressor>,
+    #[cfg(feature = "parallel")]
+    parallel: Option<ParallelSerializer>,
+}
+
+/// Writes one serialized frame, through the compressor if there is one.
+#[inline]
+fn emit_frame<W: Write>(
+    writer: &mut BufWriter<W>,
+    compressor: &mut Option<GroupCompressor>,
+    text: &[u8],
+) -> io::Result<()> {
+    match compressor {
+        Some(c) => c.push_frame(writer, text),
+        None => writer.write_all(text),
+    }
+}
+
+/// Thread pool and per-frame buffers for `extend` with the `parallel` feature.
+#[cfg(feature = "parallel")]
+struct ParallelSerializer {
+    pool: rayon::ThreadPool,
+    max_in_flight_bytes: usize,
+    buffers: Vec<Vec<u8>>,
+}
+
+/// Upper estimate of the serialized size of `frame`, used to size batches.
+#[cfg(feature = "parallel")]
+fn estimated_frame_len(frame: &ConFrame, prec: usize) -> usize {
+    // Three floats (sign, ~4 integer digits, point, `prec` digits, space)
+    // plus flag, id and newline.
+    let line = 3 * (prec + 7) + 24;
+    let blocks = if frame.has_velocities() { 2 } else { 1 };
+    let text_headers: usize = frame
+        .header
+        .prebox_header
+        .iter()
+        .chain(frame.header.postbox_header.iter())
+        .map(|h| h.len() + 1)
+        .sum();
+    256 + text_headers + blocks * (frame.atom_data.len() * line + frame.header.natm_types * 40)
 }
 
 // General implementation for any type that implements `Write`.
@@ -41,6 +297,11 @@ impl<W: Write> ConFrameWriter<W> {
         Self {
             writer: BufWriter::new(writer),
             precision: DEFAULT_FLOAT_PRECISION,
+            coordinate_width: 0,
+            buf: Vec::new(),
+            compressor: None,
+            #[cfg(feature = "parallel")]
+            parallel: None,
         }
     }
 
@@ -54,117 +315,231 @@ impl<W: Write> ConFrameWriter<W> {
         Self {
             writer: BufWriter::new(writer),
             precision,
+            coordinate_width: 0,
+            buf: Vec::new(),
+            compressor: None,
+            #[cfg(feature = "parallel")]
+            parallel: None,
         }
     }
 
+    /// Right-aligns every coordinate in a field of at least `width` bytes,
+    /// as `{:>width$.precision$}` would. 0 (the default) disables padding.
+    ///
+    /// With a width that every coordinate fits in, all coordinate lines of
+    /// a frame keep their length when the positions change, which is what
+    /// [`FramePatcher`] relies on to rewrite a frame in place.
+    /// `precision + 7` leaves room for a sign and five integer digits.
+    /// Velocity lines are not padded.
+    pub fn with_coordinate_width(mut self, width: usize) -> Self {
+        self.coordinate_width = width;
+        self
+    }
+
+    /// Compresses the output in independent groups of whole frames (see
+    /// [`crate::compression`]). `from_path` selects this from the file
+    /// extension.
+    ///
+    /// Compressed output is only complete after [`ConFrameWriter::finish`]
+    /// has written the last group and, for zstd, the seek table. Call it
+    /// explicitly: dropping the writer also finishes the output, but can
+    /// only log a failure, not return it.
+    ///
+    /// Requires the `compression` feature.
+    #[cfg(feature = "compression")]
+    pub fn with_compression(mut self, compression: Compression) -> Self {
+        self.compressor = GroupCompressor::for_compression(compression);
+        self
+    }
+
+    /// Like [`ConFrameWriter::with_coordinate_width`], for an existing writer.
+    pub fn set_coordinate_width(&mut self, width: usize) {
+        self.coordinate_width = width;
+    }
+
+    /// Enables parallel serialization in `extend`.
+    ///
+    /// Frames are formatted into per-frame buffers on a dedicated pool of
+    /// `n_threads` workers (0 means one per logical CPU) and written in
+    /// input order, so the output is identical to the serial path. Frames
+    /// are taken in batches whose estimated text size stays under
+    /// `max_in_flight_bytes` (0 selects `DEFAULT_MAX_IN_FLIGHT_BYTES`); a
+    /// single frame larger than the budget forms its own batch.
+    ///
+    /// Requires the `parallel` feature.
+    #[cfg(feature = "parallel")]
+    pub fn with_parallel(mut self, n_threads: usize, max_in_flight_bytes: usize) -> io::Result<Self> {
+        let pool = rayon::ThreadPoolBuilder::new()
+            .num_threads(n_threads)
+            .build()
+            .map_err(io::Error::other)?;
+        let max_in_flight_bytes = if max_in_flight_bytes == 0 {
+            DEFAULT_MAX_IN_FLIGHT_BYTES
+        } else {
+            max_in_flight_bytes
+        };
+        self.parallel = Some(ParallelSerializer {
+            pool,
+            max_in_flight_bytes,
+            buffers: Vec::new(),
+        });
+        Ok(self)
+    }
+
     /// Writes a single `ConFrame` to the output stream.
+    ///
+    /// The frame is serialized into a reused byte buffer with the
+    /// allocation-free formatters in `numfmt` and handed to the underlying
+    /// writer in one `write_all`. The output is byte-identical to formatting
+    /// every value with `{:.precision$}`.
     pub fn write_frame(&mut self, frame: &ConFrame) -> io::Result<()> {
-        let prec = self.precision;
+        self.buf.clear();
+        serialize_frame(&mut self.buf, frame, self.precision, self.coordinate_width);
+        emit_frame(&mut self.writer, &mut self.compressor, &self.buf)
+    }
 
-        // --- Write the 9-line Header ---
-        writeln!(self.writer, "{}", frame.header.prebox_header[0])?;
-        writeln!(self.writer, "{}", frame.header.prebox_header[1])?;
-        writeln!(
-            self.writer,
-            "{1:.0$} {2:.0$} {3:.0$}",
-            prec, frame.header.boxl[0], frame.header.boxl[1], frame.header.boxl[2]
-        )?;
-        writeln!(
-            self.writer,
-            "{1:.0$} {2:.0$} {3:.0$}",
-            prec, frame.header.angles[0], frame.header.angles[1], frame.header.angles[2]
-        )?;
-        writeln!(self.writer, "{}", frame.header.postbox_header[0])?;
-        writeln!(self.writer, "{}", frame.header.postbox_header[1])?;
-        writeln!(self.writer, "{}", frame.header.natm_types)?;
-
-        let natms_str: Vec<String> = frame
-            .header
-            .natms_per_type
-            .iter()
-            .map(|n| n.to_string())
-            .collect();
-        writeln!(self.writer, "{}", natms_str.join(" "))?;
-
-        let masses_str: Vec<String> = frame
-            .header
-            .masses_per_type
-            .iter()
-            .map(|m| format!("{:.1$}", m, prec))
-            .collect();
-        writeln!(self.writer, "{}", masses_str.join(" "))?;
-
-        // --- Write the Atom Data ---
-        let mut atom_idx_offset = 0;
-        for (type_idx, &num_atoms_in_type) in frame.header.natms_per_type.iter().enumerate() {
-            let symbol = &frame.atom_data[atom_idx_offset].symbol;
-            writeln!(self.writer, "{}", symbol)?;
-            writeln!(self.writer, "Coordinates of Component {}", type_idx + 1)?;
-
-            for i in 0..num_atoms_in_type {
-                let atom = &frame.atom_data[atom_idx_offset + i];
-                writeln!(
-                    self.writer,
-                    "{x:.prec$} {y:.prec$} {z:.prec$} {fixed_flag:.0} {atom_id}",
-                    prec = prec,
-                    x = atom.x,
-                    y = atom.y,
-                    z = atom.z,
-                    fixed_flag = if atom.is_fixed {
-                        FIXED_ATOM_FLAG
-                    } else {
-                        FREE_ATOM_FLAG
-                    },
-                    atom_id = atom.atom_id
-                )?;
-            }
-            atom_idx_offset += num_atoms_in_type;
-        }
-
-        // --- Write optional velocity section ---
-        if frame.has_velocities() {
-            // Blank separator line between coordinates and velocities
-            writeln!(self.writer)?;
-
-            let mut vel_idx_offset = 0;
-            for (type_idx, &num_atoms_in_type) in frame.header.natms_per_type.iter().enumerate() {
-                let symbol = &frame.atom_data[vel_idx_offset].symbol;
-                writeln!(self.writer, "{}", symbol)?;
-                writeln!(self.writer, "Velocities of Component {}", type_idx + 1)?;
-
-                for i in 0..num_atoms_in_type {
-                    let atom = &frame.atom_data[vel_idx_offset + i];
-                    writeln!(
-                        self.writer,
-                        "{vx:.prec$} {vy:.prec$} {vz:.prec$} {fixed_flag:.0} {atom_id}",
-                        prec = prec,
-                        vx = atom.vx.unwrap_or(0.0),
-                        vy = atom.vy.unwrap_or(0.0),
-                        vz = atom.vz.unwrap_or(0.0),
-                        fixed_flag = if atom.is_fixed {
-                            FIXED_ATOM_FLAG
-                        } else {
-                            FREE_ATOM_FLAG
-                        },
-                        atom_id = atom.atom_id
-                    )?;
-                }
-                vel_idx_offset += num_atoms_in_type;
-            }
+    /// Writes a frame from borrowed structure-of-arrays data.
+    ///
+    /// The output is byte-identical to `write_frame` on the equivalent
+    /// `ConFrame`, but nothing is copied out of the caller's arrays.
+    ///
+    /// # Errors
+    ///
+    /// `io::ErrorKind::InvalidInput` if the view's slices disagree in length
+    /// (see [`FrameView::is_consistent`]); nothing is written then.
+    ///
+    /// # Example
+    ///
+    /// ```
+    /// use readcon_core::types::FrameView;
+    /// use readcon_core::writer::ConFrameWriter;
+    ///
+    /// let view = FrameView {
+    ///     prebox_header: ["", ""],
+    ///     boxl: [10.0; 3],
+    ///     angles: [90.0; 3],
+    ///     postbox_header: ["", ""],
+    ///     symbols: &["Cu"],
+    ///     natms_per_type: &[2],
+    ///     masses_per_type: &[63.546],
+    ///     positions: &[[0.0; 3], [1.0; 3]],
+    ///     velocities: None,
+    ///     atom_ids: &[0, 1],
+    ///     fixed: None,
+    /// };
+    /// let mut out = Vec::new();
+    /// ConFrameWriter::new(&mut out).write_view(&view).unwrap();
+    /// ```
+    pub fn write_view(&mut self, view: &FrameView<'_>) -> io::Result<()> {
+        if !view.is_consistent() {
+            return Err(io::Error::new(
+                io::ErrorKind::InvalidInput,
+                "frame view arrays do not match its component counts",
+            ));
         }
+        self.buf.clear();
+        serialize_view(&mut self.buf, view, self.precision, self.coordinate_width);
+        emit_frame(&mut self.writer, &mut self.compressor, &self.buf)
+    }
 
-        Ok(())
+    /// Flushes buffered output to the underlying writer. Compressed output
+    /// closes the current frame group first.
+    pub fn flush(&mut self) -> io::Result<()> {
+        if let Some(c) = &mut self.compressor {
+            c.flush_group(&mut self.writer)?;
+        }
+        self.writer.flush()
+    }
+
+    /// Flushes, and completes compressed output with its last group and seek
+    /// table. Nothing can be written afterwards. Equivalent to `flush` for
+    /// plain output.
+    pub fn finish(&mut self) -> io::Result<()> {
+        if let Some(c) = &mut self.compressor {
+            c.finish(&mut self.writer)?;
+        }
+        self.writer.flush()
     }
 
     /// Writes all frames from an iterator to the output stream.
     ///
     /// This is the most convenient way to write a multi-frame file.
+    /// With `with_parallel`, frames are serialized on the writer's pool in
+    /// bounded batches and written in order.
     pub fn extend<'a>(&mut self, frames: impl Iterator<Item = &'a ConFrame>) -> io::Result<()> {
+        #[cfg(feature = "parallel")]
+        if self.parallel.is_some() {
+            return self.extend_parallel(frames);
+        }
         for frame in frames {
             self.write_frame(frame)?;
         }
         Ok(())
     }
+
+    #[cfg(feature = "parallel")]
+    fn extend_parallel<'a>(
+        &mut self,
+        mut frames: impl Iterator<Item = &'a ConFrame>,
+    ) -> io::Result<()> {
+        use rayon::prelude::*;
+
+        let prec = self.precision;
+        let coord_width = self.coordinate_width;
+        let Some(par) = self.parallel.as_mut() else {
+            return Ok(());
+        };
+        let mut batch: Vec<&ConFrame> = Vec::new();
+        let mut pending = frames.next();
+        while let Some(first) = pending {
+            batch.clear();
+            let mut budget = estimated_frame_len(first, prec);
+            batch.push(first);
+            pending = frames.next();
+            while let Some(frame) = pending {
+                let len = estimated_frame_len(frame, prec);
+                if budget + len > par.max_in_flight_bytes {
+                    break;
+                }
+                budget += len;
+                batch.push(frame);
+                pending = frames.next();
+            }
+
+            if par.buffers.len() < batch.len() {
+                par.buffers.resize_with(batch.len(), Vec::new);
+            }
+            let buffers = &mut par.buffers[..batch.len()];
+            par.pool.install(|| {
+                buffers.par_iter_mut().zip(batch.par_iter()).for_each(|(buf, frame)| {
+                    buf.clear();
+                    serialize_frame(buf, frame, prec, coord_width);
+                })
+            });
+            for buf in buffers.iter() {
+                emit_frame(&mut self.writer, &mut self.compressor, buf)?;
+            }
+        }
+        Ok(())
+    }
+}
+
+/// Completes compressed output that was never `finish`ed. Drop cannot return
+/// the error, so a failure is reported on stderr (or as a `tracing` event)
+/// and the output is left truncated; call [`ConFrameWriter::finish`] to
+/// handle it instead.
+impl<W: Write> Drop for ConFrameWriter<W> {
+    fn drop(&mut self) {
+        let Some(c) = &mut self.compressor else {
+            return;
+        };
+        if let Err(e) = c.finish(&mut self.writer).and_then(|()| self.writer.flush()) {
+            #[cfg(feature = "tracing")]
+            tracing::error!("ConFrameWriter could not finish compressed output on drop: {e}");
+            #[cfg(not(feature = "tracing"))]
+            eprintln!("readcon-core: ConFrameWriter could not finish compressed output on drop: {e}");
+        }
+    }
 }
 
 // Implementation block specifically for when the writer is a `File`.
@@ -172,14 +547,296 @@ impl ConFrameWriter<File> {
     /// Creates a new `ConFrameWriter` that writes to a file at the given path.
     ///
     /// This is a convenience function that creates the file and wraps it.
+    /// A `.zst` or `.gz` extension selects compressed output (see
+    /// [`ConFrameWriter::with_compression`]); without the `compression`
+    /// feature such paths fail with `ErrorKind::Unsupported`.
     pub fn from_path<P: AsRef<Path>>(path: P) -> io::Result<Self> {
-        let file = File::create(path)?;
-        Ok(Self::new(file))
+        Self::from_path_with_precision(path, DEFAULT_FLOAT_PRECISION)
     }
 
-    /// Creates a new `ConFrameWriter` that writes to a file with a custom precision.
+    /// Flushes buffered output and waits for the file's data to reach disk
+    /// (`File::sync_data`).
+    pub fn sync_data(&mut self) -> io::Result<()> {
+        self.flush()?;
+        self.writer.get_ref().sync_data()
+    }
+
+    /// Creates a new `ConFrameWriter` that writes to a file with a custom
+    /// precision, compressed according to the extension as in `from_path`.
     pub fn from_path_with_precision<P: AsRef<Path>>(path: P, precision: usize) -> io::Result<Self> {
+        let compression = Compression::from_path(path.as_ref()).check_supported()?;
         let file = File::create(path)?;
-        Ok(Self::with_precision(file, precision))
+        let mut writer = Self::with_precision(file, precision);
+        writer.compressor = GroupCompressor::for_compression(compression);
+        Ok(writer)
+    }
+
+    /// Opens a trajectory for appending, creating it if it does not exist.
+    ///
+    /// Before anything is written, the last frame of an existing file is
+    /// parsed in full, so a restart never appends after a truncated frame.
+    /// A current `<file>.idx` sidecar locates that frame directly;
+    /// otherwise it is found with the header-only boundary scan. A missing
+    /// final newline is added.
+    ///
+    /// # Errors
+    ///
+    /// Returns an `InvalidData` error if the existing contents do not end in
+    /// a complete frame, and `Unsupported` for compressed paths.
+    pub fn from_path_append<P: AsRef<Path>>(path: P) -> io::Result<Self> {
+        Self::from_path_append_with_precision(path, DEFAULT_FLOAT_PRECISION)
+    }
+
+    /// Like [`ConFrameWriter::from_path_append`], with a custom precision.
+    pub fn from_path_append_with_precision<P: AsRef<Path>>(
+        path: P,
+        precision: usize,
+    ) -> io::Result<Self> {
+        let path = path.as_ref();
+        if Compression::from_path(path) != Compression::None {
+            return Err(io::Error::new(
+                io::ErrorKind::Unsupported,
+                "cannot append to a compressed trajectory",
+            ));
+        }
+        let needs_newline = check_tail_frame(path)?;
+        let file = OpenOptions::new().create(true).append(true).open(path)?;
+        let mut writer = Self::with_precision(file, precision);
+        if needs_newline {
+            writer.writer.write_all(b"\n")?;
+        }
+        Ok(writer)
+    }
+}
+
+fn invalid_data(e: impl std::fmt::Display) -> io::Error {
+    io::Error::new(io::ErrorKind::InvalidData, e.to_string())
+}
+
+/// Opens `path` as a frame iterator with an index, preferring a current
+/// sidecar over a fresh scan.
+fn open_indexed(path: &Path) -> io::Result<ConFrameFileIterator> {
+    let mut frames = ConFrameFileIterator::open(path).map_err(invalid_data)?;
+    match FrameIndex::load_sidecar(path)? {
+        Some(index) if frames.index_fits(&index) => frames.set_index(index),
+        _ => {
+            frames.build_index().map_err(invalid_data)?;
+        }
+    }
+    Ok(frames)
+}
+
+/// Verifies that an existing file ends in a complete frame. Returns whether
+/// a newline must be written before appending.
+fn check_tail_frame(path: &Path) -> io::Result<bool> {
+    let len = match std::fs::metadata(path) {
+        Ok(metadata) => metadata.len(),
+        Err(e) if e.kind() == io::ErrorKind::NotFound => return Ok(false),
+        Err(e) => return Err(e),
+    };
+    if len == 0 {
+        return Ok(false);
+    }
+    let mut frames = open_indexed(path)?;
+    let last = match frames.index().map_or(0, FrameIndex::len) {
+        0 => return Err(invalid_data("file contains no complete frame")),
+        n => n - 1,
+    };
+    frames.seek(last).map_err(invalid_data)?;
+    match frames.next() {
+        Some(Ok(_)) => {}
+        Some(Err(e)) => return Err(invalid_data(e)),
+        None => return Err(invalid_data("file contains no complete frame")),
+    }
+    let mut last_byte = [0u8; 1];
+    read_exact_at(&File::open(path)?, &mut last_byte, len - 1)?;
+    Ok(last_byte[0] != b'\n')
+}
+
+#[cfg(unix)]
+fn read_exact_at(file: &File, buf: &mut [u8], offset: u64) -> io::Result<()> {
+    std::os::unix::fs::FileExt::read_exact_at(file, buf, offset)
+}
+
+#[cfg(unix)]
+fn write_all_at(file: &File, buf: &[u8], offset: u64) -> io::Result<()> {
+    std::os::unix::fs::FileExt::write_all_at(file, buf, offset)
+}
+
+#[cfg(windows)]
+fn read_exact_at(file: &File, mut buf: &mut [u8], mut offset: u64) -> io::Result<()> {
+    use std::os::windows::fs::FileExt;
+    while !buf.is_empty() {
+        match file.seek_read(buf, offset)? {
+            0 => return Err(io::ErrorKind::UnexpectedEof.into()),
+            n => {
+                buf = &mut buf[n..];
+                offset += n as u64;
+            }
+        }
+    }
+    Ok(())
+}
+
+#[cfg(windows)]
+fn write_all_at(file: &File, mut buf: &[u8], mut offset: u64) -> io::Result<()> {
+    use std::os::windows::fs::FileExt;
+    while !buf.is_empty() {
+        match file.seek_write(buf, offset)? {
+            0 => return Err(io::ErrorKind::WriteZero.into()),
+            n => {
+                buf = &buf[n..];
+                offset += n as u64;
+            }
+        }
+    }
+    Ok(())
+}
+
+/// Overwrites the coordinates of individual frames in place.
+///
+/// Works on files written with
+/// [`ConFrameWriter::with_coordinate_width`]: as long as every new
+/// coordinate fits the field width, each line keeps its length, so a frame
+/// is rewritten with one positioned write and later frames never move.
+/// Frames are located through the [`FrameIndex`] (loaded from a current
+/// sidecar, or built and saved), the sidecar is re-stamped after every
+/// patch, and only the patched frame is read.
+///
+/// # Example
+/// ```no_run
+/// # use readcon_core::writer::FramePatcher;
+/// let mut patcher = FramePatcher::open("traj.con", 6, 13).unwrap();
+/// patcher.patch_positions(41, &[[0.0, 0.0, 0.0], [1.0, 1.0, 1.0]]).unwrap();
+/// ```
+pub struct FramePatcher {
+    path: PathBuf,
+    file: File,
+    index: FrameIndex,
+    precision: usize,
+    width: usize,
+    text: Vec<u8>,
+    line: Vec<u8>,
+}
+
+impl FramePatcher {
+    /// Opens `path` for patching coordinates written with `precision`
+    /// decimals into fields of `width` bytes.
+    pub fn open<P: AsRef<Path>>(path: P, precision: usize, width: usize) -> io::Result<Self> {
+        let path = path.as_ref();
+        // A sidecar whose offsets do not fit the file is rebuilt, since the
+        // index decides where patches are written.
+        let index = {
+            let mut frames = ConFrameFileIterator::open(path).map_err(invalid_data)?;
+            frames.load_or_build_index().map_err(invalid_data)?.clone()
+        };
+        let file = OpenOptions::new().read(true).write(true).open(path)?;
+        Ok(FramePatcher {
+            path: path.to_path_buf(),
+            file,
+            index,
+            precision,
+            width,
+            text: Vec::new(),
+            line: Vec::new(),
+        })
+    }
+
+    /// Returns the index of the file being patched.
+    pub fn index(&self) -> &FrameIndex {
+        &self.index
+    }
+
+    /// Replaces the coordinates of frame `frame_no`, given in file order.
+    ///
+    /// Flags, ids, headers and velocities are left untouched.
+    ///
+    /// # Errors
+    ///
+    /// Fails without writing anything if the frame does not exist,
+    /// `positions` has the wrong length, or any new line would differ in
+    /// length from the old one (the value does not fit `width`, or the file
+    /// was not written with this precision and width).
+    pub fn patch_positions(&mut self, frame_no: usize, positions: &[[f64; 3]]) -> io::Result<()> {
+        let range = self.index.byte_range(frame_no).ok_or_else(|| {
+            invalid_data(ParseError::FrameOutOfRange {
+                requested: frame_no,
+                available: self.index.len(),
+            })
+        })?;
+        let num_atoms = self.index.get(frame_no).map_or(0, |e| e.num_atoms);
+        if positions.len() != num_atoms {
+            return Err(io::Error::new(
+                io::ErrorKind::InvalidInput,
+                format!("frame {frame_no} has {num_atoms} atoms, got {} positions", positions.len()),
+            ));
+        }
+
+        self.text.resize(range.len(), 0);
+        read_exact_at(&self.file, &mut self.text, range.start as u64)?;
+        let line_spans = coordinate_line_spans(&self.text).map_err(invalid_data)?;
+        if line_spans.len() != num_atoms {
+            return Err(invalid_data(ParseError::IncompleteFrame));
+        }
+
+        for (span, xyz) in line_spans.iter().zip(positions) {
+            let old = &self.text[span.clone()];
+            let rest = after_third_field(old);
+            self.line.clear();
+            for (i, &v) in xyz.iter().enumerate() {
+                if i > 0 {
+                    self.line.push(b' ');
+                }
+                numfmt::push_fixed_padded(&mut self.line, v, self.precision, self.width);
+            }
+            self.line.extend_from_slice(&old[old.len() - rest..]);
+            if self.line.len() != old.len() {
+                return Err(invalid_data(format!(
+                    "new coordinates do not fit the {}-byte fields of frame {frame_no}",
+                    self.width
+                )));
+            }
+            self.text[span.clone()].copy_from_slice(&self.line);
+        }
+
+        write_all_at(&self.file, &self.text, range.start as u64)?;
+        let _ = self.index.save_sidecar(&self.path);
+        Ok(())
+    }
+}
+
+/// Byte ranges of the coordinate lines of the frame at the start of `text`.
+fn coordinate_line_spans(text: &[u8]) -> Result<Vec<std::ops::Range<usize>>, ParseError> {
+    let mut cursor = LineCursor::new(text);
+    let mut header_lines = [""; 9];
+    for line in &mut header_lines {
+        *line = cursor.next_str_line().ok_or(ParseError::IncompleteHeader)??;
+    }
+    let header = parse_frame_header_ref(&mut header_lines.into_iter())?;
+    let mut spans = Vec::with_capacity(header.total_atoms());
+    for &count in header.natms_per_type.iter() {
+        if !cursor.skip_lines(2) {
+            return Err(ParseError::IncompleteFrame);
+        }
+        for _ in 0..count {
+            let start = cursor.pos;
+            let line = cursor.next_line().ok_or(ParseError::IncompleteFrame)?;
+            spans.push(start..start + line.len());
+        }
+    }
+    Ok(spans)
+}
+
+/// Length of the tail of an atom line that follows its third field.
+fn after_third_field(line: &[u8]) -> usize {
+    let mut pos = 0;
+    for _ in 0..3 {
+        while pos < line.len() && line[pos].is_ascii_whitespace() {
+            pos += 1;
+        }
+        while pos < line.len() && !line[pos].is_ascii_whitespace() {
+            pos += 1;
+        }
     }
+    line.len() - pos
 }
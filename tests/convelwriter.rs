@@ -66,3 +66,50 @@ fn test_convel_multi_writer_roundtrip() {
         assert_eq!(orig, round);
     }
 }
+
+#[test]
+fn test_write_view_matches_write_frame() {
+    use readcon_core::types::FrameView;
+
+    let fdat = fs::read_to_string(test_case!("tiny_cuh2.convel")).unwrap();
+    let frame = ConFrameIterator::new(&fdat).next().unwrap().unwrap();
+    let mut expected = Vec::new();
+    ConFrameWriter::new(&mut expected).write_frame(&frame).unwrap();
+
+    let atoms = &frame.atom_data;
+    let header = &frame.header;
+    let mut symbols = Vec::new();
+    let mut offset = 0;
+    for &n in &header.natms_per_type {
+        symbols.push(atoms[offset].symbol.as_str());
+        offset += n;
+    }
+    let positions: Vec<[f64; 3]> = atoms.iter().map(|a| [a.x, a.y, a.z]).collect();
+    let velocities: Vec<[f64; 3]> = atoms
+        .iter()
+        .map(|a| [a.vx.unwrap(), a.vy.unwrap(), a.vz.unwrap()])
+        .collect();
+    let ids: Vec<u64> = atoms.iter().map(|a| a.atom_id).collect();
+    let fixed: Vec<bool> = atoms.iter().map(|a| a.is_fixed).collect();
+    let mut view = FrameView {
+        prebox_header: [&header.prebox_header[0], &header.prebox_header[1]],
+        boxl: header.boxl,
+        angles: header.angles,
+        postbox_header: [&header.postbox_header[0], &header.postbox_header[1]],
+        symbols: &symbols,
+        natms_per_type: &header.natms_per_type,
+        masses_per_type: &header.masses_per_type,
+        positions: &positions,
+        velocities: Some(&velocities),
+        atom_ids: &ids,
+        fixed: Some(&fixed),
+    };
+
+    let mut written = Vec::new();
+    ConFrameWriter::new(&mut written).write_view(&view).unwrap();
+    assert_eq!(written, expected);
+
+    view.atom_ids = &ids[1..];
+    let err = ConFrameWriter::new(Vec::new()).write_view(&view).unwrap_err();
+    assert_eq!(err.kind(), std::io::ErrorKind::InvalidInput);
+}
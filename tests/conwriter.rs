@@ -129,3 +129,333 @@ fn test_builder_velocity_roundtrip() {
     assert_eq!(frames[0].atom_data[0].vx, Some(0.1));
     assert_eq!(frames[0].atom_data[1].vz, Some(0.6));
 }
+
+/// Reference serialization through `format!`, matching the writer's
+/// historical `writeln!`-based output.
+fn format_reference(frame: &readcon_core::types::ConFrame, prec: usize) -> String {
+    let h = &frame.header;
+    let join_f = |v: &[f64]| {
+        v.iter()
+            .map(|x| format!("{x:.prec$}"))
+            .collect::<Vec<_>>()
+            .join(" ")
+    };
+    let mut out = String::new();
+    out += &format!("{}\n{}\n", h.prebox_header[0], h.prebox_header[1]);
+    out += &format!("{}\n{}\n", join_f(&h.boxl), join_f(&h.angles));
+    out += &format!("{}\n{}\n", h.postbox_header[0], h.postbox_header[1]);
+    out += &format!("{}\n", h.natm_types);
+    let natms: Vec<String> = h.natms_per_type.iter().map(|n| n.to_string()).collect();
+    out += &format!("{}\n{}\n", natms.join(" "), join_f(&h.masses_per_type));
+    let mut offset = 0;
+    for (k, &n) in h.natms_per_type.iter().enumerate() {
+        out += &format!("{}\nCoordinates of Component {}\n", frame.atom_data[offset].symbol, k + 1);
+        for a in &frame.atom_data[offset..offset + n] {
+            out += &format!(
+                "{:.prec$} {:.prec$} {:.prec$} {} {}\n",
+                a.x, a.y, a.z, a.is_fixed as u8, a.atom_id
+            );
+        }
+        offset += n;
+    }
+    out
+}
+
+#[test]
+fn test_writer_output_matches_fmt_reference() {
+    let fdat = fs::read_to_string(test_case!("tiny_multi_cuh2.con")).expect("Can't find test file.");
+    let mut frames: Vec<_> = ConFrameIterator::new(&fdat).map(|r| r.unwrap()).collect();
+    // Exercise rounding, negative zero and large magnitudes as well.
+    let extra = [-0.0, -1e-9, 0.5, 2.5, 0.125, -123456.7890125, 1e16];
+    for (atom, &v) in frames[0].atom_data.iter_mut().zip(extra.iter()) {
+        atom.y = v;
+    }
+
+    for prec in [0, 1, 3, 6, 12, 17, 20] {
+        let mut buffer: Vec<u8> = Vec::new();
+        {
+            let mut writer = ConFrameWriter::with_precision(&mut buffer, prec);
+            writer.extend(frames.iter()).unwrap();
+        }
+        let expected: String = frames.iter().map(|f| format_reference(f, prec)).collect();
+        assert_eq!(String::from_utf8(buffer).unwrap(), expected, "precision {prec}");
+    }
+}
+
+#[cfg(feature = "parallel")]
+#[test]
+fn test_parallel_extend_matches_serial() {
+    let fdat = fs::read_to_string(test_case!("tiny_multi_cuh2.con")).expect("Can't find test file.");
+    let one: Vec<_> = ConFrameIterator::new(&fdat).map(|r| r.unwrap()).collect();
+    let frames: Vec<_> = one.iter().cycle().take(200).cloned().collect();
+
+    let mut serial: Vec<u8> = Vec::new();
+    {
+        let mut writer = ConFrameWriter::new(&mut serial);
+        writer.extend(frames.iter()).unwrap();
+    }
+    // A tiny budget forces many batches, including single-frame ones.
+    for (threads, budget) in [(0, 0), (3, 1), (4, 4096)] {
+        let mut parallel: Vec<u8> = Vec::new();
+        {
+            let mut writer = ConFrameWriter::new(&mut parallel)
+                .with_parallel(threads, budget)
+                .unwrap();
+            writer.extend(frames.iter()).unwrap();
+            writer.extend(frames[..3].iter()).unwrap();
+        }
+        let mut expected = serial.clone();
+        {
+            let mut writer = ConFrameWriter::new(&mut expected);
+            writer.extend(frames[..3].iter()).unwrap();
+        }
+        assert_eq!(parallel, expected, "threads={threads} budget={budget}");
+    }
+}
+
+#[test]
+fn test_async_writer_matches_sync_writer() {
+    use readcon_core::async_writer::{AsyncConFrameWriter, AsyncWriterOptions, FsyncPolicy};
+
+    let fdat = fs::read_to_string(test_case!("tiny_multi_cuh2.con")).expect("Can't find test file.");
+    let frames: Vec<_> = ConFrameIterator::new(&fdat).map(|r| r.unwrap()).collect();
+    let dir = std::env::temp_dir();
+    let sync_path = dir.join(format!("readcon-async-sync-{}.con", std::process::id()));
+    let async_path = dir.join(format!("readcon-async-{}.con", std::process::id()));
+
+    ConFrameWriter::from_path(&sync_path)
+        .unwrap()
+        .extend(frames.iter())
+        .unwrap();
+
+    let options = AsyncWriterOptions {
+        queue_capacity: 1,
+        fsync: FsyncPolicy::EveryNFrames(2),
+        ..Default::default()
+    };
+    let writer = AsyncConFrameWriter::from_path(&async_path, options).unwrap();
+    for frame in frames.iter().cloned() {
+        writer.push(frame).unwrap();
+    }
+    // flush() guarantees everything pushed so far is in the file.
+    writer.flush().unwrap();
+    assert_eq!(fs::read(&async_path).unwrap(), fs::read(&sync_path).unwrap());
+    writer.close().unwrap();
+
+    let _ = fs::remove_file(&sync_path);
+    let _ = fs::remove_file(&async_path);
+}
+
+#[test]
+fn test_async_writer_reject_returns_frame() {
+    use readcon_core::async_writer::{
+        AsyncConFrameWriter, AsyncWriterOptions, Backpressure, PushError,
+    };
+
+    let fdat = fs::read_to_string(test_case!("tiny_cuh2.con")).expect("Can't find test file.");
+    let frame = ConFrameIterator::new(&fdat).next().unwrap().unwrap();
+    let path = std::env::temp_dir().join(format!("readcon-async-reject-{}.con", std::process::id()));
+    let options = AsyncWriterOptions {
+        queue_capacity: 1,
+        backpressure: Backpressure::Reject,
+        ..Default::default()
+    };
+    let writer = AsyncConFrameWriter::from_path(&path, options).unwrap();
+    let mut written = 0;
+    for _ in 0..1000 {
+        match writer.push(frame.clone()) {
+            Ok(()) => written += 1,
+            Err(PushError::Full(rejected)) => assert_eq!(rejected, frame),
+            Err(PushError::Closed(_)) => panic!("writer thread stopped"),
+        }
+    }
+    writer.close().unwrap();
+
+    let text = fs::read_to_string(&path).unwrap();
+    assert_eq!(ConFrameIterator::new(&text).count(), written);
+    let _ = fs::remove_file(&path);
+}
+
+#[test]
+fn test_append_mode_extends_trajectory() {
+    let fdat = fs::read_to_string(test_case!("tiny_multi_cuh2.con")).expect("Can't find test file.");
+    let frames: Vec<_> = ConFrameIterator::new(&fdat).map(|r| r.unwrap()).collect();
+    let path = std::env::temp_dir().join(format!("readcon-append-{}.con", std::process::id()));
+
+    ConFrameWriter::from_path(&path)
+        .unwrap()
+        .extend(frames[..1].iter())
+        .unwrap();
+    // Drop the final newline; append mode must restore it.
+    let first = fs::read(&path).unwrap();
+    fs::write(&path, &first[..first.len() - 1]).unwrap();
+    ConFrameWriter::from_path_append(&path)
+        .unwrap()
+        .extend(frames[1..].iter())
+        .unwrap();
+
+    let mut expected: Vec<u8> = Vec::new();
+    ConFrameWriter::new(&mut expected).extend(frames.iter()).unwrap();
+    assert_eq!(fs::read(&path).unwrap(), expected);
+
+    // A truncated tail frame is refused and the file is left alone.
+    fs::write(&path, &expected[..expected.len() - 20]).unwrap();
+    let err = ConFrameWriter::from_path_append(&path).err().unwrap();
+    assert_eq!(err.kind(), std::io::ErrorKind::InvalidData);
+    assert_eq!(fs::read(&path).unwrap().len(), expected.len() - 20);
+
+    let _ = fs::remove_file(&path);
+}
+
+#[test]
+fn test_patch_positions_in_place() {
+    use readcon_core::index::FrameIndex;
+    use readcon_core::writer::FramePatcher;
+
+    let fdat = fs::read_to_string(test_case!("tiny_multi_cuh2.con")).expect("Can't find test file.");
+    let frames: Vec<_> = ConFrameIterator::new(&fdat).map(|r| r.unwrap()).collect();
+    let path = std::env::temp_dir().join(format!("readcon-patch-{}.con", std::process::id()));
+    let idx = FrameIndex::sidecar_path(&path);
+    let width = 6 + 7;
+    ConFrameWriter::from_path(&path)
+        .unwrap()
+        .with_coordinate_width(width)
+        .extend(frames.iter())
+        .unwrap();
+    let before = fs::read(&path).unwrap();
+
+    // A sidecar with a current stamp but another layout's offsets is
+    // rebuilt rather than trusted.
+    let mut narrow = Vec::new();
+    ConFrameWriter::new(&mut narrow).extend(frames.iter()).unwrap();
+    let stale = FrameIndex::build_from_bytes(&narrow).unwrap();
+    assert!(!stale.fits(&before));
+    stale.save_sidecar(&path).unwrap();
+    let patcher = FramePatcher::open(&path, 6, width).unwrap();
+    assert_eq!(patcher.index(), &FrameIndex::build_from_bytes(&before).unwrap());
+    drop(patcher);
+
+    let new_positions: Vec<[f64; 3]> = frames[1]
+        .atom_data
+        .iter()
+        .map(|a| [-a.x - 1.5, a.y * 2.0, 1234.5])
+        .collect();
+    let mut patcher = FramePatcher::open(&path, 6, width).unwrap();
+    patcher.patch_positions(1, &new_positions).unwrap();
+
+    let after = fs::read(&path).unwrap();
+    assert_eq!(after.len(), before.len());
+    let text = String::from_utf8(after).unwrap();
+    let patched: Vec<_> = ConFrameIterator::new(&text).map(|r| r.unwrap()).collect();
+    assert_eq!(patched[0], frames[0]);
+    for (atom, xyz) in patched[1].atom_data.iter().zip(&new_positions) {
+        assert!((atom.x - xyz[0]).abs() < 1e-6);
+        assert!((atom.y - xyz[1]).abs() < 1e-6);
+        assert_eq!(atom.z, xyz[2]);
+    }
+
+    // A value too wide for the field is rejected without touching the file.
+    let mut too_wide = new_positions.clone();
+    too_wide[0][0] = 1e12;
+    assert!(patcher.patch_positions(1, &too_wide).is_err());
+    assert_eq!(fs::read_to_string(&path).unwrap(), text);
+
+    let _ = fs::remove_file(&path);
+    let _ = fs::remove_file(&idx);
+}
+
+#[test]
+fn test_conb_roundtrip_reproduces_text() {
+    use readcon_core::conb::ConbWriter;
+    use readcon_core::iterators::{ConFrameFileIterator, read_all_frames};
+
+    for name in ["tiny_multi_cuh2.convel", "cuh2.con"] {
+        let fdat = fs::read_to_string(test_case!(name)).expect("Can't find test file.");
+        let frames: Vec<_> = ConFrameIterator::new(&fdat).map(|r| r.unwrap()).collect();
+        let path = std::env::temp_dir().join(format!("readcon-{name}-{}.conb", std::process::id()));
+        let mut writer = ConbWriter::from_path(&path).unwrap();
+        writer.extend(frames.iter()).unwrap();
+        writer.finish().unwrap();
+
+        let decoded = read_all_frames(&path).unwrap();
+        assert_eq!(decoded, frames);
+        let mut iter = ConFrameFileIterator::open(&path).unwrap();
+        assert_eq!(iter.len().unwrap(), frames.len());
+        iter.seek(frames.len() - 1).unwrap();
+        assert_eq!(iter.next().unwrap().unwrap(), frames[frames.len() - 1]);
+        assert!(iter.next().is_none());
+
+        for prec in [3, 6, 12] {
+            let mut expected: Vec<u8> = Vec::new();
+            ConFrameWriter::with_precision(&mut expected, prec)
+                .extend(frames.iter())
+                .unwrap();
+            let mut actual: Vec<u8> = Vec::new();
+            ConFrameWriter::with_precision(&mut actual, prec)
+                .extend(decoded.iter())
+                .unwrap();
+            assert_eq!(actual, expected, "{name} at precision {prec}");
+        }
+        let _ = fs::remove_file(&path);
+    }
+}
+
+#[cfg(feature = "compression")]
+#[test]
+fn test_compressed_roundtrip_and_seek() {
+    use readcon_core::iterators::{ConFrameFileIterator, read_all_frames, read_first_frame};
+
+    let fdat = fs::read_to_string(test_case!("cuh2.con")).expect("Can't find test file.");
+    let frame = ConFrameIterator::new(&fdat).next().unwrap().unwrap();
+    // Enough text for several 1 MiB compression groups.
+    let frames: Vec<_> = (0..150)
+        .map(|i| {
+            let mut f = frame.clone();
+            f.atom_data[0].x = i as f64;
+            f
+        })
+        .collect();
+
+    // Compare against what the plain text writer round-trips to.
+    let mut plain: Vec<u8> = Vec::new();
+    ConFrameWriter::new(&mut plain).extend(frames.iter()).unwrap();
+    let plain_text = String::from_utf8(plain).unwrap();
+    let frames: Vec<_> = ConFrameIterator::new(&plain_text).map(|r| r.unwrap()).collect();
+
+    for ext in ["zst", "gz"] {
+        let path = std::env::temp_dir().join(format!("readcon-compressed-{}.con.{ext}", std::process::id()));
+        let mut writer = ConFrameWriter::from_path(&path).unwrap();
+        writer.extend(frames.iter()).unwrap();
+        writer.finish().unwrap();
+        drop(writer);
+        assert!(fs::metadata(&path).unwrap().len() * 4 < plain_text.len() as u64);
+
+
+        assert_eq!(read_all_frames(&path).unwrap(), frames);
+        assert_eq!(read_first_frame(&path).unwrap(), frames[0]);
+        #[cfg(feature = "parallel")]
+        assert_eq!(
+            readcon_core::iterators::read_all_frames_parallel(&path, 2).unwrap(),
+            frames
+        );
+
+        let mut iter = ConFrameFileIterator::open(&path).unwrap();
+        assert_eq!(iter.is_seekable_compressed(), ext == "zst");
+        assert_eq!(iter.len().unwrap(), frames.len());
+        iter.seek(100).unwrap();
+        assert_eq!(iter.next().unwrap().unwrap(), frames[100]);
+        iter.seek(frames.len()).unwrap();
+        assert!(iter.next().is_none());
+        iter.seek(0).unwrap();
+        assert_eq!(iter.count(), frames.len());
+
+        let mut iter = ConFrameFileIterator::open(&path).unwrap();
+        assert_eq!(iter.build_index().unwrap().len(), frames.len());
+
+        assert_eq!(
+            ConFrameWriter::from_path_append(&path).err().unwrap().kind(),
+            std::io::ErrorKind::Unsupported
+        );
+        let _ = fs::remove_file(&path);
+    }
+}
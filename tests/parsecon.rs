@@ -182,3 +182,96 @@ fn test_read_all_frames_matches_iterator() {
     assert_eq!(frames[0].atom_data.len(), 4);
     assert_eq!(frames[1].atom_data.len(), 4);
 }
+
+#[test]
+fn test_iterator_seek_and_len() {
+    let fdat = fs::read_to_string(test_case!("tiny_multi_cuh2.con")).expect("Can't find test.");
+    let frames: Vec<_> = ConFrameIterator::new(&fdat)
+        .map(|r| r.expect("Failed to parse a frame"))
+        .collect();
+
+    let mut parser = ConFrameIterator::new(&fdat);
+    assert_eq!(parser.len().unwrap(), 2);
+
+    parser.seek(1).expect("seek to the last frame should succeed");
+    assert_eq!(parser.next().unwrap().unwrap(), frames[1]);
+    assert!(parser.next().is_none());
+
+    parser.seek(0).expect("seek back to the start should succeed");
+    assert_eq!(parser.next().unwrap().unwrap(), frames[0]);
+
+    parser.seek(2).expect("seek to len() should position at the end");
+    assert!(parser.next().is_none());
+    assert!(parser.seek(3).is_err());
+}
+
+#[cfg(feature = "parallel")]
+#[test]
+fn test_parallel_matches_sequential() {
+    for name in ["tiny_multi_cuh2.con", "tiny_multi_cuh2.convel"] {
+        let fdat = fs::read_to_string(test_case!(name)).expect("Can't find test.");
+        let sequential: Vec<_> = ConFrameIterator::new(&fdat)
+            .map(|r| r.expect("Failed to parse a frame"))
+            .collect();
+        let parallel: Vec<_> = iterators::parse_frames_parallel(&fdat)
+            .into_iter()
+            .map(|r| r.expect("Failed to parse a frame in parallel"))
+            .collect();
+        assert_eq!(parallel, sequential);
+    }
+}
+
+#[cfg(feature = "parallel")]
+#[test]
+fn test_read_all_frames_parallel_bounded_pool() {
+    let path = test_case!("tiny_multi_cuh2.con");
+    let serial = iterators::read_all_frames(&path).expect("read_all_frames should succeed");
+    for n_threads in [0, 1, 2] {
+        let frames = iterators::read_all_frames_parallel(&path, n_threads)
+            .expect("read_all_frames_parallel should succeed");
+        assert_eq!(frames, serial);
+    }
+}
+
+#[test]
+fn test_stream_reader_matches_iterator() {
+    use readcon_core::iterators::ConFrameStreamReader;
+    use std::io::BufReader;
+
+    for name in [
+        "cuh2.con",
+        "sulfolene.con",
+        "tiny_multi_cuh2.con",
+        "tiny_multi_cuh2.convel",
+    ] {
+        let fdat = fs::read_to_string(test_case!(name)).expect("Can't find test.");
+        let expected: Vec<_> = ConFrameIterator::new(&fdat)
+            .map(|r| r.expect("Failed to parse a frame"))
+            .collect();
+        // A tiny buffer forces lines to straddle refills.
+        let reader = BufReader::with_capacity(7, fdat.as_bytes());
+        let streamed: Vec<_> = ConFrameStreamReader::new(reader)
+            .map(|r| r.expect("Failed to stream a frame"))
+            .collect();
+        assert_eq!(streamed, expected, "{name}");
+    }
+
+    let fdat = fs::read_to_string(test_case!("tiny_multi_cuh2.con")).expect("Can't find test.");
+    let truncated = &fdat[..fdat.len() - 20];
+    let results: Vec<_> = ConFrameStreamReader::new(truncated.as_bytes()).collect();
+    assert_eq!(results.len(), 2);
+    assert!(results[0].is_ok());
+    assert!(results[1].is_err());
+}
+
+#[test]
+fn test_component_runs() {
+    let fdat = fs::read_to_string(test_case!("tiny_cuh2.con")).expect("Can't find test.");
+    let frame = ConFrameIterator::new(&fdat).next().unwrap().unwrap();
+    let runs = frame.components();
+    assert_eq!(runs.len(), 2);
+    assert_eq!((runs[0].atomic_number, runs[0].offset, runs[0].count), (29, 0, 2));
+    assert_eq!((runs[1].atomic_number, runs[1].offset, runs[1].count), (1, 2, 2));
+    assert_eq!(runs[0].mass, 63.546);
+    assert_eq!(runs[1].mass, 1.00793);
+}
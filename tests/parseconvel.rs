@@ -1,5 +1,8 @@
 mod common;
-use readcon_core::iterators::ConFrameIterator;
+use readcon_core::conb::ConbWriter;
+use readcon_core::iterators::{ConFrameFileIterator, ConFrameIterator};
+use readcon_core::parser::ParseOptions;
+use readcon_core::types::ConFrame;
 use std::fs;
 use std::path::Path;
 
@@ -113,3 +116,225 @@ fn test_convel_forward_skip() {
     // No more frames
     assert!(parser.next().is_none());
 }
+
+#[test]
+fn test_convel_soa_matches_aos() {
+    let fdat = fs::read_to_string(test_case!("tiny_multi_cuh2.convel"))
+        .expect("Can't find convel test file.");
+    let frames: Vec<_> = ConFrameIterator::new(&fdat)
+        .map(|r| r.expect("Failed to parse convel frame"))
+        .collect();
+
+    let mut soa_iter = ConFrameIterator::new(&fdat);
+    for frame in &frames {
+        let soa = soa_iter
+            .next_soa()
+            .expect("SoA iterator ended early")
+            .expect("Failed to parse convel frame as SoA");
+        assert!(soa.has_velocities());
+        assert_eq!(soa.len(), frame.atom_data.len());
+        assert_eq!(soa.columns.vx[0], frame.atom_data[0].vx.unwrap());
+        assert_eq!(&ConFrame::from(soa), frame);
+    }
+    assert!(soa_iter.next_soa().is_none());
+}
+
+#[test]
+fn test_file_iterator_matches_in_memory() {
+    // Repeat the trajectory past the 64 KiB mmap threshold.
+    let fdat = fs::read_to_string(test_case!("tiny_multi_cuh2.convel")).expect("Can't find test.");
+    let big = fdat.repeat(64 * 1024 / fdat.len() + 1);
+    let dir = std::env::temp_dir().join(format!("readcon-fileiter-{}", std::process::id()));
+    fs::create_dir_all(&dir).unwrap();
+    let path = dir.join("big.convel");
+    fs::write(&path, &big).unwrap();
+
+    let expected: Vec<_> = ConFrameIterator::new(&big).map(|r| r.unwrap()).collect();
+    let mut file_iter = ConFrameFileIterator::open(&path).expect("open should succeed");
+    assert_eq!(file_iter.len().unwrap(), expected.len());
+    let frames: Vec<_> = file_iter.by_ref().map(|r| r.unwrap()).collect();
+    assert_eq!(frames, expected);
+
+    file_iter.seek(expected.len() - 1).unwrap();
+    assert_eq!(file_iter.next().unwrap().unwrap(), expected[expected.len() - 1]);
+    assert!(file_iter.next().is_none());
+
+    // A truncated final frame surfaces as an error, after the good frames.
+    fs::write(&path, &big[..big.len() - 10]).unwrap();
+    let results: Vec<_> = ConFrameFileIterator::open(&path).unwrap().collect();
+    assert_eq!(results.len(), expected.len());
+    assert!(results.last().unwrap().is_err());
+
+    fs::remove_dir_all(&dir).unwrap();
+}
+
+#[test]
+fn test_next_into_matches_next() {
+    // Mix a velocity-free frame between .convel frames so stale
+    // velocities would be caught.
+    let convel = fs::read_to_string(test_case!("tiny_multi_cuh2.convel")).expect("Can't find test.");
+    let con = fs::read_to_string(test_case!("tiny_cuh2.con")).expect("Can't find test.");
+    let fdat = format!("{convel}{con}{convel}");
+    let expected: Vec<ConFrame> = ConFrameIterator::new(&fdat).map(|r| r.unwrap()).collect();
+
+    let mut iter = ConFrameIterator::new(&fdat);
+    let mut frame = iter.next().unwrap().unwrap();
+    assert_eq!(frame, expected[0]);
+    for want in &expected[1..] {
+        iter.next_into(&mut frame).unwrap().unwrap();
+        assert_eq!(&frame, want);
+    }
+    assert!(iter.next_into(&mut frame).is_none());
+}
+
+#[test]
+fn test_parse_options_project_frames() {
+    let fdat = fs::read_to_string(test_case!("tiny_multi_cuh2.convel")).expect("Can't find test.");
+    let full: Vec<ConFrame> = ConFrameIterator::new(&fdat).map(|r| r.unwrap()).collect();
+    let project = |options: ParseOptions| -> Vec<ConFrame> {
+        ConFrameIterator::with_options(&fdat, options)
+            .map(|r| r.unwrap())
+            .collect()
+    };
+
+    let no_vel = project(ParseOptions {
+        skip_velocities: true,
+        ..Default::default()
+    });
+    assert_eq!(no_vel.len(), full.len());
+    assert!(no_vel.iter().all(|f| !f.has_velocities()));
+    assert_eq!(no_vel[1].atom_data[2].x, full[1].atom_data[2].x);
+
+    let headers = project(ParseOptions {
+        header_only: true,
+        ..Default::default()
+    });
+    assert_eq!(headers.len(), full.len());
+    assert!(headers[0].atom_data.is_empty());
+    assert_eq!(headers[0].header, full[0].header);
+
+    // Keep Cu atoms with ids in 1..3: only atom 1 survives, velocities intact.
+    let filtered = project(ParseOptions {
+        components: vec!["Cu".to_string()],
+        atom_ids: Some(1..3),
+        ..Default::default()
+    });
+    for (frame, want) in filtered.iter().zip(&full) {
+        assert_eq!(frame.header.natm_types, 1);
+        assert_eq!(frame.header.natms_per_type, vec![1]);
+        assert_eq!(frame.header.masses_per_type, vec![want.header.masses_per_type[0]]);
+        assert_eq!(frame.atom_data, vec![want.atom_data[1].clone()]);
+    }
+
+    // The file iterator applies the same projection, for text and .conb.
+    let dir = std::env::temp_dir().join(format!("readcon-options-{}", std::process::id()));
+    fs::create_dir_all(&dir).unwrap();
+    let text_path = dir.join("traj.convel");
+    fs::write(&text_path, &fdat).unwrap();
+    let conb_path = dir.join("traj.conb");
+    let mut conb = ConbWriter::from_path(&conb_path).unwrap();
+    conb.extend(full.iter()).unwrap();
+    conb.finish().unwrap();
+    for path in [&text_path, &conb_path] {
+        let mut iter = ConFrameFileIterator::open(path).unwrap();
+        iter.set_options(ParseOptions {
+            components: vec!["Cu".to_string()],
+            atom_ids: Some(1..3),
+            ..Default::default()
+        });
+        let frames: Vec<_> = iter.map(|r| r.unwrap()).collect();
+        assert_eq!(frames, filtered);
+    }
+    fs::remove_dir_all(&dir).unwrap();
+}
+
+#[test]
+fn test_read_trajectory_shares_topology() {
+    use readcon_core::iterators::read_all_frames;
+    use readcon_core::trajectory::read_trajectory;
+
+    let text_path = test_case!("tiny_multi_cuh2.convel");
+    let frames = read_all_frames(&text_path).unwrap();
+    let conb_path =
+        std::env::temp_dir().join(format!("readcon-trajectory-{}.conb", std::process::id()));
+    let mut conb = ConbWriter::from_path(&conb_path).unwrap();
+    conb.extend(frames.iter()).unwrap();
+    conb.finish().unwrap();
+
+    for path in [&text_path, &conb_path] {
+        let trajectory = read_trajectory(path).unwrap();
+        assert_eq!(trajectory.len(), frames.len());
+        assert_eq!(trajectory.num_topologies(), 1);
+        assert_eq!(trajectory.to_frames(), frames);
+    }
+    fs::remove_file(&conb_path).unwrap();
+}
+
+#[test]
+fn test_for_each_frame_hands_frames_to_workers() {
+    use readcon_core::iterators::{for_each_frame, read_all_frames};
+    use std::ops::ControlFlow;
+    use std::sync::Mutex;
+
+    fn assert_send_sync<T: Send + Sync>() {}
+    assert_send_sync::<ConFrame>();
+    assert_send_sync::<readcon_core::trajectory::Trajectory>();
+
+    let text_path = test_case!("tiny_multi_cuh2.convel");
+    let frames = read_all_frames(&text_path).unwrap();
+    let conb_path =
+        std::env::temp_dir().join(format!("readcon-for-each-{}.conb", std::process::id()));
+    let mut conb = ConbWriter::from_path(&conb_path).unwrap();
+    conb.extend(frames.iter()).unwrap();
+    conb.finish().unwrap();
+
+    for path in [&text_path, &conb_path] {
+        let seen = Mutex::new(Vec::new());
+        let flow = for_each_frame(path, 2, |frame_no, frame| {
+            seen.lock().unwrap().push((frame_no, frame));
+            ControlFlow::Continue(())
+        })
+        .unwrap();
+        assert_eq!(flow, ControlFlow::Continue(()));
+        let mut seen = seen.into_inner().unwrap();
+        seen.sort_by_key(|(frame_no, _)| *frame_no);
+        let delivered: Vec<ConFrame> = seen.into_iter().map(|(_, frame)| frame).collect();
+        assert_eq!(delivered, frames);
+
+        let flow = for_each_frame(path, 1, |_, _| ControlFlow::Break(())).unwrap();
+        assert_eq!(flow, ControlFlow::Break(()));
+    }
+    fs::remove_file(&conb_path).unwrap();
+    assert!(for_each_frame(Path::new("/nonexistent.con"), 1, |_, _| ControlFlow::Continue(())).is_err());
+}
+
+#[cfg(feature = "instrumentation")]
+#[test]
+fn test_instrumentation_counts_stages() {
+    use readcon_core::stats::{self, Stage};
+    use readcon_core::writer::ConFrameWriter;
+
+    // Other tests in this binary also parse, so only lower bounds hold.
+    let fdat = fs::read_to_string(test_case!("tiny_multi_cuh2.convel")).unwrap();
+    let before = stats::snapshot();
+    let frames: Vec<ConFrame> = ConFrameIterator::new(&fdat).map(|r| r.unwrap()).collect();
+    let mut out = Vec::new();
+    ConFrameWriter::new(&mut out).extend(frames.iter()).unwrap();
+    let after = stats::snapshot();
+
+    assert!(stats::enabled());
+    assert!(after.frames_parsed - before.frames_parsed >= frames.len() as u64);
+    assert!(after.atoms_parsed - before.atoms_parsed >= 8);
+    assert!(after.bytes_scanned - before.bytes_scanned >= fdat.trim_end().len() as u64);
+    assert!(after.frames_written - before.frames_written >= frames.len() as u64);
+    assert!(after.bytes_written - before.bytes_written >= out.len() as u64);
+    for stage in [
+        Stage::ParseFrameHeader,
+        Stage::ParseSingleFrame,
+        Stage::ParseVelocitySection,
+        Stage::WriteFrame,
+    ] {
+        let calls = after.stage(stage).calls - before.stage(stage).calls;
+        assert!(calls >= frames.len() as u64, "{}", stage.name());
+    }
+}
@@ -226,3 +226,108 @@ class TestErrorHandling:
     def test_malformed_data(self):
         with pytest.raises(OSError):
             readcon.read_con_string("not a valid con file\n")
+
+
+class TestArrays:
+    def test_frame_arrays(self):
+        np = pytest.importorskip("numpy")
+        frame = readcon.read_con(_resource("tiny_cuh2.convel"))[0]
+        positions = frame.positions
+        assert positions.shape == (4, 3)
+        assert positions.dtype == np.float64
+        assert positions[0, 0] == pytest.approx(frame.atoms[0].x)
+        assert frame.velocities[0, 0] == pytest.approx(0.001234, abs=1e-6)
+        assert frame.atom_ids.dtype == np.uint64
+        assert frame.fixed.dtype == np.bool_
+        assert bool(frame.fixed[0]) is frame.atoms[0].is_fixed
+        assert frame.atomic_numbers[0] == 29
+
+    def test_no_velocities(self):
+        pytest.importorskip("numpy")
+        frame = readcon.read_con(_resource("tiny_cuh2.con"))[0]
+        assert frame.velocities is None
+
+    def test_read_con_arrays(self):
+        np = pytest.importorskip("numpy")
+        frames = readcon.read_con(_resource("tiny_multi_cuh2.convel"))
+        arrays = readcon.read_con_arrays(_resource("tiny_multi_cuh2.convel"))
+        assert arrays["positions"].shape == (2, 4, 3)
+        assert arrays["velocities"].shape == (2, 4, 3)
+        assert arrays["atom_ids"].shape == (2, 4)
+        assert arrays["cell"].shape == (2, 3)
+        assert arrays["atomic_numbers"].tolist() == [29, 29, 1, 1]
+        for i, frame in enumerate(frames):
+            np.testing.assert_array_equal(arrays["positions"][i], frame.positions)
+            np.testing.assert_array_equal(arrays["fixed"][i], frame.fixed)
+
+    def test_read_con_arrays_rejects_mixed_composition(self, tmp_path):
+        pytest.importorskip("numpy")
+        with open(_resource("tiny_cuh2.con")) as f:
+            one = f.read()
+        frame = readcon.read_con_string(one)[0]
+        # Blank header lines would read as a velocity section of the first
+        # frame, failing the parse before the composition is checked.
+        smaller = readcon.ConFrame(
+            cell=frame.cell,
+            angles=frame.angles,
+            atoms=frame.atoms[:3],
+            prebox_header=frame.prebox_header,
+            postbox_header=frame.postbox_header,
+        )
+        path = tmp_path / "mixed.con"
+        path.write_text(one + readcon.write_con_string([smaller]))
+        with pytest.raises(ValueError):
+            readcon.read_con_arrays(str(path))
+
+
+class TestLazyIterator:
+    def test_len_and_index(self):
+        frames = readcon.read_con(_resource("tiny_multi_cuh2.con"))
+        lazy = readcon.ConFrameIterator(_resource("tiny_multi_cuh2.con"))
+        assert len(lazy) == len(frames)
+        assert lazy[1].atoms[0].x == pytest.approx(frames[1].atoms[0].x)
+        assert lazy[-1].atoms[0].x == pytest.approx(frames[-1].atoms[0].x)
+        with pytest.raises(IndexError):
+            lazy[len(frames)]
+
+    def test_slice(self):
+        lazy = readcon.ConFrameIterator(_resource("tiny_multi_cuh2.convel"))
+        picked = lazy[::-1]
+        assert len(picked) == 2
+        assert all(frame.has_velocities for frame in picked)
+
+    def test_iteration_is_independent_of_indexing(self):
+        lazy = readcon.ConFrameIterator(_resource("tiny_multi_cuh2.con"))
+        it = iter(lazy)
+        first = next(it)
+        lazy[0]
+        second = next(it)
+        assert len(first) == len(second) == 4
+        with pytest.raises(StopIteration):
+            next(it)
+
+    def test_threads(self):
+        serial = readcon.read_con(_resource("tiny_multi_cuh2.convel"))
+        threaded = readcon.read_con(_resource("tiny_multi_cuh2.convel"), threads=2)
+        assert len(threaded) == len(serial)
+        assert threaded[1].atoms[2].vx == pytest.approx(serial[1].atoms[2].vx)
+
+
+class TestStats:
+    def test_counters_have_every_stage(self):
+        readcon.reset_stats()
+        readcon.read_con(_resource("tiny_multi_cuh2.convel"))
+        stats = readcon.stats()
+        for stage in (
+            "parse_frame_header",
+            "parse_single_frame",
+            "parse_velocity_section",
+            "rkr_frame_to_c_frame",
+            "write_frame",
+        ):
+            assert set(stats[stage]) == {"calls", "nanos"}
+        if stats["enabled"]:
+            assert stats["frames_parsed"] >= 2
+            assert stats["parse_velocity_section"]["calls"] >= 2
+        else:
+            assert stats["bytes_scanned"] == 0